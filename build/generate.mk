@@ -56,6 +56,14 @@ $(OUT)/include/Status_defaults.cpp: Data/Status/default.xcs \
 SM_OBJ = $(call SRC_TO_OBJ,$(SRC)/StatusMessage.cpp)
 $(SM_OBJ): $(OUT)/include/Status_defaults.cpp
 
+$(OUT)/include/Dialogs_tables.cpp: Data/Dialogs/index.txt $(DIALOG_FILES) \
+	tools/xml2cpp.pl $(OUT)/include/dirstamp
+	@$(NQ)echo "  GEN     $@"
+	$(Q)$(PERL) tools/xml2cpp.pl $< >$@.tmp
+	@mv $@.tmp $@
+
+$(call SRC_TO_OBJ,$(SRC)/Dialogs/DialogNode.cpp): $(OUT)/include/Dialogs_tables.cpp
+
 # UNIX resources
 
 ifeq ($(HAVE_WIN32),n)
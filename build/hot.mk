@@ -12,6 +12,7 @@ HOT_SOURCES = \
 	$(SRC)/Terrain/HeightMatrix.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Geo/GeoClip.cpp \
 	$(ENGINE_SRC_DIR)/GlideSolvers/MacCready.cpp \
@@ -27,6 +28,7 @@ HOT_SOURCES = \
 	$(ENGINE_SRC_DIR)/Route/RouteLink.cpp \
 	$(ENGINE_SRC_DIR)/Route/RoutePolars.cpp \
 	$(ENGINE_SRC_DIR)/Task/Tasks/PathSolvers/ContestDijkstra.cpp \
+	$(ENGINE_SRC_DIR)/Task/Tasks/PathSolvers/TaskDijkstra.cpp \
 	$(ENGINE_SRC_DIR)/Math/Earth.cpp
 
 $(call SRC_TO_OBJ,$(HOT_SOURCES)): OPTIMIZE += -O3
@@ -28,3 +28,8 @@ STOP_WATCH ?= n
 ifeq ($(STOP_WATCH),y)
 TARGET_CPPFLAGS += -DSTOP_WATCH
 endif
+
+# maximum number of FLARM targets (raise for ground stations)
+ifneq ($(FLARM_TRAFFIC_CAPACITY),)
+TARGET_CPPFLAGS += -DFLARM_TRAFFIC_CAPACITY=$(FLARM_TRAFFIC_CAPACITY)
+endif
@@ -42,6 +42,7 @@ else
 SCREEN_SOURCES += \
 	$(SCREEN_SRC_DIR)/SDL/Init.cpp \
 	$(SCREEN_SRC_DIR)/SDL/Font.cpp \
+	$(SCREEN_SRC_DIR)/SDL/GlyphAtlas.cpp \
 	$(SCREEN_SRC_DIR)/SDL/Event.cpp \
 	$(SCREEN_SRC_DIR)/SDL/Timer.cpp
 endif
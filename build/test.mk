@@ -69,20 +69,29 @@ TEST_NAMES = \
 	TestRadixTree TestGeoBounds TestGeoClip \
 	TestLogger TestDriver TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
-	test_load_task TestFlarmNet \
+	test_load_task TestFlarmNet TestTracing \
 	TestColorRamp TestGeoPoint TestDiffFilter \
 	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
 	TestOrderedTask \
+	TestTaskDijkstra \
 	TestPlanes \
 	TestTaskPoint \
 	TestTaskWaypoint \
 	TestZeroFinder \
 	TestAirspaceParser \
+	TestAirspaceSorter \
 	TestMETARParser \
 	TestIGCParser \
 	TestByteOrder \
-	TestByteOrder2
+	TestByteOrder2 \
+	TestTrackingQueue \
+	TestRasterPyramid \
+	TestRasterWeatherCache \
+	TestLXNToIGC \
+	TestTaskIndex \
+	TestTelemetry \
+	TestOLCTriangle
 
 TESTS = $(call name-to-bin,$(TEST_NAMES))
 
@@ -92,6 +101,57 @@ TEST_OVERWRITING_RING_BUFFER_SOURCES = \
 TEST_OVERWRITING_RING_BUFFER_DEPENDS = MATH
 $(eval $(call link-program,TestOverwritingRingBuffer,TEST_OVERWRITING_RING_BUFFER))
 
+TEST_TRACKING_QUEUE_SOURCES = \
+	$(SRC)/Tracking/TrackingQueue.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTrackingQueue.cpp
+TEST_TRACKING_QUEUE_DEPENDS = MATH
+$(eval $(call link-program,TestTrackingQueue,TEST_TRACKING_QUEUE))
+
+TEST_RASTER_PYRAMID_SOURCES = \
+	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterPyramid.cpp
+TEST_RASTER_PYRAMID_DEPENDS = JASPER IO ZZIP MATH UTIL
+$(eval $(call link-program,TestRasterPyramid,TEST_RASTER_PYRAMID))
+
+TEST_RASTER_WEATHER_CACHE_SOURCES = \
+	$(SRC)/Terrain/RasterWeatherCache.cpp \
+	$(SRC)/Terrain/RasterMap.cpp \
+	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/RasterProjection.cpp \
+	$(SRC)/Geo/GeoClip.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/StandbyThread.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterWeatherCache.cpp
+TEST_RASTER_WEATHER_CACHE_DEPENDS = ENGINE JASPER IO ZZIP MATH UTIL
+$(eval $(call link-program,TestRasterWeatherCache,TEST_RASTER_WEATHER_CACHE))
+
+TEST_LXN_TO_IGC_SOURCES = \
+	$(SRC)/Device/Driver/LX/Convert.cpp \
+	$(SRC)/Device/Driver/LX/LXN.cpp \
+	$(SRC)/Device/Driver/DownloadPipeline.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestLXNToIGC.cpp
+TEST_LXN_TO_IGC_DEPENDS = MATH
+$(eval $(call link-program,TestLXNToIGC,TEST_LXN_TO_IGC))
+
 TEST_IGC_PARSER_SOURCES = \
 	$(SRC)/Replay/IGCParser.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -134,6 +194,12 @@ TEST_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 TEST_AIRSPACE_PARSER_DEPENDS = ENGINE IO ZZIP MATH UTIL
 $(eval $(call link-program,TestAirspaceParser,TEST_AIRSPACE_PARSER))
 
+TEST_AIRSPACE_SORTER_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceSorter.cpp
+TEST_AIRSPACE_SORTER_DEPENDS = ENGINE MATH UTIL
+$(eval $(call link-program,TestAirspaceSorter,TEST_AIRSPACE_SORTER))
+
 TEST_DATE_TIME_SOURCES = \
 	$(SRC)/DateTime.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -163,6 +229,15 @@ $(TARGET_BIN_DIR)/TestOrderedTask$(TARGET_EXEEXT): $(TEST_ORDERED_TASK_OBJS) $(T
 	@$(NQ)echo "  LINK    $@"
 	$(Q)$(LINK) $(LDFLAGS) $(TARGET_ARCH) $^ $(LDLIBS) -o $@
 
+TEST_TASK_DIJKSTRA_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTaskDijkstra.cpp
+TEST_TASK_DIJKSTRA_OBJS = $(call SRC_TO_OBJ,$(TEST_TASK_DIJKSTRA_SOURCES))
+TEST_TASK_DIJKSTRA_LDADD = $(ENGINE_CORE_LIBS) $(MATH_LIBS) $(UTIL_LIBS)
+$(TARGET_BIN_DIR)/TestTaskDijkstra$(TARGET_EXEEXT): $(TEST_TASK_DIJKSTRA_OBJS) $(TEST_TASK_DIJKSTRA_LDADD) | $(TARGET_BIN_DIR)/dirstamp
+	@$(NQ)echo "  LINK    $@"
+	$(Q)$(LINK) $(LDFLAGS) $(TARGET_ARCH) $^ $(LDLIBS) -o $@
+
 TEST_PLANES_SOURCES = \
 	$(SRC)/Plane/PlaneFileGlue.cpp \
 	$(SRC)/Units/Descriptor.cpp \
@@ -207,6 +282,8 @@ $(eval $(call link-program,TestTaskWaypoint,TEST_TASKWAYPOINT))
 TEST_TROUTE_SOURCES = \
 	$(SRC)/xmlParser.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
@@ -221,6 +298,8 @@ $(eval $(call link-program,test_troute,TEST_TROUTE))
 TEST_REACH_SOURCES = \
 	$(SRC)/xmlParser.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
@@ -235,6 +314,8 @@ $(eval $(call link-program,test_reach,TEST_REACH))
 TEST_ROUTE_SOURCES = \
 	$(SRC)/xmlParser.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
@@ -293,6 +374,22 @@ TEST_FLARM_NET_SOURCES = \
 TEST_FLARM_NET_DEPENDS = MATH IO
 $(eval $(call link-program,TestFlarmNet,TEST_FLARM_NET))
 
+TEST_TRACING_SOURCES = \
+	$(SRC)/Tracing/Tracing.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTracing.cpp
+$(eval $(call link-program,TestTracing,TEST_TRACING))
+
+TEST_TELEMETRY_SOURCES = \
+	$(SRC)/Telemetry/Telemetry.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTelemetry.cpp
+$(eval $(call link-program,TestTelemetry,TEST_TELEMETRY))
+
 TEST_GEO_CLIP_SOURCES = \
 	$(SRC)/Geo/GeoClip.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -357,6 +454,15 @@ TEST_GLIDE_POLAR_SOURCES = \
 TEST_GLIDE_POLAR_DEPENDS = MATH IO
 $(eval $(call link-program,TestGlidePolar,TEST_GLIDE_POLAR))
 
+TEST_TASK_INDEX_SOURCES = \
+	$(SRC)/Task/TaskIndex.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTaskIndex.cpp
+TEST_TASK_INDEX_DEPENDS = MATH
+$(eval $(call link-program,TestTaskIndex,TEST_TASK_INDEX))
+
 TEST_FILE_UTIL_SOURCES = \
 	$(SRC)/OS/FileUtil.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -385,6 +491,12 @@ TEST_FLAT_POINT_SOURCES = \
 TEST_FLAT_POINT_DEPENDS = MATH
 $(eval $(call link-program,TestFlatPoint,TEST_FLAT_POINT))
 
+TEST_OLC_TRIANGLE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestOLCTriangle.cpp
+TEST_OLC_TRIANGLE_DEPENDS = ENGINE MATH UTIL
+$(eval $(call link-program,TestOLCTriangle,TEST_OLC_TRIANGLE))
+
 TEST_FLAT_GEO_POINT_SOURCES = \
 	$(ENGINE_SRC_DIR)/Navigation/Flat/FlatGeoPoint.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -490,6 +602,7 @@ TEST_DRIVER_SOURCES = \
 	$(LX_SOURCES) \
 	$(FLARM_SOURCES) \
 	$(VOLKSLOGGER_SOURCES) \
+	$(SRC)/Device/Driver/DownloadPipeline.cpp \
 	$(SRC)/FLARM/Traffic.cpp \
 	$(SRC)/FLARM/FlarmId.cpp \
 	$(SRC)/FLARM/FlarmCalculations.cpp \
@@ -504,6 +617,8 @@ TEST_DRIVER_SOURCES = \
 	$(SRC)/Replay/IGCParser.cpp \
 	$(SRC)/ClimbAverageCalculator.cpp \
 	$(SRC)/OS/Clock.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Util/StringUtil.cpp \
 	$(SRC)/Operation/Operation.cpp \
 	$(ENGINE_SRC_DIR)/Math/Earth.cpp \
@@ -579,6 +694,20 @@ check: $(TESTS) | $(OUT)/test/dirstamp
 	@$(NQ)echo "  TEST    $(notdir $(patsubst %$(TARGET_EXEEXT),%,$^))"
 	$(Q)$(PERL) $(TEST_SRC_DIR)/testall.pl $(TESTS)
 
+BENCH_NAMES = \
+	BenchmarkProjection \
+	BenchmarkEngine \
+	BenchmarkTerrain
+
+BENCH_PROGRAMS = $(call name-to-bin,$(BENCH_NAMES))
+BENCH_OUTPUT = $(OUT)/bench.json
+
+# run the benchmark kernels on the fixed input data in test/data and
+# write the results (JSON) to $(BENCH_OUTPUT)
+bench: $(BENCH_PROGRAMS) | $(OUT)/test/dirstamp
+	@$(NQ)echo "  BENCH   $(BENCH_OUTPUT)"
+	$(Q)$(PERL) $(TEST_SRC_DIR)/benchall.pl $(BENCH_PROGRAMS) >$(BENCH_OUTPUT)
+
 DEBUG_PROGRAM_NAMES = \
 	test_reach \
 	test_route \
@@ -587,7 +716,8 @@ DEBUG_PROGRAM_NAMES = \
 	FlightTable \
 	RunTrace \
 	RunOLCAnalysis \
-	BenchmarkProjection \
+	RunBatchContest \
+	BenchmarkProjection BenchmarkEngine BenchmarkTerrain \
 	DumpTextFile DumpTextZip WriteTextFile RunTextWriter \
 	RunXMLParser \
 	ReadMO \
@@ -622,7 +752,10 @@ DEBUG_PROGRAM_NAMES = \
 ifeq ($(TARGET),UNIX)
 DEBUG_PROGRAM_NAMES += FeedNMEA \
 	FeedTCP \
-	FeedTCPServer
+	FeedTCPServer \
+	FeedFlightLoad \
+	DumpTelemetry \
+	FakeLiveTrack24
 endif
 
 ifeq ($(TARGET),PC)
@@ -668,6 +801,8 @@ DEBUG_REPLAY_SOURCES = \
 	$(SRC)/NMEA/ThermalBand.cpp \
 	$(SRC)/NMEA/ThermalLocator.cpp \
 	$(SRC)/OS/Clock.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Operation/Operation.cpp \
 	$(SRC)/Engine/Navigation/TraceHistory.cpp \
 	$(SRC)/FLARM/State.cpp \
@@ -706,11 +841,61 @@ DEBUG_REPLAY_LDADD = \
 
 BENCHMARK_PROJECTION_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/OS/Clock.cpp \
 	$(TEST_SRC_DIR)/BenchmarkProjection.cpp
 BENCHMARK_PROJECTION_DEPENDS = MATH
 BENCHMARK_PROJECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,BenchmarkProjection,BENCHMARK_PROJECTION))
 
+BENCHMARK_ENGINE_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Geo/UTM.cpp \
+	$(SRC)/Waypoint/WaypointReaderBase.cpp \
+	$(SRC)/Waypoint/WaypointReader.cpp \
+	$(SRC)/Waypoint/WaypointReaderWinPilot.cpp \
+	$(SRC)/Waypoint/WaypointReaderFS.cpp \
+	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
+	$(SRC)/Waypoint/WaypointReaderSeeYou.cpp \
+	$(SRC)/Waypoint/WaypointReaderZander.cpp \
+	$(SRC)/Waypoint/WaypointReaderCompeGPS.cpp \
+	$(SRC)/UtilsFile.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Poco/RWLock.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkEngine.cpp
+BENCHMARK_ENGINE_LDADD = $(DEBUG_REPLAY_LDADD) $(FAKE_LIBS)
+BENCHMARK_ENGINE_DEPENDS = ENGINE IO ZZIP MATH UTIL
+$(eval $(call link-program,BenchmarkEngine,BENCHMARK_ENGINE))
+
+BENCHMARK_TERRAIN_SOURCES = \
+	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/RasterProjection.cpp \
+	$(SRC)/Terrain/RasterMap.cpp \
+	$(SRC)/Terrain/HeightMatrix.cpp \
+	$(SRC)/Geo/GeoClip.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(SRC)/OS/PathName.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Util/UTF8.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrain.cpp
+BENCHMARK_TERRAIN_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_DEPENDS = ENGINE MATH IO JASPER ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrain,BENCHMARK_TERRAIN))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(SRC)/Util/UTF8.cpp \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
@@ -770,6 +955,7 @@ $(eval $(call link-program,RunNOAADownloader,RUN_NOAA_DOWNLOADER))
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Tracking/LiveTrack24.cpp \
+	$(SRC)/Tracking/TrackingQueue.cpp \
 	$(SRC)/Version.cpp \
 	$(SRC)/DateTime.cpp \
 	$(SRC)/Net/ToBuffer.cpp \
@@ -792,6 +978,7 @@ $(eval $(call link-program,RunXMLParser,RUN_XML_PARSER))
 READ_MO_SOURCES = \
 	$(SRC)/Language/MOFile.cpp \
 	$(SRC)/OS/FileMapping.cpp \
+	$(SRC)/OS/Clock.cpp \
 	$(TEST_SRC_DIR)/ReadMO.cpp
 $(eval $(call link-program,ReadMO,READ_MO))
 
@@ -897,6 +1084,9 @@ $(eval $(call link-program,LoadTopography,LOAD_TOPOGRAPHY))
 
 LOAD_TERRAIN_SOURCES = \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
+	$(SRC)/OS/Clock.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/OS/FileUtil.cpp \
@@ -912,10 +1102,19 @@ $(eval $(call link-program,LoadTerrain,LOAD_TERRAIN))
 
 RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
+	$(SRC)/OS/Clock.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
+	$(SRC)/Terrain/RasterRenderer.cpp \
+	$(SRC)/Screen/Ramp.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
+	$(SRC)/Thread/Debug.cpp \
+	$(SRC)/Thread/WorkerPool.cpp \
 	$(SRC)/Geo/GeoClip.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
@@ -925,9 +1124,9 @@ RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Operation/Operation.cpp \
 	$(SRC)/Util/UTF8.cpp \
 	$(ENGINE_SRC_DIR)/Navigation/GeoPoint.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
 	$(TEST_SRC_DIR)/RunHeightMatrix.cpp
-RUN_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
-RUN_HEIGHT_MATRIX_DEPENDS = MATH IO JASPER ZZIP
+RUN_HEIGHT_MATRIX_DEPENDS = SCREEN MATH IO JASPER ZZIP UTIL
 $(eval $(call link-program,RunHeightMatrix,RUN_HEIGHT_MATRIX))
 
 RUN_INPUT_PARSER_SOURCES = \
@@ -1064,6 +1263,8 @@ RUN_DEVICE_DRIVER_SOURCES = \
 	$(SRC)/ClimbAverageCalculator.cpp \
 	$(SRC)/Compatibility/string.c \
 	$(SRC)/OS/Clock.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Operation/Operation.cpp \
 	$(ENGINE_SRC_DIR)/Math/Earth.cpp \
 	$(ENGINE_SRC_DIR)/Atmosphere/Pressure.cpp \
@@ -1090,6 +1291,7 @@ RUN_DECLARE_SOURCES = \
 	$(SRC)/OS/Clock.cpp \
 	$(SRC)/Thread/Thread.cpp \
 	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Compatibility/string.c \
 	$(SRC)/Operation/Operation.cpp \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
@@ -1154,6 +1356,7 @@ RUN_FLIGHT_LIST_SOURCES = \
 	$(SRC)/OS/Clock.cpp \
 	$(SRC)/Thread/Thread.cpp \
 	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Compatibility/string.c \
 	$(SRC)/Operation/Operation.cpp \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
@@ -1192,6 +1395,7 @@ RUN_DOWNLOAD_FLIGHT_SOURCES = \
 	$(SRC)/OS/Clock.cpp \
 	$(SRC)/Thread/Thread.cpp \
 	$(SRC)/Thread/StoppableThread.cpp \
+	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Compatibility/string.c \
 	$(SRC)/Operation/Operation.cpp \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
@@ -1320,6 +1524,40 @@ RUN_OLC_CPPFLAGS = -DDO_PRINT
 RUN_OLC_DEPENDS = UTIL MATH
 $(eval $(call link-program,RunOLCAnalysis,RUN_OLC))
 
+RUN_BATCH_CONTEST_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/Replay/IGCParser.cpp \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(SRC)/UtilsFile.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/SearchPoint.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/SearchPointVector.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/TracePoint.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/Flat/FlatGeoPoint.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/Flat/FlatRay.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/TaskProjection.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/ConvexHull/GrahamScan.cpp \
+	$(ENGINE_SRC_DIR)/Navigation/ConvexHull/PolygonInterior.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestManager.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/Contests.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/AbstractContest.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/ContestDijkstra.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCLeague.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCSprint.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCClassic.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCTriangle.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCFAI.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCPlus.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/XContestFree.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/XContestTriangle.cpp \
+	$(ENGINE_SRC_DIR)/Contest/ContestSolvers/OLCSISAT.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(SRC)/OS/FileUtil.cpp \
+	$(TEST_SRC_DIR)/RunBatchContest.cpp
+RUN_BATCH_CONTEST_LDADD = $(DEBUG_REPLAY_LDADD)
+RUN_BATCH_CONTEST_DEPENDS = UTIL MATH
+$(eval $(call link-program,RunBatchContest,RUN_BATCH_CONTEST))
+
 RUN_CANVAS_SOURCES = \
 	$(SRC)/Screen/Layout.cpp \
 	$(SRC)/Thread/Debug.cpp \
@@ -1364,6 +1602,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Projection/CompareProjection.cpp \
 	$(SRC)/Geo/GeoClip.cpp \
 	$(SRC)/MapWindow/MapWindow.cpp \
+	$(SRC)/MapWindow/MapLayerCache.cpp \
 	$(SRC)/MapWindow/MapWindowBlackboard.cpp \
 	$(SRC)/MapWindow/MapWindowEvents.cpp \
 	$(SRC)/MapWindow/MapWindowGlideRange.cpp \
@@ -1399,9 +1638,12 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterTerrain.cpp \
 	$(SRC)/Terrain/RasterWeather.cpp \
+	$(SRC)/Terrain/RasterWeatherCache.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
 	$(SRC)/Terrain/TerrainRenderer.cpp \
@@ -1437,6 +1679,9 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Thread/Debug.cpp \
 	$(SRC)/Thread/Mutex.cpp \
 	$(SRC)/Thread/Notify.cpp \
+	$(SRC)/Thread/Thread.cpp \
+	$(SRC)/Thread/StandbyThread.cpp \
+	$(SRC)/Thread/WorkerPool.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
@@ -1482,9 +1727,8 @@ $(eval $(call link-program,RunMapWindow,RUN_MAP_WINDOW))
 RUN_DIALOG_SOURCES = \
 	$(SRC)/Look/DialogLook.cpp \
 	$(SRC)/Look/ButtonLook.cpp \
-	$(SRC)/xmlParser.cpp \
 	$(SRC)/Dialogs/XML.cpp \
-	$(SRC)/Dialogs/Inflate.cpp \
+	$(SRC)/Dialogs/DialogNode.cpp \
 	$(SRC)/Dialogs/ListPicker.cpp \
 	$(SRC)/Dialogs/ComboPicker.cpp \
 	$(SRC)/Screen/Layout.cpp \
@@ -1742,12 +1986,15 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterPyramid.cpp \
+	$(SRC)/Tracing/Tracing.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterTerrain.cpp \
+	$(SRC)/Terrain/TerrainHeightCache.cpp \
 	$(SRC)/Terrain/TerrainSettings.cpp \
 	$(SRC)/xmlParser.cpp \
 	$(SRC)/Dialogs/XML.cpp \
-	$(SRC)/Dialogs/Inflate.cpp \
+	$(SRC)/Dialogs/DialogNode.cpp \
 	$(SRC)/Dialogs/dlgAnalysis.cpp \
 	$(SRC)/Dialogs/dlgHelp.cpp \
 	$(SRC)/Dialogs/ComboPicker.cpp \
@@ -1832,7 +2079,7 @@ RUN_AIRSPACE_WARNING_DIALOG_SOURCES = \
 	$(SRC)/Look/DialogLook.cpp \
 	$(SRC)/Look/ButtonLook.cpp \
 	$(SRC)/Dialogs/XML.cpp \
-	$(SRC)/Dialogs/Inflate.cpp \
+	$(SRC)/Dialogs/DialogNode.cpp \
 	$(SRC)/Dialogs/ListPicker.cpp \
 	$(SRC)/Dialogs/ComboPicker.cpp \
 	$(SRC)/Dialogs/dlgHelp.cpp \
@@ -1876,7 +2123,7 @@ RUN_TASK_EDITOR_DIALOG_SOURCES = \
 	$(SRC)/xmlParser.cpp \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Dialogs/XML.cpp \
-	$(SRC)/Dialogs/Inflate.cpp \
+	$(SRC)/Dialogs/DialogNode.cpp \
 	$(SRC)/Dialogs/ComboPicker.cpp \
 	$(SRC)/Dialogs/dlgHelp.cpp \
 	$(SRC)/Dialogs/dlgTaskOverview.cpp \
@@ -1977,6 +2224,21 @@ endif
 
 $(eval $(call link-program,FeedTCPServer,FEED_TCP_SERVER))
 
+FEED_FLIGHT_LOAD_SOURCES = \
+	$(SRC)/NMEA/Checksum.cpp \
+	$(SRC)/OS/Clock.cpp \
+	$(TEST_SRC_DIR)/FeedFlightLoad.cpp
+$(eval $(call link-program,FeedFlightLoad,FEED_FLIGHT_LOAD))
+
+DUMP_TELEMETRY_SOURCES = \
+	$(TEST_SRC_DIR)/DumpTelemetry.cpp
+$(eval $(call link-program,DumpTelemetry,DUMP_TELEMETRY))
+
+FAKE_LIVETRACK24_SOURCES = \
+	$(SRC)/OS/Clock.cpp \
+	$(TEST_SRC_DIR)/FakeLiveTrack24.cpp
+$(eval $(call link-program,FakeLiveTrack24,FAKE_LIVETRACK24))
+
 TODAY_INSTALL_SOURCES = \
 	$(TEST_SRC_DIR)/TodayInstall.cpp
 $(eval $(call link-program,TodayInstall,TODAY_INSTALL))
@@ -28,13 +28,18 @@ Copyright_License {
 #include "DeviceBlackboard.hpp"
 #include "Components.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
+#include "Tracing/Tracing.hpp"
+#include "Telemetry/Telemetry.hpp"
+#include "Telemetry/TelemetryGlue.hpp"
+#include "PeriodClock.hpp"
 
 /**
  * Constructor of the CalculationThread class
  * @param _glide_computer The GlideComputer used for the CalculationThread
  */
 CalculationThread::CalculationThread(GlideComputer &_glide_computer)
-  :WorkerThread(450, 100, 50), glide_computer(_glide_computer) {
+  :WorkerThread(450, 100, 50), processed_time(fixed_minus_one),
+   glide_computer(_glide_computer) {
 }
 
 void
@@ -51,12 +56,39 @@ CalculationThread::SetScreenDistanceMeters(fixed new_value)
   screen_distance_meters = new_value;
 }
 
+bool
+CalculationThread::WaitFixProcessed(fixed time, unsigned timeout_ms)
+{
+  PeriodClock clock;
+  clock.update();
+
+  while (true) {
+    {
+      ScopeLock protect(mutex);
+      if (processed_time == time)
+        return true;
+    }
+
+    const int remaining = (int)timeout_ms - clock.elapsed();
+    if (remaining <= 0 || !fix_processed.Wait(remaining))
+      return false;
+
+    /* the trigger may be left over from an older fix; reset it and
+       check again */
+    fix_processed.Reset();
+  }
+}
+
 /**
  * Main loop of the CalculationThread
  */
 void
 CalculationThread::Tick()
 {
+  Tracing::SetThreadName("CalculationThread");
+  TRACE_SPAN("CalculationThread::Tick");
+  ScopeTelemetryCycle telemetry_cycle(Telemetry::CALCULATION_THREAD);
+
   bool gps_updated;
 
   // update and transfer master info to glide computer
@@ -93,8 +125,18 @@ CalculationThread::Tick()
     device_blackboard->ReadBlackboard(glide_computer.Calculated());
   }
 
+  Telemetry::PublishFlight(glide_computer.Basic(), glide_computer.Calculated(),
+                           glide_computer.GetComputerSettings());
+
   // if (new GPS data)
   if (gps_updated) {
+    {
+      ScopeLock protect(mutex);
+      processed_time = glide_computer.Basic().time;
+    }
+
+    fix_processed.Signal();
+
     // inform map new data is ready
     TriggerCalculatedUpdate();
   }
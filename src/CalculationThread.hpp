@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Thread/WorkerThread.hpp"
 #include "Thread/Mutex.hpp"
+#include "Thread/Trigger.hpp"
 #include "ComputerSettings.hpp"
 
 class GlideComputer;
@@ -37,8 +38,8 @@ class GlideComputer;
  */
 class CalculationThread : public WorkerThread {
   /**
-   * This mutex protects #settings_computer and
-   * #screen_distance_meters.
+   * This mutex protects #settings_computer,
+   * #screen_distance_meters and #processed_time.
    */
   Mutex mutex;
 
@@ -46,6 +47,17 @@ class CalculationThread : public WorkerThread {
 
   fixed screen_distance_meters;
 
+  /**
+   * The time stamp of the last GPS fix which was processed by
+   * Tick().
+   */
+  fixed processed_time;
+
+  /**
+   * Signalled each time Tick() has processed a GPS fix.
+   */
+  ::Trigger fix_processed;
+
   /** Pointer to the GlideComputer that should be used */
   GlideComputer &glide_computer;
 
@@ -55,6 +67,15 @@ public:
   void SetComputerSettings(const ComputerSettings &new_value);
   void SetScreenDistanceMeters(fixed new_value);
 
+  /**
+   * Wait until the GPS fix with the specified time stamp has been
+   * processed.  The max-speed replay uses this to feed fixes no
+   * faster than they can be calculated.
+   *
+   * @return false on timeout
+   */
+  bool WaitFixProcessed(fixed time, unsigned timeout_ms);
+
   bool Start(bool suspended=false) {
     if (!WorkerThread::Start(suspended))
       return false;
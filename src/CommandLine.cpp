@@ -24,6 +24,9 @@ Copyright_License {
 #include "CommandLine.hpp"
 #include "Profile/Profile.hpp"
 #include "Simulator.hpp"
+#include "Tracing/Tracing.hpp"
+#include "Telemetry/Telemetry.hpp"
+#include "Compiler.h"
 
 #include <windef.h> /* for MAX_PATH */
 
@@ -32,6 +35,25 @@ int SCREENWIDTH = 640;
 int SCREENHEIGHT = 480;
 #endif
 
+/**
+ * Checks whether the command line contains the specified option as a
+ * whole argument, and not only as part of another one.
+ */
+gcc_pure
+static bool
+HasOption(const TCHAR *command_line, const TCHAR *option)
+{
+  const size_t length = _tcslen(option);
+
+  for (const TCHAR *p = command_line;
+       (p = _tcsstr(p, option)) != NULL; p += length)
+    if ((p == command_line || p[-1] == _T(' ')) &&
+        (p[length] == _T('\0') || p[length] == _T(' ')))
+      return true;
+
+  return false;
+}
+
 void
 ParseCommandLine(const TCHAR *CommandLine)
 {
@@ -75,6 +97,13 @@ ParseCommandLine(const TCHAR *CommandLine)
 
   Profile::SetFiles(extrnProfileFile);
 
+  if (HasOption(CommandLine, _T("-trace")))
+    Tracing::Enable();
+
+  if (HasOption(CommandLine, _T("-telemetry")) &&
+      !Telemetry::IsEnabled())
+    Telemetry::Open();
+
 #if !defined(_WIN32_WCE)
   SCREENWIDTH = 640;
   SCREENHEIGHT = 480;
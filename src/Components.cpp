@@ -72,6 +72,8 @@ Copyright_License {
 #include "CalculationThread.hpp"
 #include "Replay/Replay.hpp"
 #include "LocalPath.hpp"
+#include "Tracing/Tracing.hpp"
+#include "Telemetry/Telemetry.hpp"
 #include "IO/FileCache.hpp"
 #include "Hardware/AltairControl.hpp"
 #include "Hardware/DisplayGlue.hpp"
@@ -499,6 +501,9 @@ XCSoarInterface::Shutdown(void)
 
   operation.SetText(_("Shutdown, please wait..."));
 
+  // Stop the replay, because a max-speed replay feeds the threads
+  replay->Stop();
+
   // Stop threads
   LogStartUp(_T("Stop threads"));
 #ifndef ENABLE_OPENGL
@@ -561,6 +566,15 @@ XCSoarInterface::Shutdown(void)
 
   NMEALogger::Shutdown();
 
+  Telemetry::Close();
+
+  if (Tracing::IsEnabled()) {
+    LogStartUp(_T("Save trace"));
+    TCHAR path[MAX_PATH];
+    LocalPath(path, _T("xcsoar-trace.json"));
+    Tracing::ExportChromeTrace(path);
+  }
+
   delete replay;
 
   delete device_blackboard;
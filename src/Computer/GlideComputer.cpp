@@ -35,6 +35,7 @@ Copyright_License {
 #include "Logger/Logger.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "LocalTime.hpp"
+#include "Tracing/Tracing.hpp"
 
 static PeriodClock last_team_code_update;
 
@@ -87,6 +88,8 @@ GlideComputer::Initialise()
 bool
 GlideComputer::ProcessGPS()
 {
+  TRACE_SPAN("GlideComputer::ProcessGPS");
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
 
@@ -145,6 +148,8 @@ GlideComputer::ProcessGPS()
 void
 GlideComputer::ProcessIdle(bool exhaustive)
 {
+  TRACE_SPAN("GlideComputer::ProcessIdle");
+
   // Log GPS fixes for internal usage
   // (snail trail, stats, olc, ...)
   DoLogging(Basic(), LastBasic(), Calculated(), GetComputerSettings());
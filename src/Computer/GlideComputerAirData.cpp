@@ -32,6 +32,7 @@ Copyright_License {
 #include "GlideSolvers/GlidePolar.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Math/SunEphemeris.hpp"
+#include "Tracing/Tracing.hpp"
 
 #include <algorithm>
 
@@ -409,7 +410,10 @@ GlideComputerAirData::TerrainHeight()
     return;
   }
 
-  short Alt = terrain->GetTerrainHeight(basic.location);
+  short Alt = terrain_cache.GetHeight(*terrain, basic.location);
+  TRACE_COUNTER("Terrain.height_cache_hits", terrain_cache.GetHits());
+  TRACE_COUNTER("Terrain.height_cache_misses", terrain_cache.GetMisses());
+
   if (RasterBuffer::is_special(Alt)) {
     if (RasterBuffer::is_water(Alt))
       /* assume water is 0m MSL; that's the best guess */
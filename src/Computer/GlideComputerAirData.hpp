@@ -32,6 +32,7 @@ Copyright_License {
 #include "WindComputer.hpp"
 #include "ThermalLocator.hpp"
 #include "Util/WindowFilter.hpp"
+#include "Terrain/TerrainHeightCache.hpp"
 
 class Waypoints;
 class Airspaces;
@@ -47,6 +48,12 @@ class GlideComputerAirData: virtual public GlideComputerBlackboard {
   const Waypoints &waypoints;
   const RasterTerrain *terrain;
 
+  /**
+   * Caches the terrain height below the aircraft; it rarely moves
+   * into another pixel between two fixes while circling.
+   */
+  TerrainHeightCache terrain_cache;
+
   AutoQNH auto_qnh;
 
   GlideRatioCalculator gr_calculator;
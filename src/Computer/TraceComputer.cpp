@@ -25,6 +25,8 @@ Copyright_License {
 #include "ComputerSettings.hpp"
 #include "Engine/Navigation/Aircraft.hpp"
 
+#include <algorithm>
+
 TraceComputer::TraceComputer()
  :full(60),
   sprint(0, 9000, 300)
@@ -60,6 +62,39 @@ TraceComputer::LockedCopyTo(TracePointVector &v, unsigned min_time,
   mutex.Unlock();
 }
 
+bool
+TraceComputer::LockedSyncTo(TracePointVector &v, Serial &append_serial,
+                            Serial &modify_serial) const
+{
+  ScopeLock protect(mutex);
+
+  if (full.GetModifySerial() != modify_serial) {
+    full.get_trace_points(v);
+    append_serial = full.GetAppendSerial();
+    modify_serial = full.GetModifySerial();
+    return false;
+  }
+
+  if (full.GetAppendSerial() == append_serial)
+    return true;
+
+  append_serial = full.GetAppendSerial();
+
+  /* walk back from the end to the last point we already have; the
+     trace is chronological, and only a few points are new */
+  const unsigned old_size = v.size();
+  const Trace::const_reverse_iterator end = full.rend();
+  for (Trace::const_reverse_iterator i = full.rbegin(); i != end; ++i) {
+    if (old_size > 0 && !i->IsNewerThan(v[old_size - 1]))
+      break;
+
+    v.push_back(*i);
+  }
+
+  std::reverse(v.begin() + old_size, v.end());
+  return true;
+}
+
 void
 TraceComputer::Update(const ComputerSettings &settings_computer,
                       const AircraftState &state)
@@ -87,6 +87,23 @@ public:
   void LockedCopyTo(TracePointVector &v, unsigned min_time,
                             const GeoPoint &location, fixed resolution) const;
 
+  /**
+   * Update a copy of the full trace that was created by an earlier
+   * call.  Only the points appended since then are copied, unless
+   * the trace has been cleared or optimised meanwhile, which
+   * requires a full copy.  The trace is locked, and the method may
+   * be called from any thread.
+   *
+   * @param append_serial the trace's append serial at the time of
+   * the last call; will be updated
+   * @param modify_serial the trace's modify serial at the time of
+   * the last call; will be updated
+   * @return false if the copy was rebuilt, true if points were only
+   * appended (or nothing changed)
+   */
+  bool LockedSyncTo(TracePointVector &v, Serial &append_serial,
+                    Serial &modify_serial) const;
+
   void Update(const ComputerSettings &settings_computer,
               const AircraftState &state);
   void Idle(const ComputerSettings &settings_computer,
@@ -26,6 +26,7 @@ Copyright_License {
 #include "Device/Parser.hpp"
 #include "Driver/FLARM/Device.hpp"
 #include "Device/Internal.hpp"
+#include "Tracing/Tracing.hpp"
 #include "Device/Register.hpp"
 #include "DeviceBlackboard.hpp"
 #include "Components.hpp"
@@ -522,6 +523,8 @@ DeviceDescriptor::ParseLine(const char *line)
 void
 DeviceDescriptor::DataReceived(const void *data, size_t length)
 {
+  TRACE_SPAN("DeviceDescriptor::DataReceived");
+
   if (monitor != NULL)
     monitor->DataReceived(data, length);
 
@@ -0,0 +1,159 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Device/Driver/DownloadPipeline.hpp"
+
+#include <assert.h>
+
+DownloadPipeline::DownloadPipeline(Consumer &_consumer)
+  :consumer(_consumer), head(0), queued(0), failed(false)
+#ifdef HAVE_POSIX
+  , thread(*this), finished(false)
+#endif
+{
+}
+
+DownloadPipeline::~DownloadPipeline()
+{
+#ifdef HAVE_POSIX
+  if (thread.IsDefined()) {
+    mutex.Lock();
+    failed = true;
+    finished = true;
+    cond.Broadcast();
+    mutex.Unlock();
+
+    thread.Join();
+  }
+#endif
+}
+
+void *
+DownloadPipeline::GetBuffer(size_t size)
+{
+#ifdef HAVE_POSIX
+  mutex.Lock();
+  while (queued == NUM_BUFFERS && !failed)
+    cond.Wait(mutex);
+
+  const bool _failed = failed;
+  mutex.Unlock();
+
+  if (_failed)
+    return NULL;
+#else
+  if (failed)
+    return NULL;
+#endif
+
+  /* the consumer doesn't touch the #head buffer while it is not
+     queued, so it can be resized without holding the lock */
+  Buffer &buffer = buffers[head];
+  buffer.data.GrowDiscard(size);
+  return buffer.data.begin();
+}
+
+void
+DownloadPipeline::Commit(size_t length)
+{
+  assert(length <= buffers[head].data.size());
+
+  buffers[head].length = length;
+
+#ifdef HAVE_POSIX
+  if (!thread.IsDefined() && !thread.Start())
+    /* no thread: fall back to synchronous conversion */
+    failed = failed || !consumer.OnBlock(buffers[head].data.begin(), length);
+  else {
+    mutex.Lock();
+    assert(queued < NUM_BUFFERS);
+    head = (head + 1) % NUM_BUFFERS;
+    ++queued;
+    cond.Broadcast();
+    mutex.Unlock();
+  }
+#else
+  if (!failed && !consumer.OnBlock(buffers[head].data.begin(), length))
+    failed = true;
+#endif
+}
+
+bool
+DownloadPipeline::Finish()
+{
+#ifdef HAVE_POSIX
+  if (thread.IsDefined()) {
+    mutex.Lock();
+    finished = true;
+    cond.Broadcast();
+    mutex.Unlock();
+
+    thread.Join();
+  }
+#endif
+
+  return !failed;
+}
+
+#ifdef HAVE_POSIX
+
+void
+DownloadPipeline::Run()
+{
+  mutex.Lock();
+
+  while (true) {
+    if (queued == 0) {
+      if (finished)
+        break;
+
+      cond.Wait(mutex);
+      continue;
+    }
+
+    Buffer &buffer = buffers[(head + NUM_BUFFERS - queued) % NUM_BUFFERS];
+
+    if (!failed) {
+      mutex.Unlock();
+      const bool success = consumer.OnBlock(buffer.data.begin(),
+                                            buffer.length);
+      mutex.Lock();
+
+      if (!success)
+        failed = true;
+    }
+
+    --queued;
+    cond.Broadcast();
+  }
+
+  mutex.Unlock();
+}
+
+void
+DownloadPipeline::ConsumerThread::Run()
+{
+  pipeline.Run();
+}
+
+#endif
@@ -0,0 +1,160 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_DEVICE_DOWNLOAD_PIPELINE_HPP
+#define XCSOAR_DEVICE_DOWNLOAD_PIPELINE_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Util/AllocatedArray.hpp"
+
+#ifdef HAVE_POSIX
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hpp"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Passes blocks of flight data received from a logger to a
+ * #Consumer (e.g. a converter writing an IGC file) running in another
+ * thread, so converting and writing one block overlaps with the
+ * transfer of the next one.
+ *
+ * The memory usage is bounded: there are only #NUM_BUFFERS buffers,
+ * and GetBuffer() waits until the consumer has released one.  On
+ * platforms without POSIX threads, and if the thread cannot be
+ * created, the consumer is invoked synchronously by Commit().
+ */
+class DownloadPipeline : private NonCopyable {
+public:
+  class Consumer {
+  public:
+    /**
+     * Process the next block.  Blocks are passed in the order they
+     * were committed.
+     *
+     * @return false on error; all further blocks are discarded
+     */
+    virtual bool OnBlock(const void *data, size_t length) = 0;
+  };
+
+  static const unsigned NUM_BUFFERS = 2;
+
+private:
+  struct Buffer {
+    AllocatedArray<uint8_t> data;
+    size_t length;
+  };
+
+  Consumer &consumer;
+
+  Buffer buffers[NUM_BUFFERS];
+
+  /**
+   * The buffer which is filled by the producer next.
+   */
+  unsigned head;
+
+  /**
+   * The number of committed buffers which have not been consumed
+   * yet.  They precede #head in the ring.
+   */
+  unsigned queued;
+
+  /**
+   * Has the consumer failed (or has the download been cancelled)?
+   */
+  bool failed;
+
+#ifdef HAVE_POSIX
+  class ConsumerThread : public Thread {
+    DownloadPipeline &pipeline;
+
+  public:
+    ConsumerThread(DownloadPipeline &_pipeline):pipeline(_pipeline) {}
+
+  protected:
+    virtual void Run();
+  };
+
+  ConsumerThread thread;
+
+  /**
+   * Protects #head, #queued, #failed and #finished.
+   */
+  Mutex mutex;
+
+  /**
+   * Signalled when a buffer is committed or released, and on
+   * Finish().
+   */
+  Cond cond;
+
+  /**
+   * Set by Finish(): no more blocks will be committed.
+   */
+  bool finished;
+#endif
+
+public:
+  DownloadPipeline(Consumer &_consumer);
+
+  /**
+   * Stops the thread, discarding all blocks which have not been
+   * consumed yet.
+   */
+  ~DownloadPipeline();
+
+  /**
+   * Obtain the buffer for the next block.  Waits until the consumer
+   * has released one.
+   *
+   * @param size the maximum size of the block
+   * @return the buffer, or NULL if the consumer has failed
+   */
+  void *GetBuffer(size_t size);
+
+  /**
+   * Submit the buffer returned by GetBuffer() to the consumer.
+   *
+   * @param length the number of bytes which were written to the
+   * buffer
+   */
+  void Commit(size_t length);
+
+  /**
+   * Wait until all committed blocks have been consumed.
+   *
+   * @return false if the consumer has failed
+   */
+  bool Finish();
+
+private:
+#ifdef HAVE_POSIX
+  void Run();
+#endif
+};
+
+#endif
@@ -25,34 +25,24 @@ Copyright_License {
 #include "LXN.hpp"
 #include "OS/ByteOrder.hpp"
 
+#include <algorithm>
+#include <assert.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-struct Context {
-  uint8_t flight_no;
-  char date[7];
-  LXN::FlightInfo flight_info;
-  unsigned time, origin_time;
-  int origin_latitude, origin_longitude;
-  bool is_event;
-  LXN::Event event;
-  char fix_stat;
-  char vendor[3];
-  LXN::ExtensionConfig k_ext, b_ext;
-
-  Context()
-    :flight_no(0),
-     time(0), origin_time(0),
-     origin_latitude(0), origin_longitude(0),
-     is_event(false) {
-    memset(date, 0, sizeof(date));
-    flight_info.competition_class_id = 0xff;
-    memset(vendor, 0, sizeof(vendor));
-    k_ext.num = 0;
-    b_ext.num = 0;
-  }
-};
+LX::LXNToIGC::Context::Context()
+  :flight_no(0),
+   time(0), origin_time(0),
+   origin_latitude(0), origin_longitude(0),
+   is_event(false)
+{
+  memset(date, 0, sizeof(date));
+  flight_info.competition_class_id = 0xff;
+  memset(vendor, 0, sizeof(vendor));
+  k_ext.num = 0;
+  b_ext.num = 0;
+}
 
 static bool
 ValidString(const char *p, size_t size)
@@ -60,9 +50,8 @@ ValidString(const char *p, size_t size)
   return memchr(p, 0, size) != NULL;
 }
 
-static void
-HandlePosition(FILE *file, Context &context,
-               const struct LXN::Position &position)
+void
+LX::LXNToIGC::HandlePosition(const struct LXN::Position &position)
 {
     int latitude, longitude;
 
@@ -127,321 +116,476 @@ HandleExtConfig(FILE *file, const struct LXN::ExtConfig &packet,
   fprintf(file, "\r\n");
 }
 
-bool
-LX::ConvertLXNToIGC(const void *_data, size_t _length,
-                    FILE *file)
+/**
+ * Determine the size of the packet starting at #data, which must be
+ * available completely before it can be converted.
+ *
+ * @return the size, or 0 if the command is unknown
+ */
+gcc_pure
+static size_t
+PacketSize(const uint8_t *data, unsigned b_ext_num, unsigned k_ext_num)
 {
-  const uint8_t *data = (const uint8_t *)_data, *end = data + _length;
-  Context context;
-  char ch;
-  unsigned l;
+  union LXN::Packet packet = { data };
 
-  while (data < end) {
-    union LXN::Packet packet = { data };
+  switch ((LXN::Command)*packet.cmd) {
+  case LXN::EMPTY:
+  case LXN::END:
+    return 1;
 
-    unsigned packet_length;
-    switch ((LXN::Command)*packet.cmd) {
-    case LXN::EMPTY:
-      packet_length = 0;
-      while (data < end && *data == LXN::EMPTY) {
-        ++packet_length;
-        ++data;
-      }
+  case LXN::VERSION:
+    return sizeof(*packet.version);
 
-      fprintf(file, "LFILEMPTY%u\r\n", packet_length);
-      break;
+  case LXN::START:
+    return sizeof(*packet.start);
 
-    case LXN::END:
-      return true;
+  case LXN::ORIGIN:
+    return sizeof(*packet.origin);
 
-    case LXN::VERSION:
-      data += sizeof(*packet.version);
-      if (data > end)
-        return false;
+  case LXN::SECURITY_OLD:
+    return sizeof(*packet.security_old);
 
-      fprintf(file,
-              "HFRFWFIRMWAREVERSION:%3.1f\r\n"
-              "HFRHWHARDWAREVERSION:%3.1f\r\n",
-              packet.version->software / 10.,
-              packet.version->hardware / 10.);
-      break;
+  case LXN::SERIAL:
+    return sizeof(*packet.serial);
 
-    case LXN::START:
-      data += sizeof(*packet.start);
-      if (data > end ||
-          memcmp(packet.start->streraz, "STReRAZ", 8) != 0)
-        return false;
+  case LXN::POSITION_OK:
+  case LXN::POSITION_BAD:
+    return sizeof(*packet.position);
 
-      context.flight_no = packet.start->flight_no;
-      break;
+  case LXN::SECURITY:
+    return sizeof(*packet.security);
 
-    case LXN::ORIGIN:
-      data += sizeof(*packet.origin);
-      if (data > end)
-        return false;
-
-      context.origin_time = FromBE32(packet.origin->time);
-      context.origin_latitude = (int32_t)FromBE32(packet.origin->latitude);
-      context.origin_longitude = (int32_t)FromBE32(packet.origin->longitude);
-
-      fprintf(file, "L%.*sORIGIN%02d%02d%02d" "%02d%05d%c" "%03d%05d%c\r\n",
-              (int)sizeof(context.vendor), context.vendor,
-              context.origin_time / 3600, context.origin_time % 3600 / 60,
-              context.origin_time % 60,
-              abs(context.origin_latitude) / 60000,
-              abs(context.origin_latitude) % 60000,
-              context.origin_latitude >= 0 ? 'N' : 'S',
-              abs(context.origin_longitude) / 60000,
-              abs(context.origin_longitude) % 60000,
-              context.origin_longitude >= 0 ? 'E' : 'W');
-      break;
+  case LXN::COMPETITION_CLASS:
+    return sizeof(*packet.competition_class);
 
-    case LXN::SECURITY_OLD:
-      data += sizeof(*packet.security_old);
-      if (data > end)
-        return false;
+  case LXN::TASK:
+    return sizeof(*packet.task);
 
-      fprintf(file, "G%22.22s\r\n", packet.security_old->foo);
-      break;
-
-    case LXN::SERIAL:
-      data += sizeof(*packet.serial);
-      if (data > end)
-        return false;
+  case LXN::EVENT:
+    return sizeof(*packet.event);
 
-      if (!ValidString(packet.serial->serial, sizeof(packet.serial->serial)))
-        return false;
+  case LXN::B_EXT:
+    /* the B_EXT and K_EXT conversion also checks the bytes of an
+       EVENT packet */
+    return std::max(sizeof(*packet.b_ext) +
+                    b_ext_num * sizeof(packet.b_ext->data[0]),
+                    sizeof(*packet.event));
 
-      fprintf(file, "A%sFLIGHT:%u\r\nHFDTE%s\r\n",
-              packet.serial->serial, context.flight_no, context.date);
-      break;
+  case LXN::K_EXT:
+    return std::max(sizeof(*packet.k_ext) +
+                    k_ext_num * sizeof(packet.k_ext->data[0]),
+                    sizeof(*packet.event));
 
-    case LXN::POSITION_OK:
-    case LXN::POSITION_BAD:
-      data += sizeof(*packet.position);
-      if (data > end)
-        return false;
+  case LXN::DATE:
+    return sizeof(*packet.date);
 
-      HandlePosition(file, context, *packet.position);
-      break;
+  case LXN::FLIGHT_INFO:
+    return sizeof(*packet.flight_info);
 
-    case LXN::SECURITY:
-      data += sizeof(*packet.security);
-      if (data > end ||
-          packet.security->length > sizeof(packet.security->foo))
-        return false;
+  case LXN::K_EXT_CONFIG:
+  case LXN::B_EXT_CONFIG:
+    return sizeof(*packet.ext_config);
+  }
 
-      if (packet.security->type == LXN::SECURITY_HIGH)
-        ch = '2';
-      else if (packet.security->type == LXN::SECURITY_MED)
-        ch = '1';
-      else if (packet.security->type == LXN::SECURITY_LOW)
-        ch = '0';
-      else
-        return false;
+  if (*packet.cmd < 0x40)
+    return sizeof(*packet.string) + packet.string->length;
 
-      fprintf(file, "G%c", ch);
+  return 0;
+}
 
-      for (unsigned i = 0; i < packet.security->length; ++i)
-        fprintf(file, "%02X", packet.security->foo[i]);
+/**
+ * The number of bytes to skip after a packet.  This differs from
+ * PacketSize() only for the B_EXT and K_EXT packets.
+ */
+gcc_pure
+static size_t
+PacketLength(const uint8_t *data, unsigned b_ext_num, unsigned k_ext_num)
+{
+  union LXN::Packet packet = { data };
 
-      fprintf(file, "\r\n");
-      break;
+  switch (*packet.cmd) {
+  case LXN::B_EXT:
+    return sizeof(*packet.b_ext) +
+      b_ext_num * sizeof(packet.b_ext->data[0]);
 
-    case LXN::COMPETITION_CLASS:
-      data += sizeof(*packet.competition_class);
-      if (data > end)
-        return false;
-
-      if (!ValidString(packet.competition_class->class_id,
-                       sizeof(packet.competition_class->class_id)))
-        return false;
-
-      if (context.flight_info.competition_class_id == 7)
-        fprintf(file,
-                "HFFXA%03d\r\n"
-                "HFPLTPILOT:%s\r\n"
-                "HFGTYGLIDERTYPE:%s\r\n"
-                "HFGIDGLIDERID:%s\r\n"
-                "HFDTM%03dGPSDATUM:%s\r\n"
-                "HFCIDCOMPETITIONID:%s\r\n"
-                "HFCCLCOMPETITIONCLASS:%s\r\n"
-                "HFGPSGPS:%s\r\n",
-                context.flight_info.fix_accuracy,
-                context.flight_info.pilot,
-                context.flight_info.glider,
-                context.flight_info.registration,
-                context.flight_info.gps_date,
-                LXN::FormatGPSDate(context.flight_info.gps_date),
-                context.flight_info.competition_class,
-                packet.competition_class->class_id,
-                context.flight_info.gps);
-      break;
+  case LXN::K_EXT:
+    return sizeof(*packet.k_ext) +
+      k_ext_num * sizeof(packet.k_ext->data[0]);
 
-    case LXN::TASK:
-      data += sizeof(*packet.task);
-      if (data > end)
-        return false;
-
-      context.time = FromBE32(packet.task->time);
-
-      fprintf(file, "C%02d%02d%02d%02d%02d%02d"
-              "%02d%02d%02d" "%04d%02d\r\n",
-              packet.task->day, packet.task->month, packet.task->year,
-              context.time / 3600, context.time % 3600 / 60, context.time % 60,
-              packet.task->day2, packet.task->month2, packet.task->year2,
-              FromBE16(packet.task->task_id), packet.task->num_tps);
-
-      for (unsigned i = 0; i < sizeof(packet.task->usage); ++i) {
-        if (packet.task->usage[i]) {
-          int latitude = (int32_t)FromBE32(packet.task->latitude[i]);
-          int longitude = (int32_t)FromBE32(packet.task->longitude[i]);
-
-          if (!ValidString(packet.task->name[i], sizeof(packet.task->name[i])))
-            return false;
-
-          fprintf(file, "C%02d%05d%c" "%03d%05d%c" "%s\r\n",
-                  abs(latitude) / 60000, abs(latitude) % 60000,
-                  latitude >= 0 ?  'N' : 'S',
-                  abs(longitude) / 60000, abs(longitude) % 60000,
-                  longitude >= 0 ? 'E' : 'W',
-                  packet.task->name[i]);
-        }
-      }
-      break;
-
-    case LXN::EVENT:
-      data += sizeof(*packet.event);
-      if (data > end ||
-          !ValidString(packet.event->foo, sizeof(packet.event->foo)))
-        return false;
+  default:
+    return PacketSize(data, b_ext_num, k_ext_num);
+  }
+}
 
-      context.event = *packet.event;
-      context.is_event = true;
-      break;
+LX::LXNToIGC::LXNToIGC(FILE *_file)
+  :file(_file), state(RUNNING), empty_run(0), pending_length(0)
+{
+  static_assert(sizeof(LXN::Task) <= sizeof(pending),
+                "Pending buffer too small");
+  static_assert(sizeof(LXN::FlightInfo) <= sizeof(pending),
+                "Pending buffer too small");
+}
 
-    case LXN::B_EXT:
-      data += sizeof(*packet.b_ext) +
-        context.b_ext.num * sizeof(packet.b_ext->data[0]);
-      if (data > end ||
-          !ValidString(packet.event->foo, sizeof(packet.event->foo)))
-        return false;
+void
+LX::LXNToIGC::FlushEmptyRun()
+{
+  if (empty_run > 0) {
+    fprintf(file, "LFILEMPTY%u\r\n", empty_run);
+    empty_run = 0;
+  }
+}
 
-      for (unsigned i = 0; i < context.b_ext.num; ++i)
-        fprintf(file, "%0*u",
-                (int)context.b_ext.extensions[i].width,
-                FromBE16(packet.b_ext->data[i]));
+bool
+LX::LXNToIGC::ConvertPacket(union LXN::Packet packet)
+{
+  char ch;
+  unsigned l;
 
-      fprintf(file, "\r\n");
-      break;
+  switch ((LXN::Command)*packet.cmd) {
+  case LXN::VERSION:
+    fprintf(file,
+            "HFRFWFIRMWAREVERSION:%3.1f\r\n"
+            "HFRHWHARDWAREVERSION:%3.1f\r\n",
+            packet.version->software / 10.,
+            packet.version->hardware / 10.);
+    break;
+
+  case LXN::START:
+    if (memcmp(packet.start->streraz, "STReRAZ", 8) != 0)
+      return false;
+
+    context.flight_no = packet.start->flight_no;
+    break;
+
+  case LXN::ORIGIN:
+    context.origin_time = FromBE32(packet.origin->time);
+    context.origin_latitude = (int32_t)FromBE32(packet.origin->latitude);
+    context.origin_longitude = (int32_t)FromBE32(packet.origin->longitude);
+
+    fprintf(file, "L%.*sORIGIN%02d%02d%02d" "%02d%05d%c" "%03d%05d%c\r\n",
+            (int)sizeof(context.vendor), context.vendor,
+            context.origin_time / 3600, context.origin_time % 3600 / 60,
+            context.origin_time % 60,
+            abs(context.origin_latitude) / 60000,
+            abs(context.origin_latitude) % 60000,
+            context.origin_latitude >= 0 ? 'N' : 'S',
+            abs(context.origin_longitude) / 60000,
+            abs(context.origin_longitude) % 60000,
+            context.origin_longitude >= 0 ? 'E' : 'W');
+    break;
+
+  case LXN::SECURITY_OLD:
+    fprintf(file, "G%22.22s\r\n", packet.security_old->foo);
+    break;
+
+  case LXN::SERIAL:
+    if (!ValidString(packet.serial->serial, sizeof(packet.serial->serial)))
+      return false;
+
+    fprintf(file, "A%sFLIGHT:%u\r\nHFDTE%s\r\n",
+            packet.serial->serial, context.flight_no, context.date);
+    break;
+
+  case LXN::POSITION_OK:
+  case LXN::POSITION_BAD:
+    HandlePosition(*packet.position);
+    break;
+
+  case LXN::SECURITY:
+    if (packet.security->length > sizeof(packet.security->foo))
+      return false;
+
+    if (packet.security->type == LXN::SECURITY_HIGH)
+      ch = '2';
+    else if (packet.security->type == LXN::SECURITY_MED)
+      ch = '1';
+    else if (packet.security->type == LXN::SECURITY_LOW)
+      ch = '0';
+    else
+      return false;
+
+    fprintf(file, "G%c", ch);
+
+    for (unsigned i = 0; i < packet.security->length; ++i)
+      fprintf(file, "%02X", packet.security->foo[i]);
+
+    fprintf(file, "\r\n");
+    break;
+
+  case LXN::COMPETITION_CLASS:
+    if (!ValidString(packet.competition_class->class_id,
+                     sizeof(packet.competition_class->class_id)))
+      return false;
+
+    if (context.flight_info.competition_class_id == 7)
+      fprintf(file,
+              "HFFXA%03d\r\n"
+              "HFPLTPILOT:%s\r\n"
+              "HFGTYGLIDERTYPE:%s\r\n"
+              "HFGIDGLIDERID:%s\r\n"
+              "HFDTM%03dGPSDATUM:%s\r\n"
+              "HFCIDCOMPETITIONID:%s\r\n"
+              "HFCCLCOMPETITIONCLASS:%s\r\n"
+              "HFGPSGPS:%s\r\n",
+              context.flight_info.fix_accuracy,
+              context.flight_info.pilot,
+              context.flight_info.glider,
+              context.flight_info.registration,
+              context.flight_info.gps_date,
+              LXN::FormatGPSDate(context.flight_info.gps_date),
+              context.flight_info.competition_class,
+              packet.competition_class->class_id,
+              context.flight_info.gps);
+    break;
+
+  case LXN::TASK:
+    context.time = FromBE32(packet.task->time);
+
+    fprintf(file, "C%02d%02d%02d%02d%02d%02d"
+            "%02d%02d%02d" "%04d%02d\r\n",
+            packet.task->day, packet.task->month, packet.task->year,
+            context.time / 3600, context.time % 3600 / 60, context.time % 60,
+            packet.task->day2, packet.task->month2, packet.task->year2,
+            FromBE16(packet.task->task_id), packet.task->num_tps);
+
+    for (unsigned i = 0; i < sizeof(packet.task->usage); ++i) {
+      if (packet.task->usage[i]) {
+        int latitude = (int32_t)FromBE32(packet.task->latitude[i]);
+        int longitude = (int32_t)FromBE32(packet.task->longitude[i]);
+
+        if (!ValidString(packet.task->name[i], sizeof(packet.task->name[i])))
+          return false;
 
-    case LXN::K_EXT:
-      data += sizeof(*packet.k_ext) +
-        context.k_ext.num * sizeof(packet.k_ext->data[0]);
-      if (data > end ||
-          !ValidString(packet.event->foo, sizeof(packet.event->foo)))
-        return false;
+        fprintf(file, "C%02d%05d%c" "%03d%05d%c" "%s\r\n",
+                abs(latitude) / 60000, abs(latitude) % 60000,
+                latitude >= 0 ?  'N' : 'S',
+                abs(longitude) / 60000, abs(longitude) % 60000,
+                longitude >= 0 ? 'E' : 'W',
+                packet.task->name[i]);
+      }
+    }
+    break;
+
+  case LXN::EVENT:
+    if (!ValidString(packet.event->foo, sizeof(packet.event->foo)))
+      return false;
+
+    context.event = *packet.event;
+    context.is_event = true;
+    break;
+
+  case LXN::B_EXT:
+    if (!ValidString(packet.event->foo, sizeof(packet.event->foo)))
+      return false;
+
+    for (unsigned i = 0; i < context.b_ext.num; ++i)
+      fprintf(file, "%0*u",
+              (int)context.b_ext.extensions[i].width,
+              FromBE16(packet.b_ext->data[i]));
+
+    fprintf(file, "\r\n");
+    break;
+
+  case LXN::K_EXT:
+    if (!ValidString(packet.event->foo, sizeof(packet.event->foo)))
+      return false;
+
+    l = context.time + packet.k_ext->foo;
+    fprintf(file, "K%02d%02d%02d",
+            l / 3600, l % 3600 / 60, l % 60);
+
+    for (unsigned i = 0; i < context.k_ext.num; ++i)
+      fprintf(file, "%0*u",
+              context.k_ext.extensions[i].width,
+              FromBE16(packet.k_ext->data[i]));
+
+    fprintf(file, "\r\n");
+    break;
+
+  case LXN::DATE:
+    if (packet.date->day > 31 || packet.date->month > 12)
+      return false;
+
+    snprintf(context.date, sizeof(context.date),
+             "%02d%02d%02d",
+             packet.date->day % 100, packet.date->month % 100,
+             FromBE16(packet.date->year));
+    break;
+
+  case LXN::FLIGHT_INFO:
+    if (!ValidString(packet.flight_info->pilot,
+                     sizeof(packet.flight_info->pilot)) ||
+        !ValidString(packet.flight_info->glider,
+                     sizeof(packet.flight_info->glider)) ||
+        !ValidString(packet.flight_info->registration,
+                     sizeof(packet.flight_info->registration)) ||
+        !ValidString(packet.flight_info->competition_class,
+                     sizeof(packet.flight_info->competition_class)) ||
+        !ValidString(packet.flight_info->gps, sizeof(packet.flight_info->gps)))
+      return false;
+
+    if (packet.flight_info->competition_class_id > 7)
+      return false;
+
+    if (packet.flight_info->competition_class_id < 7)
+      fprintf(file,
+              "HFFXA%03d\r\n"
+              "HFPLTPILOT:%s\r\n"
+              "HFGTYGLIDERTYPE:%s\r\n"
+              "HFGIDGLIDERID:%s\r\n"
+              "HFDTM%03dGPSDATUM:%s\r\n"
+              "HFCIDCOMPETITIONID:%s\r\n"
+              "HFCCLCOMPETITIONCLASS:%s\r\n"
+              "HFGPSGPS:%s\r\n",
+              packet.flight_info->fix_accuracy,
+              packet.flight_info->pilot,
+              packet.flight_info->glider,
+              packet.flight_info->registration,
+              packet.flight_info->gps_date,
+              LXN::FormatGPSDate(packet.flight_info->gps_date),
+              packet.flight_info->competition_class,
+              LXN::FormatCompetitionClass(packet.flight_info->competition_class_id),
+              packet.flight_info->gps);
+
+    context.flight_info = *packet.flight_info;
+    break;
+
+  case LXN::K_EXT_CONFIG:
+    HandleExtConfig(file, *packet.ext_config, context.k_ext, 'J', 8);
+    break;
+
+  case LXN::B_EXT_CONFIG:
+    HandleExtConfig(file, *packet.ext_config, context.b_ext, 'I', 36);
+    break;
+
+  default:
+    if (*packet.cmd < 0x40) {
+      fprintf(file, "%.*s\r\n",
+              (int)packet.string->length, packet.string->value);
+
+      if (packet.string->length >= 12 + sizeof(context.vendor) &&
+          memcmp(packet.string->value, "HFFTYFRTYPE:", 12) == 0)
+        memcpy(context.vendor, packet.string->value + 12, sizeof(context.vendor));
+    } else
+      return false;
+  }
 
-      l = context.time + packet.k_ext->foo;
-      fprintf(file, "K%02d%02d%02d",
-              l / 3600, l % 3600 / 60, l % 60);
+  return true;
+}
 
-      for (unsigned i = 0; i < context.k_ext.num; ++i)
-        fprintf(file, "%0*u",
-                context.k_ext.extensions[i].width,
-                FromBE16(packet.k_ext->data[i]));
+size_t
+LX::LXNToIGC::Convert(const uint8_t *const begin, const uint8_t *const end)
+{
+  const uint8_t *data = begin;
+
+  while (data < end && state == RUNNING) {
+    if (*data == LXN::EMPTY) {
+      /* the run may continue in the next chunk; it is written when
+         the next packet begins */
+      ++empty_run;
+      ++data;
+      continue;
+    }
 
-      fprintf(file, "\r\n");
-      break;
+    FlushEmptyRun();
 
-    case LXN::DATE:
-      data += sizeof(*packet.date);
-      if (data > end ||
-          packet.date->day > 31 || packet.date->month > 12)
-        return false;
+    if (*data == LXN::END) {
+      state = DONE;
+      return data + 1 - begin;
+    }
 
-      snprintf(context.date, sizeof(context.date),
-               "%02d%02d%02d",
-               packet.date->day % 100, packet.date->month % 100,
-               FromBE16(packet.date->year));
+    const size_t size = PacketSize(data, context.b_ext.num,
+                                   context.k_ext.num);
+    if (size == 0) {
+      state = FAILED;
       break;
+    }
 
-    case LXN::FLIGHT_INFO:
-      data += sizeof(*packet.flight_info);
-      if (data > end ||
-          !ValidString(packet.flight_info->pilot,
-                       sizeof(packet.flight_info->pilot)) ||
-          !ValidString(packet.flight_info->glider,
-                       sizeof(packet.flight_info->glider)) ||
-          !ValidString(packet.flight_info->registration,
-                       sizeof(packet.flight_info->registration)) ||
-          !ValidString(packet.flight_info->competition_class,
-                       sizeof(packet.flight_info->competition_class)) ||
-          !ValidString(packet.flight_info->gps, sizeof(packet.flight_info->gps)))
-        return false;
-
-      if (packet.flight_info->competition_class_id > 7)
-        return false;
-
-      if (packet.flight_info->competition_class_id < 7)
-        fprintf(file,
-                "HFFXA%03d\r\n"
-                "HFPLTPILOT:%s\r\n"
-                "HFGTYGLIDERTYPE:%s\r\n"
-                "HFGIDGLIDERID:%s\r\n"
-                "HFDTM%03dGPSDATUM:%s\r\n"
-                "HFCIDCOMPETITIONID:%s\r\n"
-                "HFCCLCOMPETITIONCLASS:%s\r\n"
-                "HFGPSGPS:%s\r\n",
-                packet.flight_info->fix_accuracy,
-                packet.flight_info->pilot,
-                packet.flight_info->glider,
-                packet.flight_info->registration,
-                packet.flight_info->gps_date,
-                LXN::FormatGPSDate(packet.flight_info->gps_date),
-                packet.flight_info->competition_class,
-                LXN::FormatCompetitionClass(packet.flight_info->competition_class_id),
-                packet.flight_info->gps);
-
-      context.flight_info = *packet.flight_info;
+    if (size > size_t(end - data))
+      /* incomplete */
       break;
 
-    case LXN::K_EXT_CONFIG:
-      data += sizeof(*packet.ext_config);
-      if (data > end)
-        return false;
+    const size_t length = PacketLength(data, context.b_ext.num,
+                                       context.k_ext.num);
 
-      HandleExtConfig(file, *packet.ext_config, context.k_ext, 'J', 8);
+    union LXN::Packet packet = { data };
+    if (!ConvertPacket(packet)) {
+      state = FAILED;
       break;
+    }
 
-    case LXN::B_EXT_CONFIG:
-      data += sizeof(*packet.ext_config);
-      if (data > end)
-        return false;
+    data += length;
+  }
 
-      HandleExtConfig(file, *packet.ext_config, context.b_ext, 'I', 36);
-      break;
+  return data - begin;
+}
 
-    default:
-      if (*packet.cmd < 0x40) {
-        data += sizeof(*packet.string);
-        if (data > end)
-          return false;
+bool
+LX::LXNToIGC::Feed(const void *_data, size_t length)
+{
+  const uint8_t *data = (const uint8_t *)_data;
 
-        data += packet.string->length;
-        if (data > end)
-          return false;
+  while (length > 0 && state == RUNNING) {
+    if (pending_length == 0) {
+      const size_t consumed = Convert(data, data + length);
+      data += consumed;
+      length -= consumed;
 
-        fprintf(file, "%.*s\r\n",
-                (int)packet.string->length, packet.string->value);
+      if (state != RUNNING || length == 0)
+        break;
 
-        if (packet.string->length >= 12 + sizeof(context.vendor) &&
-            memcmp(packet.string->value, "HFFTYFRTYPE:", 12) == 0)
-          memcpy(context.vendor, packet.string->value + 12, sizeof(context.vendor));
-      } else
-        return false;
+      /* keep the incomplete packet for the next call */
+      assert(length < sizeof(pending));
+      memcpy(pending, data, length);
+      pending_length = length;
+      break;
+    }
+
+    /* complete the packet left over from the previous chunk */
+    const size_t old_length = pending_length;
+    const size_t n = std::min(length, sizeof(pending) - old_length);
+    memcpy(pending + old_length, data, n);
+    pending_length += n;
+
+    const size_t consumed = Convert(pending, pending + pending_length);
+    if (consumed >= old_length) {
+      /* the rest of the buffer will be converted from the chunk
+         directly */
+      pending_length = 0;
+      data += consumed - old_length;
+      length -= consumed - old_length;
+    } else {
+      /* still incomplete; all of the new bytes remain in the
+         buffer */
+      if (n == 0 && consumed == 0 && state == RUNNING)
+        /* can't happen: the buffer is larger than any packet */
+        state = FAILED;
+
+      memmove(pending, pending + consumed, pending_length - consumed);
+      pending_length -= consumed;
+      data += n;
+      length -= n;
     }
   }
 
-  return false;
+  return state != FAILED;
+}
+
+bool
+LX::LXNToIGC::Finish()
+{
+  if (state == RUNNING)
+    /* no END packet, or the last packet is truncated */
+    FlushEmptyRun();
+
+  return state == DONE;
+}
+
+bool
+LX::ConvertLXNToIGC(const void *data, size_t length,
+                    FILE *file)
+{
+  LXNToIGC converter(file);
+  converter.Feed(data, length);
+  return converter.Finish();
 }
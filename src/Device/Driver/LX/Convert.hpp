@@ -24,10 +24,109 @@ Copyright_License {
 #ifndef XCSOAR_DEVICE_DRIVER_LX_CONVERT_HPP
 #define XCSOAR_DEVICE_DRIVER_LX_CONVERT_HPP
 
+#include "LXN.hpp"
+
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 
 namespace LX {
+  /**
+   * Converts LXN data to IGC incrementally.  The data may be passed
+   * in chunks of arbitrary size (e.g. as they arrive from the
+   * logger); a packet which is split between two chunks is buffered
+   * until it is complete.
+   */
+  class LXNToIGC {
+    struct Context {
+      uint8_t flight_no;
+      char date[7];
+      LXN::FlightInfo flight_info;
+      unsigned time, origin_time;
+      int origin_latitude, origin_longitude;
+      bool is_event;
+      LXN::Event event;
+      char fix_stat;
+      char vendor[3];
+      LXN::ExtensionConfig k_ext, b_ext;
+
+      Context();
+    };
+
+    enum State {
+      RUNNING,
+
+      /** the END packet has been converted */
+      DONE,
+
+      /** malformed input */
+      FAILED,
+    };
+
+    FILE *file;
+
+    Context context;
+
+    State state;
+
+    /**
+     * The number of #LXN::EMPTY bytes which have not been written
+     * yet, because the run may continue in the next chunk.
+     */
+    unsigned empty_run;
+
+    /**
+     * The beginning of an incomplete packet at the end of the
+     * previous chunk.  Must be large enough for the largest packet.
+     */
+    uint8_t pending[256];
+    size_t pending_length;
+
+  public:
+    LXNToIGC(FILE *_file);
+
+    /**
+     * Convert the next chunk of LXN data.
+     *
+     * @return false if the data is malformed; there is no point in
+     * feeding more data after that
+     */
+    bool Feed(const void *data, size_t length);
+
+    /**
+     * Has the END packet been seen?
+     */
+    bool IsDone() const {
+      return state == DONE;
+    }
+
+    /**
+     * To be called after the last chunk.
+     *
+     * @return true if the data was complete and well-formed
+     */
+    bool Finish();
+
+  private:
+    /**
+     * Convert as many complete packets as possible.
+     *
+     * @return the number of bytes consumed
+     */
+    size_t Convert(const uint8_t *data, const uint8_t *end);
+
+    /**
+     * Convert one complete packet.
+     *
+     * @return false if the packet is malformed
+     */
+    bool ConvertPacket(union LXN::Packet packet);
+
+    void HandlePosition(const struct LXN::Position &position);
+
+    void FlushEmptyRun();
+  };
+
   /**
    * Convert a BLOB of LXN data to IGC, write to a file.
    */
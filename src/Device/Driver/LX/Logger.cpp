@@ -24,6 +24,7 @@
 #include "Internal.hpp"
 #include "Protocol.hpp"
 #include "Convert.hpp"
+#include "Device/Driver/DownloadPipeline.hpp"
 #include "Device/Port/Port.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/ByteOrder.hpp"
@@ -149,6 +150,24 @@ LXDevice::ReadFlightList(RecordedFlightList &flight_list,
   return success;
 }
 
+/**
+ * Feeds the received LXN data into the converter.
+ */
+class LXNConsumer : public DownloadPipeline::Consumer {
+  LX::LXNToIGC converter;
+
+public:
+  LXNConsumer(FILE *file):converter(file) {}
+
+  bool Finish() {
+    return converter.Finish();
+  }
+
+  virtual bool OnBlock(const void *data, size_t length) {
+    return converter.Feed(data, length);
+  }
+};
+
 static bool
 DownloadFlightInner(Port &port, const RecordedFlightInfo &flight,
                     FILE *file, OperationEnvironment &env)
@@ -177,22 +196,29 @@ DownloadFlightInner(Port &port, const RecordedFlightInfo &flight,
 
   env.SetProgressRange(total_length);
 
-  uint8_t *data = new uint8_t[total_length], *p = data;
+  /* convert each section in another thread while the next one is
+     being received */
+  LXNConsumer consumer(file);
+  DownloadPipeline pipeline(consumer);
+
+  unsigned position = 0;
   for (unsigned i = 0; i < LX::MemorySection::N && lengths[i] > 0; ++i) {
+    void *buffer = pipeline.GetBuffer(lengths[i]);
+    if (buffer == NULL)
+      /* conversion has failed */
+      return false;
+
     if (!LX::ReceivePacket(port, LX::READ_LOGGER_DATA,
-                           p, lengths[i], 60000)) {
-      free(data);
+                           buffer, lengths[i], 60000))
       return false;
-    }
 
-    p += lengths[i];
-    env.SetProgressPosition(p - data);
-  }
+    pipeline.Commit(lengths[i]);
 
-  bool success = LX::ConvertLXNToIGC(data, total_length, file);
-  free(data);
+    position += lengths[i];
+    env.SetProgressPosition(position);
+  }
 
-  return success;
+  return pipeline.Finish() && consumer.Finish();
 }
 
 bool
@@ -774,14 +774,11 @@ NMEAParser::PFLAA(NMEAInputLine &line, NMEAInfo &info)
 
   FlarmTraffic *flarm_slot = flarm.FindTraffic(traffic.id);
   if (flarm_slot == NULL) {
-    flarm_slot = flarm.AllocateTraffic();
+    flarm_slot = flarm.AllocateTraffic(traffic.id);
     if (flarm_slot == NULL)
       // no more slots available
       return true;
 
-    flarm_slot->Clear();
-    flarm_slot->id = traffic.id;
-
     flarm.new_traffic = true;
   }
 
@@ -0,0 +1,75 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Dialogs/DialogNode.hpp"
+#include "Util/Macros.hpp"
+
+#include <stddef.h>
+#include <string.h>
+
+struct DialogTableEntry {
+  const TCHAR *name;
+  const DialogNode *root;
+};
+
+#include "Dialogs_tables.cpp"
+
+const TCHAR *
+DialogNode::GetAttribute(const TCHAR *_name) const
+{
+  for (const Attribute *i = attributes, *end = i + num_attributes;
+       i != end; ++i)
+    if (_tcsicmp(i->name, _name) == 0)
+      return i->value;
+
+  return NULL;
+}
+
+const DialogNode *
+DialogNode::GetChildNode(const TCHAR *_name) const
+{
+  for (const_iterator i = begin(), e = end(); i != e; ++i)
+    if (_tcsicmp(i->name, _name) == 0)
+      return i;
+
+  return NULL;
+}
+
+const DialogNode *
+DialogNode::Find(const TCHAR *resource)
+{
+  unsigned low = 0, high = ARRAY_SIZE(dialog_table);
+  while (low < high) {
+    const unsigned middle = (low + high) / 2;
+    const int cmp = _tcscmp(resource, dialog_table[middle].name);
+    if (cmp == 0)
+      return dialog_table[middle].root;
+
+    if (cmp < 0)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+
+  return NULL;
+}
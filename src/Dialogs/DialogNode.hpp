@@ -0,0 +1,93 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_DIALOGS_DIALOG_NODE_HPP
+#define XCSOAR_DIALOGS_DIALOG_NODE_HPP
+
+#include "Compiler.h"
+
+#include <tchar.h>
+
+/**
+ * An element of a dialog XML file.  The dialog files are converted
+ * to constant tables of these at build time (by tools/xml2cpp.pl),
+ * so loading a dialog does not need to parse anything.
+ */
+struct DialogNode {
+  struct Attribute {
+    const TCHAR *name, *value;
+  };
+
+  typedef const DialogNode *const_iterator;
+
+  const TCHAR *name;
+
+  const Attribute *attributes;
+  unsigned num_attributes;
+
+  /**
+   * The child elements are stored contiguously.
+   */
+  const DialogNode *children;
+  unsigned num_children;
+
+  const TCHAR *GetName() const {
+    return name;
+  }
+
+  /**
+   * Look up an attribute (case insensitive).
+   *
+   * @return the value, or NULL if there is no such attribute
+   */
+  gcc_pure
+  const TCHAR *GetAttribute(const TCHAR *name) const;
+
+  /**
+   * Find the first child element with the specified name (case
+   * insensitive).
+   *
+   * @return the child, or NULL if there is no such element
+   */
+  gcc_pure
+  const DialogNode *GetChildNode(const TCHAR *name) const;
+
+  const_iterator begin() const {
+    return children;
+  }
+
+  const_iterator end() const {
+    return children + num_children;
+  }
+
+  /**
+   * Find the root element of a compiled dialog.
+   *
+   * @param resource the resource name, e.g. "IDR_XML_AIRSPACE"
+   * @return the root element, or NULL if there is no such dialog
+   */
+  gcc_pure
+  static const DialogNode *Find(const TCHAR *resource);
+};
+
+#endif
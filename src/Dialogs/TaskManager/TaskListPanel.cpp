@@ -31,7 +31,6 @@ Copyright_License {
 #include "Form/List.hpp"
 #include "Form/Draw.hpp"
 #include "Form/TabBar.hpp"
-#include "Task/TaskStore.hpp"
 #include "Task/ProtectedTaskManager.hpp"
 #include "Components.hpp"
 #include "LocalPath.hpp"
@@ -46,6 +45,8 @@ Copyright_License {
 #include "Screen/Layout.hpp"
 #include "Device/Declaration.hpp"
 #include "Profile/DeclarationConfig.hpp"
+#include "Units/UnitsFormatter.hpp"
+#include "Util/Macros.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/Scissor.hpp"
@@ -75,10 +76,9 @@ TaskListPanel::get_cursor_task()
   if (!ordered_task)
     return NULL;
 
-  if (!ordered_task->CheckTask()) {
-    delete ordered_task;
-    ordered_task = NULL;
-  }
+  /* the TaskStore owns the task, don't delete it */
+  if (!ordered_task->CheckTask())
+    return NULL;
 
   return ordered_task;
 }
@@ -138,8 +138,23 @@ TaskListPanel::OnTaskPaintListItem(Canvas &canvas, const PixelRect rc,
 
   const TCHAR *name = task_store->GetName(DrawListIndex);
 
-  canvas.text(rc.left + Layout::FastScale(2),
-              rc.top + Layout::FastScale(2), name);
+  /* the distance comes from the task index, so painting the list
+     does not need to load any task */
+  const TaskIndex::Summary &summary = task_store->GetSummary(DrawListIndex);
+  UPixelScalar distance_width = 0;
+  if (summary.valid) {
+    TCHAR buffer[32];
+    Units::FormatUserDistance(summary.distance_nominal, buffer,
+                              ARRAY_SIZE(buffer), true);
+    distance_width = canvas.CalcTextWidth(buffer) + Layout::FastScale(4);
+    canvas.text(rc.right - Layout::FastScale(2) - canvas.CalcTextWidth(buffer),
+                rc.top + Layout::FastScale(2), buffer);
+  }
+
+  canvas.text_clipped(rc.left + Layout::FastScale(2),
+                      rc.top + Layout::FastScale(2),
+                      rc.right - rc.left - distance_width
+                      - Layout::FastScale(2), name);
 }
 
 static void
@@ -194,17 +209,22 @@ TaskListPanel::LoadTask()
   if (orig == NULL)
     return;
 
+  /* copy the task before showing the message box: a background scan
+     may replace the TaskStore contents meanwhile */
+  // create new task first to guarantee pointers are different
+  OrderedTask* temptask = protected_task_manager->TaskCopy(*orig);
+
   tstring text = _("Load the selected task?");
   text += _T("\n(");
   text += get_cursor_name();
   text += _T(")");
 
   if (MessageBoxX(text.c_str(), _("Task Browser"),
-                  MB_YESNO | MB_ICONQUESTION) != IDYES)
+                  MB_YESNO | MB_ICONQUESTION) != IDYES) {
+    delete temptask;
     return;
+  }
 
-  // create new task first to guarantee pointers are different
-  OrderedTask* temptask = protected_task_manager->TaskCopy(*orig);
   delete *active_task;
   *active_task = temptask;
   RefreshView();
@@ -217,7 +237,10 @@ TaskListPanel::LoadTask()
 void
 TaskListPanel::DeleteTask()
 {
-  const TCHAR *fname = get_cursor_name();
+  /* copy the name: a background scan may replace the TaskStore
+     contents while the message box is shown */
+  const tstring fname_copy = get_cursor_name();
+  const TCHAR *fname = fname_copy.c_str();
   tstring upperstring = fname;
   std::transform(upperstring.begin(), upperstring.end(), upperstring.begin(),
       ::toupper);
@@ -265,7 +288,8 @@ ClearSuffix(TCHAR *p, const TCHAR *suffix)
 void
 TaskListPanel::RenameTask()
 {
-  const TCHAR *oldname = get_cursor_name();
+  const tstring oldname_copy = get_cursor_name();
+  const TCHAR *oldname = oldname_copy.c_str();
   StaticString<40> newname(oldname);
 
   if (ClearSuffix(newname.buffer(), _T(".cup"))) {
@@ -313,8 +337,10 @@ TaskListPanel::OnBrowseClicked()
 {
   if (!lazy_loaded) {
     lazy_loaded = true;
-    // Scan XCSoarData for available tasks
-    task_store->Scan();
+    /* show the tasks from the saved index immediately, and look for
+       new or modified task files in background */
+    task_store->LoadIndex();
+    task_store->StartScan(*this);
   }
 
   dlgTaskManager::TaskViewRestore(wTaskView);
@@ -500,9 +526,23 @@ void
 TaskListPanel::Unprepare()
 {
   delete task_store;
+  task_store = NULL;
   XMLWidget::Unprepare();
 }
 
+void
+TaskListPanel::OnTaskStoreScanned()
+{
+  SendNotification();
+}
+
+void
+TaskListPanel::OnNotification()
+{
+  if (task_store != NULL && task_store->FinishScan())
+    RefreshView();
+}
+
 void
 TaskListPanel::Show(const PixelRect &rc)
 {
@@ -25,6 +25,8 @@ Copyright_License {
 #define XCSOAR_TASK_LIST_PANEL_HPP
 
 #include "Form/XMLWidget.hpp"
+#include "Task/TaskStore.hpp"
+#include "Thread/Notify.hpp"
 
 class WndForm;
 class TabBarControl;
@@ -33,9 +35,9 @@ class WndOwnerDrawFrame;
 class TabbedControl;
 class Canvas;
 class OrderedTask;
-class TaskStore;
 
-class TaskListPanel : public XMLWidget {
+class TaskListPanel : public XMLWidget,
+                      private TaskStore::Listener, private Notify {
   WndForm &wf;
   TabBarControl &tab_bar;
 
@@ -87,6 +89,13 @@ protected:
   const TCHAR *get_cursor_name();
 
   OrderedTask *get_task_to_display();
+
+private:
+  /* virtual methods from TaskStore::Listener */
+  virtual void OnTaskStoreScanned();
+
+  /* virtual methods from Notify */
+  virtual void OnNotification();
 };
 
 #endif
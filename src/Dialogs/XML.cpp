@@ -25,7 +25,7 @@ Copyright_License {
 #include "Dialogs/CallBackTable.hpp"
 #include "Dialogs/Message.hpp"
 #include "Language/Language.hpp"
-#include "xmlParser.hpp"
+#include "DialogNode.hpp"
 #include "DataField/Boolean.hpp"
 #include "DataField/Enum.hpp"
 #include "DataField/FileReader.hpp"
@@ -49,11 +49,7 @@ Copyright_License {
 #include "Form/CheckBox.hpp"
 #include "Form/DockWindow.hpp"
 #include "StringUtil.hpp"
-#include "ResourceLoader.hpp"
 #include "Look/DialogLook.hpp"
-#include "Inflate.hpp"
-
-#include <zlib/zlib.h>
 
 #include <stdio.h>    // for _stprintf
 #include <assert.h>
@@ -98,14 +94,14 @@ typedef Window *(*CreateWindowCallback_t)(ContainerWindow &parent,
 
 static Window *
 LoadChild(SubForm &form, ContainerWindow &parent,
-          const CallBackTableEntry *lookup_table, XMLNode node,
+          const CallBackTableEntry *lookup_table, const DialogNode &node,
           const DialogStyle dialog_style, int bottom_most = 0,
           WindowStyle style=WindowStyle());
 
 static void
 LoadChildrenFromXML(SubForm &form, ContainerWindow &parent,
                     const CallBackTableEntry *lookup_table,
-                    const XMLNode *node,
+                    const DialogNode &node,
                     const DialogStyle dialog_style);
 
 /**
@@ -175,9 +171,9 @@ StringToColor(const TCHAR *string, Color &color)
  * @return Dialog style (DialogStyle_t), Default = FullWidth
  */
 static DialogStyle
-GetDialogStyle(const XMLNode &node)
+GetDialogStyle(const DialogNode &node)
 {
-  const TCHAR* popup = node.getAttribute(_T("Popup"));
+  const TCHAR* popup = node.GetAttribute(_T("Popup"));
   if ((popup == NULL) || string_is_empty(popup))
     return dialog_style_setting;
   else
@@ -195,16 +191,16 @@ ScaleWidth(const int x, const DialogStyle dialog_style)
 }
 
 static const TCHAR*
-GetName(const XMLNode &node)
+GetName(const DialogNode &node)
 {
-  return StringToStringDflt(node.getAttribute(_T("Name")), _T(""));
+  return StringToStringDflt(node.GetAttribute(_T("Name")), _T(""));
 }
 
 static const TCHAR*
-GetCaption(const XMLNode &node)
+GetCaption(const DialogNode &node)
 {
   const TCHAR* tmp =
-      StringToStringDflt(node.getAttribute(_T("Caption")), _T(""));
+      StringToStringDflt(node.GetAttribute(_T("Caption")), _T(""));
 
   // don't translate empty strings, it would query gettext metadata
   if (tmp[0] == _T('\0'))
@@ -235,13 +231,13 @@ GetCaption(const XMLNode &node)
 }
 
 static ControlPosition
-GetPosition(const XMLNode &node, const PixelRect rc, int bottom_most = -1)
+GetPosition(const DialogNode &node, const PixelRect rc, int bottom_most = -1)
 {
   ControlPosition pt;
 
   // Calculate x- and y-Coordinate
-  pt.x = StringToIntDflt(node.getAttribute(_T("X")), 0);
-  pt.y = StringToIntDflt(node.getAttribute(_T("Y")), -1);
+  pt.x = StringToIntDflt(node.GetAttribute(_T("X")), 0);
+  pt.y = StringToIntDflt(node.GetAttribute(_T("Y")), -1);
   pt.no_scaling = false;
 
   if (Layout::ScaleSupported()) {
@@ -278,13 +274,13 @@ SetPositionCentered(const ControlPosition original, const PixelRect rc,
 }
 
 static ControlSize
-GetSize(const XMLNode &node, const PixelRect rc, const RasterPoint &pos)
+GetSize(const DialogNode &node, const PixelRect rc, const RasterPoint &pos)
 {
   ControlSize sz;
 
   // Calculate width and height
-  sz.cx = StringToIntDflt(node.getAttribute(_T("Width")), 0);
-  sz.cy = StringToIntDflt(node.getAttribute(_T("Height")), 0);
+  sz.cx = StringToIntDflt(node.GetAttribute(_T("Width")), 0);
+  sz.cy = StringToIntDflt(node.GetAttribute(_T("Height")), 0);
   sz.no_scaling = false;
 
   if (Layout::ScaleSupported()) {
@@ -323,9 +319,9 @@ CallBackLookup(const CallBackTableEntry *lookup_table, const TCHAR *name)
 
 static void *
 GetCallBack(const CallBackTableEntry *lookup_table,
-            const XMLNode &node, const TCHAR* attribute)
+            const DialogNode &node, const TCHAR* attribute)
 {
-  const TCHAR *name = node.getAttribute(attribute);
+  const TCHAR *name = node.GetAttribute(attribute);
   if (name == NULL)
     return NULL;
 
@@ -334,57 +330,17 @@ GetCallBack(const CallBackTableEntry *lookup_table,
   return CallBackLookup(lookup_table, name);
 }
 
-static XMLNode *
-LoadXMLFromResource(const TCHAR* resource, XMLResults *xml_results)
-{
-  ResourceLoader::Data data = ResourceLoader::Load(resource, _T("XMLDialog"));
-  assert(data.first != NULL);
-
-  char *buffer = InflateToString(data.first, data.second);
-
-#ifdef _UNICODE
-  int length = strlen(buffer);
-  TCHAR *buffer2 = new TCHAR[length + 1];
-  length = MultiByteToWideChar(CP_UTF8, 0, buffer, length,
-                               buffer2, length);
-  buffer2[length] = _T('\0');
-  delete[] buffer;
-#else
-  const char *buffer2 = buffer;
-#endif
-
-  XMLNode *x = XMLNode::parseString(buffer2, xml_results);
-
-#ifdef _UNICODE
-  delete[] buffer2;
-#else
-  delete[] buffer;
-#endif
-
-  return x;
-}
-
 /**
- * Tries to load an XML file from the resources
- * @param lpszXML The resource name
- * @return The parsed XMLNode
+ * Looks up a dialog which was compiled into XCSoar
+ * @param resource The resource name
+ * @return The root DialogNode
  */
-static XMLNode *
-LoadXMLFromResource(const TCHAR *resource)
+static const DialogNode &
+FindDialog(const TCHAR *resource)
 {
-  XMLResults xml_results;
-
-  // Reset errors
-  xml_results.error = eXMLErrorNone;
-  XMLNode::GlobalError = false;
-
-  // Load and parse the resource
-  XMLNode *node = LoadXMLFromResource(resource, &xml_results);
-
-  // Show errors if they exist
-  assert(xml_results.error == eXMLErrorNone);
-
-  return node;
+  const DialogNode *node = DialogNode::Find(resource);
+  assert(node != NULL);
+  return *node;
 }
 
 static void
@@ -402,7 +358,7 @@ InitScaleWidth(const PixelSize size, const PixelRect rc,
 }
 
 /**
- * Loads a stand-alone XML file as a single top-level XML node
+ * Loads a stand-alone dialog as a single top-level node
  * into an existing SubForm object and sets its parent to the parent parameter
  * Ignores additional top-level XML nodes.
  * Scales based on the DialogStyle of the last XML form loaded by XCSoar.
@@ -413,7 +369,7 @@ InitScaleWidth(const PixelSize size, const PixelRect rc,
  * @param parent The parent window of the control being created
  *    set parent to "form-get_client_rect()" to make top level control
  *    or to a PanelControl to add it to a tab window
- * @param FileName The XML filename
+ * @param resource The dialog resource name
  * @return the pointer to the Window added to the form
  */
 Window *
@@ -424,27 +380,20 @@ LoadWindow(const CallBackTableEntry *lookup_table, SubForm *form,
   if (!form)
     return NULL;
 
-  XMLNode *node = LoadXMLFromResource(resource);
-  assert(node != NULL);
+  const DialogNode &node = FindDialog(resource);
 
   // use style of last form loaded
   DialogStyle dialog_style = dialog_style_last;
 
   // load only one top-level control.
-  Window *window = LoadChild(*form, parent, lookup_table, *node,
-                             dialog_style, 0, style);
-  delete node;
-
-  assert(!XMLNode::GlobalError);
-
-  return window;
+  return LoadChild(*form, parent, lookup_table, node,
+                   dialog_style, 0, style);
 }
 
 /**
- * This function returns a WndForm created either from the ressources or
- * from the XML file in XCSoarData(if found)
+ * This function returns a WndForm created from the dialog tables which
+ * were compiled from the XML files
  * @param LookUpTable The CallBackTable
- * @param FileName The XML filename to search for in XCSoarData
  * @param Parent The parent window (e.g. XCSoarInterface::main_window)
  * @param resource The resource to look for
  * @param targetRect The area where to move the dialog if not parent
@@ -456,25 +405,21 @@ LoadDialog(const CallBackTableEntry *lookup_table, SingleWindow &parent,
 {
   WndForm *form = NULL;
 
-  // Find XML file or resource and load XML data out of it
-  XMLNode *node = LoadXMLFromResource(resource);
+  // Find the compiled dialog
+  const DialogNode &node = FindDialog(resource);
 
-  // TODO code: put in error checking here and get rid of exits in xmlParser
-  // If XML error occurred -> Error messagebox + cancel
-  assert(node != NULL);
-
-  // If the main XMLNode is of type "Form"
-  assert(_tcscmp(node->getName(), _T("Form")) == 0);
+  // If the main DialogNode is of type "Form"
+  assert(_tcscmp(node.GetName(), _T("Form")) == 0);
 
   // Determine the dialog style of the dialog
-  DialogStyle dialog_style = GetDialogStyle(*node);
+  DialogStyle dialog_style = GetDialogStyle(node);
   dialog_style_last = dialog_style;
 
   // Determine the dialog size
-  const TCHAR* caption = GetCaption(*node);
+  const TCHAR* caption = GetCaption(node);
   const PixelRect rc = target_rc ? *target_rc : parent.get_client_rect();
-  ControlPosition pos = GetPosition(*node, rc, 0);
-  ControlSize size = GetSize(*node, rc, pos);
+  ControlPosition pos = GetPosition(node, rc, 0);
+  ControlSize size = GetSize(node, rc, pos);
 
   InitScaleWidth(size, rc, dialog_style);
 
@@ -516,17 +461,13 @@ LoadDialog(const CallBackTableEntry *lookup_table, SingleWindow &parent,
   // Load the children controls
   LoadChildrenFromXML(*form, form->GetClientAreaWindow(),
                       lookup_table, node, dialog_style);
-  delete node;
-
-  // If XML error occurred -> Error messagebox + cancel
-  assert(!XMLNode::GlobalError);
 
   // Return the created form
   return form;
 }
 
 static DataField *
-LoadDataField(const XMLNode &node, const CallBackTableEntry *LookUpTable,
+LoadDataField(const DialogNode &node, const CallBackTableEntry *LookUpTable,
               const DialogStyle eDialogStyle)
 {
   TCHAR data_type[32];
@@ -536,16 +477,16 @@ LoadDataField(const XMLNode &node, const CallBackTableEntry *LookUpTable,
   bool fine;
 
   _tcscpy(data_type,
-          StringToStringDflt(node.getAttribute(_T("DataType")), _T("")));
+          StringToStringDflt(node.GetAttribute(_T("DataType")), _T("")));
   _tcscpy(display_format,
-          StringToStringDflt(node. getAttribute(_T("DisplayFormat")), _T("")));
+          StringToStringDflt(node.GetAttribute(_T("DisplayFormat")), _T("")));
   _tcscpy(edit_format,
-          StringToStringDflt(node.getAttribute(_T("EditFormat")), _T("")));
+          StringToStringDflt(node.GetAttribute(_T("EditFormat")), _T("")));
 
-  fixed min = fixed(StringToFloatDflt(node.getAttribute(_T("Min")), INT_MIN));
-  fixed max = fixed(StringToFloatDflt(node.getAttribute(_T("Max")), INT_MAX));
-  step = StringToFloatDflt(node.getAttribute(_T("Step")), 1);
-  fine = StringToIntDflt(node.getAttribute(_T("Fine")), false);
+  fixed min = fixed(StringToFloatDflt(node.GetAttribute(_T("Min")), INT_MIN));
+  fixed max = fixed(StringToFloatDflt(node.GetAttribute(_T("Max")), INT_MAX));
+  step = StringToFloatDflt(node.GetAttribute(_T("Step")), 1);
+  fine = StringToIntDflt(node.GetAttribute(_T("Fine")), false);
 
   DataField::DataAccessCallback_t callback = (DataField::DataAccessCallback_t)
     GetCallBack(LookUpTable, node, _T("OnDataAccess"));
@@ -574,17 +515,17 @@ LoadDataField(const XMLNode &node, const CallBackTableEntry *LookUpTable,
 }
 
 /**
- * Creates a control from the given XMLNode as a child of the given
+ * Creates a control from the given DialogNode as a child of the given
  * parent.
  *
  * @param form the SubForm object
  * @param LookUpTable The parent CallBackTable
- * @param node The XMLNode that represents the control
+ * @param node The DialogNode that represents the control
  * @param eDialogStyle The parent's dialog style
  */
 static Window *
 LoadChild(SubForm &form, ContainerWindow &parent,
-          const CallBackTableEntry *lookup_table, XMLNode node,
+          const CallBackTableEntry *lookup_table, const DialogNode &node,
           const DialogStyle dialog_style, int bottom_most,
           WindowStyle style)
 {
@@ -603,10 +544,10 @@ LoadChild(SubForm &form, ContainerWindow &parent,
   if (!size.no_scaling)
     size.cx = ScaleWidth(size.cx, dialog_style);
 
-  if (!StringToIntDflt(node.getAttribute(_T("Visible")), 1))
+  if (!StringToIntDflt(node.GetAttribute(_T("Visible")), 1))
     style.hide();
 
-  if (StringToIntDflt(node.getAttribute(_T("Border")), 0))
+  if (StringToIntDflt(node.GetAttribute(_T("Border")), 0))
     style.border();
 
   rc.left = pos.x;
@@ -614,12 +555,12 @@ LoadChild(SubForm &form, ContainerWindow &parent,
   rc.right = rc.left + size.cx;
   rc.bottom = rc.top + size.cy;
 
-  bool expert = (StringToIntDflt(node.getAttribute(_T("Expert")), 0) == 1);
+  bool expert = (StringToIntDflt(node.GetAttribute(_T("Expert")), 0) == 1);
 
   // PropertyControl (WndProperty)
-  if (_tcscmp(node.getName(), _T("Edit")) == 0) {
+  if (_tcscmp(node.GetName(), _T("Edit")) == 0) {
     // Determine the width of the caption field
-    int caption_width = StringToIntDflt(node.getAttribute(_T("CaptionWidth")), 0);
+    int caption_width = StringToIntDflt(node.GetAttribute(_T("CaptionWidth")), 0);
 
     if (Layout::ScaleSupported())
       caption_width = Layout::Scale(caption_width);
@@ -627,8 +568,8 @@ LoadChild(SubForm &form, ContainerWindow &parent,
     caption_width = ScaleWidth(caption_width, dialog_style);
 
     // Determine whether the control is multiline or readonly
-    bool multi_line = StringToIntDflt(node.getAttribute(_T("MultiLine")), 0);
-    bool read_only = StringToIntDflt(node.getAttribute(_T("ReadOnly")), 0);
+    bool multi_line = StringToIntDflt(node.GetAttribute(_T("MultiLine")), 0);
+    bool read_only = StringToIntDflt(node.GetAttribute(_T("ReadOnly")), 0);
 
     // Load the event callback properties
     WndProperty::DataChangeCallback_t data_notify_callback =
@@ -670,10 +611,10 @@ LoadChild(SubForm &form, ContainerWindow &parent,
     property->SetOnHelpCallback(help_callback);
 
     // Load the help text
-    property->SetHelpText(StringToStringDflt(node.getAttribute(_T("Help")), _T("")));
+    property->SetHelpText(StringToStringDflt(node.GetAttribute(_T("Help")), _T("")));
 
     // If the control has (at least) one DataField child control
-    const XMLNode *data_field_node = node.getChildNode(_T("DataField"));
+    const DialogNode *data_field_node = node.GetChildNode(_T("DataField"));
     if (data_field_node != NULL) {
       // -> Load the first DataField control
       DataField *data_field =
@@ -685,10 +626,10 @@ LoadChild(SubForm &form, ContainerWindow &parent,
         property->SetDataField(data_field);
     }
 
-  } else if (_tcscmp(node.getName(), _T("TextEdit")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("TextEdit")) == 0) {
     // Determine whether the control is multiline or readonly
-    bool multi_line = StringToIntDflt(node.getAttribute(_T("MultiLine")), 0);
-    bool read_only = StringToIntDflt(node.getAttribute(_T("ReadOnly")), 0);
+    bool multi_line = StringToIntDflt(node.GetAttribute(_T("MultiLine")), 0);
+    bool read_only = StringToIntDflt(node.GetAttribute(_T("ReadOnly")), 0);
 
     EditWindowStyle edit_style(style);
     if (read_only)
@@ -715,7 +656,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
     edit->set_font(*xml_dialog_look->text_font);
 
   // ButtonControl (WndButton)
-  } else if (_tcscmp(node.getName(), _T("Button")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Button")) == 0) {
     // Determine ClickCallback function
     WndButton::ClickNotifyCallback click_callback =
       (WndButton::ClickNotifyCallback)
@@ -731,7 +672,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
                            rc,
                            button_style, click_callback);
 
-  } else if (_tcscmp(node.getName(), _T("CheckBox")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("CheckBox")) == 0) {
     // Determine click_callback function
     CheckBoxControl::ClickNotifyCallback click_callback =
       (CheckBoxControl::ClickNotifyCallback)
@@ -746,7 +687,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
                                  style, click_callback);
 
   // SymbolButtonControl (WndSymbolButton) not used yet
-  } else if (_tcscmp(node.getName(), _T("SymbolButton")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("SymbolButton")) == 0) {
     // Determine ClickCallback function
     WndButton::ClickNotifyCallback click_callback =
       (WndButton::ClickNotifyCallback)
@@ -761,7 +702,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
                                  style, click_callback);
 
   // PanelControl (WndPanel)
-  } else if (_tcscmp(node.getName(), _T("Panel")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Panel")) == 0) {
     // Create the PanelControl
 
     style.control_parent();
@@ -772,12 +713,12 @@ LoadChild(SubForm &form, ContainerWindow &parent,
 
     window = frame;
 
-    // Load children controls from the XMLNode
+    // Load children controls from the DialogNode
     LoadChildrenFromXML(form, *frame,
-                        lookup_table, &node, dialog_style);
+                        lookup_table, node, dialog_style);
 
   // KeyboardControl
-  } else if (_tcscmp(node.getName(), _T("Keyboard")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Keyboard")) == 0) {
     KeyboardControl::OnCharacterCallback_t character_callback =
       (KeyboardControl::OnCharacterCallback_t)
       GetCallBack(lookup_table, node, _T("OnCharacter"));
@@ -790,7 +731,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
 
     window = kb;
   // DrawControl (WndOwnerDrawFrame)
-  } else if (_tcscmp(node.getName(), _T("Canvas")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Canvas")) == 0) {
     // Determine DrawCallback function
     WndOwnerDrawFrame::OnPaintCallback_t paint_callback =
       (WndOwnerDrawFrame::OnPaintCallback_t)
@@ -804,7 +745,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
     window = canvas;
 
   // FrameControl (WndFrame)
-  } else if (_tcscmp(node.getName(), _T("Label")) == 0){
+  } else if (_tcscmp(node.GetName(), _T("Label")) == 0){
     // Create the FrameControl
     WndFrame* frame = new WndFrame(parent, *xml_dialog_look,
                                    pos.x, pos.y, size.cx, size.cy,
@@ -814,16 +755,16 @@ LoadChild(SubForm &form, ContainerWindow &parent,
     frame->SetCaption(caption);
     // Set caption color
     Color color;
-    if (StringToColor(node.getAttribute(_T("CaptionColor")), color))
+    if (StringToColor(node.GetAttribute(_T("CaptionColor")), color))
       frame->SetCaptionColor(color);
 
     window = frame;
 
   // ListBoxControl (WndListFrame)
-  } else if (_tcscmp(node.getName(), _T("List")) == 0){
+  } else if (_tcscmp(node.GetName(), _T("List")) == 0){
     // Determine ItemHeight of the list items
     UPixelScalar item_height =
-      Layout::Scale(StringToIntDflt(node.getAttribute(_T("ItemHeight")), 18));
+      Layout::Scale(StringToIntDflt(node.GetAttribute(_T("ItemHeight")), 18));
 
     // Create the ListBoxControl
 
@@ -842,7 +783,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
                               item_height);
 
   // TabControl (Tabbed)
-  } else if (_tcscmp(node.getName(), _T("Tabbed")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Tabbed")) == 0) {
     // Create the TabControl
 
     style.control_parent();
@@ -862,12 +803,12 @@ LoadChild(SubForm &form, ContainerWindow &parent,
         tabbed->AddClient(child);
     }
   // TabBarControl (TabBar)
-  } else if (_tcscmp(node.getName(), _T("TabBar")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("TabBar")) == 0) {
     // Create the TabBarControl
 
     bool flip_orientation = false;
-    if ( (Layout::landscape && StringToIntDflt(node.getAttribute(_T("Horizontal")), 0)) ||
-         (!Layout::landscape && StringToIntDflt(node.getAttribute(_T("Vertical")), 0) ) )
+    if ( (Layout::landscape && StringToIntDflt(node.GetAttribute(_T("Horizontal")), 0)) ||
+         (!Layout::landscape && StringToIntDflt(node.GetAttribute(_T("Vertical")), 0) ) )
       flip_orientation = true;
 
     style.control_parent();
@@ -877,7 +818,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
     window = tabbar;
 
     // TabMenuControl (TabMenu)
-  } else if (_tcscmp(node.getName(), _T("TabMenu")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("TabMenu")) == 0) {
     // Create the TabMenuControl
 
     style.control_parent();
@@ -892,7 +833,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
                                                  style);
     window = tabmenu;
 
-  } else if (_tcscmp(node.getName(), _T("Custom")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Custom")) == 0) {
     // Create a custom Window object with a callback
     CreateWindowCallback_t create_callback =
         (CreateWindowCallback_t)GetCallBack(lookup_table, node, _T("OnCreate"));
@@ -900,7 +841,7 @@ LoadChild(SubForm &form, ContainerWindow &parent,
       return NULL;
 
     window = create_callback(parent, pos.x, pos.y, size.cx, size.cy, style);
-  } else if (_tcscmp(node.getName(), _T("Widget")) == 0) {
+  } else if (_tcscmp(node.GetName(), _T("Widget")) == 0) {
     DockWindow *dock = new DockWindow();
     dock->set(parent, rc, style);
     window = dock;
@@ -920,24 +861,24 @@ LoadChild(SubForm &form, ContainerWindow &parent,
 }
 
 /**
- * Loads the Parent's children Controls from the given XMLNode
+ * Loads the Parent's children Controls from the given DialogNode
  *
  * @param form the SubForm object
  * @param Parent The parent control
  * @param LookUpTable The parents CallBackTable
- * @param Node The XMLNode that represents the parent control
+ * @param Node The DialogNode that represents the parent control
  * @param eDialogStyle The parent's dialog style
  */
 static void
 LoadChildrenFromXML(SubForm &form, ContainerWindow &parent,
                     const CallBackTableEntry *lookup_table,
-                    const XMLNode *node,
+                    const DialogNode &node,
                     const DialogStyle dialog_style)
 {
   unsigned bottom_most = 0;
 
   // Iterate through the childnodes
-  for (auto i = node->begin(), end = node->end(); i != end; ++i) {
+  for (auto i = node.begin(), end = node.end(); i != end; ++i) {
     // Load each child control from the child nodes
     Window *window = LoadChild(form, parent, lookup_table,
                                *i, dialog_style,
@@ -39,6 +39,7 @@ Copyright_License {
 #include "Util/Macros.hpp"
 #include "Units/Units.hpp"
 #include "Units/AngleFormatter.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -100,20 +101,52 @@ OnAirspaceListEnter(unsigned i)
 }
 
 
+/**
+ * Calculates distance and direction of all airspaces, split among the
+ * threads of a #WorkerPool.
+ */
+class AirspaceMetricsJob : public WorkerPool::Job {
+  AirspaceSorter &sorter;
+
+public:
+  AirspaceMetricsJob(AirspaceSorter &_sorter):sorter(_sorter) {}
+
+  virtual void Run(unsigned begin, unsigned end) {
+    sorter.UpdateMetrics(begin, end);
+  }
+};
+
+static WorkerPool *worker_pool;
+
+static void
+UpdateMetrics(const GeoPoint &location)
+{
+  airspace_sorter->SetLocation(location);
+
+  AirspaceMetricsJob job(*airspace_sorter);
+  worker_pool->Run(job, airspace_sorter->size(), 256);
+}
+
 static void UpdateList(void)
 {
-  AirspaceSelectInfo = airspace_sorter->get_list();
+  const TCHAR *name_filter = wpName->GetDataField()->GetAsString();
+  bool name_filtered = false;
 
-  if (TypeFilterIdx != WILDCARD)
-    airspace_sorter->filter_class(AirspaceSelectInfo, (AirspaceClass)TypeFilterIdx);
-  
   bool sort_distance = false;
   if (positive(distance_filter)) {
-    sort_distance = true;
-    airspace_sorter->filter_distance(AirspaceSelectInfo, distance_filter);
-  } 
+    /* query the kd-tree; the result is sorted by distance already */
+    airspace_sorter->FindWithinRange(AirspaceSelectInfo, distance_filter);
+  } else if (!string_is_empty(name_filter)) {
+    airspace_sorter->FindNamePrefix(AirspaceSelectInfo, name_filter);
+    name_filtered = true;
+  } else
+    AirspaceSelectInfo = airspace_sorter->get_list();
+
+  if (TypeFilterIdx != WILDCARD)
+    airspace_sorter->filter_class(AirspaceSelectInfo, (AirspaceClass)TypeFilterIdx);
+
   if (direction_filter != WILDCARD) {
-    sort_distance = true;
+    sort_distance = !positive(distance_filter);
     Angle a = direction_filter == 0
       ? CommonInterface::Calculated().heading
       : Angle::Degrees(fixed(direction_filter));
@@ -123,8 +156,7 @@ static void UpdateList(void)
     airspace_sorter->sort_distance(AirspaceSelectInfo);
   }
 
-  const TCHAR *name_filter = wpName->GetDataField()->GetAsString();
-  if (!string_is_empty(name_filter))
+  if (!name_filtered && !string_is_empty(name_filter))
     airspace_sorter->FilterNamePrefix(AirspaceSelectInfo, name_filter);
 
   wAirspaceList->SetLength(max((size_t)1, AirspaceSelectInfo.size()));
@@ -285,6 +317,14 @@ GetHeadingString(TCHAR *buffer)
 static void
 OnTimerNotify(gcc_unused WndForm &Sender)
 {
+  const NMEAInfo &basic = CommonInterface::Basic();
+  if (basic.location_available &&
+      basic.location.Distance(airspace_sorter->GetLocation()) > fixed(500)) {
+    /* the aircraft has moved; update the master list in place */
+    UpdateMetrics(basic.location);
+    UpdateList();
+  }
+
   if (direction_filter == 0 && !CommonInterface::Calculated().circling) {
     Angle a = last_heading - CommonInterface::Calculated().heading;
     if (a.AsDelta().AbsoluteDegrees() >= fixed(10)) {
@@ -429,6 +469,10 @@ dlgAirspaceSelect(const Airspaces &airspace_database,
                                    Units::ToUserDistance(fixed_one));
   airspace_sorter = &g_airspace_sorter;
 
+  WorkerPool pool;
+  worker_pool = &pool;
+
+  UpdateMetrics(Location);
   UpdateList();
 
   wf->ShowModal();
@@ -30,6 +30,7 @@ Copyright_License {
 #include "Replay/Replay.hpp"
 #include "DataField/FileReader.hpp"
 #include "DataField/Float.hpp"
+#include "DataField/Boolean.hpp"
 
 static WndForm *wf = NULL;
 
@@ -73,10 +74,26 @@ OnRateData(DataField *Sender, DataField::DataAccessKind_t Mode)
   }
 }
 
+static void
+OnMaxSpeedData(DataField *Sender, DataField::DataAccessKind_t Mode)
+{
+  DataFieldBoolean &df = *(DataFieldBoolean *)Sender;
+
+  switch (Mode) {
+  case DataField::daChange:
+    replay->SetMaxSpeed(df.GetAsBoolean());
+    break;
+
+  case DataField::daSpecial:
+    return;
+  }
+}
+
 static gcc_constexpr_data CallBackTableEntry CallBackTable[] = {
   DeclareCallBackEntry(OnStopClicked),
   DeclareCallBackEntry(OnStartClicked),
   DeclareCallBackEntry(OnRateData),
+  DeclareCallBackEntry(OnMaxSpeedData),
   DeclareCallBackEntry(OnCloseClicked),
   DeclareCallBackEntry(NULL)
 };
@@ -98,6 +115,13 @@ dlgLoggerReplayShowModal(void)
     wp->RefreshDisplay();
   }
 
+  wp = (WndProperty*)wf->FindByName(_T("prpMaxSpeed"));
+  if (wp) {
+    DataFieldBoolean &df = *(DataFieldBoolean *)wp->GetDataField();
+    df.Set(replay->GetMaxSpeed());
+    wp->RefreshDisplay();
+  }
+
   wp = (WndProperty*)wf->FindByName(_T("prpFile"));
   if (wp) {
     DataFieldFileReader* dfe;
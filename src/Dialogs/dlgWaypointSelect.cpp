@@ -148,17 +148,39 @@ struct WaypointSelectInfo
 struct WaypointSelectInfoVector :
   public std::vector<WaypointSelectInfo>
 {
-  void push_back(const Waypoint &waypoint, const GeoPoint &location) {
+  /**
+   * Adds a waypoint.  Distance and direction are calculated later by
+   * UpdateVectors().
+   */
+  void push_back(const Waypoint &waypoint) {
     WaypointSelectInfo info;
-
     info.waypoint = &waypoint;
 
-    const GeoVector vec(location, waypoint.location);
+    std::vector<WaypointSelectInfo>::push_back(info);
+  }
 
-    info.distance = vec.distance;
-    info.direction = vec.bearing;
+  /**
+   * Calculates distance and direction of all waypoints in one batch.
+   */
+  void UpdateVectors(const GeoPoint &location) {
+    const unsigned n = size();
+    if (n == 0)
+      return;
 
-    std::vector<WaypointSelectInfo>::push_back(info);
+    std::vector<GeoPoint> locations(n);
+    std::vector<fixed> distances(n);
+    std::vector<Angle> directions(n);
+
+    for (unsigned i = 0; i < n; ++i)
+      locations[i] = (*this)[i].waypoint->location;
+
+    DistanceBearing(location, &locations[0], n,
+                    &distances[0], &directions[0]);
+
+    for (unsigned i = 0; i < n; ++i) {
+      (*this)[i].distance = distances[i];
+      (*this)[i].direction = directions[i];
+    }
   }
 };
 
@@ -456,8 +478,6 @@ class FilterWaypointVisitor:
   public WaypointVisitor,
   private WaypointFilterData
 {
-  const GeoPoint location;
-  const Angle heading;
   WaypointSelectInfoVector &vector;
 
 private:
@@ -503,22 +523,6 @@ private:
     return false;
   }
 
-  static bool
-  CompareDirection(const Waypoint &waypoint, int direction_index,
-                    GeoPoint location, Angle heading)
-  {
-    if (direction_index <= 0)
-      return true;
-
-    int a = direction_filter_items[filter_data.direction_index];
-    Angle angle = (a == HEADING_DIRECTION) ? heading : Angle::Degrees(fixed(a));
-
-    const GeoVector vec(location, waypoint.location);
-    fixed direction_error = (vec.bearing - angle).AsDelta().AbsoluteDegrees();
-
-    return direction_error < fixed(18);
-  }
-
   static bool
   CompareName(const Waypoint &waypoint, const TCHAR *name)
   {
@@ -527,16 +531,31 @@ private:
 
 public:
   FilterWaypointVisitor(const WaypointFilterData &filter,
-                        GeoPoint _location, Angle _heading,
                         WaypointSelectInfoVector &_vector)
-    :WaypointFilterData(filter), location(_location), heading(_heading),
-     vector(_vector) {}
+    :WaypointFilterData(filter), vector(_vector) {}
 
   void Visit(const Waypoint &waypoint) {
     if (CompareType(waypoint, type_index) &&
-        (filter_data.distance_index == 0 || CompareName(waypoint, name)) &&
-        CompareDirection(waypoint, direction_index, location, heading))
-      vector.push_back(waypoint, location);
+        (filter_data.distance_index == 0 || CompareName(waypoint, name)))
+      vector.push_back(waypoint);
+  }
+};
+
+/**
+ * Matches waypoints whose direction deviates from the filter
+ * direction by more than 18 degrees.
+ */
+class WrongDirection
+{
+  Angle angle;
+
+public:
+  WrongDirection(Angle _angle):angle(_angle) {}
+
+  bool operator()(const WaypointSelectInfo &info) const {
+    const fixed direction_error =
+      (info.direction - angle).AsDelta().AbsoluteDegrees();
+    return direction_error >= fixed(18);
   }
 };
 
@@ -556,7 +575,7 @@ FillList(WaypointSelectInfoVector &list, const Waypoints &src,
   if (!filter.defined() && src.size() >= 500)
     return;
 
-  FilterWaypointVisitor visitor(filter, location, heading, list);
+  FilterWaypointVisitor visitor(filter, list);
 
   if (filter.distance_index > 0)
     src.VisitWithinRange(location, Units::ToSysDistance(
@@ -564,6 +583,16 @@ FillList(WaypointSelectInfoVector &list, const Waypoints &src,
   else
     src.VisitNamePrefix(filter.name, visitor);
 
+  list.UpdateVectors(location);
+
+  if (filter.direction_index > 0) {
+    int a = direction_filter_items[filter.direction_index];
+    Angle angle = (a == HEADING_DIRECTION) ? heading : Angle::Degrees(fixed(a));
+
+    list.erase(std::remove_if(list.begin(), list.end(), WrongDirection(angle)),
+               list.end());
+  }
+
   if (filter.distance_index > 0 || filter.direction_index > 0)
     std::sort(list.begin(), list.end(), WaypointDistanceCompare);
 }
@@ -583,8 +612,10 @@ FillLastUsedList(WaypointSelectInfoVector &list,
     if (waypoint == NULL)
       continue;
 
-    list.push_back(*waypoint, location);
+    list.push_back(*waypoint);
   }
+
+  list.UpdateVectors(location);
 }
 
 static void
@@ -23,6 +23,8 @@ Copyright_License {
 
 #include "DrawThread.hpp"
 #include "MapWindow/GlueMapWindow.hpp"
+#include "Tracing/Tracing.hpp"
+#include "Telemetry/Telemetry.hpp"
 
 #ifndef ENABLE_OPENGL
 
@@ -33,6 +35,7 @@ void
 DrawThread::Run()
 {
   SetLowPriority();
+  Tracing::SetThreadName("DrawThread");
 
   // bounds_dirty maintains the status of whether the map
   // bounds have changed and there are pending idle calls
@@ -72,7 +75,13 @@ DrawThread::Run()
       map.ExchangeBlackboard();
 
       // Draw the moving map
-      map.repaint();
+      {
+        TRACE_SPAN("DrawThread::Repaint");
+        ScopeTelemetryCycle telemetry_cycle(Telemetry::DRAW_THREAD);
+        map.repaint();
+      }
+
+      map.TraceFixLatency();
 
       if (trigger.Test()) {
         // interrupt re-calculation of bounds if there was a 
@@ -81,12 +90,14 @@ DrawThread::Run()
         continue;
       }
 
+      TRACE_SPAN("DrawThread::Idle");
       bounds_dirty = map.Idle();
     } else if (bounds_dirty) {
       /* got the "stop" trigger? */
       if (CheckStoppedOrSuspended())
         break;
 
+      TRACE_SPAN("DrawThread::Idle");
       bounds_dirty = map.Idle();
     }
   }
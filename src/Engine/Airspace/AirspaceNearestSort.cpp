@@ -2,6 +2,7 @@
 #include "Airspaces.hpp"
 #include "AirspaceVisitor.hpp"
 #include "AbstractAirspace.hpp"
+#include "Math/Earth.hpp"
 
 void 
 AirspaceNearestSort::populate_queue(const Airspaces &airspaces,
@@ -12,14 +13,30 @@ AirspaceNearestSort::populate_queue(const Airspaces &airspaces,
                          range,
                          m_condition);
 
+  std::vector<const Airspace *> items;
+  std::vector<const AbstractAirspace *> candidates;
+  items.reserve(vectors.size());
+  candidates.reserve(vectors.size());
+
   for (auto v = vectors.begin(); v != vectors.end(); ++v) {
     const AbstractAirspace *as = v->get_airspace();
     if (as != NULL) {
-      const AirspaceInterceptSolution ais = solve_intercept(*as);
-      const fixed value = metric(ais);
-      if (!negative(value)) {
-        m_q.push(std::make_pair(m_reverse? -value:value, std::make_pair(ais, *v)));
-      }
+      items.push_back(&*v);
+      candidates.push_back(as);
+    }
+  }
+
+  if (candidates.empty())
+    return;
+
+  std::vector<AirspaceInterceptSolution> solutions(candidates.size());
+  solve_intercepts(&candidates[0], candidates.size(), &solutions[0]);
+
+  for (unsigned i = 0; i < candidates.size(); ++i) {
+    const AirspaceInterceptSolution &ais = solutions[i];
+    const fixed value = metric(ais);
+    if (!negative(value)) {
+      m_q.push(std::make_pair(m_reverse? -value:value, std::make_pair(ais, *items[i])));
     }
   }
 }
@@ -38,6 +55,40 @@ AirspaceNearestSort::solve_intercept(const AbstractAirspace &a) const
   }
 }
 
+void
+AirspaceNearestSort::solve_intercepts(const AbstractAirspace *const*airspaces,
+                                      unsigned n,
+                                      AirspaceInterceptSolution *solutions) const
+{
+  /* collect the closest points of all airspaces outside, and
+     calculate their distances in one pass */
+  std::vector<GeoPoint> locations;
+  std::vector<unsigned> indices;
+  locations.reserve(n);
+  indices.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const AbstractAirspace &a = *airspaces[i];
+    if (a.Inside(m_location)) {
+      solutions[i] = AirspaceInterceptSolution::Invalid();
+    } else {
+      solutions[i].location = a.ClosestPoint(m_location);
+      locations.push_back(solutions[i].location);
+      indices.push_back(i);
+    }
+  }
+
+  if (locations.empty())
+    return;
+
+  std::vector<fixed> distances(locations.size());
+  DistanceBearing(m_location, &locations[0], locations.size(),
+                  &distances[0], NULL);
+
+  for (unsigned j = 0; j < indices.size(); ++j)
+    solutions[indices[j]].distance = distances[j];
+}
+
 fixed 
 AirspaceNearestSort::metric(const AirspaceInterceptSolution& sol) const
 {
@@ -87,6 +87,19 @@ public:
  */
   virtual AirspaceInterceptSolution solve_intercept(const AbstractAirspace &a) const;
 
+/** 
+ * Compute solutions for a series of airspaces.  This implementation
+ * determines the closest points first, and then calculates all
+ * distances in one batch.
+ * 
+ * @param airspaces Array of airspaces to compute solutions for
+ * @param n Number of airspaces
+ * @param solutions Array of n solutions to be filled
+ */
+  virtual void solve_intercepts(const AbstractAirspace *const*airspaces,
+                                unsigned n,
+                                AirspaceInterceptSolution *solutions) const;
+
 /** 
  * Metric defining sort criteria
  * 
@@ -20,6 +20,15 @@ AirspaceSoonestSort::solve_intercept(const AbstractAirspace &a) const
   return sol;
 }
 
+void
+AirspaceSoonestSort::solve_intercepts(const AbstractAirspace *const*airspaces,
+                                      unsigned n,
+                                      AirspaceInterceptSolution *solutions) const
+{
+  for (unsigned i = 0; i < n; ++i)
+    solutions[i] = solve_intercept(*airspaces[i]);
+}
+
 fixed
 AirspaceSoonestSort::metric(const AirspaceInterceptSolution& sol) const
 {
@@ -45,6 +45,14 @@ public:
  */
   virtual AirspaceInterceptSolution solve_intercept(const AbstractAirspace &a) const;
 
+/** 
+ * Compute intercept solutions by calling solve_intercept() for each
+ * airspace.
+ */
+  virtual void solve_intercepts(const AbstractAirspace *const*airspaces,
+                                unsigned n,
+                                AirspaceInterceptSolution *solutions) const;
+
 /** 
  * Calculate metric for intercept solution.  In this case, returns the
  * time to intercept if valid.
@@ -1,9 +1,13 @@
 #include "AirspaceSorter.hpp"
 #include "Airspace/Airspaces.hpp"
 #include "AbstractAirspace.hpp"
-#include "Navigation/Geometry/GeoVector.hpp"
+#include "AirspaceCircle.hpp"
+#include "AirspacePolygon.hpp"
+#include "AirspaceVisitor.hpp"
+#include "Math/Earth.hpp"
 
 #include <algorithm>
+#include <assert.h>
 
 
 static AirspaceClass MatchClass;
@@ -12,9 +16,40 @@ static const TCHAR *name_prefix;
 static Angle Direction;
 static fixed MaxDistance;
 
-AirspaceSorter::AirspaceSorter(const Airspaces &airspaces,
+static inline unsigned
+ToUpperASCII(unsigned ch)
+{
+  return ch >= 'a' && ch <= 'z'
+    ? ch - 'a' + 'A'
+    : ch;
+}
+
+/**
+ * Packs the first four characters of the string into an integer, for
+ * fast case-insensitive sorting and prefix matching.  Returns the
+ * number of characters packed in *length_r.
+ */
+static unsigned
+MakeFourChars(const TCHAR *name, unsigned *length_r=NULL)
+{
+  unsigned result = 0, length = 0;
+  for (unsigned i = 0; i < 4; ++i) {
+    result <<= 8;
+    if (name[length] != 0)
+      result |= ToUpperASCII(name[length++] & 0xff);
+  }
+
+  if (length_r != NULL)
+    *length_r = length;
+
+  return result;
+}
+
+AirspaceSorter::AirspaceSorter(const Airspaces &_airspaces,
                                const GeoPoint &Location,
-                               const fixed distance_factor)
+                               const fixed _distance_factor)
+  :airspaces(_airspaces), location(Location),
+   distance_factor(_distance_factor)
 {
   m_airspaces_all.reserve(airspaces.size());
 
@@ -24,24 +59,49 @@ AirspaceSorter::AirspaceSorter(const Airspaces &airspaces,
     const AbstractAirspace &airspace = *it->get_airspace();
 
     info.airspace = &airspace;
+    info.Distance = fixed_zero;
+    info.Direction = Angle::Zero();
+    info.FourChars = MakeFourChars(airspace.GetName());
 
-    const GeoPoint closest_loc = airspace.ClosestPoint(Location);
-    const GeoVector vec(Location, closest_loc);
+    m_airspaces_all.push_back(info);
+  }
 
-    info.Distance = vec.distance * distance_factor;
-    info.Direction = vec.bearing;
+  sort_name(m_airspaces_all);
 
-    const TCHAR *name = airspace.GetName();
+  by_pointer.reserve(m_airspaces_all.size());
+  for (unsigned i = 0; i < m_airspaces_all.size(); ++i)
+    by_pointer.push_back(std::make_pair(m_airspaces_all[i].airspace, i));
 
-    info.FourChars = ((name[0] & 0xff) << 24) +
-                     ((name[1] & 0xff) << 16) +
-                     ((name[2] & 0xff) << 8) +
-                     ((name[3] & 0xff));
+  std::sort(by_pointer.begin(), by_pointer.end());
+}
 
-    m_airspaces_all.push_back(info);
-  }
+void
+AirspaceSorter::UpdateMetrics(unsigned begin, unsigned end)
+{
+  assert(begin <= end);
+  assert(end <= m_airspaces_all.size());
 
-  sort_name(m_airspaces_all);
+  /* calculate the closest points in chunks, and their distances with
+     the batched geodesic function */
+  const unsigned CHUNK = 64;
+  GeoPoint closest[CHUNK];
+  fixed distances[CHUNK];
+  Angle directions[CHUNK];
+
+  for (unsigned i = begin; i < end; i += CHUNK) {
+    const unsigned n = std::min(end - i, CHUNK);
+    AirspaceSelectInfo *const chunk = &m_airspaces_all[i];
+
+    for (unsigned j = 0; j < n; ++j)
+      closest[j] = chunk[j].airspace->ClosestPoint(location);
+
+    DistanceBearing(location, closest, n, distances, directions);
+
+    for (unsigned j = 0; j < n; ++j) {
+      chunk[j].Distance = distances[j] * distance_factor;
+      chunk[j].Direction = directions[j];
+    }
+  }
 }
 
 const AirspaceSelectInfoVector&
@@ -50,6 +110,96 @@ AirspaceSorter::get_list() const
   return m_airspaces_all;
 }
 
+/**
+ * Collects pointers to all visited airspaces.
+ */
+class AirspacePointerCollector : public AirspaceVisitor {
+  std::vector<const AbstractAirspace *> &dest;
+
+public:
+  AirspacePointerCollector(std::vector<const AbstractAirspace *> &_dest)
+    :dest(_dest) {}
+
+protected:
+  virtual void Visit(const AirspaceCircle &as) {
+    dest.push_back(&as);
+  }
+
+  virtual void Visit(const AirspacePolygon &as) {
+    dest.push_back(&as);
+  }
+};
+
+void
+AirspaceSorter::FindWithinRange(AirspaceSelectInfoVector &vec,
+                                const fixed distance) const
+{
+  vec.clear();
+
+  std::vector<const AbstractAirspace *> found;
+  AirspacePointerCollector collector(found);
+  airspaces.visit_within_range(location, distance / distance_factor,
+                               collector);
+
+  /* the kd-tree reports bounding box matches; filter by the exact
+     distance */
+  for (auto i = found.begin(), end = found.end(); i != end; ++i) {
+    auto p = std::lower_bound(by_pointer.begin(), by_pointer.end(),
+                              PointerIndex(*i, 0));
+    if (p == by_pointer.end() || p->first != *i)
+      continue;
+
+    const AirspaceSelectInfo &info = m_airspaces_all[p->second];
+    if (info.Distance <= distance)
+      vec.push_back(info);
+  }
+
+  sort_distance(vec);
+}
+
+static bool
+CompareFourChars(const AirspaceSelectInfo &elem, unsigned value)
+{
+  return elem.FourChars < value;
+}
+
+static bool
+CompareFourCharsReverse(unsigned value, const AirspaceSelectInfo &elem)
+{
+  return value < elem.FourChars;
+}
+
+void
+AirspaceSorter::FindNamePrefix(AirspaceSelectInfoVector &vec,
+                               const TCHAR *prefix) const
+{
+  vec.clear();
+
+  unsigned length;
+  const unsigned key = MakeFourChars(prefix, &length);
+
+  bool ascii = true;
+  for (unsigned i = 0; i < length; ++i)
+    if ((unsigned)prefix[i] >= 0x80)
+      ascii = false;
+
+  AirspaceSelectInfoVector::const_iterator begin = m_airspaces_all.begin();
+  AirspaceSelectInfoVector::const_iterator end = m_airspaces_all.end();
+
+  if (ascii && length > 0) {
+    /* the master list is sorted by FourChars; all candidates share
+       the packed prefix */
+    const unsigned mask = 0xffffffff << (8 * (4 - length));
+    begin = std::lower_bound(begin, end, key, CompareFourChars);
+    end = std::upper_bound(begin, end, key | ~mask,
+                           CompareFourCharsReverse);
+  }
+
+  for (auto i = begin; i != end; ++i)
+    if (i->airspace->MatchNamePrefix(prefix))
+      vec.push_back(*i);
+}
+
 static bool
 AirspaceClassFilter(const AirspaceSelectInfo& elem1)
 {
@@ -75,7 +225,7 @@ void
 AirspaceSorter::filter_name(AirspaceSelectInfoVector& vec,
                             const unsigned char c) const
 {
-  MatchChar = c;
+  MatchChar = ToUpperASCII(c);
   vec.erase(std::remove_if(vec.begin(), vec.end(), AirspaceNameFilter),
             vec.end());
 }
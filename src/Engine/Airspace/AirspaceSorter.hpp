@@ -3,13 +3,14 @@
 
 #include "Math/Angle.hpp"
 #include "Airspace/AirspaceClass.hpp"
+#include "Navigation/GeoPoint.hpp"
 #include "Compiler.h"
 
 #include <vector>
+#include <tchar.h>
 
 class AbstractAirspace;
 class Airspaces;
-struct GeoPoint;
 
 /** Structure to hold Airspace sorting information */
 struct AirspaceSelectInfo
@@ -20,24 +21,45 @@ struct AirspaceSelectInfo
   fixed Distance;
   /** Bearing (deg true north) from observer to waypoint */
   Angle Direction;
-  /** Fast access of first four characters of name */
+  /**
+   * Fast access of first four characters of name (ASCII letters
+   * converted to upper case)
+   */
   unsigned int FourChars;
 };
 
 typedef std::vector<AirspaceSelectInfo> AirspaceSelectInfoVector;
 
 /**
- * Utility class to manage sorting of waypoints (e.g. for dlgWaypointSelect)
- * Note that distance queries do not yet make use of the kdtree, but this system
- * keeps a local master list so won't need to lock the waypoints for long.
+ * Utility class to manage sorting of airspaces (e.g. for
+ * dlgAirspaceSelect).  It keeps a local master list sorted by name,
+ * so it won't need to lock the airspaces for long.  Distance and
+ * direction of all entries are calculated by UpdateMetrics(), which
+ * may be split among several threads, and may be called again after
+ * the aircraft has moved.  Distance queries use the kd-tree.
  */
 class AirspaceSorter
 {
+  const Airspaces &airspaces;
+
+  GeoPoint location;
+
+  const fixed distance_factor;
+
   AirspaceSelectInfoVector m_airspaces_all;
 
+  typedef std::pair<const AbstractAirspace *, unsigned> PointerIndex;
+
+  /**
+   * Maps airspace pointers (as reported by the kd-tree) to indices
+   * in #m_airspaces_all; sorted by pointer.
+   */
+  std::vector<PointerIndex> by_pointer;
+
 public:
   /**
-   * Constructor.  Sorts master list of waypoints by name
+   * Constructor.  Sorts master list of airspaces by name.  Distance
+   * and direction are not calculated yet; call UpdateMetrics().
    *
    * @param _airspaces Airspaces store
    * @param Location Location of aircraft at time of query
@@ -47,6 +69,33 @@ public:
                  const GeoPoint &Location,
                  const fixed distance_factor);
 
+  gcc_pure
+  unsigned size() const {
+    return m_airspaces_all.size();
+  }
+
+  const GeoPoint &GetLocation() const {
+    return location;
+  }
+
+  /**
+   * Set a new aircraft location.  Call UpdateMetrics() afterwards.
+   */
+  void SetLocation(const GeoPoint &_location) {
+    location = _location;
+  }
+
+  /**
+   * Calculate distance and direction of the master list entries
+   * [begin, end).  This method may be called concurrently for
+   * disjoint ranges.
+   */
+  void UpdateMetrics(unsigned begin, unsigned end);
+
+  void UpdateMetrics() {
+    UpdateMetrics(0, size());
+  }
+
   /**
    * Return master list
    *
@@ -55,6 +104,27 @@ public:
   gcc_pure
   const AirspaceSelectInfoVector& get_list() const;
 
+  /**
+   * Fill the list with all airspaces within the specified range,
+   * sorted by distance.  Candidates are obtained from the kd-tree.
+   *
+   * @param vec List to fill
+   * @param distance Distance (user units) of limit
+   */
+  void FindWithinRange(AirspaceSelectInfoVector &vec,
+                       const fixed distance) const;
+
+  /**
+   * Fill the list with all airspaces matching the specified name
+   * prefix, sorted by name.  Uses a binary search on the master
+   * list if possible.
+   *
+   * @param vec List to fill
+   * @param prefix the name prefix
+   */
+  void FindNamePrefix(AirspaceSelectInfoVector &vec,
+                      const TCHAR *prefix) const;
+
   /**
    * Remove airspaces not of specified class
    *
@@ -42,11 +42,13 @@ class ContestDijkstra:
   public NavDijkstra<TracePoint>
 {
   bool solution_found;
-  bool trace_dirty;
 
   TracePointVector trace; // working trace for solver
 
 protected:
+  /** Has the working trace changed since the last search was started? */
+  bool trace_dirty;
+
   /** Number of points in current trace set */
   unsigned n_points;
 
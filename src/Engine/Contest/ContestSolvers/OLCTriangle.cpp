@@ -22,6 +22,10 @@
 #include "OLCTriangle.hpp"
 #include "Navigation/Flat/FlatRay.hpp"
 
+#include <algorithm>
+#include <math.h>
+#include <limits.h>
+
 /*
  @todo potential to use 3d convex hull to speed search
 
@@ -47,6 +51,7 @@ OLCTriangle::OLCTriangle(const Trace &_trace,
   is_closed(false),
   is_complete(false),
   first_tp(0),
+  best_d(0),
   is_fai(_is_fai)
 {}
 
@@ -59,6 +64,8 @@ OLCTriangle::Reset()
   is_closed = false;
   first_tp = 0;
   best_d = 0;
+  boxes.clear();
+  pending.clear();
 }
 
 
@@ -205,74 +212,319 @@ TriangleSecondLeg::Calculate(const TracePoint &c, unsigned best) const
 }
 
 
-void
-OLCTriangle::add_start_edges()
+/**
+ * Maximum number of trace points in a leaf of the bounding box tree.
+ */
+static const unsigned LEAF_SIZE = 4;
+
+/**
+ * Number of triangles (and box triples) to be examined in one
+ * incremental Solve() call.  This is roughly the number of edges the
+ * Dijkstra solver used to visit in its 25 iterations.
+ */
+static const unsigned SOLVE_BUDGET = 25000;
+
+gcc_const
+static unsigned
+FlatHypot(unsigned dx, unsigned dy)
 {
-  // use last point as single start,
-  // this is out of order but required
+  return (unsigned)hypot((double)dx, (double)dy);
+}
+
+/**
+ * The largest distance between two values of the two ranges.
+ */
+gcc_const
+static unsigned
+MaxSpan(int a_min, int a_max, int b_min, int b_max)
+{
+  return std::max(a_max - b_min, b_max - a_min);
+}
 
-  dijkstra.pop();
-  ScanTaskPoint destination(0, n_points-1);
-  dijkstra.link(destination, destination, 0);
+/**
+ * The smallest distance between two values of the two ranges.
+ */
+gcc_const
+static unsigned
+MinSpan(int a_min, int a_max, int b_min, int b_max)
+{
+  return std::max(0, std::max(b_min - a_max, a_min - b_max));
 }
 
+unsigned
+OLCTriangle::MaxDistance(const FlatGeoPoint &p, const BoxNode &box)
+{
+  return FlatHypot(MaxSpan(p.Longitude, p.Longitude, box.min_x, box.max_x),
+                   MaxSpan(p.Latitude, p.Latitude, box.min_y, box.max_y)) + 1;
+}
 
-void 
-OLCTriangle::add_edges(const ScanTaskPoint& origin)
+unsigned
+OLCTriangle::MinDistance(const FlatGeoPoint &p, const BoxNode &box)
 {
-  assert(origin.point_index < n_points);
-  ScanTaskPoint destination(origin.stage_number + 1, origin.point_index + 1);
-
-  switch (destination.stage_number) {
-  case 1:
-    // add points up to finish
-    for (destination.point_index = 0;
-         destination.point_index < origin.point_index;
-         ++destination.point_index) {
-      const unsigned d = 
-        distance(origin, destination);
-
-      if (!is_fai || (4*d >= best_d)) { // no reason to add candidate if worse
-                                        // than 25% rule for FAI tasks
-        dijkstra.link(destination, origin,
-                      get_weighting(origin.stage_number) * d);
-      }
+  const unsigned d =
+    FlatHypot(MinSpan(p.Longitude, p.Longitude, box.min_x, box.max_x),
+              MinSpan(p.Latitude, p.Latitude, box.min_y, box.max_y));
+  return d > 0 ? d - 1 : 0;
+}
 
+unsigned
+OLCTriangle::BuildBoxes(unsigned begin, unsigned end)
+{
+  assert(begin < end);
+
+  const unsigned index = boxes.size();
+  boxes.push_back(BoxNode());
+
+  BoxNode node;
+  node.begin = begin;
+  node.end = end;
+
+  if (end - begin <= LEAF_SIZE) {
+    node.left = node.right = 0;
+
+    const FlatGeoPoint &first =
+      GetPointFast(ScanTaskPoint(0, begin)).get_flatLocation();
+    node.min_x = node.max_x = first.Longitude;
+    node.min_y = node.max_y = first.Latitude;
+
+    for (unsigned i = begin + 1; i < end; ++i) {
+      const FlatGeoPoint &p =
+        GetPointFast(ScanTaskPoint(0, i)).get_flatLocation();
+      node.min_x = std::min(node.min_x, p.Longitude);
+      node.max_x = std::max(node.max_x, p.Longitude);
+      node.min_y = std::min(node.min_y, p.Latitude);
+      node.max_y = std::max(node.max_y, p.Latitude);
     }
-    break;
-  case 2: {
-    ScanTaskPoint previous = dijkstra.get_predecessor(origin);
-
-    // give first leg points to penultimate node
-    TriangleSecondLeg sl(is_fai, GetPointFast(previous), GetPointFast(origin));
-    for (; destination.point_index < n_points-1; ++destination.point_index) {
-      TriangleSecondLeg::Result result = sl.Calculate(GetPointFast(destination),
-                                                      best_d);
-      const unsigned d = result.leg_distance;
-      if (d) {
-        best_d = result.total_distance;
-
-        dijkstra.link(destination, origin,
-                      get_weighting(origin.stage_number) * d);
-
-        // we have an improved solution
-        is_complete = true;
-
-        // need to scan again whether path is closed
-        is_closed = false;
-        first_tp = origin.point_index;
+  } else {
+    const unsigned middle = begin + (end - begin) / 2;
+    node.left = BuildBoxes(begin, middle);
+    node.right = BuildBoxes(middle, end);
+
+    const BoxNode &left = boxes[node.left], &right = boxes[node.right];
+    node.min_x = std::min(left.min_x, right.min_x);
+    node.max_x = std::max(left.max_x, right.max_x);
+    node.min_y = std::min(left.min_y, right.min_y);
+    node.max_y = std::max(left.max_y, right.max_y);
+  }
+
+  boxes[index] = node;
+  return index;
+}
+
+bool
+OLCTriangle::CalcBound(BoxTriple &triple) const
+{
+  unsigned d_max[3], d_min[3];
+  for (unsigned i = 0; i < 3; ++i) {
+    const BoxNode &a = boxes[triple.nodes[i]];
+    const BoxNode &b = boxes[triple.nodes[(i + 1) % 3]];
+
+    // leave a margin of one for rounding errors
+    d_max[i] = FlatHypot(MaxSpan(a.min_x, a.max_x, b.min_x, b.max_x),
+                         MaxSpan(a.min_y, a.max_y, b.min_y, b.max_y)) + 1;
+
+    const unsigned d = FlatHypot(MinSpan(a.min_x, a.max_x, b.min_x, b.max_x),
+                                 MinSpan(a.min_y, a.max_y, b.min_y, b.max_y));
+    d_min[i] = d > 0 ? d - 1 : 0;
+  }
+
+  triple.bound = d_max[0] + d_max[1] + d_max[2];
+
+  if (is_fai) {
+    // every leg must be at least 25% of the total (worst-case rule)
+    const unsigned shortest = std::min(d_max[0], std::min(d_max[1], d_max[2]));
+    triple.bound = std::min(triple.bound, 4 * shortest);
+
+    // ... and no leg may be longer than 45%
+    for (unsigned i = 0; i < 3; ++i) {
+      const unsigned others_min = d_min[(i + 1) % 3] + d_min[(i + 2) % 3];
+      const unsigned others_max = d_max[(i + 1) % 3] + d_max[(i + 2) % 3];
+      if (3 * d_max[i] < others_min || 11 * d_min[i] > 9 * others_max)
+        return false;
+    }
+  }
+
+  return triple.bound > best_d;
+}
+
+void
+OLCTriangle::SplitTriple(const BoxTriple &triple)
+{
+  // split the largest box
+
+  unsigned split = 0, split_size = 0;
+  for (unsigned i = 0; i < 3; ++i) {
+    const BoxNode &node = boxes[triple.nodes[i]];
+    const unsigned size = (node.max_x - node.min_x) +
+      (node.max_y - node.min_y) + 1;
+    if (node.left != 0 && size > split_size) {
+      split = triple.nodes[i];
+      split_size = size;
+    }
+  }
+
+  assert(split_size > 0);
+  const BoxNode &node = boxes[split];
+
+  unsigned first = 0, count = 0;
+  for (unsigned i = 0; i < 3; ++i) {
+    if (triple.nodes[i] == split) {
+      if (count == 0)
+        first = i;
+      ++count;
+    }
+  }
+
+  // the ranges must remain in ascending order: the first t
+  // occurrences of the box get its first half, the others get the
+  // second half
+
+  BoxTriple children[4];
+  unsigned n = 0;
+  for (unsigned t = 0; t <= count; ++t) {
+    BoxTriple child = triple;
+    for (unsigned i = 0; i < count; ++i)
+      child.nodes[first + i] = i < t ? node.left : node.right;
+
+    if (!CalcBound(child))
+      continue;
+
+    // insert sorted, so the most promising triple is examined first
+    unsigned j = n++;
+    for (; j > 0 && children[j - 1].bound > child.bound; --j)
+      children[j] = children[j - 1];
+    children[j] = child;
+  }
+
+  pending.insert(pending.end(), children, children + n);
+}
+
+unsigned
+OLCTriangle::ScanTriple(const BoxTriple &triple)
+{
+  const BoxNode &a = boxes[triple.nodes[0]];
+  const BoxNode &b = boxes[triple.nodes[1]];
+  const BoxNode &c = boxes[triple.nodes[2]];
+
+  unsigned count = 0;
+  for (unsigned i = a.begin; i < a.end; ++i) {
+    const TracePoint &p_i = GetPointFast(ScanTaskPoint(0, i));
+
+    for (unsigned j = std::max(b.begin, i + 1); j < b.end; ++j) {
+      const TracePoint &p_j = GetPointFast(ScanTaskPoint(0, j));
+
+      // skip this pair if no point of the third box can beat the best
+      const unsigned d_ij = p_i.flat_distance(p_j);
+      const unsigned d_jk = MaxDistance(p_j.get_flatLocation(), c);
+      const unsigned d_ki = MaxDistance(p_i.get_flatLocation(), c);
+      unsigned bound = d_ij + d_jk + d_ki;
+      if (is_fai) {
+        bound = std::min(bound, 4 * std::min(d_ij, std::min(d_jk, d_ki)));
+
+        // this leg must be at least 25% and at most 45% of the total
+        if (3 * d_ij < MinDistance(p_i.get_flatLocation(), c) +
+            MinDistance(p_j.get_flatLocation(), c) ||
+            11 * d_ij > 9 * (d_jk + d_ki))
+          continue;
+      }
+
+      if (bound <= best_d)
+        continue;
+
+      const TriangleSecondLeg sl(is_fai, p_i, p_j);
+
+      for (unsigned k = std::max(c.begin, j + 1); k < c.end; ++k) {
+        const TracePoint &p_k = GetPointFast(ScanTaskPoint(0, k));
+        const TriangleSecondLeg::Result result = sl.Calculate(p_k, best_d);
+        ++count;
+
+        if (result.leg_distance) {
+          best_d = result.total_distance;
+
+          solution[0] = p_i;
+          solution[1] = p_j;
+          solution[2] = p_k;
+          solution[3] = p_i;
+
+          // we have an improved solution
+          is_complete = true;
+
+          // need to scan again whether path is closed
+          is_closed = false;
+          first_tp = i;
+        }
       }
     }
   }
-    break;
-  case 3:
-    // dummy just to close the triangle
-    destination.point_index = n_points - 1;
-    dijkstra.link(destination, origin, 0);
-    break;
-  default:
-    assert(1);
+
+  return count;
+}
+
+bool
+OLCTriangle::RunSearch(unsigned budget)
+{
+  unsigned count = 0;
+  while (!pending.empty()) {
+    if (count >= budget)
+      return false;
+
+    const BoxTriple triple = pending.back();
+    pending.pop_back();
+    ++count;
+
+    if (triple.bound <= best_d)
+      // a better triangle has been found meanwhile
+      continue;
+
+    if (boxes[triple.nodes[0]].left == 0 &&
+        boxes[triple.nodes[1]].left == 0 &&
+        boxes[triple.nodes[2]].left == 0)
+      count += ScanTriple(triple);
+    else
+      SplitTriple(triple);
   }
+
+  return true;
+}
+
+bool
+OLCTriangle::Solve(bool exhaustive)
+{
+  assert(num_stages <= MAX_STAGES);
+
+  if (pending.empty()) {
+    update_trace();
+    if (n_points < num_stages)
+      return true;
+
+    // don't re-start search unless we have had new data appear
+    if (!trace_dirty)
+      return true;
+
+    trace_dirty = false;
+
+    boxes.clear();
+    BuildBoxes(0, n_points);
+
+    BoxTriple root;
+    std::fill(root.nodes, root.nodes + 3, 0);
+    if (!CalcBound(root))
+      return true;
+
+    pending.push_back(root);
+  }
+
+#ifdef INSTRUMENT_TASK
+  count_olc_solve++;
+  count_olc_size = std::max(count_olc_size, (unsigned)pending.size());
+#endif
+
+  if (!RunSearch(exhaustive ? UINT_MAX : SOLVE_BUDGET))
+    return false;
+
+  SaveSolution();
+  update_trace();
+  return true;
 }
 
 
@@ -306,12 +558,6 @@ OLCTriangle::CalcScore() const
   return ApplyHandicap(CalcDistance()*fixed(0.001));
 }
 
-void
-OLCTriangle::start_search()
-{
-}
-
-
 bool 
 OLCTriangle::UpdateScore()
 {
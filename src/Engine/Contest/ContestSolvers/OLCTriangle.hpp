@@ -25,12 +25,55 @@
 
 #include "ContestDijkstra.hpp"
 
+#include <vector>
+
 /**
  * Specialisation of OLC Dijkstra for OLC Triangle (triangle) rules
+ *
+ * The triangle is not searched with the Dijkstra solver; instead,
+ * the trace is split into a tree of bounding boxes, and triples of
+ * boxes are refined (branch and bound) as long as their upper bound
+ * of the triangle perimeter beats the best triangle found so far.
+ * ContestDijkstra is only used to manage the trace and the solution.
+ *
+ * The search runs on the ContestDijkstra working trace, which is a
+ * copy of all points of the master #Trace.  No raw fixes are kept
+ * anywhere: the #Trace is the complete flight history, limited to
+ * a fixed number of points by removing the points which change the
+ * path the least.  Every point that is left is a triangle corner
+ * candidate.
  */
 class OLCTriangle: 
   public ContestDijkstra
 {
+  /**
+   * A node of the bounding box tree: a range of trace points and the
+   * flat bounding box of their locations.
+   */
+  struct BoxNode {
+    unsigned begin, end;
+
+    /** Indices of the child nodes, 0 if this is a leaf */
+    unsigned left, right;
+
+    int min_x, min_y, max_x, max_y;
+  };
+
+  /**
+   * Three box nodes with ascending trace ranges (two or three of them
+   * may be the same node), and the upper bound of the perimeter of
+   * triangles with one corner in each box.
+   */
+  struct BoxTriple {
+    unsigned nodes[3];
+    unsigned bound;
+  };
+
+  std::vector<BoxNode> boxes;
+
+  /** Box triples which still need to be examined (depth first) */
+  std::vector<BoxTriple> pending;
+
 protected:
   bool is_closed;
   bool is_complete;
@@ -44,6 +87,8 @@ public:
 
   void Reset();
 
+  virtual bool Solve(bool exhaustive);
+
 protected:
   virtual bool SaveSolution();
 
@@ -55,14 +100,53 @@ protected:
 
   bool path_closed() const;
 
-  void add_edges(const ScanTaskPoint &curNode);
-
-  void start_search();
-
   bool UpdateScore();
 
 private:
-  void add_start_edges();
+  /**
+   * Calculate an upper bound of the flat distance between the point
+   * and any point in the box.
+   */
+  gcc_pure
+  static unsigned MaxDistance(const FlatGeoPoint &p, const BoxNode &box);
+
+  /**
+   * Calculate a lower bound of the flat distance between the point
+   * and any point in the box.
+   */
+  gcc_pure
+  static unsigned MinDistance(const FlatGeoPoint &p, const BoxNode &box);
+
+  unsigned BuildBoxes(unsigned begin, unsigned end);
+
+  /**
+   * Calculate the perimeter bound of the specified box triple.
+   *
+   * @return false if no triangle within the triple can be better
+   * than #best_d or be valid
+   */
+  bool CalcBound(BoxTriple &triple) const;
+
+  /**
+   * Split the largest box of the triple and queue the resulting
+   * triples.
+   */
+  void SplitTriple(const BoxTriple &triple);
+
+  /**
+   * Check all triangles of a triple consisting only of leaf boxes.
+   *
+   * @return the number of triangles examined
+   */
+  unsigned ScanTriple(const BoxTriple &triple);
+
+  /**
+   * Continue the search.
+   *
+   * @param budget the maximum number of triangles to be examined
+   * @return true if the search is finished
+   */
+  bool RunSearch(unsigned budget);
 };
 
 #endif
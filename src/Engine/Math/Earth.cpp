@@ -181,6 +181,64 @@ DistanceBearing(const GeoPoint loc1, const GeoPoint loc2,
     DistanceBearingS(loc1, loc2, NULL, bearing);
 }
 
+void
+DistanceBearing(const GeoPoint origin, const GeoPoint *locations, unsigned n,
+                fixed *distances, Angle *bearings)
+{
+  assert(locations != NULL || n == 0);
+
+  const auto sc1 = origin.latitude.SinCos();
+  const fixed sin_lat1 = sc1.first, cos_lat1 = sc1.second;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoPoint loc2 = locations[i];
+
+    const auto sc2 = loc2.latitude.SinCos();
+    const fixed sin_lat2 = sc2.first, cos_lat2 = sc2.second;
+
+    const fixed dlon = (loc2.longitude - origin.longitude).Radians();
+
+#ifndef FIXED_MATH
+    /* derive the sine and cosine of dlon from its half angle, which
+       saves one sin_cos() call per location */
+    const auto sc_half = sin_cos(half(dlon));
+#endif
+
+    if (distances != NULL) {
+      const fixed s1 = (loc2.latitude - origin.latitude).accurate_half_sin();
+#ifdef FIXED_MATH
+      const fixed s2 = accurate_half_sin(dlon);
+#else
+      const fixed s2 = sc_half.first;
+#endif
+      const fixed a = sqr(s1) + cos_lat1 * cos_lat2 * sqr(s2);
+
+      distances[i] = earth_distance_function(a) * fixed_earth_r;
+    }
+
+    if (bearings != NULL) {
+#ifdef FIXED_MATH
+      const auto sc = sin_cos(dlon);
+      const fixed sin_dlon = sc.first, cos_dlon = sc.second;
+#else
+      const fixed sin_dlon = 2 * sc_half.first * sc_half.second;
+      const fixed cos_dlon = 1 - 2 * sqr(sc_half.first);
+#endif
+
+      const fixed y = sin_dlon * cos_lat2;
+      const fixed x = cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_dlon;
+
+      bearings[i] = (x == fixed_zero && y == fixed_zero)
+        ? Angle::Zero()
+        : Angle::Radians(atan2(y, x)).AsBearing();
+    }
+  }
+
+#ifdef INSTRUMENT_TASK
+  count_distbearing += n;
+#endif
+}
+
 fixed
 CrossTrackError(const GeoPoint loc1, const GeoPoint loc2,
                 const GeoPoint loc3, GeoPoint *loc4)
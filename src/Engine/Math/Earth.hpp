@@ -55,6 +55,21 @@ fixed ProjectedDistance(const GeoPoint loc1, const GeoPoint loc2,
 void DistanceBearing(const GeoPoint loc1, const GeoPoint loc2,
                      fixed *distance, Angle *bearing);
 
+/**
+ * Calculates the distances and/or bearings from one location to an
+ * array of locations.  The results agree with calling
+ * DistanceBearing() for each location (within rounding), but the
+ * trigonometric functions of the origin are evaluated only once.
+ *
+ * @param origin The reference location
+ * @param locations An array of n locations
+ * @param distances An array of n distances (m) to be filled, or NULL
+ * @param bearings An array of n bearings to be filled, or NULL
+ */
+void DistanceBearing(const GeoPoint origin,
+                     const GeoPoint *locations, unsigned n,
+                     fixed *distances, Angle *bearings);
+
 /**
  * Calculates the distance between two locations
  * @param loc1 Location 1
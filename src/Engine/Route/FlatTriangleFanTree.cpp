@@ -193,17 +193,31 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint &o,
     return;
   }
 
-  for (auto x = vs.cbegin(), end = vs.cend(); x != end; ++x) {
-    const FlatGeoPoint av = (o + (*x)) * fixed_half;
-    const GeoPoint p = parms.task_proj.unproject(av);
-    short h = parms.terrain->GetHeight(p);
-
-    if (RasterBuffer::is_water(h))
-      /* water: assume 0m MSL */
-      parms.terrain_counter++;
-    else if (!RasterBuffer::is_invalid(h)) {
-      parms.terrain_counter++;
-      parms.terrain_base += h;
+  /* query the terrain in batches, which lets RasterMap visit the
+     points tile by tile */
+  static const unsigned CHUNK_SIZE = 32;
+  GeoPoint points[CHUNK_SIZE];
+  short heights[CHUNK_SIZE];
+
+  for (auto x = vs.cbegin(), end = vs.cend(); x != end;) {
+    unsigned n = 0;
+    for (; x != end && n < CHUNK_SIZE; ++x, ++n) {
+      const FlatGeoPoint av = (o + (*x)) * fixed_half;
+      points[n] = parms.task_proj.unproject(av);
+    }
+
+    parms.terrain->GetHeights(points, heights, n);
+
+    for (unsigned i = 0; i < n; ++i) {
+      const short h = heights[i];
+
+      if (RasterBuffer::is_water(h))
+        /* water: assume 0m MSL */
+        parms.terrain_counter++;
+      else if (!RasterBuffer::is_invalid(h)) {
+        parms.terrain_counter++;
+        parms.terrain_base += h;
+      }
     }
   }
 
@@ -22,81 +22,213 @@
 
 #include "TaskDijkstra.hpp"
 #include "Task/Tasks/OrderedTask.hpp"
-#include "Util/GlobalSliceAllocator.hpp"
+#include "Math/FastMath.h"
 
-TaskDijkstra::TaskDijkstra(OrderedTask& _task, bool is_min, const bool do_reserve):
-  NavDijkstra<SearchPoint> (is_min, 0, do_reserve? DIJKSTRA_QUEUE_SIZE: 0),
-  task(_task)
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+#ifdef INSTRUMENT_TASK
+extern long count_dijkstra_queries;
+extern long count_dijkstra_links;
+#endif
+
+TaskDijkstra::TaskDijkstra(OrderedTask& _task, bool _is_min,
+                           const bool do_reserve):
+  task(_task), active_stage(0), num_stages(0), is_min(_is_min)
 {
+  if (do_reserve) {
+    static const unsigned RESERVE_POINTS = 256;
+    values.reserve(RESERVE_POINTS);
+    next_values.reserve(RESERVE_POINTS);
+    predecessors.reserve(MAX_STAGES * RESERVE_POINTS);
+    xs.reserve(RESERVE_POINTS);
+    ys.reserve(RESERVE_POINTS);
+    distances.reserve(RESERVE_POINTS);
+  }
 }
 
 bool
 TaskDijkstra::refresh_task()
 {
-  set_stages(task.TaskSize());
+  num_stages = task.TaskSize();
+  assert(num_stages <= MAX_STAGES);
+  std::fill(solution, solution + num_stages, SearchPoint());
+
   if (num_stages < 2)
     return false;
 
   active_stage = task.GetActiveTaskPointIndex();
-  calculate_sizes();
   return true;
 }
 
-void
-TaskDijkstra::calculate_sizes()
+const SearchPointVector &
+TaskDijkstra::GetStagePoints(unsigned stage) const
 {
-  for (unsigned stage = 0; stage != num_stages; ++stage)
-    sp_sizes[stage] = task.get_tp_search_points(stage).size();
+  return task.get_tp_search_points(stage);
 }
 
-unsigned
-TaskDijkstra::get_size(const unsigned stage) const
+/**
+ * Calculate the flat distance from each of the given points to the
+ * point (x,y).  The result is the same as
+ * SearchPoint::flat_distance(), but there are no function calls in
+ * the loop, so the compiler may vectorise it.
+ */
+static void
+FlatDistances(const int *gcc_restrict xs, const int *gcc_restrict ys,
+              unsigned n, int x, int y, unsigned *gcc_restrict dest)
 {
-  return sp_sizes[stage];
+#if defined(__i386__) || defined(__x86_64__)
+  /* lhypot() uses hypot() on x86; for integer coordinates of a task
+     projection, the square root of the (exact) sum of squares
+     truncates to the same value */
+  for (unsigned i = 0; i < n; ++i) {
+    const double dx = xs[i] - x, dy = ys[i] - y;
+    dest[i] = (unsigned)sqrt(dx * dx + dy * dy);
+  }
+#else
+  for (unsigned i = 0; i < n; ++i)
+    dest[i] = lhypot(xs[i] - x, ys[i] - y);
+#endif
 }
 
-const SearchPoint &
-TaskDijkstra::GetPointFast(const ScanTaskPoint &sp) const
+void
+TaskDijkstra::Relax(const SearchPointVector &from,
+                    const SearchPointVector &to, unsigned to_offset)
 {
-  return task.get_tp_search_points(sp.stage_number)[sp.point_index];
+  const unsigned n = values.size();
+  assert(n <= from.size());
+
+  xs.resize(n);
+  ys.resize(n);
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatGeoPoint &p = from[i].get_flatLocation();
+    xs[i] = p.Longitude;
+    ys[i] = p.Latitude;
+  }
+
+  distances.resize(n);
+  next_values.resize(to.size());
+
+  for (unsigned j = 0, m = to.size(); j < m; ++j) {
+    const FlatGeoPoint &p = to[j].get_flatLocation();
+    FlatDistances(&xs[0], &ys[0], n, p.Longitude, p.Latitude,
+                  &distances[0]);
+
+    /* the first of several equal candidates wins */
+    unsigned best_index = 0;
+    unsigned best_value = values[0] + distances[0];
+    if (is_min) {
+      for (unsigned i = 1; i < n; ++i) {
+        const unsigned value = values[i] + distances[i];
+        if (value < best_value) {
+          best_value = value;
+          best_index = i;
+        }
+      }
+    } else {
+      for (unsigned i = 1; i < n; ++i) {
+        const unsigned value = values[i] + distances[i];
+        if (value > best_value) {
+          best_value = value;
+          best_index = i;
+        }
+      }
+    }
+
+    next_values[j] = best_value;
+    predecessors[to_offset + j] = best_index;
+  }
+
+#ifdef INSTRUMENT_TASK
+  count_dijkstra_links += n * to.size();
+#endif
+
+  values.swap(next_values);
 }
 
-const SearchPoint &
-TaskDijkstra::get_point(const ScanTaskPoint &sp) const
+void
+TaskDijkstra::FindSolution(unsigned first_stage, unsigned final_index)
 {
-  return task.get_tp_search_points(sp.stage_number)[sp.point_index];
+  unsigned index = final_index;
+  for (unsigned stage = num_stages - 1;; --stage) {
+    solution[stage] = GetStagePoints(stage)[index];
+    if (stage == first_stage)
+      break;
+
+    index = predecessors[stage_offsets[stage] + index];
+  }
 }
 
-void
-TaskDijkstra::add_edges(const ScanTaskPoint& curNode)
+bool
+TaskDijkstra::run(const SearchPoint *location)
 {
-  ScanTaskPoint destination(curNode.stage_number + 1, 0);
-  const unsigned dsize = get_size(destination.stage_number);
+#ifdef INSTRUMENT_TASK
+  count_dijkstra_queries++;
+#endif
+
+  assert(num_stages >= 2);
+  assert(active_stage < num_stages);
+
+  /* initialise the first stage */
+
+  unsigned first_stage;
+  const SearchPointVector &first = GetStagePoints(location != NULL
+                                                  ? active_stage : 0);
+
+  if (location != NULL && active_stage > 0) {
+    /* begin at the aircraft, which is connected to all points of the
+       active stage */
+    first_stage = active_stage;
+    values.resize(first.size());
+    for (unsigned i = 0, n = first.size(); i < n; ++i)
+      values[i] = first[i].flat_distance(*location);
+  } else {
+    /* begin at the first point of the start */
+    first_stage = 0;
+    values.resize(std::min((unsigned)first.size(), 1u));
+    if (!values.empty())
+      values[0] = 0;
+  }
+
+  if (values.empty())
+    return false;
 
-  for (; destination.point_index != dsize; ++destination.point_index)
-    dijkstra.link(destination, curNode, distance(curNode, destination));
-}
+  /* allocate the predecessor table */
 
-void 
-TaskDijkstra::add_start_edges(const SearchPoint &currentLocation)
-{
-  // need to remove dummy first point
-  dijkstra.pop();
+  unsigned total = 0;
+  for (unsigned stage = first_stage + 1; stage < num_stages; ++stage) {
+    const unsigned size = GetStagePoints(stage).size();
+    if (size == 0) {
+      /* a stage without search points cannot be crossed; the solution
+         stays undefined, but it gets saved nonetheless (like the
+         previous Dijkstra implementation did) */
+      save();
+      return true;
+    }
 
-  ScanTaskPoint destination(active_stage, 0);
-  const unsigned dsize = get_size(destination.stage_number);
+    stage_offsets[stage] = total;
+    total += size;
+  }
 
-  for (; destination.point_index != dsize; ++destination.point_index)
-    dijkstra.link(destination, destination,
-                  distance(destination, currentLocation));
-}
+  if (predecessors.size() < total)
+    predecessors.resize(total);
 
-bool
-TaskDijkstra::run()
-{
-  const bool retval = distance_general();
-  if (retval)
-    save();
-  dijkstra.clear();
-  return retval;
+  /* visit the stages in order */
+
+  for (unsigned stage = first_stage + 1; stage < num_stages; ++stage)
+    Relax(GetStagePoints(stage - 1), GetStagePoints(stage),
+          stage_offsets[stage]);
+
+  /* pick the best point of the final stage */
+
+  unsigned best_index = 0;
+  for (unsigned i = 1, n = values.size(); i < n; ++i)
+    if (is_min ? values[i] < values[best_index]
+        : values[i] > values[best_index])
+      best_index = i;
+
+  FindSolution(first_stage, best_index);
+  save();
+  return true;
 }
@@ -23,8 +23,11 @@
 #ifndef TASK_DIJKSTRA_HPP
 #define TASK_DIJKSTRA_HPP
 
-#include "NavDijkstra.hpp"
-#include "Navigation/SearchPoint.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Navigation/SearchPointVector.hpp"
+#include "Compiler.h"
+
+#include <vector>
 
 class OrderedTask;
 
@@ -43,17 +46,51 @@ class OrderedTask;
  * before the active task point need only be searched for maximum achieved
  * distance rather than border search points. 
  *
- * This uses a Dijkstra search and so is O(N log(N)).
+ * The task forms a layered graph (each search point of a stage is
+ * linked to each search point of the next stage), so this is solved
+ * with dynamic programming, one stage after another.  That is
+ * O(N*M) for N stages of M points, with no heap and no edge table.
  */
-class TaskDijkstra: 
-  public NavDijkstra<SearchPoint>
-{
+class TaskDijkstra : private NonCopyable {
 protected:
+  enum {
+    MAX_STAGES = 16,
+  };
+
   OrderedTask &task;
   unsigned active_stage;
 
+  /** Number of stages in search */
+  unsigned num_stages;
+  SearchPoint solution[MAX_STAGES];
+
 private:
-  unsigned sp_sizes[MAX_STAGES];
+  const bool is_min;
+
+  /**
+   * The best total distance to each search point of the current and
+   * the next stage.
+   */
+  std::vector<unsigned> values, next_values;
+
+  /**
+   * The best predecessor of each search point, indexed by the offset
+   * of the stage in #stage_offsets plus the point index.
+   */
+  std::vector<unsigned short> predecessors;
+  unsigned stage_offsets[MAX_STAGES];
+
+  /**
+   * Flat coordinates of the current stage, as separate arrays for the
+   * distance loop.
+   */
+  std::vector<int> xs, ys;
+
+  /**
+   * Scratch buffer for the distances from all points of the current
+   * stage to one point of the next stage.
+   */
+  std::vector<unsigned> distances;
 
 public:
   /**
@@ -61,58 +98,64 @@ public:
    *
    * @param _task The task to find max/min distances for
    * @param is_min Whether this will be used to minimise or maximise distances
-   * @param do_reserve Whether to reserve dijkstra queue
+   * @param do_reserve Whether to reserve storage for the search
    */
   TaskDijkstra(OrderedTask& _task, const bool is_min,
                const bool do_reserve=false);
 
-protected:
+  /**
+   * Test whether two points (as previous search locations) are significantly
+   * different to warrant a new search
+   *
+   * @param a1 First point to compare
+   * @param a2 Second point to compare
+   * @param dist_threshold Threshold distance for significance
+   *
+   * @return True if distance is significant
+   */
   gcc_pure
-  const SearchPoint &GetPointFast(const ScanTaskPoint &sp) const;
-
-  const SearchPoint &get_point(const ScanTaskPoint &sp) const;
-  bool run();
-  virtual void save() = 0;
+  static bool distance_is_significant(const SearchPoint &a1,
+                                      const SearchPoint &a2,
+                                      const unsigned dist_threshold = 1) {
+    return a1.FlatSquareDistance(a2) > (dist_threshold * dist_threshold);
+  }
 
+protected:
   /**
    * Update internal details required from the task
    */
   bool refresh_task();
 
-  void add_start_edges(const SearchPoint &loc);
-
-  /** 
-   * Distance function for free point
-   * 
-   * @param curNode Destination node
-   * @param currentLocation Origin location
-   * 
-   * @return Distance (flat) from origin to destination
+  /**
+   * Find the best path through the stages, store it in the
+   * #solution array and call save().  If a location is given and
+   * #active_stage is not 0, the path begins at the location and
+   * continues with any point of #active_stage; otherwise it begins at
+   * the first point of stage 0.
+   *
+   * @return true if a solution was saved
    */
-  gcc_pure
-  unsigned distance(const ScanTaskPoint &curNode,
-                    const SearchPoint &currentLocation) const {
-    return GetPointFast(curNode).flat_distance(currentLocation);
-  }
+  bool run(const SearchPoint *location);
+
+  virtual void save() = 0;
 
-  /** 
-   * Distance function for edges
-   * 
-   * @param s1 Origin node
-   * @param s2 Destination node
-   * 
-   * @return Distance (flat) from origin to destination
-   */
   gcc_pure
-  unsigned distance(const ScanTaskPoint &s1, const ScanTaskPoint &s2) const {
-    return GetPointFast(s1).flat_distance(GetPointFast(s2));
-  }
+  const SearchPointVector &GetStagePoints(unsigned stage) const;
 
 private:
-  void calculate_sizes();
-  unsigned get_size(const unsigned stage) const;
 
-  void add_edges(const ScanTaskPoint &curNode);
+  /**
+   * Calculate the best value for each point of the next stage, given
+   * the values of the current stage.
+   */
+  void Relax(const SearchPointVector &from, const SearchPointVector &to,
+             unsigned to_offset);
+
+  /**
+   * Backtrack from the specified point of the final stage, and fill
+   * the #solution array.
+   */
+  void FindSolution(unsigned first_stage, unsigned final_index);
 };
 
 #endif
@@ -34,9 +34,7 @@ TaskDijkstraMax::distance_max()
   if (!refresh_task())
     return false;
 
-  const ScanTaskPoint start(0, 0);
-  dijkstra.restart(start);
-  return run();
+  return run(NULL);
 }
 
 
@@ -354,13 +354,6 @@ public:
     return static_cast<const TraceDelta *>(chronological_list.GetPrevious())->point;
   }
 
-private:
-  TraceDelta &GetFront() {
-    assert(!empty());
-
-    return *static_cast<TraceDelta *>(chronological_list.GetNext());
-  }
-
   /**
    * Returns a #Serial that gets incremented when data gets appended
    * to the #Trace.
@@ -377,6 +370,13 @@ private:
     return modify_serial;
   }
 
+private:
+  TraceDelta &GetFront() {
+    assert(!empty());
+
+    return *static_cast<TraceDelta *>(chronological_list.GetNext());
+  }
+
   gcc_pure
   unsigned get_min_time() const;
 
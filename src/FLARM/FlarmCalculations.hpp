@@ -27,12 +27,17 @@ Copyright_License {
 #include "FLARM/FlarmId.hpp"
 #include "ClimbAverageCalculator.hpp"
 
-#include <map>
+#include <unordered_map>
 
 class FlarmCalculations
 {
 private:
-  typedef std::map<FlarmId, ClimbAverageCalculator> AverageCalculatorMap;
+  /**
+   * A hash map keeps the lookup per #FlarmTraffic update O(1), even
+   * with many targets being tracked.
+   */
+  typedef std::unordered_map<FlarmId, ClimbAverageCalculator,
+                             FlarmId::Hasher> AverageCalculatorMap;
   AverageCalculatorMap averageCalculatorMap;
 
 public:
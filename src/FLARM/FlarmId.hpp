@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_FLARM_ID_HPP
 
 #include <stdint.h>
+#include <stddef.h>
 #include <tchar.h>
 
 /**
@@ -54,6 +55,24 @@ public:
     return value < other.value;
   }
 
+  /**
+   * Returns a well-distributed hash of this id, suitable for hash
+   * table lookups.  FLARM ids are 24 bit values which tend to be
+   * clustered, therefore a multiplicative hash is used.
+   */
+  uint32_t Hash() const {
+    return value * 2654435761u;
+  }
+
+  /**
+   * Function object for std::unordered_map and friends.
+   */
+  struct Hasher {
+    size_t operator()(FlarmId id) const {
+      return id.Hash();
+    }
+  };
+
   void Parse(const char *input, char **endptr_r);
 #ifdef _UNICODE
   void Parse(const TCHAR *input, TCHAR **endptr_r);
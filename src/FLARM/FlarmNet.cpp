@@ -28,20 +28,44 @@ Copyright_License {
 #include "IO/LineReader.hpp"
 #include "IO/FileLineReader.hpp"
 
+#include <vector>
+#include <algorithm>
+
 #include <stdio.h>
 #include <stdlib.h>
 
 namespace FlarmNet
 {
-  typedef std::map<FlarmId, Record*> RecordMap;
-  RecordMap record_map;
+  /**
+   * All records, sorted by id, without duplicates.  A contiguous
+   * array is much more compact than a node based container, and
+   * allows binary search.
+   */
+  static std::vector<Record> records;
+
+  /**
+   * The id of each element in #records, in the same order.  Kept
+   * separately, because it is faster to search than the (large)
+   * #Record objects, and because FindIdsByCallSign() returns
+   * pointers to it.
+   */
+  static std::vector<FlarmId> ids;
+
+  /**
+   * Indices into #records, sorted by call sign (and by id for equal
+   * call signs).  This is the secondary index for call sign and
+   * prefix searches.
+   */
+  static std::vector<unsigned> callsign_index;
 }
 
 void
 FlarmNet::Destroy()
 {
-  for (auto i = record_map.begin(); i != record_map.end(); ++i)
-    delete i->second;
+  /* swap with empty vectors to really free the memory */
+  std::vector<Record>().swap(records);
+  std::vector<FlarmId>().swap(ids);
+  std::vector<unsigned>().swap(callsign_index);
 }
 
 /**
@@ -75,33 +99,151 @@ LoadString(const char *bytes, int charCount, TCHAR *res)
 }
 
 /**
- * Reads next FlarmNet.org file entry and returns the pointer to
- * a new FlarmNetRecord instance or NULL on error.
+ * Decodes the next FlarmNet.org file entry into the specified
+ * object.
  *
- * The caller is responsible for deleting the object again!
+ * @return false on error
  */
-static FlarmNet::Record *
-LoadRecord(const char *line)
+static bool
+LoadRecord(const char *line, FlarmNet::Record &record)
 {
   if (strlen(line) < 172)
-    return NULL;
+    return false;
 
-  FlarmNet::Record *record = new FlarmNet::Record;
-  LoadString(line, 6, record->id);
-  LoadString(line + 12, 21, record->pilot);
-  LoadString(line + 54, 21, record->airfield);
-  LoadString(line + 96, 21, record->plane_type);
-  LoadString(line + 138, 7, record->registration);
-  LoadString(line + 152, 3, record->callsign);
-  LoadString(line + 158, 7, record->frequency);
+  LoadString(line, 6, record.id);
+  LoadString(line + 12, 21, record.pilot);
+  LoadString(line + 54, 21, record.airfield);
+  LoadString(line + 96, 21, record.plane_type);
+  LoadString(line + 138, 7, record.registration);
+  LoadString(line + 152, 3, record.callsign);
+  LoadString(line + 158, 7, record.frequency);
 
   // Terminate callsign string on first whitespace
-  int maxSize = sizeof(record->callsign) / sizeof(TCHAR);
-  for (int i = 0; record->callsign[i] != 0 && i < maxSize; i++)
-    if (IsWhitespaceOrNull(record->callsign[i]))
-      record->callsign[i] = 0;
+  int maxSize = sizeof(record.callsign) / sizeof(TCHAR);
+  for (int i = 0; record.callsign[i] != 0 && i < maxSize; i++)
+    if (IsWhitespaceOrNull(record.callsign[i]))
+      record.callsign[i] = 0;
+
+  return true;
+}
+
+struct CompareLoadedIds {
+  const std::vector<FlarmId> &ids;
+
+  CompareLoadedIds(const std::vector<FlarmId> &_ids):ids(_ids) {}
+
+  bool operator()(unsigned a, unsigned b) const {
+    return ids[a] < ids[b];
+  }
+};
+
+/**
+ * Compares the call signs of #FlarmNet::records referenced by
+ * index.  If a prefix length is given, only that many characters
+ * of the call sign are compared with a search string.
+ */
+struct CompareCallSign {
+  size_t prefix_length;
+
+  CompareCallSign(size_t _prefix_length=0):prefix_length(_prefix_length) {}
+
+  bool operator()(unsigned a, unsigned b) const {
+    return _tcscmp(FlarmNet::records[a].callsign,
+                   FlarmNet::records[b].callsign) < 0;
+  }
+
+  bool operator()(unsigned i, const TCHAR *cn) const {
+    return _tcscmp(FlarmNet::records[i].callsign, cn) < 0;
+  }
+
+  bool operator()(const TCHAR *cn, unsigned i) const {
+    return prefix_length > 0
+      ? _tcsncmp(cn, FlarmNet::records[i].callsign, prefix_length) < 0
+      : _tcscmp(cn, FlarmNet::records[i].callsign) < 0;
+  }
+};
+
+/**
+ * Move the elements of #records so that the new element i is the old
+ * element order[i].  #order must be a permutation; it is destroyed.
+ * Only one record is copied to a temporary at a time.
+ */
+static void
+PermuteRecords(std::vector<unsigned> &order)
+{
+  using namespace FlarmNet;
+
+  for (unsigned i = 0; i < order.size(); ++i) {
+    if (order[i] == i)
+      continue;
+
+    const Record tmp = records[i];
+    unsigned j = i;
+    while (order[j] != i) {
+      const unsigned next = order[j];
+      records[j] = records[next];
+      order[j] = j;
+      j = next;
+    }
+
+    records[j] = tmp;
+    order[j] = j;
+  }
+}
+
+/**
+ * Sort the records loaded by LoadFile() by id in place, remove
+ * duplicates (the last one wins, like in the old std::map
+ * implementation) and build the call sign index.  Apart from the
+ * records, only a few small integer arrays are allocated.
+ */
+static void
+BuildIndex()
+{
+  using namespace FlarmNet;
+
+  ids.reserve(records.size());
+  for (auto i = records.begin(), end = records.end(); i != end; ++i)
+    ids.push_back(i->GetId());
+
+  /* sort positions instead of the big records; stable sort keeps
+     duplicates in file order */
+  std::vector<unsigned> order(records.size());
+  for (unsigned i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(), CompareLoadedIds(ids));
+
+  /* keep only the last of each run of duplicates; the positions of
+     the dropped records are moved to the end, so "order" remains a
+     permutation */
+  std::vector<unsigned> dropped;
+  unsigned n = 0;
+  for (unsigned i = 0; i < order.size(); ++i) {
+    if (i + 1 < order.size() && ids[order[i]] == ids[order[i + 1]])
+      dropped.push_back(order[i]);
+    else
+      order[n++] = order[i];
+  }
+
+  std::copy(dropped.begin(), dropped.end(), order.begin() + n);
+  std::vector<unsigned>().swap(dropped);
+
+  PermuteRecords(order);
+  records.erase(records.begin() + n, records.end());
+
+  ids.resize(n);
+  for (unsigned i = 0; i < n; ++i)
+    ids[i] = records[i].GetId();
+
+  callsign_index.resize(records.size());
+  for (unsigned i = 0; i < callsign_index.size(); ++i)
+    callsign_index[i] = i;
 
-  return record;
+  /* "records" is sorted by id, therefore a stable sort keeps
+     records with the same call sign in id order */
+  std::stable_sort(callsign_index.begin(), callsign_index.end(),
+                   CompareCallSign());
 }
 
 unsigned
@@ -115,16 +257,21 @@ FlarmNet::LoadFile(NLineReader &reader)
   if (line == NULL)
     return 0;
 
-  int itemCount = 0;
-  while ((line = reader.read()) != NULL) {
-    FlarmNet::Record *record = LoadRecord(line);
-    if (record != NULL) {
-      record_map[record->GetId()] = record;
-      itemCount++;
-    }
-  }
+  /* estimate the number of records from the file size to avoid
+     reallocations; each line has about 173 bytes */
+  long size = reader.size();
+  if (size > 0)
+    records.reserve(size / 173 + 1);
+
+  Record record;
+  while ((line = reader.read()) != NULL)
+    if (LoadRecord(line, record))
+      records.push_back(record);
+
+  const unsigned n_loaded = records.size();
+  BuildIndex();
 
-  return itemCount;
+  return n_loaded;
 }
 
 unsigned
@@ -140,26 +287,45 @@ FlarmNet::LoadFile(const TCHAR *path)
 const FlarmNet::Record *
 FlarmNet::FindRecordById(FlarmId id)
 {
-  RecordMap::const_iterator i = record_map.find(id);
-  if (i != record_map.end())
-    return i->second;
+  auto i = std::lower_bound(ids.begin(), ids.end(), id);
+  if (i != ids.end() && *i == id)
+    return &records[i - ids.begin()];
 
   return NULL;
 }
 
+/**
+ * Returns the range of #callsign_index entries whose call sign
+ * begins with the specified string.  If "exact" is true, only exact
+ * matches are returned.
+ */
+static std::pair<std::vector<unsigned>::const_iterator,
+                 std::vector<unsigned>::const_iterator>
+FindCallSignRange(const TCHAR *cn, bool exact)
+{
+  using namespace FlarmNet;
+
+  if (!exact && *cn == _T('\0'))
+    /* the empty prefix matches everything */
+    return std::make_pair(callsign_index.cbegin(), callsign_index.cend());
+
+  auto begin = std::lower_bound(callsign_index.cbegin(), callsign_index.cend(),
+                                cn, CompareCallSign());
+
+  auto end = std::upper_bound(begin, callsign_index.cend(), cn,
+                              CompareCallSign(exact ? 0 : _tcslen(cn)));
+
+  return std::make_pair(begin, end);
+}
+
 const FlarmNet::Record *
 FlarmNet::FindFirstRecordByCallSign(const TCHAR *cn)
 {
-  RecordMap::const_iterator i = record_map.begin();
-  while (i != record_map.end()) {
-    const Record *record = (const Record *)(i->second);
-    if (_tcscmp(record->callsign, cn) == 0)
-      return record;
-
-    i++;
-  }
+  auto range = FindCallSignRange(cn, true);
+  if (range.first == range.second)
+    return NULL;
 
-  return NULL;
+  return &records[*range.first];
 }
 
 unsigned
@@ -167,16 +333,22 @@ FlarmNet::FindRecordsByCallSign(const TCHAR *cn, const Record *array[], unsigned
 {
   unsigned count = 0;
 
-  RecordMap::const_iterator i = record_map.begin();
-  while (i != record_map.end() && count < size) {
-    const Record *record = (const Record *)(i->second);
-    if (_tcscmp(record->callsign, cn) == 0) {
-      array[count] = record;
-      count++;
-    }
+  auto range = FindCallSignRange(cn, true);
+  for (auto i = range.first; i != range.second && count < size; ++i)
+    array[count++] = &records[*i];
 
-    i++;
-  }
+  return count;
+}
+
+unsigned
+FlarmNet::FindRecordsByCallSignPrefix(const TCHAR *prefix,
+                                      const Record *array[], unsigned size)
+{
+  unsigned count = 0;
+
+  auto range = FindCallSignRange(prefix, false);
+  for (auto i = range.first; i != range.second && count < size; ++i)
+    array[count++] = &records[*i];
 
   return count;
 }
@@ -186,16 +358,9 @@ FlarmNet::FindIdsByCallSign(const TCHAR *cn, const FlarmId *array[], unsigned si
 {
   unsigned count = 0;
 
-  RecordMap::const_iterator i = record_map.begin();
-  while (i != record_map.end() && count < size) {
-    const Record *record = (const Record *)(i->second);
-    if (_tcscmp(record->callsign, cn) == 0) {
-      array[count] = (const FlarmId *)(&(i->first));
-      count++;
-    }
-
-    i++;
-  }
+  auto range = FindCallSignRange(cn, true);
+  for (auto i = range.first; i != range.second && count < size; ++i)
+    array[count++] = &ids[*i];
 
   return count;
 }
@@ -24,7 +24,6 @@ Copyright_License {
 #ifndef XCSOAR_FLARM_NET_HPP
 #define XCSOAR_FLARM_NET_HPP
 
-#include <map>
 #include <tchar.h>
 
 class NLineReader;
@@ -81,6 +80,15 @@ namespace FlarmNet
                                  unsigned size);
   unsigned FindIdsByCallSign(const TCHAR *cn, const FlarmId *array[],
                              unsigned size);
+
+  /**
+   * Finds all records whose call sign begins with the specified
+   * prefix, ordered by call sign.
+   *
+   * @return the number of records stored in the array
+   */
+  unsigned FindRecordsByCallSignPrefix(const TCHAR *prefix,
+                                       const Record *array[], unsigned size);
 };
 
 #endif
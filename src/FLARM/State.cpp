@@ -23,11 +23,45 @@ Copyright_License {
 
 #include "FLARM/State.hpp"
 
+#include <algorithm>
+
 void
 FlarmState::Clear()
 {
   available.Clear();
   traffic.clear();
+  std::fill(traffic_index, traffic_index + TRAFFIC_INDEX_SIZE, 0);
+  new_traffic = false;
+}
+
+void
+FlarmState::RebuildIndex()
+{
+  std::fill(traffic_index, traffic_index + TRAFFIC_INDEX_SIZE, 0);
+
+  for (unsigned i = 0, n = traffic.size(); i < n; ++i)
+    AddToIndex(traffic[i].id, i);
+}
+
+void
+FlarmState::Refresh(fixed Time)
+{
+  const unsigned old_size = traffic.size();
+
+  available.Expire(Time, fixed(10));
+  if (!available)
+    traffic.clear();
+
+  for (unsigned i = traffic.size(); i-- > 0;)
+    if (!traffic[i].Refresh(Time))
+      traffic.quick_remove(i);
+
+  if (traffic.size() != old_size)
+    /* positions have changed; deleting single buckets from a
+       linear probing table is awkward, and rebuilding is cheap
+       compared to the per-fix lookups */
+    RebuildIndex();
+
   new_traffic = false;
 }
 
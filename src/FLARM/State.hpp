@@ -28,6 +28,20 @@ Copyright_License {
 #include "NMEA/Validity.hpp"
 #include "Util/TrivialArray.hpp"
 #include "Util/TypeTraits.hpp"
+#include "Compiler.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+/**
+ * The maximum number of FLARM targets which can be tracked at the
+ * same time.  A FLARM device reports far less than the default, but
+ * ground stations may receive hundreds of targets; those builds may
+ * raise it with "make FLARM_TRAFFIC_CAPACITY=n".
+ */
+#ifndef FLARM_TRAFFIC_CAPACITY
+#define FLARM_TRAFFIC_CAPACITY 25
+#endif
 
 /**
  * Received FLARM data, cached
@@ -35,7 +49,13 @@ Copyright_License {
 struct FlarmState
 {
   enum {
-    FLARM_MAX_TRAFFIC = 25,
+    FLARM_MAX_TRAFFIC = FLARM_TRAFFIC_CAPACITY,
+
+    /**
+     * The number of buckets in #traffic_index.  Odd and more than
+     * twice the capacity, to keep probe sequences short.
+     */
+    TRAFFIC_INDEX_SIZE = FLARM_MAX_TRAFFIC * 2 + 1,
   };
 
   enum class GPSStatus: uint8_t {
@@ -66,6 +86,53 @@ struct FlarmState
   /** Flarm traffic information */
   TrivialArray<FlarmTraffic, FLARM_MAX_TRAFFIC> traffic;
 
+  /**
+   * An open-addressing hash table (linear probing) which maps a
+   * #FlarmId to its position in #traffic.  Each bucket contains the
+   * position plus one; zero marks an empty bucket.
+   */
+  uint16_t traffic_index[TRAFFIC_INDEX_SIZE];
+
+private:
+  static unsigned GetIndexBucket(FlarmId id) {
+    return id.Hash() % TRAFFIC_INDEX_SIZE;
+  }
+
+  static unsigned NextIndexBucket(unsigned bucket) {
+    return ++bucket == TRAFFIC_INDEX_SIZE ? 0 : bucket;
+  }
+
+  /**
+   * Looks up the position of the specified id in #traffic.
+   *
+   * @return the position, or -1 if not found
+   */
+  gcc_pure
+  int FindTrafficPosition(FlarmId id) const {
+    for (unsigned bucket = GetIndexBucket(id);; bucket = NextIndexBucket(bucket)) {
+      const unsigned i = traffic_index[bucket];
+      if (i == 0)
+        return -1;
+
+      if (traffic[i - 1].id == id)
+        return i - 1;
+    }
+  }
+
+  void AddToIndex(FlarmId id, unsigned position) {
+    unsigned bucket = GetIndexBucket(id);
+    while (traffic_index[bucket] != 0)
+      bucket = NextIndexBucket(bucket);
+
+    traffic_index[bucket] = position + 1;
+  }
+
+  /**
+   * Rebuilds #traffic_index from scratch.  Call this after items
+   * have been removed from #traffic.
+   */
+  void RebuildIndex();
+
 public:
   void Clear();
 
@@ -93,11 +160,8 @@ public:
    * @return the FLARM_TRAFFIC pointer, NULL if not found
    */
   FlarmTraffic *FindTraffic(FlarmId id) {
-    for (auto it = traffic.begin(), end = traffic.end(); it != end; ++it)
-      if (it->id == id)
-        return it;
-
-    return NULL;
+    const int i = FindTrafficPosition(id);
+    return i >= 0 ? &traffic[i] : NULL;
   }
 
   /**
@@ -107,11 +171,8 @@ public:
    * @return the FLARM_TRAFFIC pointer, NULL if not found
    */
   const FlarmTraffic *FindTraffic(FlarmId id) const {
-    for (auto it = traffic.begin(), end = traffic.end(); it != end; ++it)
-      if (it->id == id)
-        return it;
-
-    return NULL;
+    const int i = FindTrafficPosition(id);
+    return i >= 0 ? &traffic[i] : NULL;
   }
 
   /**
@@ -143,14 +204,24 @@ public:
   }
 
   /**
-   * Allocates a new FLARM_TRAFFIC object from the array.
+   * Allocates a new FLARM_TRAFFIC object from the array, and
+   * registers it with the specified id.  The caller must not modify
+   * the id of the returned object.
    *
    * @return the FLARM_TRAFFIC pointer, NULL if the array is full
    */
-  FlarmTraffic *AllocateTraffic() {
-    return traffic.full()
-      ? NULL
-      : &traffic.append();
+  FlarmTraffic *AllocateTraffic(FlarmId id) {
+    assert(FindTraffic(id) == NULL);
+
+    if (traffic.full())
+      return NULL;
+
+    AddToIndex(id, traffic.size());
+
+    FlarmTraffic &t = traffic.append();
+    t.Clear();
+    t.id = id;
+    return &t;
   }
 
   /**
@@ -195,17 +266,7 @@ public:
     return t - traffic.begin();
   }
 
-  void Refresh(fixed Time) {
-    available.Expire(Time, fixed(10));
-    if (!available)
-      traffic.clear();
-
-    for (unsigned i = traffic.size(); i-- > 0;)
-      if (!traffic[i].Refresh(Time))
-        traffic.quick_remove(i);
-
-    new_traffic = false;
-  }
+  void Refresh(fixed Time);
 };
 
 static_assert(is_trivial<FlarmState>::value, "type is not trivial");
@@ -40,16 +40,114 @@ Copyright_License {
 #endif
 
 #include "MOFile.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <algorithm>
 
 const MOFile *mo_file;
 
+/**
+ * Protects the caches below against concurrent insertions.  Lookups
+ * don't lock: a cache entry is completely written before it is
+ * published, and it is never modified afterwards.
+ */
+static Mutex gettext_mutex;
+
+struct LiteralEntry {
+  const TCHAR *original, *translation;
+};
+
+static const unsigned LITERAL_SLOTS = 4096;
+static const unsigned LITERAL_MAX_PROBE = 16;
+
+/**
+ * The translations cached for one #mo_file.  Because lookups don't
+ * lock, reset_gettext_cache() does not clear or free a cache which
+ * may be in use; it replaces it with a new one, and keeps the old one
+ * until the process exits.
+ */
+struct GettextCache {
+  /**
+   * The cache which was replaced by this one.
+   */
+  GettextCache *const previous;
+
 #ifdef _UNICODE
-#include "Util/tstring.hpp"
-#include <map>
-typedef std::map<tstring,tstring> translation_map;
-static translation_map translations;
+  /**
+   * The translations converted to TCHAR, indexed by the string index
+   * in the #mo_file.  Converted on demand.
+   */
+  TCHAR *volatile *volatile converted;
+  unsigned num_converted;
 #endif
 
+  /**
+   * Translations of string literals, looked up by the address of the
+   * literal; see gettext_literal().
+   */
+  const LiteralEntry *volatile literal_slots[LITERAL_SLOTS];
+  LiteralEntry literal_entries[LITERAL_SLOTS / 2];
+  unsigned num_literal_entries;
+
+  GettextCache(GettextCache *_previous)
+    :previous(_previous),
+#ifdef _UNICODE
+     converted(NULL), num_converted(0),
+#endif
+     num_literal_entries(0) {
+    std::fill(literal_slots, literal_slots + LITERAL_SLOTS,
+              (const LiteralEntry *)NULL);
+  }
+
+  ~GettextCache() {
+#ifdef _UNICODE
+    if (converted != NULL) {
+      for (unsigned i = 0; i < num_converted; ++i)
+        delete[] converted[i];
+      delete[] converted;
+    }
+#endif
+
+    delete previous;
+  }
+};
+
+static GettextCache *volatile gettext_cache;
+
+/**
+ * Frees all caches when the process exits; no other thread is
+ * running at that point.
+ */
+static struct GettextCacheDeleter {
+  ~GettextCacheDeleter() {
+    delete gettext_cache;
+  }
+} gettext_cache_deleter;
+
+/**
+ * Returns the current cache, and creates it on the first call.
+ */
+static GettextCache &
+GetCache()
+{
+  GettextCache *cache = gettext_cache;
+  if (cache != NULL)
+    return *cache;
+
+  ScopeLock protect(gettext_mutex);
+
+  cache = gettext_cache;
+  if (cache == NULL) {
+    cache = new GettextCache(NULL);
+
+    /* make sure the cache is complete before it is published */
+    __sync_synchronize();
+    gettext_cache = cache;
+  }
+
+  return *cache;
+}
+
 #ifndef NDEBUG
 
 static bool language_allowed = false;
@@ -70,17 +168,69 @@ DisallowLanguage()
 
 #endif
 
+#ifdef _UNICODE
+
+/**
+ * Returns the translation with the specified index, converted to
+ * TCHAR.
+ *
+ * @return the converted string, or NULL on error
+ */
+static const TCHAR *
+GetConvertedTranslation(unsigned i)
+{
+  GettextCache &cache = GetCache();
+
+  TCHAR *volatile *table = cache.converted;
+  if (table != NULL && table[i] != NULL)
+    return table[i];
+
+  const char *translation = mo_file->get_translation(i);
+  TCHAR *result = new TCHAR[strlen(translation) + 1];
+  if (::MultiByteToWideChar(CP_UTF8, 0, translation, -1, result,
+                            strlen(translation) + 1) <= 0) {
+    delete[] result;
+    return NULL;
+  }
+
+  ScopeLock protect(gettext_mutex);
+
+  if (cache.converted == NULL) {
+    const unsigned n = mo_file->get_count();
+    table = new TCHAR *volatile[n];
+    std::fill(table, table + n, (TCHAR *)NULL);
+    cache.num_converted = n;
+    __sync_synchronize();
+    cache.converted = table;
+  } else
+    table = cache.converted;
+
+  if (i >= cache.num_converted) {
+    /* the cache was replaced, and it belongs to a different MO
+       file */
+    delete[] result;
+    return NULL;
+  }
+
+  if (table[i] != NULL) {
+    /* another thread was faster */
+    delete[] result;
+    return table[i];
+  }
+
+  __sync_synchronize();
+  table[i] = result;
+  return result;
+}
+
+#endif
+
 /**
  * Looks up a string of text from the current language file
  *
- * Currently very simple. Looks up the current string and current language
- * to find the appropriate string response. On failure will return
- * the string itself.
+ * The string is found with the hash table of the MO file.  On Unicode
+ * systems, the translation is converted to TCHAR once and cached.
  *
- * NOTES CACHING:
- * - Could load the whole file or part
- * - qsort/bsearch good idea
- * - cache misses in data structure for future use
  * @param text The text to search for
  * @return The translation if found, otherwise the text itself
  */
@@ -95,13 +245,6 @@ gettext(const TCHAR* text)
     return text;
 
 #ifdef _UNICODE
-  // Try to lookup the english string in the map of cached TCHAR translations
-  const tstring text2(text);
-  translation_map::const_iterator it = translations.find(text2);
-  if (it != translations.end())
-    // Return the looked up translation
-    return it->second.c_str();
-
   // Convert the english TCHAR string to char
   size_t wide_length = _tcslen(text);
   char original[wide_length * 4 + 1];
@@ -112,23 +255,17 @@ gettext(const TCHAR* text)
     return text;
 
   // Lookup the converted english char string in the MO file
-  const char *translation = mo_file->lookup(original);
-  // If the lookup failed -> use the english original string
-  if (translation == NULL || *translation == 0 ||
-      strcmp(original, translation) == 0)
+  const int i = mo_file->find(original);
+  if (i < 0)
     return text;
 
-  // Convert the translated char string to TCHAR
-  TCHAR translation2[strlen(translation) + 1];
-  if (::MultiByteToWideChar(CP_UTF8, 0, translation, -1, translation2,
-                            ARRAY_SIZE(translation2)) <= 0)
+  // If the translation is empty or the same -> use the english original string
+  const char *translation = mo_file->get_translation(i);
+  if (*translation == 0 || strcmp(original, translation) == 0)
     return text;
 
-  // Add the translated TCHAR string to the cache map for the next time
-  translations[text2] = translation2;
-
-  // Return the translated TCHAR string
-  return translations[text2].c_str();
+  const TCHAR *translation2 = GetConvertedTranslation(i);
+  return translation2 != NULL ? translation2 : text;
 #else
   // Search for the english original string in the MO file
   const char *translation = mo_file->lookup(text);
@@ -139,12 +276,88 @@ gettext(const TCHAR* text)
 #endif
 }
 
+gcc_const
+static unsigned
+LiteralHash(const TCHAR *text)
+{
+  const size_t address = (size_t)text;
+  return (address ^ (address >> 11)) % LITERAL_SLOTS;
+}
+
+static void
+InsertLiteral(GettextCache &cache,
+              const TCHAR *text, const TCHAR *translation)
+{
+  ScopeLock protect(gettext_mutex);
+
+  if (cache.num_literal_entries >= ARRAY_SIZE(cache.literal_entries))
+    /* full; this happens only if there are far more literals than
+       expected */
+    return;
+
+  const unsigned start = LiteralHash(text);
+  for (unsigned i = 0; i < LITERAL_MAX_PROBE; ++i) {
+    const unsigned slot = (start + i) % LITERAL_SLOTS;
+    const LiteralEntry *entry = cache.literal_slots[slot];
+    if (entry == NULL) {
+      LiteralEntry &new_entry =
+        cache.literal_entries[cache.num_literal_entries++];
+      new_entry.original = text;
+      new_entry.translation = translation;
+
+      /* make sure the entry is complete before it is published */
+      __sync_synchronize();
+      cache.literal_slots[slot] = &new_entry;
+      return;
+    }
+
+    if (entry->original == text)
+      /* another thread was faster */
+      return;
+  }
+}
+
+const TCHAR *
+gettext_literal(const TCHAR *text)
+{
+  assert(language_allowed);
+  assert(text != NULL);
+
+  if (mo_file == NULL)
+    return text;
+
+  GettextCache &cache = GetCache();
+
+  const unsigned start = LiteralHash(text);
+  for (unsigned i = 0; i < LITERAL_MAX_PROBE; ++i) {
+    const LiteralEntry *entry =
+      cache.literal_slots[(start + i) % LITERAL_SLOTS];
+    if (entry == NULL)
+      break;
+
+    if (entry->original == text)
+      return entry->translation;
+  }
+
+  const TCHAR *translation = gettext(text);
+  InsertLiteral(cache, text, translation);
+  return translation;
+}
+
 void
 reset_gettext_cache()
 {
-#ifdef _UNICODE
-  translations.clear();
-#endif
+  ScopeLock protect(gettext_mutex);
+
+  GettextCache *old_cache = gettext_cache;
+  if (old_cache == NULL)
+    /* nothing was cached yet */
+    return;
+
+  /* other threads may still be reading the old cache; keep it */
+  GettextCache *new_cache = new GettextCache(old_cache);
+  __sync_synchronize();
+  gettext_cache = new_cache;
 }
 
 #endif /* !HAVE_POSIX */
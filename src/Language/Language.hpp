@@ -59,16 +59,30 @@ void DisallowLanguage();
 gcc_const
 const TCHAR* gettext(const TCHAR* text);
 
+/**
+ * Like gettext(), but only for strings which are never modified or
+ * freed, such as string literals: the translation is cached by the
+ * address of the string, so repeated lookups cost a pointer
+ * comparison.
+ */
+gcc_const
+const TCHAR *gettext_literal(const TCHAR *text);
+
 /**
  * For source compatibility with GNU gettext.
  */
-#define _(x) gettext(_T(x))
+#define _(x) gettext_literal(_T(x))
 #define N_(x) _T(x)
 
 #if !defined(_WIN32_WCE) && !defined(NDEBUG) && defined(_MSC_VER)
 #pragma warning( disable : 4786 )
 #endif
 
+/**
+ * Forget all cached translations; call this after #mo_file has been
+ * replaced.  Lookups in other threads may continue to use the old
+ * cache; it is freed only when the process exits.
+ */
 void reset_gettext_cache();
 
 #endif // !HAVE_POSIX
@@ -23,11 +23,59 @@ Copyright_License {
 
 #include "MOFile.hpp"
 
+#include <algorithm>
 #include <assert.h>
 #include <string.h>
 
+/**
+ * The string hash function of GNU gettext (hash-string.h).
+ */
+gcc_pure
+static uint32_t
+hash_string(const char *p)
+{
+  uint32_t hval = 0;
+  while (*p != 0) {
+    hval = (hval << 4) + (unsigned char)*p++;
+    const uint32_t g = hval & (0xfU << 28);
+    if (g != 0) {
+      hval ^= g >> 24;
+      hval ^= g;
+    }
+  }
+
+  return hval;
+}
+
+gcc_const
+static bool
+is_prime(unsigned n)
+{
+  for (unsigned i = 3; i * i <= n; i += 2)
+    if (n % i == 0)
+      return false;
+
+  return true;
+}
+
+/**
+ * Returns the smallest odd prime which is not smaller than the
+ * parameter, just like msgfmt does for the hash table size.
+ */
+gcc_const
+static unsigned
+next_prime(unsigned n)
+{
+  n |= 1;
+  while (!is_prime(n))
+    n += 2;
+
+  return n;
+}
+
 MOFile::MOFile(const void *_data, size_t _size)
-  :data((const uint8_t *)_data), size(_size), count(0) {
+  :data((const uint8_t *)_data), size(_size), count(0),
+   hash_table(NULL), hash_table_size(0), hash_table_in_file(false) {
   const struct mo_header *header = (const struct mo_header *)_data;
   if (size < sizeof(*header))
     return;
@@ -44,37 +92,123 @@ MOFile::MOFile(const void *_data, size_t _size)
   if (n >= 0x100000)
     return;
 
-  strings.ResizeDiscard(n);
+  const uint32_t original_table_offset =
+    import_uint32(header->original_table_offset);
+  const uint32_t translation_table_offset =
+    import_uint32(header->translation_table_offset);
+  if (original_table_offset > size ||
+      (size - original_table_offset) / sizeof(mo_table_entry) < n ||
+      translation_table_offset > size ||
+      (size - translation_table_offset) / sizeof(mo_table_entry) < n)
+    return;
 
-  const struct mo_table_entry *entry = (const struct mo_table_entry *)
-    (const void *)(data + import_uint32(header->original_table_offset));
-  for (unsigned i = 0; i < n; ++i) {
-    strings[i].original = get_string(entry++);
-    if (strings[i].original == NULL)
-      return;
-  }
+  originals = (const struct mo_table_entry *)(const void *)
+    (data + original_table_offset);
+  translations = (const struct mo_table_entry *)(const void *)
+    (data + translation_table_offset);
 
-  entry = (const struct mo_table_entry *)(const void *)
-    (data + import_uint32(header->translation_table_offset));
-  for (unsigned i = 0; i < n; ++i) {
-    strings[i].translation = get_string(entry++);
-    if (strings[i].translation == NULL)
+  /* verify all strings once, so lookups don't need to */
+  for (unsigned i = 0; i < n; ++i)
+    if (get_string(originals + i) == NULL ||
+        get_string(translations + i) == NULL)
       return;
-  }
 
   count = n;
+
+  const uint32_t file_hash_table_size =
+    import_uint32(header->hash_table_size);
+  const uint32_t file_hash_table_offset =
+    import_uint32(header->hash_table_offset);
+  if (check_hash_table(file_hash_table_size, file_hash_table_offset)) {
+    hash_table = (const uint32_t *)(const void *)
+      (data + file_hash_table_offset);
+    hash_table_size = file_hash_table_size;
+    hash_table_in_file = true;
+  } else if (!build_hash_table())
+    count = 0;
 }
 
-const char *
-MOFile::lookup(const char *p) const
+bool
+MOFile::check_hash_table(uint32_t table_size, uint32_t offset) const
+{
+  /* the double hashing step needs at least three slots, and there
+     must be at least one empty slot to terminate each search */
+  if (table_size <= 2 || table_size <= count || offset > size ||
+      (size - offset) / sizeof(uint32_t) < table_size ||
+      offset % sizeof(uint32_t) != 0)
+    return false;
+
+  const uint32_t *table = (const uint32_t *)(const void *)(data + offset);
+  for (unsigned i = 0; i < table_size; ++i)
+    if (import_uint32(table[i]) > count)
+      return false;
+
+  return true;
+}
+
+bool
+MOFile::build_hash_table()
+{
+  const unsigned table_size = next_prime(std::max(count * 4 / 3, 3u));
+
+  allocated_hash_table.ResizeDiscard(table_size);
+  std::fill(allocated_hash_table.begin(), allocated_hash_table.end(), 0u);
+
+  for (unsigned i = 0; i < count; ++i) {
+    const uint32_t hval = hash_string(get_original(i));
+    unsigned idx = hval % table_size;
+    const unsigned incr = 1 + hval % (table_size - 2);
+
+    while (allocated_hash_table[idx] != 0) {
+      if (strcmp(get_original(allocated_hash_table[idx] - 1),
+                 get_original(i)) == 0)
+        /* duplicate; the first one wins, just like with a linear
+           search */
+        break;
+
+      idx = idx >= table_size - incr
+        ? idx - (table_size - incr)
+        : idx + incr;
+    }
+
+    if (allocated_hash_table[idx] == 0)
+      allocated_hash_table[idx] = i + 1;
+  }
+
+  hash_table = allocated_hash_table.begin();
+  hash_table_size = table_size;
+  hash_table_in_file = false;
+  return true;
+}
+
+int
+MOFile::find(const char *p) const
 {
   assert(p != NULL);
 
-  for (unsigned i = 0; i < count; ++i)
-    if (strcmp(strings[i].original, p) == 0)
-      return strings[i].translation;
+  if (count == 0)
+    return -1;
+
+  const uint32_t hval = hash_string(p);
+  unsigned idx = hval % hash_table_size;
+  const unsigned incr = 1 + hval % (hash_table_size - 2);
+
+  /* the table has at least one empty slot, but don't trust a
+     corrupt file to have one on every probe sequence */
+  for (unsigned n = 0; n < hash_table_size; ++n) {
+    const uint32_t slot = get_hash_slot(idx);
+    if (slot == 0)
+      return -1;
+
+    if (strcmp(get_original(slot - 1), p) == 0)
+      return slot - 1;
+
+    idx = idx >= hash_table_size - incr
+      ? idx - (hash_table_size - incr)
+      : idx + incr;
+  }
 
-  return NULL;
+  return -1;
 }
 
 const char *
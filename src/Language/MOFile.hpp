@@ -25,11 +25,17 @@ Copyright_License {
 #define XCSOAR_MO_FILE_HPP
 
 #include "Util/AllocatedArray.hpp"
+#include "Compiler.h"
 
 #include <stdint.h>
 
 /**
  * Loader for GNU gettext *.mo files.
+ *
+ * Strings are looked up with the hash table embedded in the file.
+ * If the file has none, an equivalent one is built in memory while
+ * loading.  Apart from that, nothing is copied: all strings point
+ * into the file's data.
  */
 class MOFile {
   struct mo_header {
@@ -45,17 +51,30 @@ class MOFile {
     uint32_t offset;
   };
 
-  struct string_pair {
-    const char *original, *translation;
-  };
-
   const uint8_t *data;
   size_t size;
 
   bool native_byte_order;
 
   unsigned count;
-  AllocatedArray<string_pair> strings;
+
+  const struct mo_table_entry *originals, *translations;
+
+  /**
+   * The hash table: each element is a string index plus one, or zero
+   * for an empty slot.  Points either into the file or into
+   * #allocated_hash_table.
+   */
+  const uint32_t *hash_table;
+  unsigned hash_table_size;
+
+  /**
+   * Is #hash_table in the file's byte order (as opposed to the host's
+   * byte order)?
+   */
+  bool hash_table_in_file;
+
+  AllocatedArray<uint32_t> allocated_hash_table;
 
 public:
   MOFile(const void *data, size_t size);
@@ -64,7 +83,33 @@ public:
     return count == 0;
   }
 
-  const char *lookup(const char *p) const;
+  unsigned get_count() const {
+    return count;
+  }
+
+  /**
+   * Look up a string.
+   *
+   * @return the index of the string, or -1 if it was not found
+   */
+  gcc_pure
+  int find(const char *original) const;
+
+  gcc_pure
+  const char *get_original(unsigned i) const {
+    return get_string_unchecked(originals + i);
+  }
+
+  gcc_pure
+  const char *get_translation(unsigned i) const {
+    return get_string_unchecked(translations + i);
+  }
+
+  gcc_pure
+  const char *lookup(const char *p) const {
+    const int i = find(p);
+    return i >= 0 ? get_translation(i) : NULL;
+  }
 
 private:
   uint32_t import_uint32(uint32_t x) const {
@@ -74,7 +119,23 @@ private:
          ((x << 8) & 0xff0000) | (x << 24));
   }
 
+  uint32_t get_hash_slot(unsigned i) const {
+    return hash_table_in_file
+      ? import_uint32(hash_table[i])
+      : hash_table[i];
+  }
+
   const char *get_string(const struct mo_table_entry *entry) const;
+
+  /**
+   * Returns a string which has been verified by the constructor.
+   */
+  const char *get_string_unchecked(const struct mo_table_entry *entry) const {
+    return (const char *)(data + import_uint32(entry->offset));
+  }
+
+  bool check_hash_table(uint32_t size, uint32_t offset) const;
+  bool build_hash_table();
 };
 
 #endif
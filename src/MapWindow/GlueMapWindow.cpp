@@ -26,6 +26,8 @@ Copyright_License {
 #include "DrawThread.hpp"
 #include "DeviceBlackboard.hpp"
 #include "Look/Look.hpp"
+#include "Tracing/Tracing.hpp"
+#include "OS/Clock.hpp"
 
 GlueMapWindow::GlueMapWindow(const Look &look)
   :MapWindow(look.map, look.traffic),
@@ -38,6 +40,7 @@ GlueMapWindow::GlueMapWindow(const Look &look)
    final_glide_bar_renderer(look.final_glide_bar, look.map.task),
    map_item_timer(*this)
 {
+  traced_fix.Clear();
 }
 
 void
@@ -92,6 +95,27 @@ GlueMapWindow::ExchangeBlackboard()
 #endif
 }
 
+void
+GlueMapWindow::TraceFixLatency()
+{
+  if (!Tracing::IsEnabled())
+    return;
+
+  const MoreData &basic = Basic();
+  if (!basic.gps.real || !basic.location_available.IsValid() ||
+      basic.location_available == traced_fix)
+    return;
+
+  traced_fix = basic.location_available;
+
+  /* the time stamp was taken from the same clock when the device
+     thread received the fix; its resolution is 1/64 s */
+  const Validity now(fixed(MonotonicClockMS()) / 1000);
+  TRACE_COUNTER("MapWindow.fix_latency_ms",
+                (int64_t)(now.GetTimeDifference(basic.location_available)
+                          * 1000));
+}
+
 void
 GlueMapWindow::SuspendThreads()
 {
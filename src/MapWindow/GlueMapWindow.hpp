@@ -32,6 +32,7 @@ Copyright_License {
 #include "Screen/Timer.hpp"
 #include "Screen/Features.hpp"
 #include "DisplayMode.hpp"
+#include "NMEA/Validity.hpp"
 
 struct Look;
 class Logger;
@@ -133,6 +134,12 @@ class GlueMapWindow : public MapWindow {
 
   WindowTimer map_item_timer;
 
+  /**
+   * The fix whose latency was recorded last by TraceFixLatency().
+   * Only accessed by the thread which draws the map.
+   */
+  Validity traced_fix;
+
 public:
   GlueMapWindow(const Look &look);
 
@@ -149,6 +156,13 @@ public:
    */
   void ExchangeBlackboard();
 
+  /**
+   * Record the age of the GPS fix which was just drawn, i.e. the
+   * fix-to-screen latency, as a trace counter.  Repaints which show
+   * the same fix again are not recorded.
+   */
+  void TraceFixLatency();
+
   /**
    * Suspend threads that are owned by this object.
    */
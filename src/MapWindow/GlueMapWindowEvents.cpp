@@ -37,6 +37,7 @@ Copyright_License {
 #include "Compiler.h"
 #include "Interface.hpp"
 #include "Screen/Fonts.hpp"
+#include "Telemetry/Telemetry.hpp"
 
 #include <algorithm>
 
@@ -294,6 +295,9 @@ void
 GlueMapWindow::on_paint(Canvas &canvas)
 {
 #ifdef ENABLE_OPENGL
+  /* there is no DrawThread with OpenGL; painting happens here */
+  ScopeTelemetryCycle telemetry_cycle(Telemetry::DRAW_THREAD);
+
   ExchangeBlackboard();
 
   /* update terrain, topography, ... */
@@ -305,6 +309,10 @@ GlueMapWindow::on_paint(Canvas &canvas)
   // Draw center screen cross hair in pan mode
   if (IsPanning())
     DrawCrossHairs(canvas);
+
+#ifdef ENABLE_OPENGL
+  TraceFixLatency();
+#endif
 }
 
 void
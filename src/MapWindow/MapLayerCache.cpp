@@ -0,0 +1,158 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "MapLayerCache.hpp"
+#include "Tracing/Tracing.hpp"
+
+#ifndef ENABLE_OPENGL
+#include <algorithm>
+#endif
+
+void
+MapLayerCache::Set(const Canvas &canvas)
+{
+  buffer.set(canvas);
+  valid = false;
+}
+
+void
+MapLayerCache::Reset()
+{
+  buffer.reset();
+  valid = false;
+}
+
+void
+MapLayerCache::Publish() const
+{
+  TRACE_COUNTER("MapLayerCache.hits", statistics.hits);
+  TRACE_COUNTER("MapLayerCache.shifted", statistics.shifted);
+  TRACE_COUNTER("MapLayerCache.misses", statistics.misses);
+}
+
+bool
+MapLayerCache::Draw(Canvas &canvas, const WindowProjection &_projection,
+                    const Key &_key)
+{
+  if (!valid || !buffer.defined() || !(key == _key)) {
+    ++statistics.misses;
+    Publish();
+    return false;
+  }
+
+#ifdef ENABLE_OPENGL
+  if (!compare_projection.Compare(_projection)) {
+    ++statistics.misses;
+    Publish();
+    return false;
+  }
+
+  buffer.CopyTo(canvas);
+  ++statistics.hits;
+#else
+  const unsigned width = _projection.GetScreenWidth();
+  const unsigned height = _projection.GetScreenHeight();
+
+  if (projection.GetScale() != _projection.GetScale() ||
+      projection.GetScreenAngle() != _projection.GetScreenAngle() ||
+      projection.GetScreenWidth() != width + 2 * margin ||
+      projection.GetScreenHeight() != height + 2 * margin) {
+    ++statistics.misses;
+    Publish();
+    return false;
+  }
+
+  /* find the part of the buffer which corresponds with the new
+     projection; at the same scale and rotation, a small pan is
+     nearly a translation */
+  const RasterPoint center =
+    projection.GeoToScreen(_projection.GetGeoLocation());
+  const RasterPoint &origin = _projection.GetScreenOrigin();
+  const int x = center.x - origin.x, y = center.y - origin.y;
+  if (x < 0 || y < 0 || x > 2 * (int)margin || y > 2 * (int)margin) {
+    ++statistics.misses;
+    Publish();
+    return false;
+  }
+
+  canvas.copy(0, 0, width, height, buffer, x, y);
+
+  if (x == (int)margin && y == (int)margin)
+    ++statistics.hits;
+  else
+    ++statistics.shifted;
+#endif
+
+  Publish();
+  return true;
+}
+
+Canvas &
+MapLayerCache::BeginRender(Canvas &canvas, const WindowProjection &_projection,
+                           const Key &_key)
+{
+  key = _key;
+  valid = false;
+
+#ifdef ENABLE_OPENGL
+  if (!buffer.defined())
+    buffer.set(canvas);
+
+  projection = _projection;
+  compare_projection = CompareProjection(_projection);
+
+  buffer.Begin(canvas);
+  return canvas;
+#else
+  const unsigned width = _projection.GetScreenWidth();
+  const unsigned height = _projection.GetScreenHeight();
+  margin = std::max(width, height) / 8;
+
+  projection = _projection;
+  projection.SetScreenSize(width + 2 * margin, height + 2 * margin);
+  RasterPoint origin = _projection.GetScreenOrigin();
+  origin.x += margin;
+  origin.y += margin;
+  projection.SetScreenOrigin(origin);
+  projection.UpdateScreenBounds();
+
+  buffer.grow(width + 2 * margin, height + 2 * margin);
+  return buffer;
+#endif
+}
+
+void
+MapLayerCache::CommitRender(Canvas &canvas,
+                            const WindowProjection &_projection)
+{
+#ifdef ENABLE_OPENGL
+  buffer.Commit(canvas);
+#else
+  canvas.copy(0, 0, _projection.GetScreenWidth(),
+              _projection.GetScreenHeight(),
+              buffer, margin, margin);
+#endif
+
+  valid = true;
+}
@@ -0,0 +1,162 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#ifndef XCSOAR_MAP_LAYER_CACHE_HPP
+#define XCSOAR_MAP_LAYER_CACHE_HPP
+
+#include "Screen/BufferCanvas.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Projection/CompareProjection.hpp"
+#include "Terrain/TerrainSettings.hpp"
+#include "Util/Serial.hpp"
+#include "Math/Angle.hpp"
+
+/**
+ * Caches the static bottom layers of the map (terrain and
+ * topography) in an off-screen buffer, so they need not be redrawn on
+ * every GPS fix.  The buffer is tagged with the projection and the
+ * data serials it was rendered from.
+ *
+ * With GDI and SDL, the buffer is larger than the screen by a margin
+ * on each side, and it is rendered with a matching projection.  A
+ * small pan at the same scale and rotation is handled by copying a
+ * shifted part of it.  With OpenGL, the buffer is a texture of screen
+ * size which is reused only while the projection is unchanged.
+ */
+class MapLayerCache {
+public:
+  /**
+   * Describes the data the layer was rendered from.
+   */
+  struct Key {
+    const void *terrain;
+    Serial terrain_serial;
+    TerrainRendererSettings terrain_settings;
+    Angle sun_azimuth;
+
+    const void *topography;
+    Serial topography_serial;
+    bool topography_enabled;
+
+    bool operator==(const Key &other) const {
+      return terrain == other.terrain &&
+        terrain_serial == other.terrain_serial &&
+        terrain_settings == other.terrain_settings &&
+        sun_azimuth == other.sun_azimuth &&
+        topography == other.topography &&
+        topography_serial == other.topography_serial &&
+        topography_enabled == other.topography_enabled;
+    }
+  };
+
+  struct Statistics {
+    /** frames which reused the layer without moving it */
+    unsigned hits;
+
+    /** frames which reused a shifted part of the layer */
+    unsigned shifted;
+
+    /** frames which had to render the layer */
+    unsigned misses;
+
+    void Clear() {
+      hits = shifted = misses = 0;
+    }
+  };
+
+private:
+  BufferCanvas buffer;
+
+  /**
+   * The projection the buffer was rendered with.  With GDI and SDL,
+   * it includes the margin.
+   */
+  WindowProjection projection;
+
+#ifdef ENABLE_OPENGL
+  CompareProjection compare_projection;
+#else
+  /**
+   * The width of the margin around the visible area [pixels].
+   */
+  unsigned margin;
+#endif
+
+  Key key;
+
+  bool valid;
+
+  Statistics statistics;
+
+public:
+  MapLayerCache():valid(false) {
+    statistics.Clear();
+  }
+
+  void Set(const Canvas &canvas);
+  void Reset();
+
+  /**
+   * Discard the cached layer, e.g. after the data source has been
+   * replaced.
+   */
+  void Invalidate() {
+    valid = false;
+  }
+
+  const Statistics &GetStatistics() const {
+    return statistics;
+  }
+
+  /**
+   * Attempt to paint the cached layer for the given projection.
+   *
+   * @return true on success, false if the caller must render the
+   * layer with BeginRender() and CommitRender()
+   */
+  bool Draw(Canvas &canvas, const WindowProjection &projection,
+            const Key &key);
+
+  /**
+   * Prepare rendering a new layer.  The caller shall render into the
+   * returned #Canvas, using GetRenderProjection(), and then call
+   * CommitRender().
+   */
+  Canvas &BeginRender(Canvas &canvas, const WindowProjection &projection,
+                      const Key &key);
+
+  const WindowProjection &GetRenderProjection() const {
+    return projection;
+  }
+
+  /**
+   * Finish rendering, and paint the new layer to the given #Canvas.
+   */
+  void CommitRender(Canvas &canvas, const WindowProjection &projection);
+
+private:
+  void Publish() const;
+};
+
+#endif
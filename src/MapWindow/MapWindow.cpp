@@ -199,6 +199,7 @@ void
 MapWindow::SetTopography(TopographyStore *_topography)
 {
   topography = _topography;
+  layer_cache.Invalidate();
 
   delete topography_renderer;
   topography_renderer = topography != NULL
@@ -210,6 +211,7 @@ void
 MapWindow::SetTerrain(RasterTerrain *_terrain)
 {
   terrain = _terrain;
+  layer_cache.Invalidate();
   terrain_center = GeoPoint(Angle::Zero(),
                             Angle::Zero());
   background.SetTerrain(_terrain);
@@ -219,6 +221,7 @@ void
 MapWindow::SetWeather(RasterWeather *_weather)
 {
   weather = _weather;
+  layer_cache.Invalidate();
   background.SetWeather(_weather);
 }
 
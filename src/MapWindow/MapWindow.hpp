@@ -39,6 +39,7 @@ Copyright_License {
 #include "Renderer/BackgroundRenderer.hpp"
 #include "Renderer/WaypointRenderer.hpp"
 #include "Renderer/TrailRenderer.hpp"
+#include "MapLayerCache.hpp"
 #include "Compiler.h"
 #include <vector>
 
@@ -72,6 +73,11 @@ class MapWindow :
 
   LabelBlock label_block;
 
+  /**
+   * Caches terrain and topography between frames.
+   */
+  MapLayerCache layer_cache;
+
 protected:
   const MapLook &look;
 
@@ -290,16 +296,28 @@ protected:
   virtual void on_paint_buffer(Canvas& canvas);
 
 private:
+  /**
+   * Renders terrain and topography, or copies them from #layer_cache
+   * @param canvas The drawing canvas
+   */
+  void RenderBackground(Canvas &canvas);
+  /**
+   * Returns the data serials and settings which affect #layer_cache
+   */
+  gcc_pure
+  MapLayerCache::Key GetLayerKey() const;
   /**
    * Renders the terrain background
    * @param canvas The drawing canvas
+   * @param projection The projection to render with
    */
-  void RenderTerrain(Canvas &canvas);
+  void RenderTerrain(Canvas &canvas, const WindowProjection &projection);
   /**
    * Renders the topography
    * @param canvas The drawing canvas
+   * @param projection The projection to render with
    */
-  void RenderTopography(Canvas &canvas);
+  void RenderTopography(Canvas &canvas, const WindowProjection &projection);
   /**
    * Renders the topography labels
    * @param canvas The drawing canvas
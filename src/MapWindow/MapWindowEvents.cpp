@@ -59,6 +59,7 @@ MapWindow::on_create()
 #ifndef ENABLE_OPENGL
   WindowCanvas canvas(*this);
   buffer_canvas.set(canvas);
+  layer_cache.Set(canvas);
 
   if (!IsAncientHardware())
     stencil_canvas.set(canvas);
@@ -75,6 +76,8 @@ MapWindow::on_destroy()
   SetTerrain(NULL);
   SetWeather(NULL);
 
+  layer_cache.Reset();
+
 #ifndef ENABLE_OPENGL
   buffer_canvas.reset();
 
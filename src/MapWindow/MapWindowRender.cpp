@@ -28,20 +28,63 @@ Copyright_License {
 #include "Task/ProtectedTaskManager.hpp"
 #include "Units/Units.hpp"
 #include "Renderer/AircraftRenderer.hpp"
+#include "Topography/TopographyStore.hpp"
+#include "Terrain/RasterTerrain.hpp"
+#include "Terrain/RasterWeather.hpp"
 
 void
-MapWindow::RenderTerrain(Canvas &canvas)
+MapWindow::RenderTerrain(Canvas &canvas, const WindowProjection &projection)
 {
-  background.SetSunAngle(render_projection, GetMapSettings().terrain,
-                           Basic(), Calculated());
-  background.Draw(canvas, render_projection, GetMapSettings().terrain);
+  background.Draw(canvas, projection, GetMapSettings().terrain);
 }
 
 void
-MapWindow::RenderTopography(Canvas &canvas)
+MapWindow::RenderTopography(Canvas &canvas,
+                            const WindowProjection &projection)
 {
   if (topography_renderer != NULL && GetMapSettings().topography_enabled)
-    topography_renderer->Draw(canvas, render_projection);
+    topography_renderer->Draw(canvas, projection);
+}
+
+MapLayerCache::Key
+MapWindow::GetLayerKey() const
+{
+  MapLayerCache::Key key;
+  key.terrain = terrain;
+  if (terrain != NULL)
+    key.terrain_serial = terrain->GetSerial();
+  key.terrain_settings = GetMapSettings().terrain;
+  key.sun_azimuth = background.GetSunAzimuth();
+  key.topography = topography;
+  if (topography != NULL)
+    key.topography_serial = topography->GetSerial();
+  key.topography_enabled = GetMapSettings().topography_enabled;
+  return key;
+}
+
+void
+MapWindow::RenderBackground(Canvas &canvas)
+{
+  background.SetSunAngle(render_projection, GetMapSettings().terrain,
+                         Basic(), Calculated());
+
+  if (weather != NULL && weather->GetParameter() > 0) {
+    /* the weather overlay changes with time and draws spot heights
+       relative to the current projection; don't cache it */
+    layer_cache.Invalidate();
+    RenderTerrain(canvas, render_projection);
+    RenderTopography(canvas, render_projection);
+    return;
+  }
+
+  const MapLayerCache::Key key = GetLayerKey();
+  if (layer_cache.Draw(canvas, render_projection, key))
+    return;
+
+  Canvas &layer = layer_cache.BeginRender(canvas, render_projection, key);
+  RenderTerrain(layer, layer_cache.GetRenderProjection());
+  RenderTopography(layer, layer_cache.GetRenderProjection());
+  layer_cache.CommitRender(canvas, render_projection);
 }
 
 void
@@ -101,11 +144,8 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc)
   label_block.reset();
 
   // Render terrain, groundline and topography
-  draw_sw.Mark(_T("RenderTerrain"));
-  RenderTerrain(canvas);
-
-  draw_sw.Mark(_T("RenderTopography"));
-  RenderTopography(canvas);
+  draw_sw.Mark(_T("RenderBackground"));
+  RenderBackground(canvas);
 
   draw_sw.Mark(_T("RenderFinalGlideShading"));
   RenderFinalGlideShading(canvas);
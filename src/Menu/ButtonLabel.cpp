@@ -24,6 +24,7 @@ Copyright_License {
 #include "ButtonLabel.hpp"
 #include "MenuBar.hpp"
 #include "MenuData.hpp"
+#include "ExpandMacros.hpp"
 #include "Language/Language.hpp"
 #include "Util/StringUtil.hpp"
 #include "Util/Macros.hpp"
@@ -52,76 +53,117 @@ ButtonLabel::Destroy()
   bar = NULL;
 }
 
-ButtonLabel::Expanded
-ButtonLabel::Expand(const TCHAR *text, TCHAR *buffer, size_t size)
-{
-  Expanded expanded;
-  const TCHAR *dollar;
-
-  if ((text == NULL) || (*text == _T('\0')) || (*text == _T(' '))) {
-    expanded.visible = false;
-    return expanded;
-  } else if ((dollar = _tcschr(text, '$')) == NULL) {
-    /* no macro, we can just translate the text */
-    expanded.visible = true;
-    expanded.enabled = true;
-    expanded.text = gettext(text);
-    return expanded;
-  } else {
-    const TCHAR *macros = dollar;
-    /* backtrack until the first non-whitespace character, because we
-       don't want to translate whitespace between the text and the
-       macro */
-    while (macros > text && _istspace(macros[-1]))
-      --macros;
-
-    TCHAR s[100];
-    expanded.enabled = !ExpandMacros(text, s, ARRAY_SIZE(s));
-    if (s[0] == _T('\0') || s[0] == _T(' ')) {
-      expanded.visible = false;
-      return expanded;
-    }
+/**
+ * The macro inputs, shared by all labels.
+ */
+static MacroInputs inputs;
 
-    /* copy the text (without trailing whitespace) to a new buffer and
-       translate it */
-    TCHAR translatable[256];
-    std::copy(text, macros, translatable);
-    translatable[macros - text] = _T('\0');
+/**
+ * The parsed label of a button, and the state it was last shown
+ * with.
+ */
+struct CachedLabel {
+  LabelTemplate label;
 
-    const TCHAR *translated = string_is_empty(translatable)
-      ? _T("") : gettext(translatable);
+  unsigned event;
 
-    /* concatenate the translated text and the macro output */
-    _tcscpy(buffer, translated);
-    _tcscat(buffer, s + (macros - text));
+  /**
+   * The #MacroInputs serials at the time the label was last shown.
+   */
+  Serial serials[MacroInputs::NUM_GROUPS];
 
-    expanded.visible = true;
-    expanded.text = buffer;
-    return expanded;
-  }
+  /**
+   * Has the button been updated with this label?
+   */
+  bool shown;
+
+  CachedLabel():event(0), shown(false) {}
+};
+
+static CachedLabel cached_labels[Menu::MAX_ITEMS];
+
+ButtonLabel::Expanded
+ButtonLabel::Expand(const TCHAR *text, TCHAR *buffer, size_t size)
+{
+  LabelTemplate label;
+  label.Parse(text);
+  inputs.Update(label.GetDependencies());
+  return label.Expand(inputs, buffer, size);
 }
 
-void
-ButtonLabel::SetLabelText(unsigned index, const TCHAR *text, unsigned event)
+static void
+Show(unsigned index, const LabelTemplate &label, unsigned event)
 {
   TCHAR buffer[100];
-  Expanded expanded = Expand(text, buffer, ARRAY_SIZE(buffer));
+  ButtonLabel::Expanded expanded =
+    label.Expand(inputs, buffer, ARRAY_SIZE(buffer));
   if (expanded.visible)
     bar->ShowButton(index, expanded.enabled, expanded.text, event);
   else
     bar->HideButton(index);
 }
 
+void
+ButtonLabel::SetLabelText(unsigned index, const TCHAR *text, unsigned event)
+{
+  assert(index < Menu::MAX_ITEMS);
+
+  CachedLabel &cached = cached_labels[index];
+  if (cached.label.GetSource() != text)
+    cached.label.Parse(text);
+
+  inputs.Update(cached.label.GetDependencies());
+  Show(index, cached.label, event);
+
+  cached.event = event;
+  std::copy(inputs.serials, inputs.serials + MacroInputs::NUM_GROUPS,
+            cached.serials);
+  cached.shown = true;
+}
+
 void
 ButtonLabel::Set(const Menu &menu, const Menu *overlay, bool full)
 {
-  for (unsigned i = 0; i < menu.MAX_ITEMS; ++i) {
+  /* parse new labels and collect only the inputs which are actually
+     used by the menu */
+  unsigned groups = 0;
+  const MenuItem *items[Menu::MAX_ITEMS];
+  for (unsigned i = 0; i < Menu::MAX_ITEMS; ++i) {
     const MenuItem &item = overlay != NULL && (*overlay)[i].IsDefined()
       ? (*overlay)[i]
       : menu[i];
+    items[i] = &item;
+
+    CachedLabel &cached = cached_labels[i];
+    if (cached.label.GetSource() != item.label) {
+      cached.label.Parse(item.label);
+      cached.shown = false;
+    }
+
+    if (full || cached.label.IsDynamic())
+      groups |= cached.label.GetDependencies();
+  }
+
+  inputs.Update(groups);
+
+  for (unsigned i = 0; i < Menu::MAX_ITEMS; ++i) {
+    const MenuItem &item = *items[i];
+    CachedLabel &cached = cached_labels[i];
+    const LabelTemplate &label = cached.label;
+
+    /* a label needs to be shown again only if it is new, or if one
+       of the inputs its macros depend on has changed */
+    if (!full && cached.shown && cached.event == item.event &&
+        (!label.IsDynamic() ||
+         !inputs.Changed(cached.serials, label.GetDependencies())))
+      continue;
+
+    Show(i, label, item.event);
 
-    if (full || item.IsDynamic())
-      SetLabelText(i, item.label, item.event);
+    cached.event = item.event;
+    std::copy(inputs.serials, inputs.serials + MacroInputs::NUM_GROUPS,
+              cached.serials);
+    cached.shown = true;
   }
 }
 
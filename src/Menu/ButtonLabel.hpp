@@ -44,21 +44,22 @@ namespace ButtonLabel {
   void SetFont(const Font &Font);
   void Destroy();
 
-  gcc_pure
+  /**
+   * Expand the macros in a label and translate it.
+   */
   Expanded Expand(const TCHAR *text, TCHAR *buffer, size_t size);
 
   void SetLabelText(unsigned i, const TCHAR *text, unsigned event);
   bool IsEnabled(unsigned i);
 
-  bool ExpandMacros(const TCHAR *In, TCHAR *OutBuffer, size_t Size);
-
   void OnResize(const PixelRect &rc);
 
   /**
    * Show the specified menu.
    *
-   * @param full do a full update; if false, then only dynamic buttons
-   * are updated (to reduce flickering)
+   * @param full do a full update; if false, then only new buttons and
+   * dynamic buttons whose macro inputs have changed are updated (to
+   * reduce flickering)
    */
   void Set(const Menu &menu, const Menu *overlay=NULL, bool full=true);
 };
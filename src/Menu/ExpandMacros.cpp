@@ -21,7 +21,7 @@ Copyright_License {
 }
 */
 
-#include "Menu/ButtonLabel.hpp"
+#include "Menu/ExpandMacros.hpp"
 #include "Language/Language.hpp"
 #include "Gauge/GaugeFLARM.hpp"
 #include "Logger/Logger.hpp"
@@ -42,574 +42,804 @@ Copyright_License {
 #include "Net/Features.hpp"
 #include "UIState.hpp"
 
-#include <stdlib.h>
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
 
 /**
- * Replaces ToReplace with ReplaceWith in String
- * @param String Buffer string
- * @param ToReplace The string that will be replaced
- * @param ReplaceWith The replacement
- * @param Size (?)
+ * The known macros.  The order matters: a label's "enabled" state
+ * is determined by applying the macros' #MacroEffect in this order
+ * (which is the order the old search-and-replace implementation
+ * checked them in).
  */
-static void
-ReplaceInString(TCHAR *String, const TCHAR *ToReplace,
-                const TCHAR *ReplaceWith, size_t Size)
+enum Macro {
+  CHECK_AIRSPACE,
+
+  /* task macros; these are all invalid without a task manager */
+  CHECK_TASK_RESUMED,
+  CHECK_TASK,
+  WAYPOINT_NEXT,
+  WAYPOINT_PREVIOUS,
+  WAYPOINT_NEXT_ARM,
+  WAYPOINT_PREVIOUS_ARM,
+  ADVANCE_ARMED,
+  CHECK_AUTO_MC,
+  TASK_ABORT_TOGGLE_ACTION_NAME,
+
+  CHECK_FLARM,
+  CHECK_CIRCLING,
+  CHECK_VEGA,
+  CHECK_REPLAY,
+  CHECK_WAYPOINT_FILE,
+  CHECK_LOGGER,
+  CHECK_NET,
+  CHECK_TERRAIN,
+  LOGGER_ACTIVE,
+  SNAIL_TRAIL_TOGGLE_NAME,
+  AIRSPACE_TOGGLE_NAME,
+  TERRAIN_TOPOLOGY_TOGGLE_NAME,
+  TERRAIN_TOPOGRAPHY_TOGGLE_NAME,
+  FULL_SCREEN_TOGGLE_ACTION_NAME,
+  ZOOM_AUTO_TOGGLE_ACTION_NAME,
+  TOPOLOGY_TOGGLE_ACTION_NAME,
+  TOPOGRAPHY_TOGGLE_ACTION_NAME,
+  TERRAIN_TOGGLE_ACTION_NAME,
+  MAP_LABELS_TOGGLE_ACTION_NAME,
+  MACCREADY_TOGGLE_ACTION_NAME,
+  AUX_INFO_TOGGLE_ACTION_NAME,
+  DISP_MODE_CLIMB_SHORT_INDICATOR,
+  DISP_MODE_CRUISE_SHORT_INDICATOR,
+  DISP_MODE_AUTO_SHORT_INDICATOR,
+  DISP_MODE_FINAL_SHORT_INDICATOR,
+  AIRSPACE_MODE_ALL_SHORT_INDICATOR,
+  AIRSPACE_MODE_CLIP_SHORT_INDICATOR,
+  AIRSPACE_MODE_AUTO_SHORT_INDICATOR,
+  AIRSPACE_MODE_BELOW_SHORT_INDICATOR,
+  AIRSPACE_MODE_ALL_OFF_INDICATOR,
+  SNAIL_TRAIL_OFF_SHORT_INDICATOR,
+  SNAIL_TRAIL_SHORT_SHORT_INDICATOR,
+  SNAIL_TRAIL_LONG_SHORT_INDICATOR,
+  SNAIL_TRAIL_FULL_SHORT_INDICATOR,
+  AIRSPACE_OFF_SHORT_INDICATOR,
+  AIRSPACE_ON_SHORT_INDICATOR,
+  FLARM_DISP_TOGGLE_ACTION_NAME,
+  NEXT_PAGE_NAME,
+
+  NUM_MACROS
+};
+
+#define G(name) (1 << MacroInputs::name)
+
+struct MacroDefinition {
+  const TCHAR *name;
+
+  /** a bit mask of the #MacroInputs::Group values it reads */
+  unsigned dependencies;
+};
+
+/** indexed by #Macro */
+static gcc_constexpr_data MacroDefinition macro_definitions[] = {
+  { _T("CheckAirspace"), G(ENVIRONMENT) },
+  { _T("CheckTaskResumed"), G(TASK) },
+  { _T("CheckTask"), G(TASK) | G(CALCULATED) },
+  { _T("WaypointNext"), G(TASK) },
+  { _T("WaypointPrevious"), G(TASK) | G(CALCULATED) },
+  { _T("WaypointNextArm"), G(TASK) },
+  { _T("WaypointPreviousArm"), G(TASK) | G(CALCULATED) },
+  { _T("AdvanceArmed"), G(TASK) },
+  { _T("CheckAutoMc"), G(TASK) | G(CALCULATED) | G(COMPUTER_SETTINGS) },
+  { _T("TaskAbortToggleActionName"), G(TASK) },
+  { _T("CheckFLARM"), G(BASIC) },
+  { _T("CheckCircling"), G(CALCULATED) },
+  { _T("CheckVega"), G(ENVIRONMENT) },
+  { _T("CheckReplay"), G(BASIC) },
+  { _T("CheckWaypointFile"), G(ENVIRONMENT) },
+  { _T("CheckLogger"), G(BASIC) },
+  { _T("CheckNet"), 0 },
+  { _T("CheckTerrain"), G(CALCULATED) },
+  { _T("LoggerActive"), G(ENVIRONMENT) },
+  { _T("SnailTrailToggleName"), G(MAP_SETTINGS) },
+  { _T("AirSpaceToggleName"), G(MAP_SETTINGS) },
+  { _T("TerrainTopologyToggleName"), G(MAP_SETTINGS) },
+  { _T("TerrainTopographyToggleName"), G(MAP_SETTINGS) },
+  { _T("FullScreenToggleActionName"), G(ENVIRONMENT) },
+  { _T("ZoomAutoToggleActionName"), G(MAP_SETTINGS) },
+  { _T("TopologyToggleActionName"), G(MAP_SETTINGS) },
+  { _T("TopographyToggleActionName"), G(MAP_SETTINGS) },
+  { _T("TerrainToggleActionName"), G(MAP_SETTINGS) },
+  { _T("MapLabelsToggleActionName"), G(MAP_SETTINGS) },
+  { _T("MacCreadyToggleActionName"), G(COMPUTER_SETTINGS) },
+  { _T("AuxInfoToggleActionName"), G(UI) },
+  { _T("DispModeClimbShortIndicator"), G(UI) },
+  { _T("DispModeCruiseShortIndicator"), G(UI) },
+  { _T("DispModeAutoShortIndicator"), G(UI) },
+  { _T("DispModeFinalShortIndicator"), G(UI) },
+  { _T("AirspaceModeAllShortIndicator"), G(MAP_SETTINGS) },
+  { _T("AirspaceModeClipShortIndicator"), G(MAP_SETTINGS) },
+  { _T("AirspaceModeAutoShortIndicator"), G(MAP_SETTINGS) },
+  { _T("AirspaceModeBelowShortIndicator"), G(MAP_SETTINGS) },
+  { _T("AirspaceModeAllOffIndicator"), G(MAP_SETTINGS) },
+  { _T("SnailTrailOffShortIndicator"), G(MAP_SETTINGS) },
+  { _T("SnailTrailShortShortIndicator"), G(MAP_SETTINGS) },
+  { _T("SnailTrailLongShortIndicator"), G(MAP_SETTINGS) },
+  { _T("SnailTrailFullShortIndicator"), G(MAP_SETTINGS) },
+  { _T("AirSpaceOffShortIndicator"), G(MAP_SETTINGS) },
+  { _T("AirSpaceOnShortIndicator"), G(MAP_SETTINGS) },
+  { _T("FlarmDispToggleActionName"), G(UI) },
+  { _T("NextPageName"), G(PAGES) },
+};
+
+#undef G
+
+static_assert(ARRAY_SIZE(macro_definitions) == NUM_MACROS,
+              "Wrong number of macro definitions");
+static_assert(NUM_MACROS <= 64, "Too many macros for the bit mask");
+
+/**
+ * How a macro affects the "enabled" state of its label.
+ */
+enum MacroEffect {
+  KEEP,
+  DISABLE,
+
+  /** enable the label, even if a previous macro has disabled it */
+  ENABLE,
+};
+
+gcc_pure
+static int
+FindMacro(const TCHAR *name, size_t length)
 {
-  TCHAR TmpBuf[MAX_PATH];
-  size_t iR = _tcslen(ToReplace);
-  TCHAR *pC;
-
-  while ((pC = _tcsstr(String, ToReplace)) != NULL) {
-    _tcscpy(TmpBuf, pC + iR);
-    _tcscpy(pC, ReplaceWith);
-    _tcscat(pC, TmpBuf);
+  for (unsigned i = 0; i < NUM_MACROS; ++i) {
+    const TCHAR *candidate = macro_definitions[i].name;
+    if (_tcsncmp(candidate, name, length) == 0 &&
+        candidate[length] == _T('\0'))
+      return i;
   }
+
+  return -1;
 }
 
-/**
- * If Condition is true, Macro in Buffer will be replaced by TrueText,
- * otherwise by FalseText.
- * @param Condition Condition to be checked
- * @param Buffer Buffer string
- * @param Macro The string that will be replaced
- * @param TrueText The replacement if Condition is true
- * @param FalseText The replacement if Condition is false
- * @param Size (?)
- */
-static void
-CondReplaceInString(bool Condition, TCHAR *Buffer, const TCHAR *Macro,
-                    const TCHAR *TrueText, const TCHAR *FalseText, size_t Size)
+static const TCHAR *
+Indicator(bool condition)
 {
-  if (Condition)
-    ReplaceInString(Buffer, Macro, TrueText, Size);
-  else
-    ReplaceInString(Buffer, Macro, FalseText, Size);
+  return condition ? _T("(*)") : _T("");
 }
 
-static bool
-ExpandTaskMacros(TCHAR *OutBuffer, size_t Size,
-                 const DerivedInfo &calculated,
-                 const ComputerSettings &settings_computer)
+static const TCHAR *
+TerrainTopographyToggleName(const MacroInputs::MapSettingsInputs &map)
 {
-  if (protected_task_manager == NULL)
-    return true;
+  unsigned val = 0;
+  if (map.topography_enabled)
+    val++;
+  if (map.terrain_enable)
+    val += 2;
+
+  switch (val) {
+  case 0:
+    return _("Topography On");
+  case 1:
+    return _("Terrain On");
+  case 2:
+    return _("Terrain + Topography");
+  default:
+    return _("Terrain Off");
+  }
+}
 
-  bool invalid = false;
-  ProtectedTaskManager::Lease task_manager(*protected_task_manager);
+static const TCHAR *
+EvaluateWaypointNext(const MacroInputs::TaskInputs &task,
+                     MacroEffect &effect)
+{
+  if (!task.next)
+    effect = DISABLE;
 
-  if (_tcsstr(OutBuffer, _T("$(CheckTaskResumed)"))) {
-    // TODO code: check, does this need to be set with temporary task?
-    if (task_manager->IsMode(TaskManager::MODE_ABORT) ||
-        task_manager->IsMode(TaskManager::MODE_GOTO))
-      invalid = true;
-    ReplaceInString(OutBuffer, _T("$(CheckTaskResumed)"), _T(""), Size);
+  const bool next_is_final = task.next && !task.next2;
+  if (task.abort)
+    return next_is_final ? _("Furthest Landpoint") : _("Next Landpoint");
+
+  return next_is_final ? _("Finish Turnpoint") : _("Next Turnpoint");
+}
+
+static const TCHAR *
+EvaluateWaypointPrevious(const MacroInputs &inputs, MacroEffect &effect)
+{
+  const MacroInputs::TaskInputs &task = inputs.task;
+  const bool previous_is_start = task.previous && !task.previous2;
+
+  if (task.abort) {
+    if (!task.previous)
+      effect = DISABLE;
+
+    return previous_is_start
+      ? _("Closest Landpoint") : _("Previous Landpoint");
   }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckTask)"))) {
-    if (!calculated.task_stats.task_valid)
-      invalid = true;
+  if (inputs.calculated.has_optional_starts && !task.previous)
+    return _("Next Startpoint");
+
+  if (!task.previous)
+    effect = DISABLE;
+
+  return previous_is_start ? _("Start Turnpoint") : _("Previous Turnpoint");
+}
+
+static const TCHAR *
+EvaluateTaskMacro(Macro macro, const MacroInputs &inputs, MacroEffect &effect)
+{
+  const MacroInputs::TaskInputs &task = inputs.task;
 
-    ReplaceInString(OutBuffer, _T("$(CheckTask)"), _T(""), Size);
+  if (!task.available) {
+    effect = DISABLE;
+    return _T("");
   }
 
-  const AbstractTask *task = task_manager->GetActiveTask();
-  if (task == NULL || !task->CheckTask() ||
-      task_manager->IsMode(TaskManager::MODE_GOTO)) {
+  if ((macro == WAYPOINT_NEXT || macro == WAYPOINT_PREVIOUS ||
+       macro == WAYPOINT_NEXT_ARM || macro == WAYPOINT_PREVIOUS_ARM) &&
+      (!task.active_valid || task.go_to)) {
+    effect = DISABLE;
+    return macro == WAYPOINT_NEXT || macro == WAYPOINT_NEXT_ARM
+      ? _("Next Turnpoint") : _("Previous Turnpoint");
+  }
 
-    if (_tcsstr(OutBuffer, _T("$(WaypointNext)"))) {
-      invalid = true;
-      ReplaceInString(OutBuffer, _T("$(WaypointNext)"),
-          _("Next Turnpoint"), Size);
+  switch (macro) {
+  case CHECK_TASK_RESUMED:
+    // TODO code: check, does this need to be set with temporary task?
+    if (task.abort || task.go_to)
+      effect = DISABLE;
+    return _T("");
 
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointPrevious)"))) {
-      invalid = true;
-      ReplaceInString(OutBuffer, _T("$(WaypointPrevious)"),
-          _("Previous Turnpoint"), Size);
+  case CHECK_TASK:
+    if (!inputs.calculated.task_valid)
+      effect = DISABLE;
+    return _T("");
 
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointNextArm)"))) {
-      invalid = true;
-      ReplaceInString(OutBuffer, _T("$(WaypointNextArm)"),
-          _("Next Turnpoint"), Size);
+  case WAYPOINT_NEXT:
+    return EvaluateWaypointNext(task, effect);
 
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointPreviousArm)"))) {
-      invalid = true;
-      ReplaceInString(OutBuffer, _T("$(WaypointPreviousArm)"),
-          _("Previous Turnpoint"), Size);
-    }
+  case WAYPOINT_PREVIOUS:
+    return EvaluateWaypointPrevious(inputs, effect);
+
+  case WAYPOINT_NEXT_ARM:
+    if (task.abort)
+      return EvaluateWaypointNext(task, effect);
 
-  } else if (task_manager->IsMode(TaskManager::MODE_ABORT)) {
-
-    if (_tcsstr(OutBuffer, _T("$(WaypointNext)"))) {
-      if (!task->IsValidTaskPoint(1))
-        invalid = true;
-
-      CondReplaceInString(task->IsValidTaskPoint(1) && !task->IsValidTaskPoint(2),
-                          OutBuffer,
-                          _T("$(WaypointNext)"),
-                          _("Furthest Landpoint"),
-                          _("Next Landpoint"), Size);
-
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointPrevious)"))) {
-      if (!task->IsValidTaskPoint(-1))
-        invalid = true;
-
-      CondReplaceInString(task->IsValidTaskPoint(-1) && !task->IsValidTaskPoint(-2),
-                          OutBuffer,
-                          _T("$(WaypointPrevious)"),
-                          _("Closest Landpoint"),
-                          _("Previous Landpoint"), Size);
-
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointNextArm)"))) {
-      if (!task->IsValidTaskPoint(1))
-        invalid = true;
-
-      CondReplaceInString(task->IsValidTaskPoint(1) && !task->IsValidTaskPoint(2),
-                          OutBuffer,
-                          _T("$(WaypointNextArm)"),
-                          _("Furthest Landpoint"),
-                          _("Next Landpoint"), Size);
-
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointPreviousArm)"))) {
-      if (!task->IsValidTaskPoint(-1))
-        invalid = true;
-
-      CondReplaceInString(task->IsValidTaskPoint(-1) && !task->IsValidTaskPoint(-2),
-                          OutBuffer,
-                          _T("$(WaypointPreviousArm)"),
-                          _("Closest Landpoint"),
-                          _("Previous Landpoint"), Size);
+    switch ((TaskAdvance::TaskAdvanceState_t)task.advance_state) {
+    case TaskAdvance::START_DISARMED:
+      return _("Arm start");
+    case TaskAdvance::TURN_DISARMED:
+      return _("Arm turn");
+    default:
+      return EvaluateWaypointNext(task, effect);
     }
 
-  } else { // ordered task mode
-
-    const bool next_is_final = task->IsValidTaskPoint(1) && !task->IsValidTaskPoint(2);
-    const bool previous_is_start = task->IsValidTaskPoint(-1) && !task->IsValidTaskPoint(-2);
-    const bool has_optional_starts = calculated.common_stats.ordered_has_optional_starts;
-
-    if (_tcsstr(OutBuffer, _T("$(WaypointNext)"))) {
-      // Waypoint\nNext
-      if (!task->IsValidTaskPoint(1))
-        invalid = true;
-
-      CondReplaceInString(next_is_final,
-                          OutBuffer,
-                          _T("$(WaypointNext)"),
-                          _("Finish Turnpoint"),
-                          _("Next Turnpoint"), Size);
-      
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointPrevious)"))) {
-
-      if (has_optional_starts && !task->IsValidTaskPoint(-1)) {
-        ReplaceInString(OutBuffer, _T("$(WaypointPrevious)"), _("Next Startpoint"), Size);
-      } else {
-
-        CondReplaceInString(previous_is_start,
-                            OutBuffer,
-                            _T("$(WaypointPrevious)"),
-                            _("Start Turnpoint"),
-                            _("Previous Turnpoint"), Size);
-
-        if (!task->IsValidTaskPoint(-1))
-          invalid = true;
-      }
-
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointNextArm)"))) {
-      // Waypoint\nNext
-
-      switch (task_manager->GetTaskAdvance().get_advance_state()) {
-      case TaskAdvance::MANUAL:
-      case TaskAdvance::AUTO:
-      case TaskAdvance::START_ARMED:
-      case TaskAdvance::TURN_ARMED:
-        CondReplaceInString(next_is_final,
-                            OutBuffer,
-                            _T("$(WaypointNextArm)"),
-                            _("Finish Turnpoint"),
-                            _("Next Turnpoint"), Size);
-        if (!task->IsValidTaskPoint(1))
-          invalid = true;
-        break;
-      case TaskAdvance::START_DISARMED:
-        ReplaceInString(OutBuffer, _T("$(WaypointNextArm)"), _("Arm start"), Size);
-        break;
-      case TaskAdvance::TURN_DISARMED:
-        ReplaceInString(OutBuffer, _T("$(WaypointNextArm)"), _("Arm turn"), Size);
-        break;
-      }
-
-    } else if (_tcsstr(OutBuffer, _T("$(WaypointPreviousArm)"))) {
-
-      switch (task_manager->GetTaskAdvance().get_advance_state()) {
-      case TaskAdvance::MANUAL:
-      case TaskAdvance::AUTO:
-      case TaskAdvance::START_DISARMED:
-      case TaskAdvance::TURN_DISARMED:
-
-        if (has_optional_starts && !task->IsValidTaskPoint(-1)) {
-          ReplaceInString(OutBuffer, _T("$(WaypointPreviousArm)"), _("Next Startpoint"), Size);
-        } else {
-
-          CondReplaceInString(previous_is_start,
-                              OutBuffer,
-                              _T("$(WaypointPreviousArm)"),
-                              _("Start Turnpoint"),
-                              _("Previous Turnpoint"), Size);
-
-          if (!task->IsValidTaskPoint(-1))
-            invalid = true;
-        }
-
-        break;
-      case TaskAdvance::START_ARMED:
-        ReplaceInString(OutBuffer, _T("$(WaypointPreviousArm)"), _("Disarm start"), Size);
-        break;
-      case TaskAdvance::TURN_ARMED:
-        ReplaceInString(OutBuffer, _T("$(WaypointPreviousArm)"), _("Disarm turn"), Size);
-        break;
-      }
-    } 
-  }
+  case WAYPOINT_PREVIOUS_ARM:
+    if (task.abort)
+      return EvaluateWaypointPrevious(inputs, effect);
 
-  if (_tcsstr(OutBuffer, _T("$(AdvanceArmed)"))) {
-    switch (task_manager->GetTaskAdvance().get_advance_state()) {
+    switch ((TaskAdvance::TaskAdvanceState_t)task.advance_state) {
+    case TaskAdvance::START_ARMED:
+      return _("Disarm start");
+    case TaskAdvance::TURN_ARMED:
+      return _("Disarm turn");
+    default:
+      return EvaluateWaypointPrevious(inputs, effect);
+    }
+
+  case ADVANCE_ARMED:
+    switch ((TaskAdvance::TaskAdvanceState_t)task.advance_state) {
     case TaskAdvance::MANUAL:
-      ReplaceInString(OutBuffer, _T("$(AdvanceArmed)"), 
-                      _("Advance\n(manual)"), Size);
-      invalid = true;
-      break;
+      effect = DISABLE;
+      return _("Advance\n(manual)");
     case TaskAdvance::AUTO:
-      ReplaceInString(OutBuffer, _T("$(AdvanceArmed)"), 
-                      _("Advance\n(auto)"), Size);
-      invalid = true;
-      break;
+      effect = DISABLE;
+      return _("Advance\n(auto)");
     case TaskAdvance::START_ARMED:
-      ReplaceInString(OutBuffer, _T("$(AdvanceArmed)"), 
-                      _("Abort\nStart"), Size);
-      invalid = false;
-      break;
+      effect = ENABLE;
+      return _("Abort\nStart");
     case TaskAdvance::START_DISARMED:
-      ReplaceInString(OutBuffer, _T("$(AdvanceArmed)"), 
-                      _("Arm\nStart"), Size);
-      invalid = false;
-      break;
+      effect = ENABLE;
+      return _("Arm\nStart");
     case TaskAdvance::TURN_ARMED:
-      ReplaceInString(OutBuffer, _T("$(AdvanceArmed)"), 
-                      _("Abort\nTurn"), Size);
-      invalid = false;
-      break;
+      effect = ENABLE;
+      return _("Abort\nTurn");
     case TaskAdvance::TURN_DISARMED:
-      ReplaceInString(OutBuffer, _T("$(AdvanceArmed)"), 
-                      _("Arm\nTurn"), Size);
-      invalid = false;
-      break;
+      effect = ENABLE;
+      return _("Arm\nTurn");
     }
-  }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckAutoMc)"))) {
-    if (!calculated.task_stats.task_valid
-        && ((settings_computer.task.auto_mc_mode==TaskBehaviour::AUTOMC_FINALGLIDE)
-            || (settings_computer.task.auto_mc_mode==TaskBehaviour::AUTOMC_BOTH)))
-      invalid = true;
+    return _T("");
 
-    ReplaceInString(OutBuffer, _T("$(CheckAutoMc)"), _T(""), Size);
-  }
+  case CHECK_AUTO_MC:
+    if (!inputs.calculated.task_valid &&
+        (inputs.computer_settings.auto_mc_mode == TaskBehaviour::AUTOMC_FINALGLIDE ||
+         inputs.computer_settings.auto_mc_mode == TaskBehaviour::AUTOMC_BOTH))
+      effect = DISABLE;
+    return _T("");
 
-  if (_tcsstr(OutBuffer, _T("$(TaskAbortToggleActionName)"))) {
-    if (task_manager->IsMode(TaskManager::MODE_GOTO)) {
-      CondReplaceInString(task_manager->GetOrderedTask().CheckTask(),
-                          OutBuffer, _T("$(TaskAbortToggleActionName)"),
-                          _("Resume"), _("Abort"), Size);
-    } else 
-      CondReplaceInString(task_manager->IsMode(TaskManager::MODE_ABORT),
-                          OutBuffer, _T("$(TaskAbortToggleActionName)"),
-                          _("Resume"), _("Abort"), Size);
-  }
+  case TASK_ABORT_TOGGLE_ACTION_NAME:
+    if (task.go_to)
+      return task.ordered_valid ? _("Resume") : _("Abort");
+    return task.abort ? _("Resume") : _("Abort");
 
-  return invalid;
+  default:
+    assert(false);
+    return _T("");
+  }
 }
 
-static const NMEAInfo &
-Basic()
+/**
+ * Evaluate one macro.
+ *
+ * @param effect is updated if the macro affects the "enabled"
+ * state of the label
+ * @return the replacement text, which stays valid at least until
+ * #inputs is modified
+ */
+static const TCHAR *
+EvaluateMacro(Macro macro, const MacroInputs &inputs, MacroEffect &effect)
 {
-  return CommonInterface::Basic();
-}
+  const MacroInputs::MapSettingsInputs &map = inputs.map_settings;
+
+  switch (macro) {
+  case CHECK_AIRSPACE:
+    if (inputs.environment.airspaces_empty)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_TASK_RESUMED:
+  case CHECK_TASK:
+  case WAYPOINT_NEXT:
+  case WAYPOINT_PREVIOUS:
+  case WAYPOINT_NEXT_ARM:
+  case WAYPOINT_PREVIOUS_ARM:
+  case ADVANCE_ARMED:
+  case CHECK_AUTO_MC:
+  case TASK_ABORT_TOGGLE_ACTION_NAME:
+    return EvaluateTaskMacro(macro, inputs, effect);
+
+  case CHECK_FLARM:
+    if (!inputs.basic.flarm_available)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_CIRCLING:
+    if (!inputs.calculated.circling)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_VEGA:
+    if (!inputs.environment.vega)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_REPLAY:
+    if (inputs.basic.movement_detected)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_WAYPOINT_FILE:
+    if (inputs.environment.waypoints_empty)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_LOGGER:
+    if (inputs.basic.replay)
+      effect = DISABLE;
+    return _T("");
+
+  case CHECK_NET:
+#ifndef HAVE_NET
+    effect = DISABLE;
+#endif
+    return _T("");
 
-static const DerivedInfo &
-Calculated()
-{
-  return CommonInterface::Calculated();
-}
+  case CHECK_TERRAIN:
+    if (!inputs.calculated.terrain_valid)
+      effect = DISABLE;
+    return _T("");
 
-static const ComputerSettings &
-GetComputerSettings()
-{
-  return CommonInterface::GetComputerSettings();
+  case LOGGER_ACTIVE:
+    return inputs.environment.logger_active ? _("Stop") : _("Start");
+
+  case SNAIL_TRAIL_TOGGLE_NAME:
+    switch ((TrailLength)map.trail_length) {
+    case TRAIL_OFF:
+      return _("Long");
+    case TRAIL_LONG:
+      return _("Short");
+    case TRAIL_SHORT:
+      return _("Full");
+    case TRAIL_FULL:
+      return _("Off");
+    }
+
+    return _T("");
+
+  case AIRSPACE_TOGGLE_NAME:
+    return map.airspace_enable ? _("Off") : _("On");
+
+  case TERRAIN_TOPOLOGY_TOGGLE_NAME:
+  case TERRAIN_TOPOGRAPHY_TOGGLE_NAME:
+    return TerrainTopographyToggleName(map);
+
+  case FULL_SCREEN_TOGGLE_ACTION_NAME:
+    return inputs.environment.full_screen ? _("Off") : _("On");
+
+  case ZOOM_AUTO_TOGGLE_ACTION_NAME:
+    return map.auto_zoom_enabled ? _("Manual") : _("Auto");
+
+  case TOPOLOGY_TOGGLE_ACTION_NAME:
+  case TOPOGRAPHY_TOGGLE_ACTION_NAME:
+    return map.topography_enabled ? _("Off") : _("On");
+
+  case TERRAIN_TOGGLE_ACTION_NAME:
+    return map.terrain_enable ? _("Off") : _("On");
+
+  case MAP_LABELS_TOGGLE_ACTION_NAME: {
+    static const TCHAR *const labels[] = { N_("All"),
+                                           N_("Task & Landables"),
+                                           N_("Task"),
+                                           N_("None") };
+    static gcc_constexpr_data unsigned int n = ARRAY_SIZE(labels);
+    return gettext(labels[(map.label_selection + 1) % n]);
+  }
+
+  case MACCREADY_TOGGLE_ACTION_NAME:
+    return inputs.computer_settings.auto_mc ? _("Manual") : _("Auto");
+
+  case AUX_INFO_TOGGLE_ACTION_NAME:
+    return inputs.ui.auxiliary_enabled ? _("Off") : _("On");
+
+  case DISP_MODE_CLIMB_SHORT_INDICATOR:
+    return Indicator(inputs.ui.force_display_mode == DM_CIRCLING);
+
+  case DISP_MODE_CRUISE_SHORT_INDICATOR:
+    return Indicator(inputs.ui.force_display_mode == DM_CRUISE);
+
+  case DISP_MODE_AUTO_SHORT_INDICATOR:
+    return Indicator(inputs.ui.force_display_mode == DM_NONE);
+
+  case DISP_MODE_FINAL_SHORT_INDICATOR:
+    return Indicator(inputs.ui.force_display_mode == DM_FINAL_GLIDE);
+
+  case AIRSPACE_MODE_ALL_SHORT_INDICATOR:
+    return Indicator(map.airspace_altitude_mode == ALLON);
+
+  case AIRSPACE_MODE_CLIP_SHORT_INDICATOR:
+    return Indicator(map.airspace_altitude_mode == CLIP);
+
+  case AIRSPACE_MODE_AUTO_SHORT_INDICATOR:
+    return Indicator(map.airspace_altitude_mode == AUTO);
+
+  case AIRSPACE_MODE_BELOW_SHORT_INDICATOR:
+    return Indicator(map.airspace_altitude_mode == ALLBELOW);
+
+  case AIRSPACE_MODE_ALL_OFF_INDICATOR:
+    return Indicator(map.airspace_altitude_mode == ALLOFF);
+
+  case SNAIL_TRAIL_OFF_SHORT_INDICATOR:
+    return Indicator(map.trail_length == TRAIL_OFF);
+
+  case SNAIL_TRAIL_SHORT_SHORT_INDICATOR:
+    return Indicator(map.trail_length == TRAIL_SHORT);
+
+  case SNAIL_TRAIL_LONG_SHORT_INDICATOR:
+    return Indicator(map.trail_length == TRAIL_LONG);
+
+  case SNAIL_TRAIL_FULL_SHORT_INDICATOR:
+    return Indicator(map.trail_length == TRAIL_FULL);
+
+  case AIRSPACE_OFF_SHORT_INDICATOR:
+    return Indicator(!map.airspace_enable);
+
+  case AIRSPACE_ON_SHORT_INDICATOR:
+    return Indicator(map.airspace_enable);
+
+  case FLARM_DISP_TOGGLE_ACTION_NAME:
+    return inputs.ui.flarm_gauge ? _("Off") : _("On");
+
+  case NEXT_PAGE_NAME:
+    return inputs.pages.next_page_name;
+
+  case NUM_MACROS:
+    break;
+  }
+
+  assert(false);
+  return _T("");
 }
 
-static const MapSettings &
-GetMapSettings()
+MacroInputs::MacroInputs()
 {
-  return CommonInterface::GetMapSettings();
+  memset(&task, 0, sizeof(task));
+  memset(&calculated, 0, sizeof(calculated));
+  memset(&basic, 0, sizeof(basic));
+  memset(&computer_settings, 0, sizeof(computer_settings));
+  memset(&map_settings, 0, sizeof(map_settings));
+  memset(&ui, 0, sizeof(ui));
+  memset(&pages, 0, sizeof(pages));
+  memset(&environment, 0, sizeof(environment));
 }
 
-static const UIState &
-GetUIState()
+/**
+ * Replace the old snapshot of a group with a new one (both zero
+ * padded, so they can be compared with memcmp()), and increment the
+ * serial if they differ.
+ */
+template<typename T>
+static void
+Commit(T &old_value, const T &new_value, Serial &serial)
 {
-  return CommonInterface::GetUIState();
+  if (memcmp(&old_value, &new_value, sizeof(T)) != 0) {
+    memcpy(&old_value, &new_value, sizeof(T));
+    ++serial;
+  }
 }
 
-bool
-ButtonLabel::ExpandMacros(const TCHAR *In, TCHAR *OutBuffer, size_t Size)
+static void
+CollectTask(MacroInputs::TaskInputs &task)
 {
-  // ToDo, check Buffer Size
-  bool invalid = false;
-  CopyString(OutBuffer, In, Size);
-
-  if (_tcsstr(OutBuffer, _T("$(")) == NULL)
-    return false;
+  if (protected_task_manager == NULL)
+    return;
 
-  if (_tcsstr(OutBuffer, _T("$(CheckAirspace)"))) {
-    if (airspace_database.empty())
-      invalid = true;
+  task.available = true;
 
-    ReplaceInString(OutBuffer, _T("$(CheckAirspace)"), _T(""), Size);
+  ProtectedTaskManager::Lease task_manager(*protected_task_manager);
+  task.abort = task_manager->IsMode(TaskManager::MODE_ABORT);
+  task.go_to = task_manager->IsMode(TaskManager::MODE_GOTO);
+  task.advance_state = task_manager->GetTaskAdvance().get_advance_state();
+
+  const AbstractTask *active = task_manager->GetActiveTask();
+  task.active_valid = active != NULL && active->CheckTask();
+  if (task.active_valid) {
+    task.previous2 = active->IsValidTaskPoint(-2);
+    task.previous = active->IsValidTaskPoint(-1);
+    task.next = active->IsValidTaskPoint(1);
+    task.next2 = active->IsValidTaskPoint(2);
   }
 
-  invalid |= ExpandTaskMacros(OutBuffer, Size,
-                              Calculated(), GetComputerSettings());
+  if (task.go_to)
+    task.ordered_valid = task_manager->GetOrderedTask().CheckTask();
+}
 
+void
+MacroInputs::Update(unsigned groups)
+{
+  if (groups & (1 << TASK)) {
+    TaskInputs value;
+    memset(&value, 0, sizeof(value));
+    CollectTask(value);
+    Commit(task, value, serials[TASK]);
+  }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckFLARM)"))) {
-    if (!Basic().flarm.available)
-      invalid = true;
-    ReplaceInString(OutBuffer, _T("$(CheckFLARM)"), _T(""), Size);
+  if (groups & (1 << CALCULATED)) {
+    const DerivedInfo &src = CommonInterface::Calculated();
+    CalculatedInputs value;
+    memset(&value, 0, sizeof(value));
+    value.task_valid = src.task_stats.task_valid;
+    value.has_optional_starts = src.common_stats.ordered_has_optional_starts;
+    value.circling = src.circling;
+    value.terrain_valid = src.terrain_valid;
+    Commit(calculated, value, serials[CALCULATED]);
   }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckCircling)"))) {
-    if (!Calculated().circling)
-      invalid = true;
-    ReplaceInString(OutBuffer, _T("$(CheckCircling)"), _T(""), Size);
+  if (groups & (1 << BASIC)) {
+    const NMEAInfo &src = CommonInterface::Basic();
+    BasicInputs value;
+    memset(&value, 0, sizeof(value));
+    value.flarm_available = src.flarm.available;
+    value.replay = src.gps.replay;
+    value.movement_detected = CommonInterface::MovementDetected();
+    Commit(basic, value, serials[BASIC]);
   }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckVega)"))) {
-    if (devVarioFindVega()== NULL)
-      invalid = true;
-    ReplaceInString(OutBuffer, _T("$(CheckVega)"), _T(""), Size);
+  if (groups & (1 << COMPUTER_SETTINGS)) {
+    const ComputerSettings &src = CommonInterface::GetComputerSettings();
+    ComputerSettingsInputs value;
+    memset(&value, 0, sizeof(value));
+    value.auto_mc = src.task.auto_mc;
+    value.auto_mc_mode = src.task.auto_mc_mode;
+    Commit(computer_settings, value, serials[COMPUTER_SETTINGS]);
   }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckReplay)"))) {
-    if (CommonInterface::MovementDetected())
-      invalid = true;
+  if (groups & (1 << MAP_SETTINGS)) {
+    const MapSettings &src = CommonInterface::GetMapSettings();
+    MapSettingsInputs value;
+    memset(&value, 0, sizeof(value));
+    value.airspace_enable = src.airspace.enable;
+    value.topography_enabled = src.topography_enabled;
+    value.terrain_enable = src.terrain.enable;
+    value.auto_zoom_enabled = src.auto_zoom_enabled;
+    value.trail_length = src.trail_length;
+    value.airspace_altitude_mode = src.airspace.altitude_mode;
+    value.label_selection = src.waypoint.label_selection;
+    Commit(map_settings, value, serials[MAP_SETTINGS]);
+  }
 
-    ReplaceInString(OutBuffer, _T("$(CheckReplay)"), _T(""), Size);
+  if (groups & (1 << UI)) {
+    UIInputs value;
+    memset(&value, 0, sizeof(value));
+    value.auxiliary_enabled = CommonInterface::GetUIState().auxiliary_enabled;
+    value.flarm_gauge = CommonInterface::GetUISettings().enable_flarm_gauge;
+    value.force_display_mode = CommonInterface::GetUIState().force_display_mode;
+    Commit(ui, value, serials[UI]);
   }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckWaypointFile)"))) {
-    invalid |= way_points.IsEmpty();
-    ReplaceInString(OutBuffer, _T("$(CheckWaypointFile)"), _T(""), Size);
+  if (groups & (1 << PAGES)) {
+    PagesInputs value;
+    memset(&value, 0, sizeof(value));
+    const PageSettings::PageLayout &page =
+      CommonInterface::GetUISettings().pages.pages[Pages::NextIndex()];
+    page.MakeTitle(value.next_page_name, true);
+    Commit(pages, value, serials[PAGES]);
   }
 
-  if (_tcsstr(OutBuffer, _T("$(CheckLogger)"))) {
-    invalid |= Basic().gps.replay;
-    ReplaceInString(OutBuffer, _T("$(CheckLogger)"), _T(""), Size);
+  if (groups & (1 << ENVIRONMENT)) {
+    EnvironmentInputs value;
+    memset(&value, 0, sizeof(value));
+    value.airspaces_empty = airspace_database.empty();
+    value.waypoints_empty = way_points.IsEmpty();
+    value.vega = devVarioFindVega() != NULL;
+    value.logger_active = logger.IsLoggerActive();
+    value.full_screen = CommonInterface::main_window.GetFullScreen();
+    Commit(environment, value, serials[ENVIRONMENT]);
   }
+}
 
-  if (_tcsstr(OutBuffer, _T("$(CheckFLARM)"))) {
-    if (!Basic().flarm.available)
-      invalid = true;
+void
+LabelTemplate::Parse(const TCHAR *text)
+{
+  source = text;
+  prefix_length = 0;
+  num_tokens = 0;
+  macros = 0;
+  dependencies = 0;
+
+  if (text == NULL)
+    return;
+
+  const TCHAR *dollar = _tcschr(text, _T('$'));
+  if (dollar == NULL)
+    return;
+
+  /* backtrack until the first non-whitespace character, because we
+     don't want to translate whitespace between the text and the
+     macro */
+  const TCHAR *p = dollar;
+  while (p > text && _istspace(p[-1]))
+    --p;
+
+  prefix_length = p - text;
+
+  const TCHAR *literal = p;
+  while (num_tokens < MAX_TOKENS - 2) {
+    const TCHAR *start = _tcsstr(p, _T("$("));
+    if (start == NULL)
+      break;
 
-    ReplaceInString(OutBuffer, _T("$(CheckFLARM)"), _T(""), Size);
-  }
-  if (_tcsstr(OutBuffer, _T("$(CheckNet)"))) {
-#ifndef HAVE_NET
-    invalid = true;
-#endif
+    const TCHAR *name = start + 2;
+    const TCHAR *end = _tcschr(name, _T(')'));
+    if (end == NULL)
+      break;
+
+    const int macro = FindMacro(name, end - name);
+    if (macro < 0) {
+      /* unknown macros are left in the label */
+      p = end + 1;
+      continue;
+    }
+
+    if (start > literal) {
+      Token &token = tokens[num_tokens++];
+      token.text = literal;
+      token.length = start - literal;
+      token.macro = LITERAL;
+    }
+
+    Token &token = tokens[num_tokens++];
+    token.text = NULL;
+    token.length = 0;
+    token.macro = macro;
+
+    macros |= (uint64_t)1 << macro;
+    dependencies |= macro_definitions[macro].dependencies;
 
-    ReplaceInString(OutBuffer, _T("$(CheckNet)"), _T(""), Size);
+    p = literal = end + 1;
   }
-  if (_tcsstr(OutBuffer, _T("$(CheckTerrain)"))) {
-    if (!Calculated().terrain_valid)
-      invalid = true;
 
-    ReplaceInString(OutBuffer, _T("$(CheckTerrain)"), _T(""), Size);
+  if (*literal != _T('\0')) {
+    Token &token = tokens[num_tokens++];
+    token.text = literal;
+    token.length = _tcslen(literal);
+    token.macro = LITERAL;
   }
+}
 
-  CondReplaceInString(logger.IsLoggerActive(), OutBuffer,
-                      _T("$(LoggerActive)"), _("Stop"),
-                      _("Start"), Size);
+static TCHAR *
+Append(TCHAR *dest, TCHAR *end, const TCHAR *src, size_t length)
+{
+  if (length > size_t(end - dest))
+    length = end - dest;
 
-  if (_tcsstr(OutBuffer, _T("$(SnailTrailToggleName)"))) {
-    switch (GetMapSettings().trail_length) {
-    case TRAIL_OFF:
-      ReplaceInString(OutBuffer, _T("$(SnailTrailToggleName)"),
-                      _("Long"), Size);
-      break;
-    case TRAIL_LONG:
-      ReplaceInString(OutBuffer, _T("$(SnailTrailToggleName)"),
-                      _("Short"), Size);
-      break;
-    case TRAIL_SHORT:
-      ReplaceInString(OutBuffer, _T("$(SnailTrailToggleName)"),
-                      _("Full"), Size);
-      break;
-    case TRAIL_FULL:
-      ReplaceInString(OutBuffer, _T("$(SnailTrailToggleName)"),
-                      _("Off"), Size);
-      break;
-    }
+  std::copy(src, src + length, dest);
+  return dest + length;
+}
+
+ButtonLabel::Expanded
+LabelTemplate::Expand(const MacroInputs &inputs,
+                      TCHAR *buffer, size_t size) const
+{
+  ButtonLabel::Expanded expanded;
+
+  if (source == NULL || *source == _T('\0') || *source == _T(' ')) {
+    expanded.visible = false;
+    return expanded;
   }
 
-  if (_tcsstr(OutBuffer, _T("$(AirSpaceToggleName)"))) {
-    ReplaceInString(OutBuffer, _T("$(AirSpaceToggleName)"),
-                    GetMapSettings().airspace.enable ? _("Off") : _("On"), Size);
+  if (!IsDynamic()) {
+    /* no macro, we can just translate the text */
+    expanded.visible = true;
+    expanded.enabled = true;
+    expanded.text = gettext(source);
+    return expanded;
   }
 
-  if (_tcsstr(OutBuffer, _T("$(TerrainTopologyToggleName)"))) {
-    char val = 0;
-    if (GetMapSettings().topography_enabled)
-      val++;
-    if (GetMapSettings().terrain.enable)
-      val += (char)2;
-    switch (val) {
-    case 0:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopologyToggleName)"),
-                      _("Topography On"), Size);
-      break;
-    case 1:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopologyToggleName)"),
-                      _("Terrain On"), Size);
-      break;
-    case 2:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopologyToggleName)"),
-                      _("Terrain + Topography"), Size);
-      break;
-    case 3:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopologyToggleName)"),
-                      _("Terrain Off"), Size);
-      break;
+  unsigned char effect[NUM_MACROS];
+
+  TCHAR s[100];
+  TCHAR *p = s, *const s_end = s + ARRAY_SIZE(s) - 1;
+  for (unsigned i = 0; i < num_tokens; ++i) {
+    const Token &token = tokens[i];
+    if (token.macro == LITERAL) {
+      p = Append(p, s_end, token.text, token.length);
+    } else {
+      MacroEffect e = KEEP;
+      const TCHAR *value = EvaluateMacro((Macro)token.macro, inputs, e);
+      effect[token.macro] = e;
+      p = Append(p, s_end, value, _tcslen(value));
     }
   }
+  *p = _T('\0');
 
-  if (_tcsstr(OutBuffer, _T("$(TerrainTopographyToggleName)"))) {
-    char val = 0;
-    if (GetMapSettings().topography_enabled)
-      val++;
-    if (GetMapSettings().terrain.enable)
-      val += (char)2;
-    switch (val) {
-    case 0:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopographyToggleName)"),
-                      _("Topography On"), Size);
-      break;
-    case 1:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopographyToggleName)"),
-                      _("Terrain On"), Size);
-      break;
-    case 2:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopographyToggleName)"),
-                      _("Terrain + Topography"), Size);
-      break;
-    case 3:
-      ReplaceInString(OutBuffer, _T("$(TerrainTopographyToggleName)"),
-                      _("Terrain Off"), Size);
-      break;
-    }
+  /* apply the macros' effects in their canonical order */
+  bool invalid = false;
+  for (unsigned i = 0; i < NUM_MACROS; ++i) {
+    if ((macros & ((uint64_t)1 << i)) == 0)
+      continue;
+
+    if (effect[i] == DISABLE)
+      invalid = true;
+    else if (effect[i] == ENABLE)
+      invalid = false;
   }
 
-  CondReplaceInString(CommonInterface::main_window.GetFullScreen(), OutBuffer,
-                      _T("$(FullScreenToggleActionName)"),
-                      _("Off"), _("On"), Size);
-  CondReplaceInString(GetMapSettings().auto_zoom_enabled, OutBuffer,
-		                  _T("$(ZoomAutoToggleActionName)"),
-		                  _("Manual"), _("Auto"), Size);
-  CondReplaceInString(GetMapSettings().topography_enabled, OutBuffer,
-                      _T("$(TopologyToggleActionName)"),
-                      _("Off"), _("On"), Size);
-  CondReplaceInString(GetMapSettings().topography_enabled, OutBuffer,
-                      _T("$(TopographyToggleActionName)"),
-                      _("Off"), _("On"), Size);
-  CondReplaceInString(GetMapSettings().terrain.enable, OutBuffer,
-                      _T("$(TerrainToggleActionName)"),
-                      _("Off"), _("On"), Size);
-
-  if (_tcsstr(OutBuffer, _T("$(MapLabelsToggleActionName)"))) {
-    static const TCHAR *const labels[] = { N_("All"),
-                                           N_("Task & Landables"),
-                                           N_("Task"),
-                                           N_("None") };
-    static gcc_constexpr_data unsigned int n = ARRAY_SIZE(labels);
-    unsigned int i = GetMapSettings().waypoint.label_selection;
-    ReplaceInString(OutBuffer, _T("$(MapLabelsToggleActionName)"),
-                    gettext(labels[(i + 1) % n]), Size);
+  if (prefix_length == 0 && (s[0] == _T('\0') || s[0] == _T(' '))) {
+    expanded.visible = false;
+    return expanded;
   }
 
-  CondReplaceInString(GetComputerSettings().task.auto_mc,
-                      OutBuffer, _T("$(MacCreadyToggleActionName)"),
-                      _("Manual"), _("Auto"), Size);
-  CondReplaceInString(GetUIState().auxiliary_enabled,
-                      OutBuffer, _T("$(AuxInfoToggleActionName)"),
-                      _("Off"), _("On"), Size);
-
-  CondReplaceInString(GetUIState().force_display_mode == DM_CIRCLING,
-                      OutBuffer, _T("$(DispModeClimbShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetUIState().force_display_mode == DM_CRUISE,
-                      OutBuffer, _T("$(DispModeCruiseShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetUIState().force_display_mode == DM_NONE,
-                      OutBuffer, _T("$(DispModeAutoShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetUIState().force_display_mode == DM_FINAL_GLIDE,
-                      OutBuffer, _T("$(DispModeFinalShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-
-  CondReplaceInString(GetMapSettings().airspace.altitude_mode == ALLON,
-                      OutBuffer, _T("$(AirspaceModeAllShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().airspace.altitude_mode == CLIP,
-                      OutBuffer, _T("$(AirspaceModeClipShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().airspace.altitude_mode == AUTO,
-                      OutBuffer, _T("$(AirspaceModeAutoShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().airspace.altitude_mode == ALLBELOW,
-                      OutBuffer, _T("$(AirspaceModeBelowShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().airspace.altitude_mode == ALLOFF,
-                      OutBuffer, _T("$(AirspaceModeAllOffIndicator)"),
-                      _T("(*)"), _T(""), Size);
-
-  CondReplaceInString(GetMapSettings().trail_length == TRAIL_OFF,
-                      OutBuffer, _T("$(SnailTrailOffShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().trail_length == TRAIL_SHORT,
-                      OutBuffer, _T("$(SnailTrailShortShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().trail_length == TRAIL_LONG,
-                      OutBuffer, _T("$(SnailTrailLongShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().trail_length == TRAIL_FULL,
-                      OutBuffer, _T("$(SnailTrailFullShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-
-  CondReplaceInString(!GetMapSettings().airspace.enable,
-                      OutBuffer, _T("$(AirSpaceOffShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-  CondReplaceInString(GetMapSettings().airspace.enable,
-                      OutBuffer, _T("$(AirSpaceOnShortIndicator)"),
-                      _T("(*)"), _T(""), Size);
-
-  CondReplaceInString(CommonInterface::GetUISettings().enable_flarm_gauge,
-                      OutBuffer, _T("$(FlarmDispToggleActionName)"),
-                      _("Off"), _("On"), Size);
-
-  if (_tcsstr(OutBuffer, _T("$(NextPageName)"))) {
-    TCHAR label[30];
-    const PageSettings::PageLayout &page =
-      CommonInterface::GetUISettings().pages.pages[Pages::NextIndex()];
-    page.MakeTitle(label, true);
-    ReplaceInString(OutBuffer, _T("$(NextPageName)"), label, Size);
+  /* copy the text (without trailing whitespace) to a new buffer and
+     translate it */
+  const TCHAR *translated = _T("");
+  TCHAR translatable[256];
+  if (prefix_length > 0) {
+    const size_t length = std::min(size_t(prefix_length),
+                                   ARRAY_SIZE(translatable) - 1);
+    std::copy(source, source + length, translatable);
+    translatable[length] = _T('\0');
+    translated = gettext(translatable);
   }
 
-  return invalid;
+  /* concatenate the translated text and the macro output */
+  assert(size > 0);
+  TCHAR *end = buffer + size - 1;
+  p = Append(buffer, end, translated, _tcslen(translated));
+  p = Append(p, end, s, _tcslen(s));
+  *p = _T('\0');
+
+  expanded.visible = true;
+  expanded.enabled = !invalid;
+  expanded.text = buffer;
+  return expanded;
 }
@@ -0,0 +1,199 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_MENU_EXPAND_MACROS_HPP
+#define XCSOAR_MENU_EXPAND_MACROS_HPP
+
+#include "Menu/ButtonLabel.hpp"
+#include "Util/Serial.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <tchar.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A snapshot of everything the menu label macros look at, split into
+ * groups.  Each group has a #Serial which is incremented whenever
+ * the group's values change, so a label needs to be expanded again
+ * only if one of the groups it depends on has a new serial.
+ */
+struct MacroInputs {
+  enum Group {
+    /** the task manager state; collecting it requires a lease */
+    TASK,
+    CALCULATED,
+    BASIC,
+    COMPUTER_SETTINGS,
+    MAP_SETTINGS,
+    UI,
+    PAGES,
+    /** global objects: airspaces, waypoints, devices, logger, window */
+    ENVIRONMENT,
+    NUM_GROUPS
+  };
+
+  struct TaskInputs {
+    /** is there a task manager at all? */
+    bool available;
+
+    bool abort, go_to;
+
+    /** does the active task exist and pass CheckTask()? */
+    bool active_valid;
+
+    /** IsValidTaskPoint() of the active task at offset -2, -1, 1, 2 */
+    bool previous2, previous, next, next2;
+
+    /** CheckTask() of the ordered task; only collected in goto mode */
+    bool ordered_valid;
+
+    unsigned char advance_state;
+  } task;
+
+  struct CalculatedInputs {
+    bool task_valid, has_optional_starts, circling, terrain_valid;
+  } calculated;
+
+  struct BasicInputs {
+    bool flarm_available, replay, movement_detected;
+  } basic;
+
+  struct ComputerSettingsInputs {
+    bool auto_mc;
+    unsigned char auto_mc_mode;
+  } computer_settings;
+
+  struct MapSettingsInputs {
+    bool airspace_enable, topography_enabled, terrain_enable;
+    bool auto_zoom_enabled;
+    unsigned char trail_length, airspace_altitude_mode, label_selection;
+  } map_settings;
+
+  struct UIInputs {
+    bool auxiliary_enabled, flarm_gauge;
+    unsigned char force_display_mode;
+  } ui;
+
+  struct PagesInputs {
+    TCHAR next_page_name[30];
+  } pages;
+
+  struct EnvironmentInputs {
+    bool airspaces_empty, waypoints_empty, vega, logger_active;
+    bool full_screen;
+  } environment;
+
+  Serial serials[NUM_GROUPS];
+
+  MacroInputs();
+
+  /**
+   * Collect the current values of the specified groups, and
+   * increment the serials of those which have changed.
+   *
+   * @param groups a bit mask of #Group values
+   */
+  void Update(unsigned groups);
+
+  /**
+   * Has any of the specified groups changed since the serials in
+   * #seen were copied?
+   */
+  gcc_pure
+  bool Changed(const Serial *seen, unsigned groups) const {
+    for (unsigned i = 0; i < NUM_GROUPS; ++i)
+      if ((groups & (1 << i)) != 0 && seen[i] != serials[i])
+        return true;
+
+    return false;
+  }
+};
+
+/**
+ * A menu label which has been parsed into literal text and macro
+ * tokens.  Parsing is done once; expanding it afterwards does not
+ * search the text, and the macros only read a #MacroInputs snapshot.
+ */
+class LabelTemplate : private NonCopyable {
+  enum {
+    MAX_TOKENS = 16,
+    LITERAL = 0xff,
+  };
+
+  struct Token {
+    const TCHAR *text;
+    unsigned short length;
+
+    /** the macro id, or #LITERAL */
+    unsigned char macro;
+  };
+
+  /**
+   * The label this was parsed from.  The tokens point into it, so it
+   * must not be freed while this object is in use.
+   */
+  const TCHAR *source;
+
+  /**
+   * The length of the text before the first macro (without trailing
+   * whitespace), which gets translated as a whole.
+   */
+  unsigned prefix_length;
+
+  Token tokens[MAX_TOKENS];
+  unsigned num_tokens;
+
+  /** a bit mask of the macros used by this label */
+  uint64_t macros;
+
+  /** a bit mask of the #MacroInputs::Group values used by this label */
+  unsigned dependencies;
+
+public:
+  LabelTemplate():source(NULL), num_tokens(0), macros(0), dependencies(0) {}
+
+  void Parse(const TCHAR *text);
+
+  const TCHAR *GetSource() const {
+    return source;
+  }
+
+  bool IsDynamic() const {
+    return macros != 0;
+  }
+
+  unsigned GetDependencies() const {
+    return dependencies;
+  }
+
+  /**
+   * Expand the macros and translate the label.  The groups returned
+   * by GetDependencies() must have been collected in #inputs.
+   */
+  ButtonLabel::Expanded Expand(const MacroInputs &inputs,
+                               TCHAR *buffer, size_t size) const;
+};
+
+#endif
@@ -25,6 +25,8 @@ Copyright_License {
 #include "DeviceBlackboard.hpp"
 #include "Protection.hpp"
 #include "NMEA/MoreData.hpp"
+#include "Tracing/Tracing.hpp"
+#include "Telemetry/Telemetry.hpp"
 
 MergeThread::MergeThread(DeviceBlackboard &_device_blackboard)
   :WorkerThread(150, 50, 20),
@@ -56,6 +58,10 @@ MergeThread::Process()
 void
 MergeThread::Tick()
 {
+  Tracing::SetThreadName("MergeThread");
+  TRACE_SPAN("MergeThread::Tick");
+  ScopeTelemetryCycle telemetry_cycle(Telemetry::MERGE_THREAD);
+
   ScopeLock protect(device_blackboard.mutex);
 
   Process();
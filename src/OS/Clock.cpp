@@ -60,6 +60,38 @@ MonotonicClockMS()
 #endif /* !HAVE_POSIX */
 }
 
+uint64_t
+MonotonicClockUS()
+{
+#if defined(HAVE_POSIX) && !defined(__CYGWIN__)
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#elif defined(__APPLE__) /* OS X does not define CLOCK_MONOTONIC */
+  static mach_timebase_info_data_t base;
+  if (base.denom == 0)
+    (void)mach_timebase_info(&base);
+
+  return (mach_absolute_time() * base.numer) / (1000 * base.denom);
+#else
+  /* we have no monotonic clock, fall back to gettimeofday() */
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+#else /* !HAVE_POSIX */
+  LARGE_INTEGER frequency, count;
+  if (!::QueryPerformanceFrequency(&frequency) ||
+      !::QueryPerformanceCounter(&count))
+    return (uint64_t)::GetTickCount() * 1000;
+
+  /* split the division to avoid an overflow */
+  const uint64_t f = frequency.QuadPart, c = count.QuadPart;
+  return c / f * 1000000 + c % f * 1000000 / f;
+#endif /* !HAVE_POSIX */
+}
+
 int
 GetSystemUTCOffset()
 {
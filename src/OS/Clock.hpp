@@ -26,6 +26,8 @@ Copyright_License {
 
 #include "Compiler.h"
 
+#include <stdint.h>
+
 /**
  * Returns the value of a monotonic clock in milliseconds.
  */
@@ -33,6 +35,15 @@ gcc_pure
 unsigned
 MonotonicClockMS();
 
+/**
+ * Returns the value of a monotonic clock in microseconds.  This is
+ * meant for measuring short durations, e.g. in benchmarks.  It is
+ * not declared "pure", because the compiler would then be allowed to
+ * merge two calls around the code being measured.
+ */
+uint64_t
+MonotonicClockUS();
+
 /**
  * Query the UTC offset from the OS.
  *
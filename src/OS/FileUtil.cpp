@@ -308,3 +308,27 @@ File::Exists(const TCHAR* path)
     (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
 #endif
 }
+
+bool
+File::GetInfo(const TCHAR *path, uint64_t &mtime, uint64_t &size)
+{
+#ifdef HAVE_POSIX
+  struct stat st;
+  if (stat(NarrowPathName(path), &st) != 0 || !S_ISREG(st.st_mode))
+    return false;
+
+  mtime = st.st_mtime;
+  size = st.st_size;
+  return true;
+#else
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!GetFileAttributesEx(path, GetFileExInfoStandard, &data) ||
+      (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    return false;
+
+  mtime = data.ftLastWriteTime.dwLowDateTime |
+    ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32);
+  size = data.nFileSizeLow | ((uint64_t)data.nFileSizeHigh << 32);
+  return true;
+#endif
+}
@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_OS_FILEUTIL_HPP
 
 #include <tchar.h>
+#include <stdint.h>
 
 #ifdef HAVE_POSIX
 #include <unistd.h>
@@ -93,6 +94,14 @@ namespace File
    */
   bool Exists(const TCHAR* path);
 
+  /**
+   * Determine the modification time stamp and the size of a regular
+   * file.  The unit of the time stamp depends on the platform; it may
+   * only be compared with other values returned by this function.
+   * @return false if the file does not exist or is not a regular file
+   */
+  bool GetInfo(const TCHAR *path, uint64_t &mtime, uint64_t &size);
+
   /**
    * Deletes the given file
    * @param path Path to the file that should be deleted
@@ -26,6 +26,8 @@ Copyright_License {
 #include "Math/Angle.hpp"
 #include "Screen/Layout.hpp"
 
+#include <algorithm>
+
 Projection::Projection() :
   geo_location(Angle::Zero(), Angle::Zero()),
   screen_rotation(Angle::Zero())
@@ -77,6 +79,23 @@ Projection::GeoToScreen(const GeoPoint &g) const
   return sc;
 }
 
+fixed
+Projection::GetTranslationError(Angle longitude_shift,
+                                Angle south, Angle north) const
+{
+  const fixed reference_cos = geo_location.latitude.fastcosine();
+
+  /* the cosine is largest at the equator and decreases towards both
+     poles */
+  const fixed min_cos = std::min(south.fastcosine(), north.fastcosine());
+  const fixed max_cos = south < Angle::Zero() && north > Angle::Zero()
+    ? fixed_one
+    : std::max(south.fastcosine(), north.fastcosine());
+
+  return AngleToPixels(longitude_shift) *
+    std::max(max_cos - reference_cos, reference_cos - min_cos);
+}
+
 void 
 Projection::SetScale(const fixed _scale)
 {
@@ -132,6 +132,24 @@ public:
   gcc_pure
   RasterPoint GeoToScreen(const GeoPoint &g) const;
 
+  /**
+   * Screen coordinates obtained from this object may be moved to a
+   * projection with the same scale and rotation, but a different
+   * GeoLocation, by adding the screen offset of the old GeoLocation.
+   * That offset scales longitude differences with the cosine of the
+   * GeoLocation's latitude, while GeoToScreen() uses the cosine of
+   * each point's own latitude.  This function returns the maximum
+   * resulting error (in pixels, not counting integer rounding).
+   *
+   * @param longitude_shift the (non-negative) longitude difference
+   * between the old and the new GeoLocation
+   * @param south the southern limit of the moved points
+   * @param north the northern limit of the moved points
+   */
+  gcc_pure
+  fixed GetTranslationError(Angle longitude_shift,
+                            Angle south, Angle north) const;
+
   /**
    * Returns the origin/rotation center in screen coordinates
    * @return The origin/rotation center in screen coordinates
@@ -30,6 +30,7 @@ Copyright_License {
 #include "CalculationThread.hpp"
 #include "MergeThread.hpp"
 #include "DrawThread.hpp"
+#include "Task/TaskStore.hpp"
 
 #include <assert.h>
 
@@ -53,9 +54,39 @@ void TriggerGPSUpdate()
   calculation_thread->Trigger();
 }
 
+/**
+ * See SetUIUpdateDecimation().  These are not protected by a mutex: a
+ * race only affects which of the updates gets dropped.
+ */
+static unsigned ui_update_decimation = 1;
+static unsigned vario_update_count, calculated_update_count;
+
+void
+SetUIUpdateDecimation(unsigned n)
+{
+  assert(n > 0);
+
+  ui_update_decimation = n;
+  vario_update_count = calculated_update_count = 0;
+}
+
+/**
+ * @return true if this update shall be passed to the main window
+ */
+static bool
+CheckUIUpdateDecimation(unsigned &count)
+{
+  if (++count < ui_update_decimation)
+    return false;
+
+  count = 0;
+  return true;
+}
+
 void TriggerVarioUpdate()
 {
-  CommonInterface::main_window.SendGPSUpdate();
+  if (CheckUIUpdateDecimation(vario_update_count))
+    CommonInterface::main_window.SendGPSUpdate();
 }
 
 void
@@ -67,7 +98,8 @@ TriggerMapUpdate()
 void
 TriggerCalculatedUpdate()
 {
-  CommonInterface::main_window.SendCalculatedUpdate();
+  if (CheckUIUpdateDecimation(calculated_update_count))
+    CommonInterface::main_window.SendCalculatedUpdate();
 }
 
 #include "DeviceBlackboard.hpp"
@@ -103,6 +135,10 @@ SuspendAllThreads()
 
   CommonInterface::main_window.SuspendThreads();
   calculation_thread->Suspend();
+
+  /* the task index scanner reads the waypoint database; it is not
+     resumed, the task list keeps the result of the previous scan */
+  TaskStore::CancelBackgroundScan();
 }
 
 void
@@ -50,6 +50,14 @@ TriggerMapUpdate();
 void
 TriggerCalculatedUpdate();
 
+/**
+ * Pass only every nth vario and calculated update to the main window
+ * (1 passes all of them).  This is used by the max-speed replay,
+ * which produces far more updates than the screen can draw.
+ */
+void
+SetUIUpdateDecimation(unsigned n);
+
 void CreateCalculationThread(void);
 
 // changed only in config or by user interface
@@ -59,6 +59,14 @@ public:
 
   bool DrawSpotHeights(Canvas& canvas, LabelBlock& block);
 
+  /**
+   * Returns the sun azimuth relative to the screen, as calculated by
+   * SetSunAngle().
+   */
+  Angle GetSunAzimuth() const {
+    return sun_azimuth;
+  }
+
   void SetSunAngle(const WindowProjection &projection,
                    const TerrainRendererSettings &settings,
                    const NMEAInfo &basic, const DerivedInfo &calculated);
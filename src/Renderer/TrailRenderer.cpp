@@ -34,6 +34,8 @@ Copyright_License {
 
 #include <algorithm>
 
+#include <assert.h>
+
 using std::min;
 using std::max;
 
@@ -77,6 +79,232 @@ GetSnailColorIndex(fixed cv)
                            (short)((cv + fixed_one) / 2 * TrailLook::NUMSNAILCOLORS)));
 }
 
+void
+TrailRenderer::SyncSnail(const TraceComputer &trace_computer)
+{
+  if (!trace_computer.LockedSyncTo(snail, snail_append_serial,
+                                   snail_modify_serial)) {
+    /* the trace was cleared or optimised; all cached data refers to
+       points that may be gone */
+    snail_colours_valid = 0;
+    snail_range_end = 0;
+    projected_valid = false;
+  }
+
+  snail_colours.resize(snail.size());
+}
+
+gcc_pure
+static fixed
+GetSnailValue(const TracePoint &point, SnailType type)
+{
+  return type == stAltitude ? point.GetAltitude() : point.GetVario();
+}
+
+void
+TrailRenderer::UpdateSnailColours(unsigned begin, SnailType type)
+{
+  const unsigned end = snail.size();
+  assert(begin < end);
+
+  const fixed old_min = snail_value_min, old_max = snail_value_max;
+
+  if (snail_range_end == 0 || begin < snail_range_begin ||
+      type != snail_range_type) {
+    /* start from scratch */
+    snail_max_queue.clear();
+    snail_min_queue.clear();
+    snail_range_end = begin;
+    snail_colours_valid = begin;
+  }
+
+  /* drop the points which have fallen off the trail */
+  while (!snail_max_queue.empty() && snail_max_queue.front() < begin)
+    snail_max_queue.pop_front();
+  while (!snail_min_queue.empty() && snail_min_queue.front() < begin)
+    snail_min_queue.pop_front();
+
+  /* add the new points */
+  for (unsigned i = max(snail_range_end, begin); i < end; ++i) {
+    const fixed value = GetSnailValue(snail[i], type);
+
+    while (!snail_max_queue.empty() &&
+           GetSnailValue(snail[snail_max_queue.back()], type) <= value)
+      snail_max_queue.pop_back();
+    snail_max_queue.push_back(i);
+
+    while (!snail_min_queue.empty() &&
+           GetSnailValue(snail[snail_min_queue.back()], type) >= value)
+      snail_min_queue.pop_back();
+    snail_min_queue.push_back(i);
+  }
+
+  const fixed window_max = GetSnailValue(snail[snail_max_queue.front()], type);
+  const fixed window_min = GetSnailValue(snail[snail_min_queue.front()], type);
+
+  if (type == stAltitude) {
+    snail_value_max = max(fixed(1000), window_max);
+    snail_value_min = min(fixed(500), window_min);
+  } else {
+    snail_value_max = min(fixed(7.5), max(fixed(0.75), window_max));
+    snail_value_min = max(fixed(-5.0), min(fixed(-2.0), window_min));
+  }
+
+  snail_range_begin = begin;
+  snail_range_end = end;
+  snail_range_type = type;
+
+  if (snail_value_min != old_min || snail_value_max != old_max ||
+      snail_colours_valid < begin)
+    snail_colours_valid = begin;
+
+  for (unsigned i = snail_colours_valid; i < end; ++i) {
+    const TracePoint &point = snail[i];
+
+    if (type == stAltitude) {
+      unsigned index((point.GetAltitude() - snail_value_min)
+                     / (snail_value_max - snail_value_min)
+                     * (TrailLook::NUMSNAILCOLORS - 1));
+      snail_colours[i] = max(0u, min(TrailLook::NUMSNAILCOLORS - 1, index));
+    } else {
+      const fixed colour_vario = negative(point.GetVario())
+        ? - point.GetVario() / snail_value_min
+        : point.GetVario() / snail_value_max;
+      snail_colours[i] = GetSnailColorIndex(colour_vario);
+    }
+  }
+
+  snail_colours_valid = end;
+}
+
+bool
+TrailRenderer::CanReuseProjectedSnail(const WindowProjection &projection,
+                                      unsigned begin, bool enable_traildrift,
+                                      const SpeedVector wind,
+                                      fixed time) const
+{
+  if (!projected_valid || begin < projected_begin ||
+      projection.GetScale() != projected_projection.GetScale() ||
+      projection.GetScreenAngle() != projected_projection.GetScreenAngle() ||
+      enable_traildrift != projected_drift_enabled)
+    return false;
+
+  if (!projected_bounds.IsInside(projection.GetScreenBounds()))
+    /* the map was moved too far away */
+    return false;
+
+  if (enable_traildrift &&
+      (wind.bearing != projected_wind.bearing ||
+       wind.norm != projected_wind.norm ||
+       time < projected_time ||
+       (time - projected_time) * wind.norm >
+       projection.GetScreenWidthMeters()))
+    /* the drift offsets applied in Draw() would become too large */
+    return false;
+
+  /* Draw() moves all points with the offset of the reference point
+     (and the drift with the drift vector at the reference point);
+     that is only exact at the reference latitude */
+  Angle shift = Angle::Radians((projection.GetGeoLocation().longitude -
+                                projected_projection.GetGeoLocation().longitude)
+                               .AsDelta().AbsoluteRadians());
+  Angle south = projected_bounds.south, north = projected_bounds.north;
+  if (enable_traildrift) {
+    /* the drift factor is at most one */
+    const fixed dt = time - projected_time;
+    shift = shift +
+      Angle::Radians(dt * projected_drift.longitude.AbsoluteRadians());
+    const Angle dlat =
+      Angle::Radians(dt * projected_drift.latitude.AbsoluteRadians());
+    south = south - dlat;
+    north = north + dlat;
+  }
+
+  if (projected_projection.GetTranslationError(shift, south,
+                                               north) > fixed_one)
+    return false;
+
+  return true;
+}
+
+void
+TrailRenderer::UpdateProjectedSnail(const WindowProjection &projection,
+                                    unsigned begin, bool enable_traildrift,
+                                    const GeoPoint traildrift,
+                                    const SpeedVector wind, fixed time)
+{
+  if (!CanReuseProjectedSnail(projection, begin, enable_traildrift,
+                              wind, time)) {
+    projected.clear();
+    projected_valid = true;
+    projected_begin = projected_end = begin;
+    projected_gap = true;
+    projected_projection = projection;
+    projected_bounds = projection.GetScreenBounds().Scale(fixed_four);
+    projected_drift_enabled = enable_traildrift;
+    projected_wind = wind;
+    projected_drift = traildrift;
+    projected_time = time;
+  }
+
+  /* trim points which have fallen off the trail */
+  if (begin > projected_begin) {
+    while (!projected.empty() && projected.front().index < begin)
+      projected.pop_front();
+
+    if (!projected.empty())
+      projected.front().gap = true;
+
+    projected_begin = begin;
+    if (projected_end < begin) {
+      projected_end = begin;
+      projected_gap = true;
+    }
+  }
+
+  /* append new points */
+  const unsigned end = snail.size();
+  for (unsigned i = projected_end; i < end; ++i) {
+    const TracePoint &point = snail[i];
+    const GeoPoint gp = projected_drift_enabled
+      ? point.get_location().Parametric(projected_drift,
+                                        point.CalculateDrift(projected_time))
+      : point.get_location();
+    if (!projected_bounds.IsInside(gp)) {
+      /* the point is outside of the MapWindow; don't paint it */
+      projected_gap = true;
+      continue;
+    }
+
+    if (!projected_gap) {
+      /* level of detail: skip points which are closer than 3 pixels
+         to the previous one, before projecting them */
+      const GeoPoint d = gp - projected_last;
+      const fixed dx = projected_projection.AngleToPixels(d.longitude)
+        * gp.latitude.fastcosine();
+      const fixed dy = projected_projection.AngleToPixels(d.latitude);
+      if (dx * dx + dy * dy < fixed(9))
+        continue;
+    }
+
+    ProjectedPoint p;
+    p.point = projected_projection.GeoToScreen(gp);
+    p.index = i;
+    p.gap = projected_gap;
+    projected.push_back(p);
+    projected_last = gp;
+    projected_gap = false;
+  }
+
+  projected_end = end;
+}
+
+struct TracePointTimeLess {
+  bool operator()(const TracePoint &point, unsigned time) const {
+    return point.GetTime() < time;
+  }
+};
+
 void
 TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
                     const WindowProjection &projection, unsigned min_time,
@@ -87,7 +315,12 @@ TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
   if (settings.trail_length == TRAIL_OFF)
     return;
 
-  if (!LoadTrace(trace_computer, min_time, projection))
+  SyncSnail(trace_computer);
+
+  const unsigned begin =
+    std::lower_bound(snail.begin(), snail.end(), min_time,
+                     TracePointTimeLess()) - snail.begin();
+  if (begin >= snail.size())
     return;
 
   if (!calculated.wind_available)
@@ -101,69 +334,77 @@ TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
     traildrift = basic.location - tp1;
   }
 
-  fixed value_max, value_min;
+  UpdateSnailColours(begin, settings.snail_type);
+  UpdateProjectedSnail(projection, begin, enable_traildrift, traildrift,
+                       calculated.wind, basic.time);
 
-  if (settings.snail_type == stAltitude) {
-    value_max = fixed(1000);
-    value_min = fixed(500);
-    for (auto it = trace.begin(); it != trace.end(); ++it) {
-      value_max = max(it->GetAltitude(), value_max);
-      value_min = min(it->GetAltitude(), value_min);
-    }
-  } else {
-    value_max = fixed(0.75);
-    value_min = fixed(-2.0);
-    for (auto it = trace.begin(); it != trace.end(); ++it) {
-      value_max = max(it->GetVario(), value_max);
-      value_min = min(it->GetVario(), value_min);
-    }
-    value_max = min(fixed(7.5), value_max);
-    value_min = max(fixed(-5.0), value_min);
+  if (projected.empty())
+    return;
+
+  /* translate the cached points to the current projection */
+  const GeoPoint &reference = projected_projection.GetGeoLocation();
+  const RasterPoint reference_pt = projection.GeoToScreen(reference);
+  const int offset_x = reference_pt.x - projected_projection.GetScreenOrigin().x;
+  const int offset_y = reference_pt.y - projected_projection.GetScreenOrigin().y;
+
+  /* the screen vector of 1000 seconds of full drift; the drift which
+     has accumulated since the cache was built is added to each point
+     according to its drift factor */
+  int drift_x = 0, drift_y = 0;
+  if (projected_drift_enabled) {
+    const RasterPoint drift_pt = projection.GeoToScreen(
+      reference.Parametric(projected_drift, fixed(1000)));
+    drift_x = drift_pt.x - reference_pt.x;
+    drift_y = drift_pt.y - reference_pt.y;
   }
 
   bool scaled_trail = settings.snail_scaling_enabled &&
                       projection.GetMapScale() <= fixed_int_constant(6000);
 
-  const GeoBounds bounds = projection.GetScreenBounds().Scale(fixed_four);
+  const Pen *pens = settings.snail_type != stAltitude && scaled_trail
+    ? look.hpSnailVario
+    : look.hpSnail;
 
-  RasterPoint last_point;
-  bool last_valid = false;
-  for (auto it = trace.begin(), end = trace.end(); it != end; ++it) {
-    const GeoPoint gp = enable_traildrift
-      ? it->get_location().Parametric(traildrift,
-                                      it->CalculateDrift(basic.time))
-      : it->get_location();
-    if (!bounds.IsInside(gp)) {
-      /* the point is outside of the MapWindow; don't paint it */
-      last_valid = false;
-      continue;
+  /* draw runs of equally coloured segments as one polyline each */
+  points.GrowDiscard(projected.size());
+
+  unsigned n = 0;
+  unsigned colour = 0;
+  for (auto it = projected.begin(), end = projected.end(); it != end; ++it) {
+    const unsigned point_colour = snail_colours[it->index];
+
+    if (n >= 2 && (it->gap || point_colour != colour)) {
+      canvas.Select(pens[colour]);
+      canvas.DrawPolyline(points.begin(), n);
+
+      points[0] = points[n - 1];
+      n = 1;
     }
 
-    RasterPoint pt = projection.GeoToScreen(gp);
-
-    if (last_valid) {
-      if (settings.snail_type == stAltitude) {
-        unsigned index((it->GetAltitude() - value_min) / (value_max - value_min)
-                       * (TrailLook::NUMSNAILCOLORS - 1));
-        index = max(0u, min(TrailLook::NUMSNAILCOLORS - 1, index));
-        canvas.Select(look.hpSnail[index]);
-      } else {
-        const fixed colour_vario = negative(it->GetVario())
-          ? - it->GetVario() / value_min
-          : it->GetVario() / value_max ;
-
-        if (!scaled_trail)
-          canvas.Select(look.hpSnail[GetSnailColorIndex(colour_vario)]);
-        else
-          canvas.Select(look.hpSnailVario[GetSnailColorIndex(colour_vario)]);
-      }
-      canvas.line_piece(last_point, pt);
+    if (it->gap)
+      n = 0;
+
+    RasterPoint pt = it->point;
+    pt.x += offset_x;
+    pt.y += offset_y;
+
+    if (projected_drift_enabled) {
+      const TracePoint &point = snail[it->index];
+      const fixed drift = point.CalculateDrift(basic.time) -
+        point.CalculateDrift(projected_time);
+      pt.x += (int)(drift * drift_x / 1000);
+      pt.y += (int)(drift * drift_y / 1000);
     }
-    last_point = pt;
-    last_valid = true;
+
+    colour = point_colour;
+    points[n++] = pt;
   }
 
-  canvas.line(last_point, pos);
+  canvas.Select(pens[colour]);
+  if (n >= 2)
+    canvas.DrawPolyline(points.begin(), n);
+
+  canvas.line(points[n - 1], pos);
 }
 
 void
@@ -25,18 +25,28 @@ Copyright_License {
 #define XCSOAR_TRAIL_RENDERER_HPP
 
 #include "Util/AllocatedArray.hpp"
+#include "Util/Serial.hpp"
 #include "Screen/Point.hpp"
 #include "Engine/Navigation/TracePoint.hpp"
+#include "Engine/Navigation/GeoPoint.hpp"
+#include "Engine/Navigation/SpeedVector.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Projection/Projection.hpp"
+#include "Math/Angle.hpp"
+#include "MapSettings.hpp"
+
+#include <deque>
+#include <vector>
+
+#include <stdint.h>
 
 class Canvas;
 class TraceComputer;
-class Projection;
 class WindowProjection;
 class ContestTraceVector;
 struct TrailLook;
 struct NMEAInfo;
 struct DerivedInfo;
-struct MapSettings;
 
 class TrailRenderer {
   const TrailLook &look;
@@ -44,8 +54,122 @@ class TrailRenderer {
   TracePointVector trace;
   AllocatedArray<RasterPoint> points;
 
+  /**
+   * A persistent copy of the full trace for the snail trail.  It is
+   * updated incrementally with TraceComputer::LockedSyncTo(), so a
+   * frame only copies the fixes that were appended since the last
+   * one.
+   */
+  TracePointVector snail;
+  Serial snail_append_serial, snail_modify_serial;
+
+  /**
+   * The snail colour index of each point in #snail, relative to the
+   * value range in #snail_value_min and #snail_value_max.  Only the
+   * first #snail_colours_valid elements are up to date.
+   */
+  std::vector<uint8_t> snail_colours;
+  unsigned snail_colours_valid;
+
+  /**
+   * The altitude or vario range of the visible part of the trail,
+   * which starts at #snail_range_begin and ends at
+   * #snail_range_end.
+   */
+  fixed snail_value_min, snail_value_max;
+  unsigned snail_range_begin, snail_range_end;
+  SnailType snail_range_type;
+
+  /**
+   * Indices of #snail points in the visible range with decreasing
+   * (#snail_max_queue) and increasing (#snail_min_queue) values.
+   * The front is the maximum/minimum of the range.  When the start
+   * of the trail moves, only the dropped points are removed, instead
+   * of scanning the whole range again.
+   */
+  std::deque<unsigned> snail_max_queue, snail_min_queue;
+
+  /**
+   * The snail points projected with #projected_projection (the
+   * projection that was active when the cache was started), thinned
+   * to at least 3 pixels apart before projecting them.
+   *
+   * The cache survives map movement: it depends only on scale,
+   * rotation and wind, and the translation to the current projection
+   * is applied as an offset while drawing.  With trail drift, each
+   * point additionally moves along the drift vector by its own drift
+   * factor, which is also applied while drawing.  New fixes are
+   * appended at the end, and points which are older than the trail
+   * length are trimmed at the front.
+   *
+   * The cache is rebuilt when the scale, the rotation or the wind
+   * changes, when the visible area leaves #projected_bounds, when
+   * the trail drift since #projected_time becomes larger than the
+   * screen, or when the offset may be off by more than one pixel for
+   * some point (see Projection::GetTranslationError()).  Together
+   * with the integer rounding in Projection::GeoToScreen(), a
+   * translated point may be up to three pixels away from where a
+   * fresh projection would put it.
+   */
+  struct ProjectedPoint {
+    RasterPoint point;
+
+    /**
+     * Index into #snail; the colour of the segment ending at this
+     * point is looked up there.
+     */
+    unsigned index;
+
+    /**
+     * Is this the first point after a gap (e.g. a part of the trail
+     * that is outside of the map)?
+     */
+    bool gap;
+  };
+
+  std::deque<ProjectedPoint> projected;
+
+  /**
+   * Is #projected usable at all?  If false, the cache is rebuilt by
+   * the next UpdateProjectedSnail() call.
+   */
+  bool projected_valid;
+
+  /**
+   * The first #snail point that was considered for the cache.
+   */
+  unsigned projected_begin;
+
+  /**
+   * The first #snail point that has not been projected yet.
+   */
+  unsigned projected_end;
+
+  bool projected_gap;
+
+  /**
+   * The (drifted) location of the last point in #projected, used for
+   * thinning.
+   */
+  GeoPoint projected_last;
+
+  Projection projected_projection;
+
+  /**
+   * Points outside of this area were skipped.
+   */
+  GeoBounds projected_bounds;
+
+  bool projected_drift_enabled;
+  SpeedVector projected_wind;
+  GeoPoint projected_drift;
+  fixed projected_time;
+
 public:
-  TrailRenderer(const TrailLook &_look):look(_look) {}
+  TrailRenderer(const TrailLook &_look)
+    :look(_look), snail_colours_valid(0),
+     snail_range_begin(0), snail_range_end(0),
+     projected_valid(false) {}
 
   /**
    * Load the full trace into this object.
@@ -81,6 +205,35 @@ public:
             const ContestTraceVector &trace);
 
 private:
+  /**
+   * Update #snail, and invalidate the caches which depend on points
+   * that have vanished.
+   */
+  void SyncSnail(const TraceComputer &trace_computer);
+
+  /**
+   * Update the colour range and the colour indices of the visible
+   * snail points [begin, #snail.size()).
+   */
+  void UpdateSnailColours(unsigned begin, SnailType type);
+
+  /**
+   * Can #projected be reused for the specified projection?
+   */
+  gcc_pure
+  bool CanReuseProjectedSnail(const WindowProjection &projection,
+                              unsigned begin, bool enable_traildrift,
+                              const SpeedVector wind, fixed time) const;
+
+  /**
+   * Update #projected for the visible snail points [begin,
+   * #snail.size()).
+   */
+  void UpdateProjectedSnail(const WindowProjection &projection,
+                            unsigned begin, bool enable_traildrift,
+                            const GeoPoint traildrift,
+                            const SpeedVector wind, fixed time);
+
   void DrawTraceVector(Canvas &canvas, const Projection &projection,
                        const TracePointVector &trace);
 };
@@ -56,6 +56,14 @@ public:
   const TCHAR* GetFilename();
   void SetFilename(const TCHAR *name);
 
+  /**
+   * Returns the time stamp of the fix which was passed to
+   * on_advance() by the last Update() call.
+   */
+  fixed GetTime() const {
+    return t_simulation;
+  }
+
 protected:
   virtual bool UpdateTime();
   virtual void ResetTime();
@@ -31,13 +31,18 @@
 #include <algorithm>
 
 IgcReplayGlue::IgcReplayGlue(Logger *_logger)
-  :logger(_logger)
+  :logger(_logger), max_speed(false)
 {
 }
 
 bool
 IgcReplayGlue::UpdateTime()
 {
+  if (max_speed) {
+    t_simulation += fixed_one;
+    return true;
+  }
+
   // Allow for poor time slicing, we never get called more
   // than 4 times per second, so this will yield 1 second updates
   if (!clock.check(760))
@@ -36,9 +36,19 @@ class IgcReplayGlue:
 
   Logger *logger;
 
+  /**
+   * If set, then UpdateTime() advances by one second on each call,
+   * instead of following the wall clock.  See #MaxSpeedReplayThread.
+   */
+  bool max_speed;
+
 public:
   IgcReplayGlue(Logger *_logger);
 
+  void SetMaxSpeed(bool _max_speed) {
+    max_speed = _max_speed;
+  }
+
 protected:
   virtual bool UpdateTime();
   virtual void ResetTime();
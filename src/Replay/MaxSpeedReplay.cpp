@@ -0,0 +1,121 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Replay/MaxSpeedReplay.hpp"
+#include "Replay/IgcReplayGlue.hpp"
+#include "MergeThread.hpp"
+#include "CalculationThread.hpp"
+#include "Protection.hpp"
+#include "Components.hpp"
+#include "PeriodClock.hpp"
+#include "LogFile.hpp"
+
+#include <assert.h>
+
+bool
+MaxSpeedReplayThread::Start(unsigned _ui_decimation)
+{
+  assert(!IsDefined());
+  assert(_ui_decimation > 0);
+
+  ui_decimation = _ui_decimation;
+  replay.SetMaxSpeed(true);
+  busy.Set();
+
+  if (!StoppableThread::Start()) {
+    busy.Set(false);
+    replay.SetMaxSpeed(false);
+    return false;
+  }
+
+  return true;
+}
+
+void
+MaxSpeedReplayThread::Stop()
+{
+  if (!IsDefined())
+    return;
+
+  BeginStop();
+  Join();
+
+  replay.SetMaxSpeed(false);
+}
+
+/**
+ * Write the throughput to the log file.
+ */
+static void
+LogFixRate(unsigned num_fixes, unsigned num_timeouts, int elapsed_ms)
+{
+  if (elapsed_ms <= 0)
+    elapsed_ms = 1;
+
+  LogStartUp(_T("Max-speed replay: %u fixes in %d ms (%u fixes/s, %u timeouts)"),
+             num_fixes, elapsed_ms,
+             (unsigned)((unsigned long long)num_fixes * 1000 / elapsed_ms),
+             num_timeouts);
+}
+
+void
+MaxSpeedReplayThread::Run()
+{
+  /* the rate limiting of the worker threads would cap the replay at
+     a few fixes per second */
+  merge_thread->SetThrottled(false);
+  calculation_thread->SetThrottled(false);
+  SetUIUpdateDecimation(ui_decimation);
+
+  PeriodClock clock, report_clock;
+  clock.update();
+  report_clock.update();
+
+  unsigned num_fixes = 0, num_timeouts = 0;
+  while (!CheckStopped() && replay.Update()) {
+    ++num_fixes;
+
+    /* the timeout is a fallback for fixes whose time stamp gets
+       overridden by another device */
+    if (!calculation_thread->WaitFixProcessed(replay.GetTime(), 1000)) {
+      /* log only the first one; LogFixRate() reports the total */
+      if (num_timeouts++ == 0)
+        LogStartUp(_T("Max-speed replay: fix %u was not processed within 1 s"),
+                   num_fixes);
+    }
+
+    if (report_clock.check_update(10000))
+      LogFixRate(num_fixes, num_timeouts, clock.elapsed());
+  }
+
+  LogFixRate(num_fixes, num_timeouts, clock.elapsed());
+
+  SetUIUpdateDecimation(1);
+  calculation_thread->SetThrottled(true);
+  merge_thread->SetThrottled(true);
+
+  /* show the final state */
+  TriggerCalculatedUpdate();
+
+  busy.Set(false);
+}
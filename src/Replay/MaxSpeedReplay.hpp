@@ -0,0 +1,83 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_MAX_SPEED_REPLAY_HPP
+#define XCSOAR_MAX_SPEED_REPLAY_HPP
+
+#include "Thread/StoppableThread.hpp"
+#include "Thread/Flag.hpp"
+
+class IgcReplayGlue;
+
+/**
+ * Runs an IGC replay as fast as the #MergeThread and the
+ * #CalculationThread can consume the fixes, instead of following the
+ * wall clock.  After each fix, it waits until the #CalculationThread
+ * has processed it (back-pressure), so no fix gets skipped.  The
+ * throughput is written to the log file.
+ */
+class MaxSpeedReplayThread : public StoppableThread {
+  IgcReplayGlue &replay;
+
+  /**
+   * Pass only every nth update to the main window.
+   */
+  unsigned ui_decimation;
+
+  /**
+   * Set while Run() is feeding fixes.
+   */
+  Flag busy;
+
+public:
+  MaxSpeedReplayThread(IgcReplayGlue &_replay)
+    :replay(_replay), ui_decimation(1) {}
+
+  /**
+   * Start feeding fixes.  The #IgcReplayGlue must have been started
+   * already.
+   *
+   * @param _ui_decimation draw only every nth fix; 1 draws all of
+   * them
+   */
+  bool Start(unsigned _ui_decimation);
+
+  /**
+   * Stop feeding fixes, and wait for the thread to exit.  The replay
+   * itself is left running.
+   */
+  void Stop();
+
+  /**
+   * Is the replay still running?  Returns false after the end of the
+   * file was reached (the thread must still be stopped with Stop()).
+   */
+  bool IsBusy() const {
+    return busy.Get();
+  }
+
+protected:
+  virtual void Run();
+};
+
+#endif
@@ -31,6 +31,7 @@ Replay::Stop()
 {
   switch (mode) {
   case MODE_IGC:
+    max_speed_thread.Stop();
     igc_replay.Stop();
     break;
   case MODE_NMEA:
@@ -50,7 +51,10 @@ Replay::Start()
 {
   switch (mode) {
   case MODE_IGC:
+    max_speed_thread.Stop();
     igc_replay.Start();
+    if (max_speed)
+      max_speed_thread.Start(ui_decimation);
     break;
   case MODE_NMEA:
     nmea_replay.Start();
@@ -96,6 +100,15 @@ Replay::Update()
 {
   switch (mode) {
   case MODE_IGC:
+    if (max_speed_thread.IsDefined()) {
+      /* the MaxSpeedReplayThread feeds the fixes */
+      if (max_speed_thread.IsBusy())
+        return true;
+
+      max_speed_thread.Stop();
+      return false;
+    }
+
     return igc_replay.Update();
   case MODE_NMEA:
     return nmea_replay.Update();
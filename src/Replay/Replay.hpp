@@ -27,6 +27,7 @@ Copyright_License {
 #include "Replay/IgcReplayGlue.hpp"
 #include "Replay/NmeaReplayGlue.hpp"
 #include "Replay/DemoReplayGlue.hpp"
+#include "Replay/MaxSpeedReplay.hpp"
 
 #include <tchar.h>
 #include <windef.h> /* for MAX_PATH */
@@ -48,11 +49,29 @@ class Replay
   NmeaReplayGlue nmea_replay;
   DemoReplayGlue demo_replay;
 
+  /**
+   * Replay IGC files as fast as the glide computer can process them?
+   */
+  bool max_speed;
+
+  /**
+   * Draw only every nth fix during a max-speed replay.
+   */
+  unsigned ui_decimation;
+
+  MaxSpeedReplayThread max_speed_thread;
+
 public:
   Replay(Logger *_logger, ProtectedTaskManager& task_manager):
     mode(MODE_NULL),
     igc_replay(_logger),
-    demo_replay(task_manager) {}
+    demo_replay(task_manager),
+    max_speed(false), ui_decimation(1),
+    max_speed_thread(igc_replay) {}
+
+  ~Replay() {
+    max_speed_thread.Stop();
+  }
 
   bool Update();
   void Stop();
@@ -62,6 +81,24 @@ public:
 
   fixed GetTimeScale();
   void SetTimeScale(const fixed time_scale);
+
+  bool GetMaxSpeed() const {
+    return max_speed;
+  }
+
+  /**
+   * Enable or disable the max-speed mode, which ignores the time
+   * scale and feeds the fixes of an IGC file as fast as they can be
+   * calculated.  It does not apply to NMEA files and the demo.  The
+   * new setting is used by the next Start() call.
+   *
+   * @param _ui_decimation draw only every nth fix; 1 draws all of
+   * them
+   */
+  void SetMaxSpeed(bool _max_speed, unsigned _ui_decimation=10) {
+    max_speed = _max_speed;
+    ui_decimation = _ui_decimation;
+  }
 };
 
 #endif
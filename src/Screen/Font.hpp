@@ -41,6 +41,9 @@ Copyright_License {
 #include <tchar.h>
 
 class TextUtil;
+#if !defined(ANDROID) && defined(ENABLE_SDL)
+class GlyphAtlas;
+#endif
 
 /**
  * A font loaded from storage.  It is used by #Canvas to draw text.
@@ -55,6 +58,12 @@ protected:
   #else // !ANDROID
   #ifdef ENABLE_SDL
   TTF_Font *font;
+
+  /**
+   * The rendered glyphs of this font; created together with the
+   * #font.
+   */
+  GlyphAtlas *atlas;
   #else
   HFONT font;
   #endif
@@ -73,6 +82,8 @@ protected:
 public:
   #ifdef ANDROID
   Font():text_util_object(NULL) {}
+  #elif defined(ENABLE_SDL)
+  Font():font(NULL), atlas(NULL) {}
   #else
   Font():font(NULL) {}
   #endif
@@ -109,6 +120,11 @@ public:
   Native() const {
     return font;
   }
+
+  GlyphAtlas &
+  GetAtlas() const {
+    return *atlas;
+  }
   #else
   HFONT
   Native() const {
@@ -30,6 +30,10 @@ Copyright_License {
 #include "Util/ListHead.hpp"
 #include "Util/Cache.hpp"
 
+#ifndef ANDROID
+#include "Screen/SDL/GlyphAtlas.hpp"
+#endif
+
 #include <unordered_map>
 #include <string>
 #include <assert.h>
@@ -246,4 +250,8 @@ TextCache::flush()
 
   size_cache.Clear();
   text_cache.Clear();
+
+#ifndef ANDROID
+  GlyphAtlas::FlushTextures();
+#endif
 }
@@ -34,6 +34,11 @@ Copyright_License {
 #include "Screen/OpenGL/Compatibility.hpp"
 #include "Screen/Util.hpp"
 
+#ifndef ANDROID
+#include "Screen/SDL/GlyphAtlas.hpp"
+#endif
+
+#include <algorithm>
 #include <assert.h>
 
 AllocatedArray<RasterPoint> Canvas::vertex_buffer;
@@ -381,6 +386,109 @@ Canvas::DrawFocusRectangle(PixelRect rc)
   DrawOutlineRectangle(rc.left, rc.top, rc.right, rc.bottom, COLOR_DARK_GRAY);
 }
 
+#ifndef ANDROID
+
+/**
+ * Vertex and texture coordinates of the quads of a #GlyphRun, two
+ * triangles per glyph, so the whole string can be drawn with one
+ * glDrawArrays() call per pass.
+ */
+struct GlyphVertices {
+  RasterPoint vertices[GlyphRun::MAX_GLYPHS * 6];
+  GLfloat coords[GlyphRun::MAX_GLYPHS * 6 * 2];
+  unsigned n;
+
+  void Fill(const GlyphRun &run, PixelScalar x, PixelScalar y,
+            UPixelScalar max_width, PixelSize texture_size) {
+    n = 0;
+
+    const PixelScalar clip = x + max_width;
+    const PixelScalar y1 = y + run.height;
+
+    for (unsigned i = 0; i < run.length; ++i) {
+      const GlyphRun::Item &item = run.items[i];
+      const PixelScalar x0 = x + item.x;
+      if (x0 >= clip)
+        continue;
+
+      const UPixelScalar width = std::min(item.width,
+                                          UPixelScalar(clip - x0));
+      const PixelScalar x1 = x0 + width;
+
+      const GLfloat u0 = (GLfloat)item.src_x / texture_size.cx;
+      const GLfloat v0 = (GLfloat)item.src_y / texture_size.cy;
+      const GLfloat u1 = (GLfloat)(item.src_x + width) / texture_size.cx;
+      const GLfloat v1 = (GLfloat)(item.src_y + run.height) / texture_size.cy;
+
+      Add(x0, y, u0, v0);
+      Add(x1, y, u1, v0);
+      Add(x0, y1, u0, v1);
+      Add(x1, y, u1, v0);
+      Add(x1, y1, u1, v1);
+      Add(x0, y1, u0, v1);
+    }
+  }
+
+  void Add(PixelScalar x, PixelScalar y, GLfloat u, GLfloat v) {
+    vertices[n].x = x;
+    vertices[n].y = y;
+    coords[n * 2] = u;
+    coords[n * 2 + 1] = v;
+    ++n;
+  }
+};
+
+/**
+ * Only used in the OpenGL thread; too large for the stack.
+ */
+static GlyphRun glyph_run;
+static GlyphVertices glyph_vertices;
+
+/**
+ * Draw #glyph_run from the font's #GlyphAtlas, with the same passes
+ * as the #TextCache code path.
+ *
+ * @param cut_out cut out the shape in black before drawing the text
+ * color?
+ */
+static void
+DrawGlyphRun(GlyphAtlas &atlas, PixelScalar x, PixelScalar y,
+             UPixelScalar max_width, Color text_color, bool cut_out)
+{
+  GLTexture &texture = atlas.GetTexture();
+
+  glyph_vertices.Fill(glyph_run, x, y, max_width,
+                      texture.GetAllocatedSize());
+  if (glyph_vertices.n == 0)
+    return;
+
+  GLEnable scope(GL_TEXTURE_2D);
+  texture.Bind();
+  GLLogicOp logic_op(GL_AND_INVERTED);
+
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_VALUE, 0, glyph_vertices.vertices);
+  glTexCoordPointer(2, GL_FLOAT, 0, glyph_vertices.coords);
+
+  if (cut_out) {
+    /* cut out the shape in black */
+    OpenGL::glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glDrawArrays(GL_TRIANGLES, 0, glyph_vertices.n);
+  }
+
+  if (text_color != COLOR_BLACK) {
+    /* draw the text color on top */
+    OpenGL::glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    logic_op.set(GL_OR);
+    text_color.Set();
+    glDrawArrays(GL_TRIANGLES, 0, glyph_vertices.n);
+  }
+
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+#endif
+
 void
 Canvas::text(PixelScalar x, PixelScalar y, const TCHAR *text)
 {
@@ -392,6 +500,21 @@ Canvas::text(PixelScalar x, PixelScalar y, const TCHAR *text)
   if (font == NULL)
     return;
 
+#ifndef ANDROID
+  GlyphAtlas &atlas = font->GetAtlas();
+  if (atlas.Layout(text, glyph_run)) {
+    if (background_mode == OPAQUE)
+      /* draw the opaque background */
+      DrawFilledRectangle(x, y, x + glyph_run.width, y + glyph_run.height,
+                          background_color);
+
+    DrawGlyphRun(atlas, x, y, glyph_run.width, text_color,
+                 background_mode != OPAQUE ||
+                 background_color != COLOR_BLACK);
+    return;
+  }
+#endif
+
   GLTexture *texture = TextCache::get(font, text);
   if (texture == NULL)
     return;
@@ -432,6 +555,14 @@ Canvas::text_transparent(PixelScalar x, PixelScalar y, const TCHAR *text)
   if (font == NULL)
     return;
 
+#ifndef ANDROID
+  GlyphAtlas &atlas = font->GetAtlas();
+  if (atlas.Layout(text, glyph_run)) {
+    DrawGlyphRun(atlas, x, y, glyph_run.width, text_color, true);
+    return;
+  }
+#endif
+
   GLTexture *texture = TextCache::get(font, text);
   if (texture == NULL)
     return;
@@ -465,6 +596,14 @@ Canvas::text_clipped(PixelScalar x, PixelScalar y, UPixelScalar width,
   if (font == NULL)
     return;
 
+#ifndef ANDROID
+  GlyphAtlas &atlas = font->GetAtlas();
+  if (atlas.Layout(text, glyph_run)) {
+    DrawGlyphRun(atlas, x, y, width, text_color, true);
+    return;
+  }
+#endif
+
   GLTexture *texture = TextCache::get(font, text);
   if (texture == NULL)
     return;
@@ -39,7 +39,7 @@ RawBitmap::RawBitmap(UPixelScalar nWidth, UPixelScalar nHeight)
   :width(nWidth), height(nHeight),
    corrected_width(CorrectedWidth(nWidth))
 #ifdef ENABLE_OPENGL
-  , texture(new GLTexture(CorrectedWidth(nWidth), nHeight))
+  , texture(NULL)
   , dirty(true)
 #endif
 {
@@ -101,7 +101,11 @@ protected:
   BGRColor *buffer;
 
 #ifdef ENABLE_OPENGL
-  GLTexture *texture;
+  /**
+   * The texture is created on demand in stretch_to(), so the buffer
+   * can be filled without an OpenGL context.
+   */
+  mutable GLTexture *texture;
 
   /**
    * Has the buffer been modified, and needs to be copied into the
@@ -171,6 +175,17 @@ public:
 #endif
   }
 
+  /**
+   * Returns a pointer to the specified row, counting from the top.
+   */
+  BGRColor *GetRow(unsigned y) {
+#ifndef USE_GDI
+    return buffer + y * corrected_width;
+#else
+    return buffer + (height - 1 - y) * corrected_width;
+#endif
+  }
+
   void SetDirty() {
 #ifdef ENABLE_OPENGL
     dirty = true;
@@ -206,6 +221,11 @@ public:
   void stretch_to(UPixelScalar width, UPixelScalar height, Canvas &dest_canvas,
                   UPixelScalar dest_width, UPixelScalar dest_height) const {
 #ifdef ENABLE_OPENGL
+    if (texture == NULL) {
+      texture = new GLTexture(corrected_width, this->height);
+      dirty = true;
+    }
+
     texture->Bind();
 
     if (dirty) {
@@ -35,6 +35,7 @@ Copyright_License {
 
 #ifndef ENABLE_OPENGL
 #include "Screen/Util.hpp"
+#include "Screen/SDL/GlyphAtlas.hpp"
 
 #include <SDL_rotozoom.h>
 #include <SDL_imageFilter.h>
@@ -197,6 +198,42 @@ Canvas::CalcTextSize(const TCHAR *text) const
 
 #ifndef ENABLE_OPENGL
 
+/**
+ * Draw text by copying its glyphs from the font's #GlyphAtlas.
+ *
+ * @param background the color of the opaque background, or NULL for
+ * transparent text
+ * @return false if the text cannot be drawn from the atlas
+ */
+static bool
+DrawFromAtlas(Canvas &canvas, const Font &font,
+              PixelScalar x, PixelScalar y, const TCHAR *text,
+              Color text_color, const Color *background)
+{
+  GlyphAtlas &atlas = font.GetAtlas();
+  ScopeLock protect(atlas.mutex);
+
+  GlyphRun run;
+  if (!atlas.Layout(text, run))
+    return false;
+
+  if (background != NULL)
+    canvas.DrawFilledRectangle(x, y, x + run.width, y + run.height,
+                               *background);
+
+  SDL_Surface *surface = atlas.GetSurface();
+  SDL_Color color = text_color;
+  ::SDL_SetColors(surface, &color, 1, 1);
+
+  for (unsigned i = 0; i < run.length; ++i) {
+    const GlyphRun::Item &item = run.items[i];
+    canvas.copy(x + item.x, y, item.width, run.height,
+                surface, item.src_x, item.src_y);
+  }
+
+  return true;
+}
+
 void
 Canvas::text(PixelScalar x, PixelScalar y, const TCHAR *text)
 {
@@ -205,6 +242,10 @@ Canvas::text(PixelScalar x, PixelScalar y, const TCHAR *text)
   if (font == NULL)
     return;
 
+  if (DrawFromAtlas(*this, *font, x, y, text, text_color,
+                    background_mode == OPAQUE ? &background_color : NULL))
+    return;
+
 #ifdef UNICODE
   s = ::TTF_RenderUNICODE_Solid(font->native(), (const Uint16 *)text,
                                 COLOR_BLACK);
@@ -235,6 +276,9 @@ Canvas::text_transparent(PixelScalar x, PixelScalar y, const TCHAR *text)
   if (font == NULL)
     return;
 
+  if (DrawFromAtlas(*this, *font, x, y, text, text_color, NULL))
+    return;
+
 #ifdef UNICODE
   s = ::TTF_RenderUNICODE_Solid(font->Native(), (const Uint16 *)text,
                                 COLOR_BLACK);
@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "Screen/Font.hpp"
+#include "Screen/SDL/GlyphAtlas.hpp"
 #include "Screen/Debug.hpp"
 #include "OS/FileUtil.hpp"
 #include "Compiler.h"
@@ -110,6 +111,8 @@ Font::_set(const char *file, UPixelScalar ptsize, bool bold, bool italic)
 
   CalculateHeights();
 
+  atlas = new GlyphAtlas(font);
+
   return true;
 }
 
@@ -161,6 +164,9 @@ Font::Reset()
   if (font != NULL) {
     assert(IsScreenInitialized());
 
+    delete atlas;
+    atlas = NULL;
+
     TTF_CloseFont(font);
     font = NULL;
   }
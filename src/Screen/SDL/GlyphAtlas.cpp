@@ -0,0 +1,385 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Screen/SDL/GlyphAtlas.hpp"
+
+#ifdef ENABLE_OPENGL
+#include "Screen/OpenGL/Texture.hpp"
+#endif
+
+#include <algorithm>
+#include <assert.h>
+#include <string.h>
+
+#ifdef ENABLE_OPENGL
+/**
+ * All atlases, for FlushTextures().
+ */
+static ListHead atlases((ListHead::empty()));
+#endif
+
+/**
+ * Decode one UTF-8 character and advance the pointer.  Only the
+ * Basic Multilingual Plane is supported, because that is what the
+ * SDL_ttf glyph functions accept.
+ */
+static bool
+NextCharacter(const char *&p, unsigned &ch)
+{
+  const unsigned char *s = (const unsigned char *)p;
+
+  if (s[0] < 0x80) {
+    ch = s[0];
+    p += 1;
+    return true;
+  }
+
+  if ((s[0] & 0xe0) == 0xc0) {
+    if ((s[1] & 0xc0) != 0x80)
+      return false;
+
+    ch = ((s[0] & 0x1f) << 6) | (s[1] & 0x3f);
+    p += 2;
+    return ch >= 0x80;
+  }
+
+  if ((s[0] & 0xf0) == 0xe0) {
+    if ((s[1] & 0xc0) != 0x80 || (s[2] & 0xc0) != 0x80)
+      return false;
+
+    ch = ((s[0] & 0x0f) << 12) | ((s[1] & 0x3f) << 6) | (s[2] & 0x3f);
+    p += 3;
+    return ch >= 0x800;
+  }
+
+  return false;
+}
+
+static SDL_Surface *
+CreateSurface(unsigned width, unsigned height)
+{
+  SDL_Surface *surface = ::SDL_CreateRGBSurface(SDL_SWSURFACE, width, height,
+                                                8, 0, 0, 0, 0);
+  if (surface == NULL)
+    return NULL;
+
+#ifdef ENABLE_OPENGL
+  /* the pixels are the coverage values of TTF_RenderUNICODE_Shaded();
+     a gray palette lets GLTexture load it as GL_LUMINANCE */
+  SDL_Color palette[0x100];
+  for (unsigned i = 0; i < 0x100; ++i) {
+    palette[i].r = palette[i].g = palette[i].b = i;
+    palette[i].unused = 0;
+  }
+
+  ::SDL_SetColors(surface, palette, 0, 0x100);
+#else
+  /* TTF_RenderUNICODE_Solid() uses 1 for the glyph and 0 for the
+     background; the text color is set in palette entry 1 before
+     copying */
+  ::SDL_SetColorKey(surface, SDL_SRCCOLORKEY, 0);
+#endif
+
+  ::SDL_FillRect(surface, NULL, 0);
+  return surface;
+}
+
+GlyphAtlas::GlyphAtlas(TTF_Font *_font)
+  :font(_font), height(::TTF_FontHeight(_font)),
+   cursor_x(0), cursor_y(0), generation(0)
+#ifdef ENABLE_OPENGL
+  , texture(NULL), dirty(true)
+#endif
+{
+  unsigned initial_height = INITIAL_HEIGHT;
+  while (initial_height < height && initial_height < MAX_HEIGHT)
+    initial_height <<= 1;
+
+  surface = CreateSurface(WIDTH, initial_height);
+
+  std::fill(latin1, latin1 + 0x100, Glyph());
+
+#ifdef ENABLE_OPENGL
+  InsertAfter(atlases);
+#endif
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+#ifdef ENABLE_OPENGL
+  Remove();
+  delete texture;
+#endif
+
+  if (surface != NULL)
+    ::SDL_FreeSurface(surface);
+}
+
+void
+GlyphAtlas::Clear()
+{
+  ++generation;
+
+  std::fill(latin1, latin1 + 0x100, Glyph());
+  glyphs.clear();
+
+  cursor_x = cursor_y = 0;
+  ::SDL_FillRect(surface, NULL, 0);
+
+#ifdef ENABLE_OPENGL
+  dirty = true;
+#endif
+}
+
+bool
+GlyphAtlas::Grow()
+{
+  const unsigned old_height = surface->h;
+  if (old_height * 2 > MAX_HEIGHT)
+    return false;
+
+  SDL_Surface *new_surface = CreateSurface(WIDTH, old_height * 2);
+  if (new_surface == NULL)
+    return false;
+
+  /* both surfaces have the same width and format, so the pitch is
+     the same */
+  assert(new_surface->pitch == surface->pitch);
+  memcpy(new_surface->pixels, surface->pixels,
+         surface->pitch * old_height);
+
+  ::SDL_FreeSurface(surface);
+  surface = new_surface;
+
+#ifdef ENABLE_OPENGL
+  dirty = true;
+#endif
+  return true;
+}
+
+const GlyphAtlas::Glyph *
+GlyphAtlas::LookupGlyph(unsigned ch) const
+{
+  if (ch < 0x100)
+    return latin1[ch].IsDefined() ? &latin1[ch] : NULL;
+
+  auto i = glyphs.find(ch);
+  return i != glyphs.end() ? &i->second : NULL;
+}
+
+const GlyphAtlas::Glyph *
+GlyphAtlas::GetGlyph(unsigned ch)
+{
+  const Glyph *cached = LookupGlyph(ch);
+  if (cached != NULL)
+    return cached;
+
+  if (surface == NULL)
+    return NULL;
+
+  int minx, maxx, miny, maxy, advance;
+  if (::TTF_GlyphMetrics(font, (Uint16)ch, &minx, &maxx, &miny, &maxy,
+                         &advance) != 0)
+    return NULL;
+
+  /* render the glyph just like SDL_ttf would render a string
+     consisting only of this character */
+  const Uint16 text[2] = { (Uint16)ch, 0 };
+  static const SDL_Color white = { 0xff, 0xff, 0xff, 0 };
+#ifdef ENABLE_OPENGL
+  static const SDL_Color black = { 0, 0, 0, 0 };
+  SDL_Surface *rendered = ::TTF_RenderUNICODE_Shaded(font, text, white, black);
+#else
+  SDL_Surface *rendered = ::TTF_RenderUNICODE_Solid(font, text, white);
+#endif
+  if (rendered == NULL)
+    return NULL;
+
+  assert(rendered->format->BytesPerPixel == 1);
+
+  const unsigned width = rendered->w;
+  const unsigned rows = std::min((unsigned)rendered->h, (unsigned)height);
+  if (width > WIDTH) {
+    ::SDL_FreeSurface(rendered);
+    return NULL;
+  }
+
+  /* find a place in the atlas */
+
+  if (cursor_x + width > WIDTH) {
+    cursor_x = 0;
+    cursor_y += height;
+  }
+
+  if (cursor_y + height > (unsigned)surface->h && !Grow()) {
+    Clear();
+
+    if (height > (unsigned)surface->h) {
+      ::SDL_FreeSurface(rendered);
+      return NULL;
+    }
+  }
+
+  const Uint8 *src = (const Uint8 *)rendered->pixels;
+  Uint8 *dest = (Uint8 *)surface->pixels + cursor_y * surface->pitch
+    + cursor_x;
+  for (unsigned row = 0; row < rows; ++row) {
+    memcpy(dest, src, width);
+    src += rendered->pitch;
+    dest += surface->pitch;
+  }
+
+  ::SDL_FreeSurface(rendered);
+
+  Glyph glyph;
+  glyph.x = cursor_x;
+  glyph.y = cursor_y;
+  glyph.width = width;
+  glyph.offset = std::min(minx, 0);
+  glyph.advance = advance;
+  glyph.right = std::max(advance, maxx);
+
+  cursor_x += width;
+
+#ifdef ENABLE_OPENGL
+  dirty = true;
+#endif
+
+  if (ch < 0x100) {
+    latin1[ch] = glyph;
+    return &latin1[ch];
+  }
+
+  return &(glyphs[ch] = glyph);
+}
+
+PixelScalar
+GlyphAtlas::GetKerning(unsigned a, const Glyph &ga,
+                       unsigned b, const Glyph &gb)
+{
+  const unsigned key = (a << 16) | b;
+  auto i = kerning.find(key);
+  if (i != kerning.end())
+    return i->second;
+
+  /* SDL_ttf has no public API for the kerning of a character pair;
+     derive it from the width of the pair as SDL_ttf lays it out,
+     which also includes the bold overhang */
+  const Uint16 text[3] = { (Uint16)a, (Uint16)b, 0 };
+  int width, _height;
+  PixelScalar value = 0;
+  if (::TTF_SizeUNICODE(font, text, &width, &_height) == 0)
+    value = width + ga.offset - ga.advance - gb.right;
+
+  if (kerning.size() >= MAX_KERNING_PAIRS)
+    kerning.clear();
+
+  kerning.insert(std::make_pair(key, value));
+  return value;
+}
+
+bool
+GlyphAtlas::Layout(const char *text, GlyphRun &run)
+{
+  assert(text != NULL);
+
+  /* rendering a glyph may clear the atlas, which invalidates the
+     positions collected so far; retry once in that case */
+  for (unsigned attempt = 0; attempt < 2; ++attempt) {
+    const unsigned start_generation = generation;
+
+    run.length = 0;
+    run.height = height;
+
+    PixelScalar pen = 0, right = 0;
+    unsigned previous = 0;
+    Glyph previous_glyph = Glyph();
+
+    const char *p = text;
+    while (*p != 0) {
+      unsigned ch;
+      if (!NextCharacter(p, ch) || run.length >= GlyphRun::MAX_GLYPHS)
+        return false;
+
+      const Glyph *glyph = GetGlyph(ch);
+      if (glyph == NULL)
+        return false;
+
+      if (generation != start_generation)
+        break;
+
+      if (run.length == 0)
+        /* SDL_ttf shifts the string to the right if the first glyph
+           extends to the left of the pen position */
+        pen = -glyph->offset;
+      else
+        pen += previous_glyph.advance +
+          GetKerning(previous, previous_glyph, ch, *glyph);
+
+      GlyphRun::Item &item = run.items[run.length++];
+      item.x = pen + glyph->offset;
+      item.src_x = glyph->x;
+      item.src_y = glyph->y;
+      item.width = glyph->width;
+
+      right = std::max(right, PixelScalar(pen + glyph->right));
+
+      previous = ch;
+      previous_glyph = *glyph;
+    }
+
+    if (generation == start_generation) {
+      run.width = right;
+      return true;
+    }
+  }
+
+  /* the string has more distinct glyphs than the atlas can hold */
+  return false;
+}
+
+#ifdef ENABLE_OPENGL
+
+GLTexture &
+GlyphAtlas::GetTexture()
+{
+  if (texture == NULL || dirty) {
+    delete texture;
+    texture = new GLTexture(surface);
+    dirty = false;
+  }
+
+  return *texture;
+}
+
+void
+GlyphAtlas::FlushTextures()
+{
+  for (ListHead *i = atlases.GetNext(); i != &atlases; i = i->GetNext()) {
+    GlyphAtlas &atlas = *static_cast<GlyphAtlas *>(i);
+    delete atlas.texture;
+    atlas.texture = NULL;
+  }
+}
+
+#endif
@@ -0,0 +1,219 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_SCREEN_SDL_GLYPH_ATLAS_HPP
+#define XCSOAR_SCREEN_SDL_GLYPH_ATLAS_HPP
+
+#include "Screen/Point.hpp"
+#include "Util/ListHead.hpp"
+#include "Util/NonCopyable.hpp"
+#include "Compiler.h"
+
+#include <SDL_ttf.h>
+
+#include <unordered_map>
+
+#ifdef ENABLE_OPENGL
+class GLTexture;
+#else
+#include "Thread/Mutex.hpp"
+#endif
+
+/**
+ * The positions of the glyphs of one string within a #GlyphAtlas,
+ * as calculated by GlyphAtlas::Layout().
+ */
+struct GlyphRun {
+  enum {
+    MAX_GLYPHS = 256,
+  };
+
+  struct Item {
+    /**
+     * The horizontal position of the glyph's cell, relative to the
+     * left edge of the string.
+     */
+    PixelScalar x;
+
+    /**
+     * The glyph's cell within the atlas surface.
+     */
+    UPixelScalar src_x, src_y, width;
+  };
+
+  Item items[MAX_GLYPHS];
+  unsigned length;
+
+  UPixelScalar width, height;
+};
+
+/**
+ * Caches the rendered glyphs of one font in a single surface (and,
+ * with OpenGL, a single texture).  A string is drawn by copying its
+ * glyphs from the atlas, instead of rendering the whole string with
+ * SDL_ttf each time.
+ *
+ * All glyphs of a font have the same height, so the atlas is packed
+ * in rows of TTF_FontHeight() pixels.  When it is full, it is cleared
+ * and refilled with the glyphs that are currently used.
+ */
+class GlyphAtlas : private ListHead, private NonCopyable {
+  enum {
+    WIDTH = 512,
+    INITIAL_HEIGHT = 64,
+    MAX_HEIGHT = 1024,
+
+    /**
+     * Clear the kerning table when it grows beyond this number of
+     * character pairs.
+     */
+    MAX_KERNING_PAIRS = 4096,
+  };
+
+  struct Glyph {
+    UPixelScalar x, y, width;
+
+    /**
+     * The distance from the pen position to the left edge of the
+     * cell; it is negative for glyphs which extend to the left of
+     * the pen position.
+     */
+    PixelScalar offset;
+
+    /**
+     * The horizontal distance from this glyph's pen position to the
+     * next one, not including kerning.
+     */
+    PixelScalar advance;
+
+    /**
+     * The right edge of the glyph's ink (or the advance, whichever
+     * is larger), relative to the pen position.
+     */
+    PixelScalar right;
+
+    bool IsDefined() const {
+      return width > 0;
+    }
+  };
+
+  TTF_Font *const font;
+  const UPixelScalar height;
+
+  SDL_Surface *surface;
+
+  /**
+   * The insert position for the next glyph.
+   */
+  UPixelScalar cursor_x, cursor_y;
+
+  /**
+   * Incremented each time the atlas is cleared; a layout which
+   * observes a change must be restarted.
+   */
+  unsigned generation;
+
+  /**
+   * Glyphs of the Latin-1 range are looked up in this table, all
+   * others in #glyphs.
+   */
+  Glyph latin1[0x100];
+  std::unordered_map<unsigned, Glyph> glyphs;
+
+  /**
+   * Kerning adjustments by character pair (first << 16 | second).
+   */
+  std::unordered_map<unsigned, PixelScalar> kerning;
+
+#ifdef ENABLE_OPENGL
+  GLTexture *texture;
+
+  /**
+   * Has the surface been modified since the #texture was uploaded?
+   */
+  bool dirty;
+#endif
+
+public:
+#ifndef ENABLE_OPENGL
+  /**
+   * Protects the atlas; without OpenGL, text is drawn by the
+   * DrawThread, too.  Must be held while calling Layout() and while
+   * copying from the surface.
+   */
+  Mutex mutex;
+#endif
+
+  GlyphAtlas(TTF_Font *font);
+  ~GlyphAtlas();
+
+  /**
+   * Calculate the glyph positions of the specified UTF-8 string,
+   * rendering glyphs which are not in the atlas yet.
+   *
+   * @return false if the string cannot be drawn from the atlas
+   * (invalid UTF-8, characters outside the Basic Multilingual Plane,
+   * too long); the caller should fall back to rendering the whole
+   * string
+   */
+  bool Layout(const char *text, GlyphRun &run);
+
+  SDL_Surface *GetSurface() {
+    return surface;
+  }
+
+#ifdef ENABLE_OPENGL
+  /**
+   * Returns the texture containing all glyphs, uploading the surface
+   * if it has been modified.  Must be called in the OpenGL thread.
+   */
+  GLTexture &GetTexture();
+
+  /**
+   * Delete the OpenGL textures of all atlases, e.g. because the
+   * OpenGL context is about to be destroyed.  They will be uploaded
+   * again on demand.
+   */
+  static void FlushTextures();
+#endif
+
+private:
+  void Clear();
+  bool Grow();
+
+  gcc_pure
+  const Glyph *LookupGlyph(unsigned ch) const;
+
+  /**
+   * Returns the glyph for the specified character, rendering it into
+   * the atlas if necessary.
+   *
+   * @return NULL if the glyph could not be rendered
+   */
+  const Glyph *GetGlyph(unsigned ch);
+
+  PixelScalar GetKerning(unsigned a, const Glyph &ga,
+                         unsigned b, const Glyph &gb);
+};
+
+#endif
@@ -0,0 +1,264 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Task/TaskIndex.hpp"
+#include "OS/FileUtil.hpp"
+#include "Thread/Flag.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+
+static const uint32_t task_index_magic = 0x7a5d1c02;
+
+/** sanity limits for loading a damaged index file */
+static const uint32_t MAX_STRING_LENGTH = 4096;
+static const uint32_t MAX_TASKS_PER_FILE = 1024;
+
+static bool
+WriteUInt32(FILE *file, uint32_t value)
+{
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool
+WriteUInt64(FILE *file, uint64_t value)
+{
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool
+WriteFixed(FILE *file, fixed value)
+{
+  const double d = (double)value;
+  return fwrite(&d, sizeof(d), 1, file) == 1;
+}
+
+static bool
+WriteString(FILE *file, const tstring &value)
+{
+  return WriteUInt32(file, value.length()) &&
+    fwrite(value.data(), sizeof(TCHAR), value.length(),
+           file) == value.length();
+}
+
+static bool
+ReadUInt32(FILE *file, uint32_t &value)
+{
+  return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool
+ReadUInt64(FILE *file, uint64_t &value)
+{
+  return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool
+ReadFixed(FILE *file, fixed &value)
+{
+  double d;
+  if (fread(&d, sizeof(d), 1, file) != 1)
+    return false;
+
+  value = fixed(d);
+  return true;
+}
+
+static bool
+ReadString(FILE *file, tstring &value)
+{
+  uint32_t length;
+  if (!ReadUInt32(file, length) || length > MAX_STRING_LENGTH)
+    return false;
+
+  TCHAR buffer[MAX_STRING_LENGTH];
+  if (fread(buffer, sizeof(TCHAR), length, file) != length)
+    return false;
+
+  value.assign(buffer, length);
+  return true;
+}
+
+static bool
+WriteSummary(FILE *file, const TaskIndex::Summary &summary)
+{
+  const uint32_t flags = (summary.valid ? 1 : 0) |
+    (summary.has_targets ? 2 : 0);
+
+  return WriteUInt32(file, flags) &&
+    WriteUInt32(file, summary.factory_type) &&
+    WriteUInt32(file, summary.num_points) &&
+    WriteFixed(file, summary.distance_nominal) &&
+    WriteFixed(file, summary.distance_min) &&
+    WriteFixed(file, summary.distance_max);
+}
+
+static bool
+ReadSummary(FILE *file, TaskIndex::Summary &summary)
+{
+  uint32_t flags, factory_type;
+  if (!ReadUInt32(file, flags) || !ReadUInt32(file, factory_type) ||
+      !ReadUInt32(file, summary.num_points) ||
+      !ReadFixed(file, summary.distance_nominal) ||
+      !ReadFixed(file, summary.distance_min) ||
+      !ReadFixed(file, summary.distance_max))
+    return false;
+
+  summary.valid = (flags & 1) != 0;
+  summary.has_targets = (flags & 2) != 0;
+  summary.factory_type = (uint8_t)factory_type;
+  return true;
+}
+
+static bool
+LoadFiles(FILE *file, std::vector<TaskIndex::FileEntry> &files)
+{
+  uint32_t magic, tchar_size, num_files;
+  if (!ReadUInt32(file, magic) || magic != task_index_magic ||
+      !ReadUInt32(file, tchar_size) || tchar_size != sizeof(TCHAR) ||
+      !ReadUInt32(file, num_files))
+    return false;
+
+  files.resize(num_files);
+  for (std::vector<TaskIndex::FileEntry>::iterator i = files.begin(),
+         end = files.end(); i != end; ++i) {
+    uint32_t num_tasks;
+    if (!ReadString(file, i->path) ||
+        !ReadUInt64(file, i->mtime) || !ReadUInt64(file, i->size) ||
+        !ReadUInt32(file, num_tasks) || num_tasks > MAX_TASKS_PER_FILE)
+      return false;
+
+    if (i != files.begin() && !((i - 1)->path < i->path))
+      /* not sorted */
+      return false;
+
+    i->tasks.resize(num_tasks);
+    for (std::vector<TaskIndex::Task>::iterator j = i->tasks.begin(),
+           tasks_end = i->tasks.end(); j != tasks_end; ++j)
+      if (!ReadString(file, j->suffix) || !ReadSummary(file, j->summary))
+        return false;
+  }
+
+  return true;
+}
+
+bool
+TaskIndex::Load(const TCHAR *path)
+{
+  files.clear();
+
+  FILE *file = _tfopen(path, _T("rb"));
+  if (file == NULL)
+    return false;
+
+  const bool success = LoadFiles(file, files);
+  fclose(file);
+
+  if (!success)
+    files.clear();
+
+  return success;
+}
+
+bool
+TaskIndex::Save(const TCHAR *path) const
+{
+  FILE *file = _tfopen(path, _T("wb"));
+  if (file == NULL)
+    return false;
+
+  bool success = WriteUInt32(file, task_index_magic) &&
+    WriteUInt32(file, sizeof(TCHAR)) &&
+    WriteUInt32(file, files.size());
+
+  for (const_iterator i = begin(), e = end(); success && i != e; ++i) {
+    success = WriteString(file, i->path) &&
+      WriteUInt64(file, i->mtime) && WriteUInt64(file, i->size) &&
+      WriteUInt32(file, i->tasks.size());
+
+    for (std::vector<Task>::const_iterator j = i->tasks.begin(),
+           tasks_end = i->tasks.end(); success && j != tasks_end; ++j)
+      success = WriteString(file, j->suffix) &&
+        WriteSummary(file, j->summary);
+  }
+
+  if (fclose(file) != 0)
+    success = false;
+
+  if (!success)
+    File::Delete(path);
+
+  return success;
+}
+
+struct CompareFileEntryPath {
+  bool operator()(const TaskIndex::FileEntry &entry,
+                  const tstring &path) const {
+    return entry.path < path;
+  }
+};
+
+int
+TaskIndex::Update(std::vector<tstring> paths, Reader &reader,
+                  const Flag *cancel)
+{
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+  std::vector<FileEntry> new_files;
+  new_files.reserve(paths.size());
+
+  int num_read = 0;
+  for (std::vector<tstring>::const_iterator i = paths.begin(),
+         end = paths.end(); i != end; ++i) {
+    if (cancel != NULL && cancel->Get())
+      return -1;
+
+    new_files.push_back(FileEntry());
+    FileEntry &entry = new_files.back();
+    entry.path = *i;
+
+    if (!File::GetInfo(i->c_str(), entry.mtime, entry.size)) {
+      new_files.pop_back();
+      continue;
+    }
+
+    std::vector<FileEntry>::const_iterator old =
+      std::lower_bound(files.begin(), files.end(), *i,
+                       CompareFileEntryPath());
+    if (old != files.end() && old->path == *i &&
+        old->mtime == entry.mtime && old->size == entry.size) {
+      entry.tasks = old->tasks;
+      continue;
+    }
+
+    /* invalid files stay in the index (without tasks), so they are
+       not read again until they are modified */
+    ++num_read;
+    if (!reader.Read(i->c_str(), entry))
+      entry.tasks.clear();
+  }
+
+  files.swap(new_files);
+  return num_read;
+}
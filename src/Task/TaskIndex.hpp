@@ -0,0 +1,140 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TASK_INDEX_HPP
+#define XCSOAR_TASK_INDEX_HPP
+
+#include "Util/tstring.hpp"
+#include "Math/fixed.hpp"
+
+#include <vector>
+#include <stdint.h>
+#include <tchar.h>
+
+class Flag;
+
+/**
+ * A persistent index of the task files in the data directories.  For
+ * each file, it remembers the time stamp, the size, and the name
+ * suffixes and summaries of the tasks inside, so the task list can
+ * be shown without parsing any task file.  Only files which have
+ * changed since the index was saved need to be read again.
+ */
+class TaskIndex {
+public:
+  struct Summary {
+    /** was the task loaded successfully, and did it pass CheckTask()? */
+    bool valid;
+
+    bool has_targets;
+
+    /** a TaskBehaviour::FactoryType value */
+    uint8_t factory_type;
+
+    unsigned num_points;
+
+    fixed distance_nominal, distance_min, distance_max;
+  };
+
+  struct Task {
+    /**
+     * The name suffix from the task file; empty if there is none.
+     */
+    tstring suffix;
+
+    Summary summary;
+  };
+
+  struct FileEntry {
+    tstring path;
+
+    /** see File::GetInfo() */
+    uint64_t mtime, size;
+
+    std::vector<Task> tasks;
+  };
+
+  /**
+   * Reads a task file which is not in the index yet, or which has
+   * changed.
+   */
+  class Reader {
+  public:
+    /**
+     * Fill #entry.tasks.
+     *
+     * @return false if the file is not a valid task file
+     */
+    virtual bool Read(const TCHAR *path, FileEntry &entry) = 0;
+  };
+
+  typedef std::vector<FileEntry>::const_iterator const_iterator;
+
+private:
+  /**
+   * The indexed files, sorted by path.
+   */
+  std::vector<FileEntry> files;
+
+public:
+  const_iterator begin() const {
+    return files.begin();
+  }
+
+  const_iterator end() const {
+    return files.end();
+  }
+
+  unsigned size() const {
+    return files.size();
+  }
+
+  void Clear() {
+    files.clear();
+  }
+
+  /**
+   * Replace the contents with the index file saved by Save().
+   *
+   * @return false if the file does not exist or is not a valid index;
+   * the index is empty then
+   */
+  bool Load(const TCHAR *path);
+
+  bool Save(const TCHAR *path) const;
+
+  /**
+   * Bring the index up to date with the specified task files.
+   * Entries for other files are removed, and files whose time stamp
+   * and size have not changed are not read again.
+   *
+   * @param paths the task files which shall be indexed
+   * @param cancel if this flag gets set, the update is aborted and
+   * the index is left unmodified
+   * @return the number of files which were read, or -1 if cancelled
+   */
+  int Update(std::vector<tstring> paths, Reader &reader,
+             const Flag *cancel=NULL);
+};
+
+#endif
@@ -30,45 +30,159 @@ Copyright_License {
 #include "OS/FileUtil.hpp"
 #include "LocalPath.hpp"
 #include "Language/Language.hpp"
+#include "Compatibility/path.h"
 
+#include <windef.h> /* for MAX_PATH */
 #include <cstdio>
 #include <algorithm>
 
 class TaskFileVisitor: public File::Visitor
 {
 private:
-  TaskStore::ItemVector &store;
+  std::vector<tstring> &paths;
 
 public:
-  TaskFileVisitor(TaskStore::ItemVector &_store):
-    store(_store) {}
+  TaskFileVisitor(std::vector<tstring> &_paths):
+    paths(_paths) {}
 
   void Visit(const TCHAR *path, const TCHAR *filename) {
-    // Create a TaskFile instance to determine how many
-    // tasks are inside of this task file
+    paths.push_back(path);
+  }
+};
+
+/**
+ * Reads the task names and summaries of a task file for the
+ * #TaskIndex.
+ */
+class TaskFileIndexReader: public TaskIndex::Reader
+{
+  static void Summarize(OrderedTask *task, TaskIndex::Summary &summary) {
+    if (task == NULL) {
+      summary.valid = false;
+      summary.has_targets = false;
+      summary.factory_type = 0;
+      summary.num_points = 0;
+      summary.distance_nominal = summary.distance_min =
+        summary.distance_max = fixed_zero;
+      return;
+    }
+
+    const TaskStats &stats = task->GetStats();
+    summary.valid = task->CheckTask();
+    summary.has_targets = task->HasTargets();
+    summary.factory_type = (uint8_t)task->get_factory_type();
+    summary.num_points = task->TaskSize();
+    summary.distance_nominal = stats.distance_nominal;
+    summary.distance_min = stats.distance_min;
+    summary.distance_max = stats.distance_max;
+
+    delete task;
+  }
+
+public:
+  virtual bool Read(const TCHAR *path, TaskIndex::FileEntry &entry) {
     TaskFile* task_file = TaskFile::Create(path);
     if (task_file == NULL)
-      return;
+      return false;
+
+    // Count the tasks in the task file
+    const unsigned count = task_file->Count();
+    entry.tasks.resize(count);
+    for (unsigned i = 0; i < count; i++) {
+      TaskIndex::Task &task = entry.tasks[i];
+      if (i < task_file->namesuffixes.size() &&
+          task_file->namesuffixes[i] != NULL)
+        task.suffix = task_file->namesuffixes[i];
+
+      Summarize(task_file->GetTask(&way_points, i), task.summary);
+    }
+
+    delete task_file;
+    return true;
+  }
+};
+
+static const TCHAR *
+GetIndexPath(TCHAR *buffer)
+{
+  LocalPath(buffer, _T("cache"));
+  Directory::Create(buffer);
+  _tcscat(buffer, _T(DIR_SEPARATOR_S "tasks.idx"));
+  return buffer;
+}
+
+/**
+ * Update the index from the task files in the data directories, and
+ * save it.
+ *
+ * @return false if the update was cancelled
+ */
+static bool
+UpdateIndex(TaskIndex &index, const Flag *cancel)
+{
+  std::vector<tstring> paths;
+  TaskFileVisitor tfv(paths);
+  VisitDataFiles(_T("*.tsk"), tfv);
+  VisitDataFiles(_T("*.cup"), tfv);
+
+  TaskFileIndexReader reader;
+  if (index.Update(paths, reader, cancel) < 0)
+    return false;
+
+  TCHAR path[MAX_PATH];
+  index.Save(GetIndexPath(path));
+  return true;
+}
+
+TaskStore *TaskStore::scanning;
+
+void
+TaskStore::ScanThread::Run()
+{
+  if (!UpdateIndex(index, &cancel))
+    return;
+
+  done.Set();
+  listener->OnTaskStoreScanned();
+}
+
+TaskStore::~TaskStore()
+{
+  CancelScan();
+}
+
+void
+TaskStore::Clear()
+{
+  // clear entries first
+  store.erase(store.begin(), store.end());
+}
+
+void
+TaskStore::Fill()
+{
+  Clear();
+
+  for (TaskIndex::const_iterator file = index.begin(), end = index.end();
+       file != end; ++file) {
+    const TCHAR *path = file->path.c_str();
 
     // Get base name of the task file
     const TCHAR* base_name = BaseName(path);
 
-    // Count the tasks in the task file
-    unsigned count = task_file->Count();
-    // For each task in the task file
+    const unsigned count = file->tasks.size();
     for (unsigned i = 0; i < count; i++) {
+      const TaskIndex::Task &task = file->tasks[i];
+
       // Copy base name of the file into task name
       StaticString<256> name;
       name = (base_name != NULL) ? base_name : path;
 
       // If the task file holds more than one task
       if (count > 1) {
-        if (i < task_file->namesuffixes.size() &&
-            task_file->namesuffixes[i]) {
-
+        if (!task.suffix.empty()) {
           name += _T(": ");
-          name += task_file->namesuffixes[i];
-
+          name += task.suffix.c_str();
         } else {
           // .. append " - Task #[n]" suffix to the task name
           name.AppendFormat(_T(": %s #%2d"), _("Task"), i + 1);
@@ -76,32 +190,87 @@ public:
       }
 
       // Add the task to the TaskStore
-      store.push_back(TaskStore::Item(path, name.empty() ? path : name, i));
+      store.push_back(TaskStore::Item(path, name.empty() ? path : name,
+                                      task.summary, i));
     }
-
-    // Remove temporary TaskFile instance
-    delete task_file;
   }
-};
 
-void
-TaskStore::Clear()
+  std::sort(store.begin(), store.end());
+}
+
+bool
+TaskStore::LoadIndex()
 {
-  // clear entries first
-  store.erase(store.begin(), store.end());
+  CancelScan();
+
+  TCHAR path[MAX_PATH];
+  const bool success = index.Load(GetIndexPath(path));
+  Fill();
+  return success;
 }
 
 void
 TaskStore::Scan()
 {
-  Clear();
+  CancelScan();
 
-  // scan files
-  TaskFileVisitor tfv(store);
-  VisitDataFiles(_T("*.tsk"), tfv);
-  VisitDataFiles(_T("*.cup"), tfv);
+  UpdateIndex(index, NULL);
+  Fill();
+}
 
-  std::sort(store.begin(), store.end());
+void
+TaskStore::StartScan(Listener &listener)
+{
+  if (scan_thread.IsDefined())
+    return;
+
+  /* SuspendAllThreads() can cancel only one scan */
+  CancelBackgroundScan();
+
+  scan_thread.index = index;
+  scan_thread.listener = &listener;
+  scan_thread.cancel.Set(false);
+  scan_thread.done.Set(false);
+  scan_thread.Start();
+  scanning = this;
+}
+
+bool
+TaskStore::FinishScan()
+{
+  if (!scan_thread.IsDefined())
+    return false;
+
+  scan_thread.Join();
+  if (scanning == this)
+    scanning = NULL;
+
+  if (!scan_thread.done.Get())
+    return false;
+
+  index = scan_thread.index;
+  Fill();
+  return true;
+}
+
+void
+TaskStore::CancelScan()
+{
+  if (!scan_thread.IsDefined())
+    return;
+
+  scan_thread.cancel.Set();
+  scan_thread.Join();
+
+  if (scanning == this)
+    scanning = NULL;
+}
+
+void
+TaskStore::CancelBackgroundScan()
+{
+  if (scanning != NULL)
+    scanning->CancelScan();
 }
 
 size_t
@@ -111,12 +280,14 @@ TaskStore::Size() const
 }
 
 TaskStore::Item::Item(const tstring &_filename, const tstring _task_name,
+                      const TaskIndex::Summary &_summary,
                       unsigned _task_index):
   task_name(_task_name),
   filename(_filename),
   task_index(_task_index),
   task(NULL),
-  valid(true)
+  valid(_summary.valid),
+  summary(_summary)
 {        
 }
 
@@ -24,13 +24,18 @@ Copyright_License {
 #ifndef TASK_STORE_HPP
 #define TASK_STORE_HPP
 
+#include "Task/TaskIndex.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Flag.hpp"
 #include "Util/tstring.hpp"
 #include <vector>
 
 class OrderedTask;
 
 /**
- * Class to load multiple tasks on demand, e.g. for browsing
+ * Class to load multiple tasks on demand, e.g. for browsing.  The
+ * list is built from a persistent #TaskIndex; an OrderedTask is only
+ * constructed when GetTask() is called.
  */
 class TaskStore 
 {
@@ -42,9 +47,10 @@ public:
     unsigned task_index;
     OrderedTask* task;
     bool valid;
+    TaskIndex::Summary summary;
 
     Item(const tstring &the_filename, const tstring _task_name,
-         unsigned _task_index = 0);
+         const TaskIndex::Summary &_summary, unsigned _task_index = 0);
     ~Item();
 
     const TCHAR* GetName() const;
@@ -55,18 +61,96 @@ public:
 
   typedef std::vector<TaskStore::Item> ItemVector;
 
+  class Listener {
+  public:
+    /**
+     * Called by the scanner thread after a background scan has
+     * completed.  Call FinishScan() in the main thread to apply the
+     * result.
+     */
+    virtual void OnTaskStoreScanned() = 0;
+  };
+
 private:
+  /**
+   * Updates a copy of the index in background.
+   */
+  class ScanThread : public Thread {
+  public:
+    TaskIndex index;
+
+    Listener *listener;
+
+    /**
+     * Set by the main thread to abort the scan.
+     */
+    Flag cancel;
+
+    /**
+     * Set by the thread when #index is complete.
+     */
+    Flag done;
+
+  protected:
+    virtual void Run();
+  };
+
   /**
    * Internal task storage
    */
   ItemVector store;
 
+  TaskIndex index;
+
+  ScanThread scan_thread;
+
+  /**
+   * The TaskStore whose background scan is running, or NULL.  Only
+   * accessed by the main thread.
+   */
+  static TaskStore *scanning;
+
 public:
+  ~TaskStore();
+
+  /**
+   * Fill the store from the index saved by the last scan.  This does
+   * not read any task file, but the list may be outdated.
+   *
+   * @return false if there was no saved index
+   */
+  bool LoadIndex();
+
   /**
-   * Scan the XCSoarData folder for .tsk files and add them to the TaskStore
+   * Scan the XCSoarData folder for .tsk files and add them to the
+   * TaskStore.  Only task files which have changed since the last
+   * scan are read.
    */
   void Scan();
 
+  /**
+   * Start a Scan() in a background thread.  When it has completed,
+   * Listener::OnTaskStoreScanned() is called.  Does nothing if a
+   * background scan is already running.
+   */
+  void StartScan(Listener &listener);
+
+  /**
+   * Apply the result of the background scan started by StartScan().
+   * Must be called after Listener::OnTaskStoreScanned().
+   *
+   * @return true if the store was updated
+   */
+  bool FinishScan();
+
+  /**
+   * Abort a running background scan.  The scanner reads the global
+   * waypoint database without a lock, therefore SuspendAllThreads()
+   * calls this before the waypoints are modified.  Must be called
+   * from the main thread.
+   */
+  static void CancelBackgroundScan();
+
   /**
    * Clear all the tasks from the TaskStore
    */
@@ -86,12 +170,31 @@ public:
    */
   const TCHAR *GetName(unsigned index) const;
 
+  /**
+   * Return the summary of the task defined by the given index, from
+   * the task index.
+   */
+  const TaskIndex::Summary &GetSummary(unsigned index) const {
+    return store[index].summary;
+  }
+
   /**
    * Return the task defined by the given index
    * @param index TaskStore index of the desired Task
    * @return The task defined by the given index
    */
   OrderedTask* GetTask(unsigned index);
+
+private:
+  /**
+   * Abort a background scan and wait for the thread to exit.
+   */
+  void CancelScan();
+
+  /**
+   * Rebuild #store from #index.
+   */
+  void Fill();
 };
 
 #endif
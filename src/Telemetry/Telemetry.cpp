@@ -0,0 +1,160 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Telemetry/Telemetry.hpp"
+
+#include <assert.h>
+#include <string.h>
+
+#if defined(HAVE_POSIX) && !defined(ANDROID)
+#define HAVE_SHM
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Telemetry {
+  Segment *segment;
+
+#ifdef HAVE_SHM
+  /**
+   * The name of the shared memory object, or empty if #segment was
+   * attached by the caller.
+   */
+  static char shm_name[64];
+#endif
+
+  static const char *const thread_names[NUM_THREADS] = {
+    "CalculationThread",
+    "MergeThread",
+    "DrawThread",
+  };
+
+  static void Initialise(Segment &segment);
+}
+
+static void
+Telemetry::Initialise(Segment &s)
+{
+  memset(&s, 0, sizeof(s));
+
+  for (unsigned i = 0; i < NUM_THREADS; ++i)
+    strncpy(s.threads[i].data.name, thread_names[i],
+            sizeof(s.threads[i].data.name) - 1);
+
+  s.version = VERSION;
+  s.size = sizeof(s);
+#ifdef HAVE_POSIX
+  s.pid = getpid();
+#endif
+
+  /* the magic is written last, so a reader never sees a half
+     initialised header */
+  __sync_synchronize();
+  s.magic = MAGIC;
+}
+
+bool
+Telemetry::Open(const char *name)
+{
+  assert(segment == NULL);
+
+#ifdef HAVE_SHM
+  if (strlen(name) >= sizeof(shm_name))
+    return false;
+
+  int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+
+  if (ftruncate(fd, sizeof(Segment)) < 0) {
+    close(fd);
+    shm_unlink(name);
+    return false;
+  }
+
+  void *p = mmap(NULL, sizeof(Segment), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    shm_unlink(name);
+    return false;
+  }
+
+  strcpy(shm_name, name);
+  Initialise(*(Segment *)p);
+  segment = (Segment *)p;
+  return true;
+#else
+  (void)name;
+  return false;
+#endif
+}
+
+void
+Telemetry::Attach(Segment &_segment)
+{
+  assert(segment == NULL);
+
+  Initialise(_segment);
+  segment = &_segment;
+}
+
+void
+Telemetry::Close()
+{
+  Segment *s = segment;
+  if (s == NULL)
+    return;
+
+  segment = NULL;
+
+#ifdef HAVE_SHM
+  if (shm_name[0] != 0) {
+    munmap(s, sizeof(*s));
+    shm_unlink(shm_name);
+    shm_name[0] = 0;
+  }
+#endif
+}
+
+void
+Telemetry::AddCycle(ThreadId thread, uint64_t start, uint64_t duration)
+{
+  assert((unsigned)thread < NUM_THREADS);
+
+  Segment *s = segment;
+  if (s == NULL)
+    return;
+
+  Section<ThreadTiming> &section = s->threads[thread];
+  ThreadTiming &timing = BeginWrite(section);
+  ++timing.cycles;
+  timing.last_start = start;
+  timing.total_duration += duration;
+  timing.last_duration = duration;
+  if (duration > timing.max_duration)
+    timing.max_duration = duration;
+  EndWrite(section);
+}
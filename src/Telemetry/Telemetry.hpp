@@ -0,0 +1,105 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TELEMETRY_HPP
+#define XCSOAR_TELEMETRY_HPP
+
+#include "Telemetry/TelemetryLayout.hpp"
+#include "OS/Clock.hpp"
+#include "Compiler.h"
+
+#include <stddef.h>
+
+/**
+ * Publishes key blackboard values and per-thread cycle timing in a
+ * shared memory segment (see TelemetryLayout.hpp), for external
+ * monitoring tools.  It is disabled unless Open() has been called;
+ * then, each instrumentation point costs one pointer check.
+ */
+namespace Telemetry {
+  /**
+   * The default name of the POSIX shared memory object.
+   */
+  static const char DEFAULT_NAME[] = "/xcsoar-telemetry";
+
+  /**
+   * The interval between two blackboard snapshots [ms].
+   */
+  static const unsigned PUBLISH_INTERVAL = 200;
+
+  extern Segment *segment;
+
+  gcc_pure
+  static inline bool
+  IsEnabled()
+  {
+    return segment != NULL;
+  }
+
+  /**
+   * Create the shared memory object and start publishing.  Only
+   * available on POSIX systems (except Android).
+   *
+   * @return false on error
+   */
+  bool Open(const char *name=DEFAULT_NAME);
+
+  /**
+   * Publish into a caller-provided segment instead of a shared memory
+   * object; used by the unit test.
+   */
+  void Attach(Segment &segment);
+
+  /**
+   * Stop publishing and remove the shared memory object.  All
+   * instrumented threads must have been stopped.
+   */
+  void Close();
+
+  /**
+   * Record a completed cycle of the specified thread.  May only be
+   * called from that thread.
+   */
+  void AddCycle(ThreadId thread, uint64_t start, uint64_t duration);
+}
+
+/**
+ * Records a thread cycle from construction to destruction.
+ */
+class ScopeTelemetryCycle {
+  const Telemetry::ThreadId thread;
+  const bool enabled;
+  const uint64_t start;
+
+public:
+  explicit ScopeTelemetryCycle(Telemetry::ThreadId _thread)
+    :thread(_thread), enabled(Telemetry::IsEnabled()),
+     start(enabled ? MonotonicClockUS() : 0) {}
+
+  ~ScopeTelemetryCycle() {
+    if (enabled)
+      Telemetry::AddCycle(thread, start, MonotonicClockUS() - start);
+  }
+};
+
+#endif
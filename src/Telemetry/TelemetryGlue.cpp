@@ -0,0 +1,126 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Telemetry/TelemetryGlue.hpp"
+#include "Telemetry/Telemetry.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+#include "ComputerSettings.hpp"
+
+void
+Telemetry::PublishFlight(const MoreData &basic, const DerivedInfo &calculated,
+                         const ComputerSettings &settings)
+{
+  Segment *s = segment;
+  if (s == NULL)
+    return;
+
+  const uint64_t now = MonotonicClockUS();
+  if (s->flight.data.timestamp != 0 &&
+      now < s->flight.data.timestamp + PUBLISH_INTERVAL * 1000)
+    return;
+
+  Flight &flight = BeginWrite(s->flight);
+
+  unsigned flags = 0;
+  if (basic.connected)
+    flags |= Flight::CONNECTED;
+
+  flight.timestamp = now;
+  flight.satellites_used = basic.gps.satellites_used_available &&
+    basic.gps.satellites_used > 0
+    ? basic.gps.satellites_used : 0;
+  flight.time = (double)basic.time;
+
+  if (basic.location_available) {
+    flags |= Flight::LOCATION;
+    flight.latitude = (double)basic.location.latitude.Degrees();
+    flight.longitude = (double)basic.location.longitude.Degrees();
+    flight.ground_speed = (float)basic.ground_speed;
+    flight.track = (float)basic.track.Degrees();
+  }
+
+  if (basic.gps_altitude_available) {
+    flags |= Flight::GPS_ALTITUDE;
+    flight.gps_altitude = (float)basic.gps_altitude;
+  }
+
+  if (basic.baro_altitude_available) {
+    flags |= Flight::BARO_ALTITUDE;
+    flight.baro_altitude = (float)basic.baro_altitude;
+  }
+
+  flight.nav_altitude = (float)basic.nav_altitude;
+
+  if (calculated.altitude_agl_valid) {
+    flags |= Flight::ALTITUDE_AGL;
+    flight.altitude_agl = (float)calculated.altitude_agl;
+  }
+
+  if (basic.airspeed_available) {
+    flags |= Flight::AIRSPEED;
+    flight.true_airspeed = (float)basic.true_airspeed;
+    flight.indicated_airspeed = (float)basic.indicated_airspeed;
+  }
+
+  if (basic.total_energy_vario_available)
+    flags |= Flight::TOTAL_ENERGY_VARIO;
+  flight.brutto_vario = (float)basic.brutto_vario;
+
+  if (basic.netto_vario_available)
+    flags |= Flight::NETTO_VARIO;
+  flight.netto_vario = (float)basic.netto_vario;
+
+  flight.average_vario = (float)calculated.average;
+
+  if (calculated.wind_available) {
+    flags |= Flight::WIND;
+    flight.wind_speed = (float)calculated.wind.norm;
+    flight.wind_bearing = (float)calculated.wind.bearing.Degrees();
+  }
+
+  if (calculated.flight.flying)
+    flags |= Flight::FLYING;
+
+  if (calculated.circling)
+    flags |= Flight::CIRCLING;
+
+  flight.mac_cready = (float)settings.glide_polar_task.GetMC();
+
+  const TaskStats &task_stats = calculated.task_stats;
+  if (task_stats.task_valid) {
+    flags |= Flight::TASK_VALID;
+    flight.task_remaining_distance = task_stats.total.remaining.IsDefined()
+      ? (float)task_stats.total.remaining.get_distance()
+      : 0.f;
+    flight.task_altitude_difference =
+      (float)task_stats.total.solution_remaining.altitude_difference;
+  }
+
+  flight.flarm_traffic = basic.flarm.available
+    ? basic.flarm.traffic.size() : 0;
+
+  flight.flags = flags;
+
+  EndWrite(s->flight);
+}
@@ -0,0 +1,197 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TELEMETRY_LAYOUT_HPP
+#define XCSOAR_TELEMETRY_LAYOUT_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * The layout of the shared memory segment published by
+ * #Telemetry.  External tools map it read-only; this header does not
+ * depend on anything else in XCSoar, so they can include it as is.
+ *
+ * Each section is protected by a sequence counter: the writer
+ * increments it before and after modifying the section, so it is odd
+ * while a write is in progress.  A reader copies the section and
+ * retries if the counter was odd or has changed meanwhile.  The
+ * writer never waits for a reader.
+ */
+namespace Telemetry {
+  static const uint32_t MAGIC = 0x58435450; /* "XCTP" */
+
+  /**
+   * Incremented whenever the layout changes incompatibly.
+   */
+  static const uint32_t VERSION = 1;
+
+  enum ThreadId {
+    CALCULATION_THREAD,
+    MERGE_THREAD,
+    DRAW_THREAD,
+    NUM_THREADS
+  };
+
+  /**
+   * Key values of the blackboards.  A value is only meaningful if
+   * the corresponding bit in #flags is set.
+   */
+  struct Flight {
+    enum Flags {
+      CONNECTED = 0x1,
+      LOCATION = 0x2,
+      GPS_ALTITUDE = 0x4,
+      BARO_ALTITUDE = 0x8,
+      ALTITUDE_AGL = 0x10,
+      AIRSPEED = 0x20,
+      TOTAL_ENERGY_VARIO = 0x40,
+      NETTO_VARIO = 0x80,
+      WIND = 0x100,
+      FLYING = 0x200,
+      CIRCLING = 0x400,
+      TASK_VALID = 0x800,
+    };
+
+    /** monotonic time of this snapshot [us] */
+    uint64_t timestamp;
+
+    uint32_t flags;
+
+    uint32_t satellites_used;
+
+    /** GPS time [s UTC since midnight] */
+    double time;
+
+    /** [degrees] */
+    double latitude, longitude;
+
+    /** [m] */
+    float gps_altitude, baro_altitude, nav_altitude, altitude_agl;
+
+    /** [m/s] */
+    float ground_speed, true_airspeed, indicated_airspeed;
+
+    /** [degrees] */
+    float track;
+
+    /** [m/s] */
+    float brutto_vario, netto_vario, average_vario;
+
+    float wind_speed;
+
+    /** the direction the wind is coming from [degrees] */
+    float wind_bearing;
+
+    /** [m/s] */
+    float mac_cready;
+
+    /** [m] */
+    float task_remaining_distance, task_altitude_difference;
+
+    uint32_t flarm_traffic;
+
+    uint32_t reserved;
+  };
+
+  /**
+   * Cycle timing of one thread.
+   */
+  struct ThreadTiming {
+    char name[24];
+
+    /** the number of cycles completed */
+    uint64_t cycles;
+
+    /** monotonic time when the last cycle started [us] */
+    uint64_t last_start;
+
+    /** the sum of all cycle durations [us] */
+    uint64_t total_duration;
+
+    /** [us] */
+    uint32_t last_duration, max_duration;
+  };
+
+  template<typename T>
+  struct Section {
+    volatile uint32_t sequence;
+    uint32_t reserved;
+    T data;
+  };
+
+  struct Segment {
+    uint32_t magic, version;
+
+    /** sizeof(Segment), to detect mismatching builds */
+    uint32_t size;
+
+    uint32_t pid;
+
+    Section<Flight> flight;
+
+    Section<ThreadTiming> threads[NUM_THREADS];
+  };
+
+  /**
+   * Mark the section as being modified.  Only one thread may write
+   * to a section.
+   */
+  template<typename T>
+  static inline T &
+  BeginWrite(Section<T> &section)
+  {
+    section.sequence = section.sequence + 1;
+    __sync_synchronize();
+    return section.data;
+  }
+
+  template<typename T>
+  static inline void
+  EndWrite(Section<T> &section)
+  {
+    __sync_synchronize();
+    section.sequence = section.sequence + 1;
+  }
+
+  /**
+   * Copy a consistent snapshot of the section.
+   *
+   * @return false if the writer was active; try again
+   */
+  template<typename T>
+  static inline bool
+  TryRead(const Section<T> &section, T &dest)
+  {
+    const uint32_t sequence = section.sequence;
+    if (sequence & 1)
+      return false;
+
+    __sync_synchronize();
+    memcpy(&dest, &section.data, sizeof(dest));
+    __sync_synchronize();
+    return section.sequence == sequence;
+  }
+}
+
+#endif
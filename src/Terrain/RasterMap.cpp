@@ -97,10 +97,27 @@ RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
 short
 RasterMap::GetHeight(const GeoPoint &location) const
 {
-  RasterLocation pt = projection.project(location) >> 8;
+  RasterLocation pt = GetPixel(location);
   return raster_tile_cache.GetHeight(pt.x, pt.y);
 }
 
+void
+RasterMap::GetHeights(const GeoPoint *locations, short *heights,
+                      unsigned n) const
+{
+  static const unsigned CHUNK_SIZE = 64;
+  RasterLocation pixels[CHUNK_SIZE];
+
+  for (unsigned start = 0; start < n; start += CHUNK_SIZE) {
+    const unsigned size = std::min(n - start, CHUNK_SIZE);
+
+    for (unsigned i = 0; i < size; ++i)
+      pixels[i] = GetPixel(locations[start + i]);
+
+    raster_tile_cache.GetHeights(pixels, heights + start, size);
+  }
+}
+
 short
 RasterMap::GetInterpolatedHeight(const GeoPoint &location) const
 {
@@ -74,6 +74,20 @@ public:
     return raster_tile_cache.GetSerial();
   }
 
+  /**
+   * Estimate the number of bytes used by this object, assuming it
+   * was allocated on the heap.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return sizeof(*this) + raster_tile_cache.GetMemoryUsage();
+  }
+
+  const RasterTileCache::IntersectionStatistics &
+  GetIntersectionStatistics() const {
+    return raster_tile_cache.GetIntersectionStatistics();
+  }
+
   /**
    * @see RasterProjection::pixel_distance()
    */
@@ -84,12 +98,28 @@ public:
     return projection.pixel_distance(location, 256 * pixels);
   }
 
+  /**
+   * Determine the pixel which contains the specified location.  The
+   * result may be out of range.
+   */
+  gcc_pure
+  RasterLocation GetPixel(const GeoPoint &location) const {
+    return projection.project(location) >> 8;
+  }
+
   /**
    * Determine the non-interpolated height at the specified location.
    */
   gcc_pure
   short GetHeight(const GeoPoint &location) const;
 
+  /**
+   * Determine the non-interpolated heights at many locations at once.
+   * This is faster than calling GetHeight() for each of them.
+   */
+  void GetHeights(const GeoPoint *locations, short *heights,
+                  unsigned n) const;
+
   /**
    * Determine the interpolated height at the specified location.
    */
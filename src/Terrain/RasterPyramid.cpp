@@ -0,0 +1,179 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterPyramid.hpp"
+#include "Terrain/RasterBuffer.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <limits.h>
+
+gcc_const
+static inline short
+ToBound(short h)
+{
+  return h < 0 ? RasterPyramid::UNKNOWN : h;
+}
+
+void
+RasterPyramid::Build(const RasterBuffer &overview, unsigned _bits)
+{
+  Reset();
+
+  bits = _bits;
+
+  unsigned width = overview.get_width(), height = overview.get_height();
+  if (width == 0 || height == 0)
+    return;
+
+  unsigned size = 0;
+  while (true) {
+    Level &level = levels.append();
+    level.width = width;
+    level.height = height;
+    level.offset = size;
+    size += width * height;
+
+    if ((width == 1 && height == 1) || levels.full())
+      break;
+
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+  }
+
+  data.GrowDiscard(size);
+
+  const Level &base = levels[0];
+  const short *src = overview.get_data();
+  for (unsigned i = 0, n = base.width * base.height; i < n; ++i)
+    data[i] = ToBound(src[i]);
+
+  Propagate(0, 0, base.width, base.height);
+}
+
+void
+RasterPyramid::Merge(const RasterBuffer &tile, unsigned x, unsigned y)
+{
+  const unsigned width = tile.get_width(), height = tile.get_height();
+  if (!IsDefined() || width == 0 || height == 0)
+    return;
+
+  const Level &base = levels[0];
+  const unsigned max_x = base.width - 1, max_y = base.height - 1;
+
+  /* pixels beyond the last overview column/row are clamped to it, just
+     like RasterTileCache::GetFieldDirect() does */
+  for (unsigned row = 0; row < height; ++row) {
+    const unsigned cy = std::min((y + row) >> bits, max_y);
+    const short *src = tile.get_data_at(0, row);
+
+    for (unsigned column = 0; column < width; ++column) {
+      const unsigned cx = std::min((x + column) >> bits, max_x);
+      short &bound = At(base, cx, cy);
+      const short h = ToBound(src[column]);
+      if (h > bound)
+        bound = h;
+    }
+  }
+
+  Propagate(std::min(x >> bits, max_x), std::min(y >> bits, max_y),
+            std::min((x + width - 1) >> bits, max_x) + 1,
+            std::min((y + height - 1) >> bits, max_y) + 1);
+}
+
+void
+RasterPyramid::Propagate(unsigned x0, unsigned y0, unsigned x1, unsigned y1)
+{
+  for (unsigned l = 1; l < levels.size(); ++l) {
+    const Level &fine = levels[l - 1], &coarse = levels[l];
+
+    x0 >>= 1;
+    y0 >>= 1;
+    x1 = (x1 + 1) >> 1;
+    y1 = (y1 + 1) >> 1;
+    assert(x1 <= coarse.width);
+    assert(y1 <= coarse.height);
+
+    for (unsigned y = y0; y < y1; ++y) {
+      const unsigned fy = y * 2;
+      const bool has_bottom = fy + 1 < fine.height;
+
+      for (unsigned x = x0; x < x1; ++x) {
+        const unsigned fx = x * 2;
+        const bool has_right = fx + 1 < fine.width;
+
+        short h = At(fine, fx, fy);
+        if (has_right)
+          h = std::max(h, At(fine, fx + 1, fy));
+        if (has_bottom) {
+          h = std::max(h, At(fine, fx, fy + 1));
+          if (has_right)
+            h = std::max(h, At(fine, fx + 1, fy + 1));
+        }
+
+        At(coarse, x, y) = h;
+      }
+    }
+  }
+}
+
+bool
+RasterPyramid::FindClearCell(unsigned x, unsigned y, int height,
+                             Cell &cell) const
+{
+  if (!IsDefined())
+    return false;
+
+  const Level &base = levels[0];
+  const unsigned cx = std::min(x >> bits, base.width - 1);
+  const unsigned cy = std::min(y >> bits, base.height - 1);
+
+  short h = At(base, cx, cy);
+  if (h > height)
+    return false;
+
+  /* climb up while the parent cell is still clear; a parent bound is
+     never lower than its children's */
+  unsigned l = 0;
+  while (l + 1 < levels.size()) {
+    const short parent = At(levels[l + 1], cx >> (l + 1), cy >> (l + 1));
+    if (parent > height)
+      break;
+
+    h = parent;
+    ++l;
+  }
+
+  const unsigned lx = cx >> l, ly = cy >> l;
+  cell.x0 = (lx << l) << bits;
+  cell.y0 = (ly << l) << bits;
+  /* the last column/row also covers the clamped pixels */
+  cell.x1 = ((lx + 1) << l) >= base.width
+    ? UINT_MAX
+    : ((lx + 1) << l) << bits;
+  cell.y1 = ((ly + 1) << l) >= base.height
+    ? UINT_MAX
+    : ((ly + 1) << l) << bits;
+  cell.height = h;
+  return true;
+}
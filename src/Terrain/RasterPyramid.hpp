@@ -0,0 +1,149 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_RASTER_PYRAMID_HPP
+#define XCSOAR_RASTER_PYRAMID_HPP
+
+#include "Util/NonCopyable.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "Util/StaticArray.hpp"
+#include "Compiler.h"
+
+#include <stddef.h>
+
+class RasterBuffer;
+
+/**
+ * A pyramid of maximum terrain heights.  The finest level has one
+ * cell per overview pixel; each coarser level halves the resolution.
+ * A cell stores an upper bound for all heights which
+ * RasterTileCache::GetFieldDirect() may return for pixels within it,
+ * both from the overview and from loaded tiles.  Cells which contain
+ * invalid or water heights (i.e. negative values) store #UNKNOWN.
+ *
+ * Ray marches use this to skip cells which are entirely below the
+ * glide line.
+ */
+class RasterPyramid : private NonCopyable {
+public:
+  /**
+   * The bound of a cell which contains negative heights; such a cell
+   * is never considered clear.
+   */
+  static const short UNKNOWN = 0x7fff;
+
+  /**
+   * A rectangle of pixels whose heights are known to be not above
+   * #height.  The end coordinates are exclusive.
+   */
+  struct Cell {
+    unsigned x0, y0, x1, y1;
+    short height;
+
+    void Clear() {
+      x0 = y0 = x1 = y1 = 0;
+    }
+
+    bool IsInside(unsigned x, unsigned y) const {
+      return x >= x0 && x < x1 && y >= y0 && y < y1;
+    }
+  };
+
+private:
+  struct Level {
+    unsigned width, height;
+
+    /**
+     * The index of the first cell of this level in #data.
+     */
+    unsigned offset;
+  };
+
+  /**
+   * The number of pixel bits per cell of the finest level.
+   */
+  unsigned bits;
+
+  StaticArray<Level, 24> levels;
+
+  AllocatedArray<short> data;
+
+public:
+  RasterPyramid() {
+    Reset();
+  }
+
+  void Reset() {
+    levels.clear();
+  }
+
+  bool IsDefined() const {
+    return !levels.empty();
+  }
+
+  /**
+   * (Re-)build the pyramid from the overview.
+   *
+   * @param bits the overview shift (RasterTileCache::OVERVIEW_BITS)
+   */
+  void Build(const RasterBuffer &overview, unsigned bits);
+
+  /**
+   * Merge the heights of a newly loaded tile.  This only raises
+   * bounds, so they remain valid after the tile is discarded again.
+   *
+   * @param x the first pixel column of the tile
+   * @param y the first pixel row of the tile
+   */
+  void Merge(const RasterBuffer &tile, unsigned x, unsigned y);
+
+  /**
+   * Find the largest cell containing the specified pixel whose bound
+   * is not above the specified height.
+   *
+   * @return true if such a cell was found
+   */
+  bool FindClearCell(unsigned x, unsigned y, int height, Cell &cell) const;
+
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return IsDefined() ? data.size() * sizeof(short) : 0;
+  }
+
+private:
+  short &At(const Level &level, unsigned x, unsigned y) {
+    return data[level.offset + y * level.width + x];
+  }
+
+  short At(const Level &level, unsigned x, unsigned y) const {
+    return data[level.offset + y * level.width + x];
+  }
+
+  /**
+   * Recalculate the cells of all coarser levels covering the
+   * specified rectangle of finest level cells.
+   */
+  void Propagate(unsigned x0, unsigned y0, unsigned x1, unsigned y1);
+};
+
+#endif
@@ -29,12 +29,20 @@ Copyright_License {
 #include "Screen/Layout.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Asset.hpp"
+#include "Util/AllocatedArray.hpp"
 
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
 
 //#define FAST_RSQRT
 
+/**
+ * The minimum number of rows handed to one thread at a time.  Smaller
+ * bands are not worth the synchronisation overhead.
+ */
+static const unsigned MIN_BAND_ROWS = 16;
+
 static inline unsigned
 MIX(unsigned x, unsigned y, unsigned i)
 {
@@ -134,59 +142,168 @@ RasterRenderer::GenerateImage(bool do_shading,
     GenerateUnshadedImage(height_scale);
 }
 
-void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale)
+/**
+ * Colour table index for "outside the terrain file bounds".  It is
+ * not a valid index, and is drawn as white background.
+ */
+static const unsigned short INDEX_INVALID = 256;
+
+/**
+ * Convert a row of heights to colour table indices: heights below
+ * sea level are clamped to zero, water maps to 255 and invalid cells
+ * to #INDEX_INVALID.  There are no data-dependent branches, which
+ * allows the compiler to vectorise this loop.
+ */
+static void
+HeightsToIndices(const short *gcc_restrict src,
+                 unsigned short *gcc_restrict dest,
+                 unsigned n, unsigned height_scale)
 {
-  const short *src = height_matrix.GetData();
-  const BGRColor *oColorBuf = color_table + 64 * 256;
-  BGRColor *dest = image->GetTopRow();
-
-  for (unsigned y = height_matrix.get_height(); y > 0; --y) {
-    BGRColor *p = dest;
-    dest = image->GetNextRow(dest);
-
-    for (unsigned x = height_matrix.get_width(); x > 0; --x) {
-      short h = *src++;
-      if (gcc_likely(!RasterBuffer::is_special(h))) {
-        if (h < 0)
-          h = 0;
-
-        h = min(254, h >> height_scale);
-        *p++ = oColorBuf[h];
-      } else if (RasterBuffer::is_water(h)) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = BGRColor(0xff, 0xff, 0xff);
-      }
+  for (unsigned i = 0; i < n; ++i) {
+    const int h = src[i];
+    int index = h > 0 ? h >> height_scale : 0;
+    index = index < 254 ? index : 254;
+
+    const int special = h == RasterBuffer::TERRAIN_INVALID
+      ? INDEX_INVALID : 255;
+    dest[i] = h <= RasterBuffer::TERRAIN_WATER_THRESHOLD ? special : index;
+  }
+}
+
+/**
+ * Look up the colours of a row of colour table indices.
+ */
+static void
+IndicesToColours(const unsigned short *gcc_restrict src,
+                 BGRColor *gcc_restrict dest,
+                 unsigned n, const BGRColor *table)
+{
+  const BGRColor white(0xff, 0xff, 0xff);
+
+  for (unsigned i = 0; i < n; ++i)
+    dest[i] = gcc_likely(src[i] != INDEX_INVALID) ? table[src[i]] : white;
+}
+
+/**
+ * Set a flag for each cell in [begin, end) which has a "special"
+ * neighbour (water or invalid) at the given offsets.  Slope shading
+ * is skipped for these.
+ */
+static void
+MarkSpecialNeighbours(const short *gcc_restrict row,
+                      const short *gcc_restrict above,
+                      const short *gcc_restrict below,
+                      unsigned char *gcc_restrict dest,
+                      unsigned begin, unsigned end,
+                      unsigned column_minus, unsigned column_plus)
+{
+  for (unsigned x = begin; x < end; ++x)
+    dest[x] = RasterBuffer::is_special(above[x]) |
+      RasterBuffer::is_special(below[x]) |
+      RasterBuffer::is_special(row[x - column_minus]) |
+      RasterBuffer::is_special(row[x + column_plus]);
+}
+
+/**
+ * Renders a range of rows without shading.  Scratch buffers are
+ * allocated per call, because the ranges are processed concurrently.
+ */
+class UnshadedJob : public WorkerPool::Job {
+  const HeightMatrix &height_matrix;
+  RawBitmap &image;
+  const BGRColor *table;
+  unsigned height_scale;
+
+public:
+  UnshadedJob(const HeightMatrix &_height_matrix, RawBitmap &_image,
+              const BGRColor *_table, unsigned _height_scale)
+    :height_matrix(_height_matrix), image(_image),
+     table(_table), height_scale(_height_scale) {}
+
+  virtual void Run(unsigned begin, unsigned end) {
+    const unsigned width = height_matrix.get_width();
+    AllocatedArray<unsigned short> indices(width);
+
+    const short *src = height_matrix.GetData() + begin * width;
+    for (unsigned y = begin; y < end; ++y, src += width) {
+      HeightsToIndices(src, indices.begin(), width, height_scale);
+      IndicesToColours(indices.begin(), image.GetRow(y), width, table);
     }
   }
+};
+
+void
+RasterRenderer::GenerateUnshadedImage(unsigned height_scale)
+{
+  UnshadedJob job(height_matrix, *image, color_table + 64 * 256,
+                  height_scale);
+  workers.Run(job, height_matrix.get_height(), MIN_BAND_ROWS);
 
   image->SetDirty();
 }
 
+static inline unsigned
+ColumnMinusIndex(unsigned x, unsigned border_left, unsigned q)
+{
+  return x >= border_left ? q : x;
+}
+
+static inline unsigned
+ColumnPlusIndex(unsigned x, unsigned width, unsigned border_right,
+                unsigned q)
+{
+  return x < border_right ? q : width - 1 - x;
+}
+
+/**
+ * Renders a range of rows with slope shading.
+ */
+class SlopeJob : public WorkerPool::Job {
+  const HeightMatrix &height_matrix;
+  RawBitmap &image;
+  const BGRColor *color_table;
+  unsigned height_scale;
+  unsigned quantisation_effective;
+  unsigned height_slope_factor;
+  int contrast;
+  int sx, sy, sz;
+
+public:
+  SlopeJob(const HeightMatrix &_height_matrix, RawBitmap &_image,
+           const BGRColor *_color_table,
+           unsigned _height_scale, unsigned _quantisation_effective,
+           unsigned _height_slope_factor, int _contrast,
+           int _sx, int _sy, int _sz)
+    :height_matrix(_height_matrix), image(_image),
+     color_table(_color_table),
+     height_scale(_height_scale),
+     quantisation_effective(_quantisation_effective),
+     height_slope_factor(_height_slope_factor),
+     contrast(_contrast), sx(_sx), sy(_sy), sz(_sz) {}
+
+  virtual void Run(unsigned begin, unsigned end);
+};
+
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
 // grid), then increase the step size to be equal to the terrain
 // grid for purposes of calculating slope, to avoid shading problems
 // (gridding of display) This is why quantisation_effective is used instead of 1
 // previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
-                                   int contrast,
-                                   const int sx, const int sy, const int sz)
+SlopeJob::Run(unsigned begin, unsigned end)
 {
-  assert(quantisation_effective > 0);
+  const unsigned width = height_matrix.get_width();
+  const unsigned height = height_matrix.get_height();
+
+  /* the interior columns, where both horizontal neighbours are
+     quantisation_effective cells away */
+  const unsigned border_left = quantisation_effective;
+  const unsigned border_right = width - quantisation_effective;
+  const unsigned border_bottom = height - quantisation_effective;
+  const unsigned interior_begin = std::min(border_left, width);
+  const unsigned interior_end =
+    std::max(interior_begin, std::min(border_right, width));
 
-  PixelRect border;
-  border.left = quantisation_effective;
-  border.top = quantisation_effective;
-  border.right = height_matrix.get_width() - quantisation_effective;
-  border.bottom = height_matrix.get_height() - quantisation_effective;
-
-  const unsigned height_slope_factor = max(1, (int)pixel_size);
-
-  const short *src = height_matrix.GetData();
   const BGRColor *oColorBuf = color_table + 64 * 256;
 #ifdef FAST_RSQRT
   const short szindex = sz*contrast/128;
@@ -198,109 +315,125 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sz_c = sz*contrast>>7;
 #endif
 
-  BGRColor *dest = image->GetTopRow();
+  AllocatedArray<unsigned short> indices(width);
+  AllocatedArray<unsigned char> skip(width);
 
-  for (unsigned y = 0; y < height_matrix.get_height(); ++y) {
-    const unsigned row_plus_index = y < (unsigned)border.bottom
+  for (unsigned y = begin; y < end; ++y) {
+    const unsigned row_plus_index = y < border_bottom
       ? quantisation_effective
-      : height_matrix.get_height() - 1 - y;
-    const unsigned row_plus_offset = height_matrix.get_width() * row_plus_index;
+      : height - 1 - y;
+    const unsigned row_plus_offset = width * row_plus_index;
 
     const unsigned row_minus_index = y >= quantisation_effective
       ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.get_width() * row_minus_index;
+    const unsigned row_minus_offset = width * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    BGRColor *p = dest;
-    dest = image->GetNextRow(dest);
-
-    for (unsigned x = 0; x < height_matrix.get_width(); ++x, ++src) {
-      short h = *src;
-      if (gcc_likely(!RasterBuffer::is_special(h))) {
-        if (h < 0)
-          h = 0;
-
-        h = min(254, h >> height_scale);
-
-        // no need to calculate slope if undefined height or sea level
-
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
-        // X direction
-
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.get_width() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
-
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
-
-        short h_above = src[-(int)row_minus_offset];
-        short h_below = src[row_plus_offset];
-        short h_left = src[-(int)column_minus_index];
-        short h_right = src[column_plus_index];
-
-        if (gcc_unlikely(RasterBuffer::is_special(h_above) ||
-                         RasterBuffer::is_special(h_below) ||
-                         RasterBuffer::is_special(h_left) ||
-                         RasterBuffer::is_special(h_right))) {
-          /* some "special" terrain value surrounding us (water or
-             invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
-          continue;
-        }
+    const short *src = height_matrix.GetData() + y * width;
+    const short *above = src - row_minus_offset;
+    const short *below = src + row_plus_offset;
+
+    assert(above >= height_matrix.GetData());
+    assert(below + width <= height_matrix.GetDataEnd());
+
+    HeightsToIndices(src, indices.begin(), width, height_scale);
+
+    /* flag the cells next to water or invalid terrain; the edge
+       columns have smaller horizontal offsets */
+    MarkSpecialNeighbours(src, above, below, skip.begin(),
+                          interior_begin, interior_end,
+                          quantisation_effective, quantisation_effective);
+    for (unsigned x = 0; x < width; ++x) {
+      if (x == interior_begin)
+        x = interior_end;
+      if (x >= width)
+        break;
+
+      MarkSpecialNeighbours(src, above, below, skip.begin(), x, x + 1,
+                            ColumnMinusIndex(x, border_left,
+                                             quantisation_effective),
+                            ColumnPlusIndex(x, width, border_right,
+                                            quantisation_effective));
+    }
+
+    BGRColor *p = image.GetRow(y);
+
+    for (unsigned x = 0; x < width; ++x, ++p) {
+      const unsigned short index = indices[x];
+      if (gcc_unlikely(index >= 255)) {
+        /* water, or outside the terrain file bounds: white
+           background */
+        *p = index == 255
+          ? oColorBuf[255]
+          : BGRColor(0xff, 0xff, 0xff);
+        continue;
+      }
+
+      if (gcc_unlikely(skip[x])) {
+        /* some "special" terrain value surrounding us (water or
+           invalid), skip slope calculation */
+        *p = oColorBuf[index];
+        continue;
+      }
+
+      const unsigned column_plus_index =
+        ColumnPlusIndex(x, width, border_right, quantisation_effective);
+      const unsigned column_minus_index =
+        ColumnMinusIndex(x, border_left, quantisation_effective);
+
+      assert(x >= column_minus_index);
+      assert(x + column_plus_index < width);
 
-        const int p32 = h_above - h_below;
-        const int p22 = h_right - h_left;
+      const int p32 = above[x] - below[x];
+      const int p22 = src[x + column_plus_index] - src[x - column_minus_index];
 
-        const unsigned p20 = column_plus_index + column_minus_index;
+      const unsigned p20 = column_plus_index + column_minus_index;
 
-        const int dd0 = p22 * p31;
-        const int dd1 = p20 * p32;
-        const int dd2 = p20 * p31 * height_slope_factor;
+      const int dd0 = p22 * p31;
+      const int dd1 = p20 * p32;
+      const int dd2 = p20 * p31 * height_slope_factor;
 #ifndef FAST_RSQRT
-        const int num = (dd2 * sz + dd0 * sx + dd1 * sy);
-        const int mag = (dd0 * dd0 + dd1 * dd1 + dd2 * dd2);
+      const int num = (dd2 * sz + dd0 * sx + dd1 * sy);
+      const int mag = (dd0 * dd0 + dd1 * dd1 + dd2 * dd2);
 #ifdef FIXED_MATH
-        const int sval = num / (int)isqrt4(mag);
+      const int sval = num / (int)isqrt4(mag);
 #else
-        const int sval = num / (int)sqrt((fixed)mag);
+      const int sval = num / (int)sqrt((fixed)mag);
 #endif
-        int sindex = (sval - sz) * contrast / 128;
-        if (gcc_unlikely(sindex < -64))
-          sindex = -64;
-        if (gcc_unlikely(sindex > 63))
-          sindex = 63;
-        *p++ = oColorBuf[h + 256*sindex];
+      int sindex = (sval - sz) * contrast / 128;
+      if (gcc_unlikely(sindex < -64))
+        sindex = -64;
+      if (gcc_unlikely(sindex > 63))
+        sindex = 63;
+      *p = oColorBuf[index + 256*sindex];
 #else
-        const int num = (dd2 * sz_c + dd0 * sx_c + dd1 * sy_c);
-        const int sval = i_normalise_mag3(num, dd0, dd1, dd2);
-        if (gcc_unlikely(sval<=sval_min))
-          *p++ = color_table[h];
-        else if (gcc_unlikely(sval >= sval_max))
-          *p++ = color_table[h + 127*256];
-        else
-          *p++ = szColorBuf[h + (sval*256)];
-
+      const int num = (dd2 * sz_c + dd0 * sx_c + dd1 * sy_c);
+      const int sval = i_normalise_mag3(num, dd0, dd1, dd2);
+      if (gcc_unlikely(sval<=sval_min))
+        *p = color_table[index];
+      else if (gcc_unlikely(sval >= sval_max))
+        *p = color_table[index + 127*256];
+      else
+        *p = szColorBuf[index + (sval*256)];
 #endif
-      } else if (RasterBuffer::is_water(h)) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = BGRColor(0xff, 0xff, 0xff);
-      }
     }
   }
+}
+
+void
+RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+                                   int contrast,
+                                   const int sx, const int sy, const int sz)
+{
+  assert(quantisation_effective > 0);
+
+  const unsigned height_slope_factor = max(1, (int)pixel_size);
+
+  SlopeJob job(height_matrix, *image, color_table,
+               height_scale, quantisation_effective, height_slope_factor,
+               contrast, sx, sy, sz);
+  workers.Run(job, height_matrix.get_height(), MIN_BAND_ROWS);
 
   image->SetDirty();
 }
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Terrain/HeightMatrix.hpp"
 #include "Screen/RawBitmap.hpp"
 #include "Util/NonCopyable.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #define NUM_COLOR_RAMP_LEVELS 13
 
@@ -52,6 +53,11 @@ class RasterRenderer : private NonCopyable {
 
   BGRColor color_table[256 * 128];
 
+  /**
+   * The threads which render bands of rows in GenerateImage().
+   */
+  WorkerPool workers;
+
 public:
   RasterRenderer();
   ~RasterRenderer();
@@ -78,6 +78,25 @@ public:
     return lease->GetHeight(location);
   }
 
+  /**
+   * Determine the heights of many locations with only one lease.
+   */
+  void GetTerrainHeights(const GeoPoint *locations, short *heights,
+                         unsigned n) const {
+    Lease lease(*this);
+    lease->GetHeights(locations, heights, n);
+  }
+
+  /**
+   * Determine the pixel which contains the specified location.  The
+   * projection is set up by the constructor and never changes, so
+   * this does not need a lease.
+   */
+  gcc_pure
+  RasterLocation GetTerrainPixel(const GeoPoint location) const {
+    return map.GetPixel(location);
+  }
+
   GeoPoint GetTerrainCenter() const {
     return map.GetMapCenter();
   }
@@ -28,6 +28,8 @@ Copyright_License {
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Math/FastMath.h"
+#include "Tracing/Tracing.hpp"
+#include "Thread/FastMutex.hpp"
 
 #include <stdlib.h>
 #include <algorithm>
@@ -255,6 +257,63 @@ RasterTileCache::GetHeight(unsigned px, unsigned py) const
                                    py << (SUBPIXEL_BITS - OVERVIEW_BITS));
 }
 
+/**
+ * A pixel of a GetHeights() call, sorted by tile.
+ */
+struct TileOrderItem {
+  unsigned tile, index;
+
+  bool operator<(const TileOrderItem &other) const {
+    return tile < other.tile;
+  }
+};
+
+void
+RasterTileCache::GetHeights(const RasterLocation *pixels, short *heights,
+                            unsigned n) const
+{
+  /* sort in chunks, to avoid a heap allocation */
+  static const unsigned CHUNK_SIZE = 64;
+  TileOrderItem order[CHUNK_SIZE];
+
+  for (unsigned start = 0; start < n; start += CHUNK_SIZE) {
+    const unsigned size = std::min(n - start, CHUNK_SIZE);
+
+    for (unsigned i = 0; i < size; ++i) {
+      const RasterLocation &p = pixels[start + i];
+      order[i].tile = p.x < width && p.y < height
+        ? (p.y / tile_height) * tiles.GetWidth() + p.x / tile_width
+        : UINT_MAX;
+      order[i].index = start + i;
+    }
+
+    std::sort(order, order + size);
+
+    const RasterTile *tile = NULL;
+    unsigned current = UINT_MAX;
+    for (const TileOrderItem *i = order, *end = order + size; i != end; ++i) {
+      const RasterLocation &p = pixels[i->index];
+      short &h = heights[i->index];
+
+      if (i->tile == UINT_MAX) {
+        // outside overall bounds
+        h = RasterBuffer::TERRAIN_INVALID;
+        continue;
+      }
+
+      if (i->tile != current) {
+        current = i->tile;
+        tile = &tiles.GetLinear(current);
+      }
+
+      h = tile->IsEnabled()
+        ? tile->GetHeight(p.x, p.y)
+        : Overview.get_interpolated(p.x << (SUBPIXEL_BITS - OVERVIEW_BITS),
+                                    p.y << (SUBPIXEL_BITS - OVERVIEW_BITS));
+    }
+  }
+}
+
 short
 RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
 {
@@ -303,6 +362,22 @@ RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
   bounds_initialised = true;
 }
 
+size_t
+RasterTileCache::GetMemoryUsage() const
+{
+  size_t size =
+    Overview.get_width() * Overview.get_height() * sizeof(short) +
+    pyramid.GetMemoryUsage() +
+    tiles.GetSize() * sizeof(RasterTile);
+
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    if (it->IsEnabled())
+      size += it->buffer.get_width() * it->buffer.get_height() *
+        sizeof(short);
+
+  return size;
+}
+
 void
 RasterTileCache::Reset()
 {
@@ -314,6 +389,8 @@ RasterTileCache::Reset()
   scan_overview = true;
 
   Overview.reset();
+  pyramid.Reset();
+  statistics.Clear();
 
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
@@ -416,15 +493,24 @@ RasterTileCache::MarkerSegment(long file_offset, unsigned id)
 
 extern RasterTileCache *raster_tile_current;
 
+/**
+ * The JPEG2000 decoder reports to #raster_tile_current, so only one
+ * file may be decoded at a time.
+ */
+static FastMutex jpg2000_mutex;
+
 void
 RasterTileCache::LoadJPG2000(const char *jp2_filename)
 {
   jas_stream_t *in;
 
+  jpg2000_mutex.Lock();
+
   raster_tile_current = this;
 
   in = jas_stream_fopen(jp2_filename, "rb");
   if (!in) {
+    jpg2000_mutex.Unlock();
     Reset();
     return;
   }
@@ -434,6 +520,8 @@ RasterTileCache::LoadJPG2000(const char *jp2_filename)
 
   jp2_decode(in, scan_overview ? "xcsoar=2" : "xcsoar=1");
   jas_stream_close(in);
+
+  jpg2000_mutex.Unlock();
 }
 
 bool
@@ -514,7 +602,9 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file,
   if (initialised && !bounds_initialised)
     initialised = false;
 
-  if (!initialised)
+  if (initialised)
+    pyramid.Build(Overview, OVERVIEW_BITS);
+  else
     Reset();
 
   operation = NULL;
@@ -527,17 +617,24 @@ RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
   if (!PollTiles(x, y, radius))
     return;
 
+  TRACE_SPAN("RasterTileCache::UpdateTiles");
+
   remaining_segments = 0;
 
   LoadJPG2000(path);
 
-  /* permanently disable the requested tiles which are still not
-     loaded, to prevent trying to reload them over and over in a busy
-     loop */
+  /* merge the new tiles into the max pyramid; permanently disable
+     the requested tiles which are still not loaded, to prevent trying
+     to reload them over and over in a busy loop */
   for (auto it = RequestTiles.begin(), end = RequestTiles.end();
       it != end; ++it) {
     RasterTile &tile = tiles.GetLinear(*it);
-    if (tile.is_requested() && !tile.IsEnabled())
+    if (!tile.is_requested())
+      continue;
+
+    if (tile.IsEnabled())
+      pyramid.Merge(tile.buffer, tile.xstart, tile.ystart);
+    else
       tile.Clear();
   }
 
@@ -642,6 +739,8 @@ RasterTileCache::LoadCache(FILE *file)
             overview_size, file) != overview_size)
     return false;
 
+  pyramid.Build(Overview, OVERVIEW_BITS);
+
   initialised = true;
   scan_overview = false;
   return true;
@@ -1037,16 +1136,17 @@ RasterTileCache::FirstIntersection(int x0, int y0,
   unsigned last_clear_y = y0;
   short last_clear_h = h_origin;
 
+  // the last cell which was found to be below the glide
+  RasterPyramid::Cell clear;
+  clear.Clear();
+
   while (h_terrain>=0) {
 
     if (!step_counter) {
 
-      if ((_x >= width) || (_y >= height))
+      if ((x_int >= width) || (y_int >= height))
         break; // outside bounds
 
-      h_terrain = GetFieldDirect(x_int, y_int, tile_index)+h_safety;
-      step_counter = tile_index<0? step_coarse: step_fine;
-
       // calculate height of glide so far
       const short dh = (short)((total_steps*slope_fact)>>RASTER_SLOPE_FACT);
 
@@ -1056,6 +1156,13 @@ RasterTileCache::FirstIntersection(int x0, int y0,
         h_int = std::min(h_int, h_dest);
       }
 
+      // a negative safety height could turn a skipped sample into an
+      // invalid one, so don't use the pyramid then
+      h_terrain = GetFieldBelow(x_int, y_int,
+                                h_safety >= 0 ? h_int - h_safety : -1,
+                                clear, tile_index) + h_safety;
+      step_counter = tile_index<0? step_coarse: step_fine;
+
 #ifdef DEBUG_TILE
       printf("%d %d %d %d %d # fint\n", x_int, y_int, h_int, h_terrain, h_ceiling);
 #endif
@@ -1187,6 +1294,21 @@ RasterTileCache::GetFieldDirect(const unsigned px, const unsigned py, int& tile_
   return Overview.get(x_overview, y_overview);
 }
 
+short
+RasterTileCache::GetFieldBelow(unsigned px, unsigned py, int limit,
+                               RasterPyramid::Cell &clear,
+                               int &tile_index) const
+{
+  if ((clear.IsInside(px, py) && clear.height <= limit) ||
+      (limit >= 0 && pyramid.FindClearCell(px, py, limit, clear))) {
+    ++statistics.skipped;
+    return clear.height;
+  }
+
+  ++statistics.lookups;
+  return GetFieldDirect(px, py, tile_index);
+}
+
 RasterLocation
 RasterTileCache::Intersection(int x0, int y0,
                               int x1, int y1,
@@ -1242,6 +1364,10 @@ RasterTileCache::Intersection(int x0, int y0,
   unsigned last_clear_y = _y;
   short last_clear_h = h_int;
 
+  // the last cell which was found to be below the glide
+  RasterPyramid::Cell clear;
+  clear.Clear();
+
   while (h_terrain>=0) {
 
     if (!step_counter) {
@@ -1249,15 +1375,15 @@ RasterTileCache::Intersection(int x0, int y0,
       if ((_x >= width) || (_y >= height))
         break; // outside bounds
 
-      h_terrain = GetFieldDirect(_x, _y, tile_index);
-      step_counter = tile_index<0? step_coarse: step_fine;
-
       // calculate height of glide so far
       const short dh = (short)((total_steps*slope_fact)>>RASTER_SLOPE_FACT);
 
       // current aircraft height
       h_int = h_origin-dh;
 
+      h_terrain = GetFieldBelow(_x, _y, h_int, clear, tile_index);
+      step_counter = tile_index<0? step_coarse: step_fine;
+
       if (h_int < h_terrain) {
         if (refine_step<3) // can't refine any further
           return RasterLocation(last_clear_x, last_clear_y);
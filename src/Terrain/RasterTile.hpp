@@ -24,6 +24,7 @@ Copyright_License {
 #define XCSOAR_RASTERTILE_HPP
 
 #include "Terrain/RasterBuffer.hpp"
+#include "Terrain/RasterPyramid.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
@@ -190,6 +191,23 @@ class RasterTileCache : private NonCopyable {
   static const unsigned INTERSECT_BITS = 7;
 
 public:
+  /**
+   * Counts the terrain samples taken by FirstIntersection() and
+   * Intersection().  These are diagnostics only, and are updated
+   * without locking.
+   */
+  struct IntersectionStatistics {
+    /** samples which were looked up in the overview or a tile */
+    unsigned lookups;
+
+    /** samples which were proven clear by the max pyramid */
+    unsigned skipped;
+
+    void Clear() {
+      lookups = skipped = 0;
+    }
+  };
+
   /**
    * The fixed-point fractional part of sub-pixel coordinates.
    *
@@ -263,6 +281,15 @@ protected:
   unsigned short tile_width, tile_height;
 
   RasterBuffer Overview;
+
+  /**
+   * Maximum heights of the overview and all tiles loaded so far, for
+   * skipping cells in intersection searches.
+   */
+  RasterPyramid pyramid;
+
+  mutable IntersectionStatistics statistics;
+
   bool scan_overview;
   unsigned int width, height;
   unsigned int overview_width_fine, overview_height_fine;
@@ -308,6 +335,17 @@ public:
   gcc_pure
   short GetHeight(unsigned x, unsigned y) const;
 
+  /**
+   * Like GetHeight(), but for many pixels at once.  The pixels are
+   * visited tile by tile, so each tile is looked up only once and
+   * its buffer is read in one go.
+   *
+   * @param pixels the pixel locations; may be out of range
+   * @param heights the destination array, in the order of #pixels
+   */
+  void GetHeights(const RasterLocation *pixels, short *heights,
+                  unsigned n) const;
+
   /**
    * Determine the interpolated height at the specified sub-pixel
    * location.
@@ -359,6 +397,19 @@ protected:
    */
   short GetFieldDirect(const unsigned px, const unsigned py, int &tile_index) const;
 
+  /**
+   * Like GetFieldDirect(), but if the max pyramid proves that the
+   * height at this location is not above the specified limit, return
+   * the bound instead of looking up the actual height.  The clear
+   * cell is remembered in #clear, so following samples within it are
+   * answered without any lookup.
+   *
+   * @param limit the height which must not be exceeded; a negative
+   * value disables the pyramid
+   */
+  short GetFieldBelow(unsigned px, unsigned py, int limit,
+                      RasterPyramid::Cell &clear, int &tile_index) const;
+
 public:
   bool LoadOverview(const char *path, const TCHAR *world_file,
                     OperationEnvironment &operation);
@@ -430,8 +481,19 @@ public:
     return Overview.get_max();
   }
 
+  const IntersectionStatistics &GetIntersectionStatistics() const {
+    return statistics;
+  }
+
   unsigned int GetWidth() const { return width; }
   unsigned int GetHeight() const { return height; }
+
+  /**
+   * Estimate the number of bytes allocated on the heap by this
+   * object: the overview, the tile table and all loaded tiles.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const;
 };
 
 #endif
@@ -101,7 +101,11 @@ RasterWeather::RasterWeather()
     _parameter(0),
     _weather_time(0),
     reload(true),
-    weather_map(NULL)
+    weather_map(NULL),
+    active_key(0, 0, 0),
+    view_location(GeoPoint::Invalid()),
+    view_radius(fixed_zero),
+    cache(OpenMap)
 {
   std::fill(weather_available, weather_available + MAX_WEATHER_TIMES, false);
 }
@@ -185,8 +189,8 @@ RasterWeather::GetFilename(TCHAR *rasp_filename, const TCHAR* name,
   LocalPath(rasp_filename, fname);
 }
 
-bool
-RasterWeather::LoadItem(const TCHAR* name, unsigned time_index,
+RasterMap *
+RasterWeather::OpenItem(const TCHAR* name, unsigned time_index,
                         OperationEnvironment &operation)
 {
   TCHAR rasp_filename[MAX_PATH];
@@ -194,12 +198,79 @@ RasterWeather::LoadItem(const TCHAR* name, unsigned time_index,
   RasterMap *map = new RasterMap(rasp_filename, NULL, NULL, operation);
   if (!map->isMapLoaded()) {
     delete map;
-    return false;
+    return NULL;
   }
 
-  delete weather_map;
-  weather_map = map;
-  return true;
+  return map;
+}
+
+RasterMap *
+RasterWeather::OpenMap(unsigned parameter, unsigned time_index,
+                       OperationEnvironment &operation)
+{
+  assert(parameter > 0 && parameter < MAX_WEATHER_MAP);
+
+  const TCHAR *name = WeatherDescriptors[parameter].name;
+  if (name == NULL)
+    return NULL;
+
+  RasterMap *map = OpenItem(name, time_index, operation);
+  if (map == NULL && parameter == 1)
+    map = OpenItem(_T("wstar_bsratio"), time_index, operation);
+
+  return map;
+}
+
+/**
+ * Returns the modification time of the RASP file, to tell cached maps
+ * of a replaced file apart.
+ */
+static uint64_t
+GetRASPStamp()
+{
+  TCHAR path[MAX_PATH];
+  LocalPath(path, _T("xcsoar-rasp.dat"));
+
+  uint64_t mtime, size;
+  return File::GetInfo(path, mtime, size) ? mtime : 0;
+}
+
+void
+RasterWeather::Activate(unsigned time_index, OperationEnvironment &operation)
+{
+  const uint64_t stamp = GetRASPStamp();
+  const RasterWeatherCache::Key key(_parameter, time_index, stamp);
+
+  /* keep the previous map around, the user may step back to it */
+  if (weather_map != NULL)
+    cache.Put(active_key, weather_map);
+
+  weather_map = cache.Take(key);
+  if (weather_map == NULL)
+    weather_map = OpenMap(_parameter, time_index, operation);
+
+  active_key = key;
+  center = GeoPoint(Angle::Zero(), Angle::Zero());
+
+  /* prefetch the neighbouring time slots, next one first */
+  RasterWeatherCache::Key neighbours[2];
+  unsigned n = 0;
+
+  for (unsigned i = time_index + 1; i < MAX_WEATHER_TIMES; ++i) {
+    if (weather_available[i]) {
+      neighbours[n++] = RasterWeatherCache::Key(_parameter, i, stamp);
+      break;
+    }
+  }
+
+  for (unsigned i = time_index; i > 0; --i) {
+    if (weather_available[i - 1]) {
+      neighbours[n++] = RasterWeatherCache::Key(_parameter, i - 1, stamp);
+      break;
+    }
+  }
+
+  cache.Prefetch(neighbours, n, view_location, view_radius);
 }
 
 bool
@@ -283,12 +354,7 @@ RasterWeather::Reload(int day_time, OperationEnvironment &operation)
     } else {
       found = true;
 
-      _Close();
-
-      if (!LoadItem(WeatherDescriptors[_parameter].name, _weather_time,
-                    operation) &&
-          _parameter == 1)
-        LoadItem(_T("wstar_bsratio"), _weather_time, operation);
+      Activate(_weather_time, operation);
     }
   }
 
@@ -300,6 +366,8 @@ RasterWeather::Reload(int day_time, OperationEnvironment &operation)
 void
 RasterWeather::Close()
 {
+  cache.Clear();
+
   Poco::ScopedRWLock protect(lock, true);
   _Close();
 }
@@ -321,6 +389,9 @@ RasterWeather::SetViewCenter(const GeoPoint &location, fixed radius)
 
   Poco::ScopedRWLock protect(lock, true);
 
+  view_location = location;
+  view_radius = radius;
+
   /* only update the RasterMap if the center was moved far enough */
   if (center.Distance(location) < fixed(1000))
     return;
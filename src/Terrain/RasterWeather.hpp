@@ -24,6 +24,7 @@ Copyright_License {
 #ifndef XCSOAR_TERRAIN_RASTER_WEATHER_HPP
 #define XCSOAR_TERRAIN_RASTER_WEATHER_HPP
 
+#include "Terrain/RasterWeatherCache.hpp"
 #include "Engine/Navigation/GeoPoint.hpp"
 #include "Poco/RWLock.h"
 #include "Compiler.h"
@@ -50,6 +51,24 @@ private:
   bool reload;
   RasterMap *weather_map;
 
+  /**
+   * The parameter and time slot of #weather_map.
+   */
+  RasterWeatherCache::Key active_key;
+
+  /**
+   * The most recent view passed to SetViewCenter(); used for
+   * prefetching.
+   */
+  GeoPoint view_location;
+  fixed view_radius;
+
+  /**
+   * Decoded maps which are not displayed currently, and the thread
+   * which loads the neighbouring time slots in advance.
+   */
+  RasterWeatherCache cache;
+
   mutable Poco::RWLock lock;
 
   bool weather_available[MAX_WEATHER_TIMES];
@@ -96,6 +115,22 @@ public:
 
   void SetTime(unsigned i);
 
+  /**
+   * Limit the memory used by maps which are cached for quick
+   * switching.
+   */
+  void SetCacheBudget(size_t bytes) {
+    cache.SetBudget(bytes);
+  }
+
+  /**
+   * Load the map for the specified parameter and time slot.
+   *
+   * @return the new map (to be freed by the caller) or NULL on error
+   */
+  static RasterMap *OpenMap(unsigned parameter, unsigned time_index,
+                            OperationEnvironment &operation);
+
   gcc_const
   static int IndexToTime(int index);
 
@@ -106,8 +141,15 @@ private:
   static void GetFilename(TCHAR *rasp_filename, const TCHAR *name,
                           unsigned time_index);
 
-  bool LoadItem(const TCHAR* name, unsigned time_index,
-                OperationEnvironment &operation);
+  static RasterMap *OpenItem(const TCHAR* name, unsigned time_index,
+                             OperationEnvironment &operation);
+
+  /**
+   * Make the specified time slot of the current parameter active,
+   * and schedule its neighbours for prefetching.  Caller must hold
+   * the write lock.
+   */
+  void Activate(unsigned time_index, OperationEnvironment &operation);
 
   gcc_pure
   bool ExistsItem(struct zzip_dir *dir, const TCHAR* name,
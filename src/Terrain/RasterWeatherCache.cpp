@@ -0,0 +1,229 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterWeatherCache.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Operation/Operation.hpp"
+#include "Tracing/Tracing.hpp"
+
+#include <algorithm>
+
+RasterWeatherCache::RasterWeatherCache(LoadFunction _load, size_t _budget)
+  :load(_load), budget(_budget), used(0), is_loading(false), skip_tiles(false),
+   center(GeoPoint::Invalid()), radius(fixed_zero),
+   hits(0), misses(0) {}
+
+RasterWeatherCache::~RasterWeatherCache()
+{
+  Clear();
+}
+
+void
+RasterWeatherCache::SetBudget(size_t _budget)
+{
+  ScopeLock protect(mutex);
+  budget = _budget;
+  Trim();
+}
+
+std::list<RasterWeatherCache::Item>::iterator
+RasterWeatherCache::Find(const Key &key)
+{
+  for (auto i = items.begin(), end = items.end(); i != end; ++i)
+    if (i->key == key)
+      return i;
+
+  return items.end();
+}
+
+void
+RasterWeatherCache::Trim()
+{
+  while (used > budget && !items.empty()) {
+    const Item &item = items.back();
+    used -= item.size;
+    delete item.map;
+    items.pop_back();
+  }
+}
+
+void
+RasterWeatherCache::Publish() const
+{
+  TRACE_COUNTER("RasterWeatherCache.hits", hits);
+  TRACE_COUNTER("RasterWeatherCache.misses", misses);
+  TRACE_COUNTER("RasterWeatherCache.bytes", used);
+}
+
+RasterMap *
+RasterWeatherCache::Take(const Key &key)
+{
+  ScopeLock protect(mutex);
+
+  if (is_loading && loading == key) {
+    /* the thread has already started decoding it: skip the rest of
+       the queue and the tiles, and wait for this one */
+    queue.clear();
+    skip_tiles = true;
+    WaitDone();
+    skip_tiles = false;
+  } else
+    /* waiting for a queued map would block the caller for the whole
+       queue; loading it directly is faster */
+    queue.shrink(std::remove(queue.begin(), queue.end(), key) -
+                 queue.begin());
+
+  auto i = Find(key);
+  if (i == items.end()) {
+    ++misses;
+    Publish();
+    return NULL;
+  }
+
+  RasterMap *map = i->map;
+  used -= i->size;
+  items.erase(i);
+
+  ++hits;
+  Publish();
+  return map;
+}
+
+void
+RasterWeatherCache::Put(const Key &key, RasterMap *map)
+{
+  if (map == NULL)
+    return;
+
+  const size_t size = map->GetMemoryUsage();
+
+  ScopeLock protect(mutex);
+
+  auto i = Find(key);
+  if (i != items.end()) {
+    used -= i->size;
+    delete i->map;
+    items.erase(i);
+  }
+
+  items.push_front(Item(key, map, size));
+  used += size;
+  Trim();
+  Publish();
+}
+
+void
+RasterWeatherCache::Prefetch(const Key *keys, unsigned n,
+                             const GeoPoint &_center, fixed _radius)
+{
+  ScopeLock protect(mutex);
+
+  queue.clear();
+  /* reverse order: the thread takes the last one first */
+  for (unsigned i = n; i > 0 && !queue.full(); --i) {
+    const Key &key = keys[i - 1];
+    if ((!is_loading || loading != key) && Find(key) == items.end())
+      queue.append(key);
+  }
+
+  center = _center;
+  radius = _radius;
+
+  if (!queue.empty() && !IsBusy())
+    Trigger();
+}
+
+void
+RasterWeatherCache::WaitPrefetch()
+{
+  ScopeLock protect(mutex);
+  WaitDone();
+}
+
+void
+RasterWeatherCache::Clear()
+{
+  ScopeLock protect(mutex);
+
+  Stop();
+
+  queue.clear();
+
+  for (auto i = items.begin(), end = items.end(); i != end; ++i)
+    delete i->map;
+  items.clear();
+  used = 0;
+}
+
+void
+RasterWeatherCache::Tick()
+{
+  /* check IsStopped() after each item: Clear() blocks the main
+     thread until this method returns */
+  while (!queue.empty() && !IsStopped()) {
+    loading = queue.back();
+    queue.shrink(queue.size() - 1);
+
+    if (Find(loading) != items.end())
+      continue;
+
+    is_loading = true;
+    const Key key = loading;
+    const GeoPoint _center = center;
+    const fixed _radius = radius;
+
+    mutex.Unlock();
+
+    NullOperationEnvironment operation;
+    RasterMap *map = load(key.parameter, key.time_index, operation);
+    if (map != NULL && _center.IsValid() && positive(_radius)) {
+      /* load the tiles for the current view; give up after a few
+         rounds, the rest will be loaded when the map gets active */
+      for (unsigned i = 0; i < 16; ++i) {
+        map->SetViewCenter(_center, _radius);
+        if (!map->IsDirty())
+          break;
+
+        ScopeLock protect(mutex);
+        if (IsStopped() || skip_tiles)
+          break;
+      }
+    }
+
+    const size_t size = map != NULL ? map->GetMemoryUsage() : 0;
+
+    mutex.Lock();
+
+    is_loading = false;
+
+    if (map != NULL) {
+      if (Find(key) == items.end()) {
+        items.push_front(Item(key, map, size));
+        used += size;
+        Trim();
+      } else
+        /* Put() was faster */
+        delete map;
+    }
+  }
+}
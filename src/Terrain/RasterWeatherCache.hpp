@@ -0,0 +1,212 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_WEATHER_CACHE_HPP
+#define XCSOAR_TERRAIN_RASTER_WEATHER_CACHE_HPP
+
+#include "Thread/StandbyThread.hpp"
+#include "Engine/Navigation/GeoPoint.hpp"
+#include "Util/StaticArray.hpp"
+#include "Compiler.h"
+
+#include <list>
+#include <stddef.h>
+#include <stdint.h>
+
+class RasterMap;
+class OperationEnvironment;
+
+/**
+ * A least-recently-used cache of decoded RASP maps, keyed by weather
+ * parameter and time slot.  A background thread loads maps which are
+ * likely to be needed next (e.g. the neighbouring time slots), so
+ * stepping through the forecast does not have to wait for the
+ * JPEG2000 decoder.
+ *
+ * The cache owns only maps which are not currently displayed; the
+ * active map is taken out with Take() and given back with Put().
+ * The memory used by the cached maps is limited by a budget.
+ */
+class RasterWeatherCache : private StandbyThread {
+public:
+  /**
+   * The default memory budget [bytes].
+   */
+#if defined(ANDROID)
+  static const size_t DEFAULT_BUDGET = 16 * 1024 * 1024;
+#elif !defined(_WIN32_WCE)
+  static const size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+#else
+  static const size_t DEFAULT_BUDGET = 4 * 1024 * 1024;
+#endif
+
+  /**
+   * The maximum number of maps which can be queued for prefetching.
+   */
+  static const unsigned MAX_PREFETCH = 4;
+
+  struct Key {
+    unsigned parameter, time_index;
+
+    /**
+     * Identifies the version of the RASP file the map was loaded
+     * from (e.g. its modification time), so maps from a replaced
+     * file are never returned.
+     */
+    uint64_t stamp;
+
+    Key() = default;
+    Key(unsigned _parameter, unsigned _time_index, uint64_t _stamp)
+      :parameter(_parameter), time_index(_time_index), stamp(_stamp) {}
+
+    bool operator==(const Key &other) const {
+      return parameter == other.parameter && time_index == other.time_index &&
+        stamp == other.stamp;
+    }
+
+    bool operator!=(const Key &other) const {
+      return !(*this == other);
+    }
+  };
+
+  /**
+   * Loads a map; called by the thread without holding the mutex.
+   *
+   * @return the new map or NULL on error
+   */
+  typedef RasterMap *(*LoadFunction)(unsigned parameter, unsigned time_index,
+                                     OperationEnvironment &operation);
+
+private:
+  struct Item {
+    Key key;
+    RasterMap *map;
+    size_t size;
+
+    Item(const Key &_key, RasterMap *_map, size_t _size)
+      :key(_key), map(_map), size(_size) {}
+  };
+
+  /**
+   * The cached maps, most recently used first.
+   */
+  std::list<Item> items;
+
+  const LoadFunction load;
+
+  size_t budget, used;
+
+  /**
+   * Maps which shall be loaded by the thread.  The most important one
+   * is the last, because the thread takes them from the end.
+   */
+  StaticArray<Key, MAX_PREFETCH> queue;
+
+  /**
+   * The map which is currently being loaded by the thread.
+   */
+  Key loading;
+  bool is_loading;
+
+  /**
+   * Take() waits for #loading; skip its tiles.
+   */
+  bool skip_tiles;
+
+  /**
+   * The view which the thread loads the tiles for.
+   */
+  GeoPoint center;
+  fixed radius;
+
+  unsigned hits, misses;
+
+public:
+  explicit RasterWeatherCache(LoadFunction _load,
+                              size_t _budget=DEFAULT_BUDGET);
+
+  /**
+   * Stops the thread and deletes all cached maps.
+   */
+  ~RasterWeatherCache();
+
+  /**
+   * Change the memory budget, and discard maps which exceed it.
+   */
+  void SetBudget(size_t _budget);
+
+  /**
+   * Remove the specified map from the cache and return it to the
+   * caller, who becomes its owner.  If the thread is already loading
+   * this map, wait for it (without its tiles); if it is only queued,
+   * remove it from the queue and let the caller load it.
+   *
+   * @return the map or NULL if it is not cached
+   */
+  RasterMap *Take(const Key &key);
+
+  /**
+   * Give a map to the cache.  It may be deleted right away if it does
+   * not fit into the budget.
+   */
+  void Put(const Key &key, RasterMap *map);
+
+  /**
+   * Replace the prefetch queue.  The thread will load the specified
+   * maps (unless already cached), and the tiles around the specified
+   * view.
+   */
+  void Prefetch(const Key *keys, unsigned n,
+                const GeoPoint &center, fixed radius);
+
+  /**
+   * Wait until the thread has worked through the prefetch queue.
+   */
+  void WaitPrefetch();
+
+  /**
+   * Stop the thread and delete all cached maps.
+   */
+  void Clear();
+
+private:
+  gcc_pure
+  std::list<Item>::iterator Find(const Key &key);
+
+  /**
+   * Delete the least recently used maps until the budget is met.
+   * Caller must lock the mutex.
+   */
+  void Trim();
+
+  /**
+   * Publish the hit/miss counters.
+   */
+  void Publish() const;
+
+protected:
+  /* virtual methods from class StandbyThread */
+  virtual void Tick();
+};
+
+#endif
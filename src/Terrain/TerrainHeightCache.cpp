@@ -0,0 +1,59 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/TerrainHeightCache.hpp"
+#include "Terrain/RasterTerrain.hpp"
+
+void
+TerrainHeightCache::Flush()
+{
+  for (unsigned i = 0; i < SIZE; ++i)
+    entries[i].valid = false;
+}
+
+short
+TerrainHeightCache::GetHeight(const RasterTerrain &_terrain,
+                              const GeoPoint &location)
+{
+  /* the serial is checked before the lookup: if tiles get loaded
+     during the lookup, the next call will flush the result */
+  const Serial current = _terrain.GetSerial();
+  if (&_terrain != terrain || current != serial) {
+    Flush();
+    terrain = &_terrain;
+    serial = current;
+  }
+
+  const RasterLocation pixel = _terrain.GetTerrainPixel(location);
+  Entry &entry = entries[Hash(pixel)];
+  if (entry.valid && entry.pixel == pixel) {
+    ++hits;
+    return entry.height;
+  }
+
+  ++misses;
+  entry.pixel = pixel;
+  entry.height = _terrain.GetTerrainHeight(location);
+  entry.valid = true;
+  return entry.height;
+}
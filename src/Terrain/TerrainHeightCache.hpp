@@ -0,0 +1,87 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_HEIGHT_CACHE_HPP
+#define XCSOAR_TERRAIN_HEIGHT_CACHE_HPP
+
+#include "Terrain/RasterLocation.hpp"
+#include "Util/Serial.hpp"
+#include "Compiler.h"
+
+struct GeoPoint;
+class RasterTerrain;
+
+/**
+ * Remembers the terrain heights of recently queried pixels, so
+ * repeated point queries (e.g. for each GPS fix while circling) do
+ * not need to lock the terrain.  The cache is flushed when the
+ * terrain's serial changes, i.e. when tiles have been loaded.
+ *
+ * This class is not thread-safe; each thread (or computer) owns its
+ * own instance.
+ */
+class TerrainHeightCache {
+  static const unsigned SIZE = 64;
+
+  struct Entry {
+    RasterLocation pixel;
+    short height;
+    bool valid;
+  };
+
+  const RasterTerrain *terrain;
+  Serial serial;
+
+  Entry entries[SIZE];
+
+  unsigned hits, misses;
+
+public:
+  TerrainHeightCache():terrain(NULL), hits(0), misses(0) {
+    Flush();
+  }
+
+  void Flush();
+
+  /**
+   * Determine the non-interpolated height at the specified location,
+   * like RasterTerrain::GetTerrainHeight().
+   */
+  short GetHeight(const RasterTerrain &terrain, const GeoPoint &location);
+
+  unsigned GetHits() const {
+    return hits;
+  }
+
+  unsigned GetMisses() const {
+    return misses;
+  }
+
+private:
+  gcc_const
+  static unsigned Hash(const RasterLocation &pixel) {
+    return (pixel.x ^ (pixel.y * 0x9e37u)) % SIZE;
+  }
+};
+
+#endif
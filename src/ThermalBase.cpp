@@ -30,15 +30,20 @@ Copyright_License {
 #include "Engine/Navigation/SpeedVector.hpp"
 
 static fixed
-GetElevation(RasterTerrain::Lease &map, const GeoPoint loc)
+ToElevation(short hground)
 {
-  short hground = map->GetHeight(loc);
   if (RasterBuffer::is_special(hground))
     hground = 0;
 
   return fixed(hground);
 }
 
+static fixed
+GetElevation(RasterTerrain::Lease &map, const GeoPoint loc)
+{
+  return ToElevation(map->GetHeight(loc));
+}
+
 void
 EstimateThermalBase(const GeoPoint location, const fixed altitude,
                     const fixed average, const SpeedVector wind,
@@ -63,8 +68,6 @@ EstimateThermalBase(const GeoPoint location, const fixed altitude,
     return;
   }
 
-  RasterTerrain::Lease map(*terrain);
-
   // Height step of the 10 calculation intervals
   const fixed dh = altitude / 10;
 
@@ -72,18 +75,37 @@ EstimateThermalBase(const GeoPoint location, const fixed altitude,
   // We do this because the terrain elevation may shift
   // as we trace the thermal back to its source
 
+  /* the locations do not depend on the terrain, so they are
+     calculated before taking the lease, and the terrain is queried
+     in one batch */
+  static const unsigned MAX_STEPS = 11;
+  GeoPoint locations[MAX_STEPS];
+  unsigned n = 0;
+  for (fixed h = altitude; !negative(h) && n < MAX_STEPS; h -= dh) {
+    // Time to descend to this height
+    const fixed t = (altitude-h)/average;
+
+    // Calculate position
+    locations[n++] = FindLatitudeLongitude(location, wind.bearing,
+                                           wind.norm * t);
+  }
+
+  short elevations[MAX_STEPS];
+
+  RasterTerrain::Lease map(*terrain);
+  map->GetHeights(locations, elevations, n);
+
   GeoPoint loc = location;
 
-  for (fixed h = altitude; !negative(h); h -= dh) {
+  fixed h = altitude;
+  for (unsigned i = 0; i < n; ++i, h -= dh) {
     // Time to descend to this height
     fixed t = (altitude-h)/average;
 
-    // Calculate position
-    loc = FindLatitudeLongitude(location, wind.bearing, 
-                                wind.norm * t);
+    loc = locations[i];
 
     // Calculate altitude above ground
-    fixed dh = h - GetElevation(map, loc);
+    fixed dh = h - ToElevation(elevations[i]);
 
     // At or below ground level, use linear interpolation
     // to estimate intersection
@@ -106,4 +128,3 @@ EstimateThermalBase(const GeoPoint location, const fixed altitude,
   ground_location = loc;
   ground_alt = GetElevation(map, ground_location);
 }
-
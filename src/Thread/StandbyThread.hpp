@@ -130,6 +130,17 @@ protected:
     return pending || busy;
   }
 
+  /**
+   * Has the "stop" command been sent?  A Tick() implementation which
+   * loops over several jobs may check this to bail out early.
+   *
+   * Caller must lock the mutex.
+   */
+  gcc_pure
+  bool IsStopped() const {
+    return stop;
+  }
+
   /**
    * Send the "stop" command to the thread.
    *
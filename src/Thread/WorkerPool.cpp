@@ -0,0 +1,167 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/WorkerPool.hpp"
+
+#include <assert.h>
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+
+static unsigned
+GetNumberOfProcessors()
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (unsigned)n : 1;
+}
+
+WorkerPool::WorkerPool(unsigned max_workers)
+  :num_workers(GetNumberOfProcessors() - 1), num_started(0),
+   job(NULL), next(0), end(0), band_size(1), busy(0), quit(false)
+{
+  if (max_workers > MAX_WORKERS)
+    max_workers = MAX_WORKERS;
+  if (num_workers > max_workers)
+    num_workers = max_workers;
+}
+
+WorkerPool::~WorkerPool()
+{
+  mutex.Lock();
+  quit = true;
+  work_cond.Broadcast();
+  mutex.Unlock();
+
+  for (unsigned i = 0; i < num_started; ++i) {
+    workers[i]->Join();
+    delete workers[i];
+  }
+}
+
+void
+WorkerPool::StartWorkers()
+{
+  while (num_started < num_workers) {
+    Worker *worker = new Worker(*this);
+    if (!worker->Start()) {
+      /* can't create more threads: continue with what we have */
+      delete worker;
+      num_workers = num_started;
+      break;
+    }
+
+    workers[num_started++] = worker;
+  }
+}
+
+void
+WorkerPool::Work()
+{
+  while (job != NULL && next < end) {
+    const unsigned begin = next;
+    const unsigned band_end = end - begin > band_size
+      ? begin + band_size
+      : end;
+    next = band_end;
+    ++busy;
+
+    Job &current = *job;
+    mutex.Unlock();
+    current.Run(begin, band_end);
+    mutex.Lock();
+
+    --busy;
+  }
+}
+
+void
+WorkerPool::Worker::Run()
+{
+  pool.mutex.Lock();
+
+  while (!pool.quit) {
+    if (pool.job == NULL || pool.next >= pool.end) {
+      pool.work_cond.Wait(pool.mutex);
+      continue;
+    }
+
+    pool.Work();
+
+    if (pool.busy == 0)
+      pool.done_cond.Signal();
+  }
+
+  pool.mutex.Unlock();
+}
+
+void
+WorkerPool::Run(Job &_job, unsigned size, unsigned min_band)
+{
+  if (min_band == 0)
+    min_band = 1;
+
+  if (num_workers == 0 || size < 2 * min_band) {
+    _job.Run(0, size);
+    return;
+  }
+
+  StartWorkers();
+
+  /* hand out several bands per thread, so a thread which gets
+     preempted does not delay the whole job too much */
+  const unsigned n_bands = (num_workers + 1) * 4;
+  unsigned _band_size = (size + n_bands - 1) / n_bands;
+  if (_band_size < min_band)
+    _band_size = min_band;
+
+  mutex.Lock();
+  assert(job == NULL);
+
+  job = &_job;
+  next = 0;
+  end = size;
+  band_size = _band_size;
+  work_cond.Broadcast();
+
+  Work();
+
+  while (busy > 0)
+    done_cond.Wait(mutex);
+
+  job = NULL;
+  mutex.Unlock();
+}
+
+#else /* !HAVE_POSIX */
+
+WorkerPool::WorkerPool(unsigned max_workers) {}
+
+WorkerPool::~WorkerPool() {}
+
+void
+WorkerPool::Run(Job &job, unsigned size, unsigned min_band)
+{
+  job.Run(0, size);
+}
+
+#endif
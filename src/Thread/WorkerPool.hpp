@@ -0,0 +1,157 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_WORKER_POOL_HPP
+#define XCSOAR_THREAD_WORKER_POOL_HPP
+
+#include "Util/NonCopyable.hpp"
+
+#ifdef HAVE_POSIX
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hpp"
+#endif
+
+/**
+ * A small set of threads which split a range of items (e.g. the rows
+ * of a bitmap) among themselves.  The calling thread participates in
+ * the work, and Run() returns only after all items have been
+ * processed.
+ *
+ * The threads are created lazily, on the first Run() call which is
+ * large enough to be split.  On platforms without POSIX threads, and
+ * on single-core machines, all work is done by the calling thread.
+ */
+class WorkerPool : private NonCopyable {
+public:
+  /**
+   * The maximum number of threads, not counting the calling thread.
+   */
+  static const unsigned MAX_WORKERS = 7;
+
+  class Job {
+  public:
+    /**
+     * Process the items [begin, end).  This method is called
+     * concurrently from several threads, with disjoint ranges.
+     */
+    virtual void Run(unsigned begin, unsigned end) = 0;
+  };
+
+private:
+#ifdef HAVE_POSIX
+  class Worker : public Thread {
+    WorkerPool &pool;
+
+  public:
+    Worker(WorkerPool &_pool):pool(_pool) {}
+
+  protected:
+    virtual void Run();
+  };
+
+  /**
+   * Protects all of the following attributes.
+   */
+  Mutex mutex;
+
+  /**
+   * Signalled when a new job is submitted, or when the pool is being
+   * destroyed.
+   */
+  Cond work_cond;
+
+  /**
+   * Signalled when the last busy worker has finished its range.
+   */
+  Cond done_cond;
+
+  Worker *workers[MAX_WORKERS];
+
+  /**
+   * The number of threads to be used (excluding the caller).
+   */
+  unsigned num_workers;
+
+  /**
+   * The number of threads that were actually started.
+   */
+  unsigned num_started;
+
+  Job *job;
+
+  /**
+   * The first item which has not yet been handed out, the end of the
+   * range and the number of items per hand-out.
+   */
+  unsigned next, end, band_size;
+
+  /**
+   * The number of threads which are currently inside Job::Run().
+   */
+  unsigned busy;
+
+  bool quit;
+#endif
+
+public:
+  /**
+   * @param max_workers the maximum number of additional threads;
+   * the actual number is limited by the number of CPUs
+   */
+  explicit WorkerPool(unsigned max_workers=MAX_WORKERS);
+  ~WorkerPool();
+
+  /**
+   * Returns the number of threads which will work on a job, including
+   * the calling thread.
+   */
+  unsigned GetConcurrency() const {
+#ifdef HAVE_POSIX
+    return num_workers + 1;
+#else
+    return 1;
+#endif
+  }
+
+  /**
+   * Run the job on the items [0, size), and wait for its completion.
+   *
+   * @param min_band the minimum number of items per hand-out; jobs
+   * smaller than two of these are run in the calling thread
+   */
+  void Run(Job &job, unsigned size, unsigned min_band=1);
+
+#ifdef HAVE_POSIX
+private:
+  void StartWorkers();
+
+  /**
+   * Process bands of the current job until there are no more.  The
+   * mutex must be locked.
+   */
+  void Work();
+#endif
+};
+
+#endif
@@ -39,8 +39,10 @@ WorkerThread::Run()
     /* wait for work */
     event_trigger.Wait();
 
+    const bool throttled = !unthrottled.Get();
+
     /* got the "stop" trigger? */
-    if (delay > 0
+    if (throttled && delay > 0
         ? WaitForStopped(delay)
         : CheckStoppedOrSuspended())
       break;
@@ -60,11 +62,14 @@ WorkerThread::Run()
     }
 
     /* do the actual work */
-    if (period_min > 0)
+    if (throttled && period_min > 0)
       clock.update();
 
     Tick();
 
+    if (!throttled)
+      continue;
+
     unsigned idle = idle_min;
     if (period_min > 0) {
       unsigned elapsed = clock.elapsed();
@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Thread/SuspensibleThread.hpp"
 #include "Thread/Trigger.hpp"
+#include "Thread/Flag.hpp"
 
 /**
  * A thread which performs regular work in background.
@@ -35,6 +36,11 @@ class WorkerThread : public SuspensibleThread {
 
   unsigned period_min, idle_min, delay;
 
+  /**
+   * If set, then #period_min, #idle_min and #delay are ignored.
+   */
+  Flag unthrottled;
+
 public:
   /**
    * @param period_min the minimum duration of one period [ms].  If
@@ -56,6 +62,15 @@ public:
     event_trigger.Signal();
   }
 
+  /**
+   * Disable (or re-enable) the rate limiting configured in the
+   * constructor.  This may be called from any thread; it takes
+   * effect after the current iteration.
+   */
+  void SetThrottled(bool throttled) {
+    unthrottled.Set(!throttled);
+  }
+
   /**
    * Suspend execution until resume() is called.
    */
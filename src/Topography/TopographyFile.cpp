@@ -130,6 +130,7 @@ TopographyFile::Update(const WindowProjection &map_projection)
   if (!file.status) {
     // ... clear the whole buffer
     ClearCache();
+    ++serial;
     return false;
   }
 
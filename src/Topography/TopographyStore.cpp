@@ -52,14 +52,23 @@ TopographyStore::ScanVisibility(const WindowProjection &m_projection,
   // we will make sure we update at least one cache per call
   // to make sure eventually everything gets refreshed
   unsigned num_updated = 0;
+  bool modified = false;
   for (auto it = files.begin(), end = files.end(); it != end; ++it) {
-    if ((*it)->Update(m_projection)) {
+    const Serial old_serial = (*it)->GetSerial();
+    const bool updated = (*it)->Update(m_projection);
+    if ((*it)->GetSerial() != old_serial)
+      modified = true;
+
+    if (updated) {
       ++num_updated;
       if (num_updated >= max_update)
         break;
     }
   }
 
+  if (modified)
+    ++serial;
+
   return num_updated;
 }
 
@@ -190,6 +199,8 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
     // Update progress bar
     operation.SetProgressPosition((reader.tell() * 100) / filesize);
   }
+
+  ++serial;
 }
 
 void
@@ -199,4 +210,5 @@ TopographyStore::Reset()
     delete *it;
 
   files.clear();
+  ++serial;
 }
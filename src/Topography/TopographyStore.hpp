@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
+#include "Util/Serial.hpp"
 
 #include <tchar.h>
 
@@ -48,6 +49,12 @@ public:
 private:
   StaticArray<TopographyFile *, MAXTOPOGRAPHY> files;
 
+  /**
+   * Incremented whenever the set of files or the visible shapes of
+   * any file change.
+   */
+  Serial serial;
+
 public:
   ~TopographyStore();
 
@@ -59,6 +66,10 @@ public:
     return *files[i];
   }
 
+  const Serial &GetSerial() const {
+    return serial;
+  }
+
   /**
    * @param max_update the maximum number of files updated in this
    * call
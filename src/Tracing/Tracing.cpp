@@ -0,0 +1,282 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Tracing.hpp"
+#include "OS/Clock.hpp"
+#include "Thread/Local.hpp"
+#include "Thread/FastMutex.hpp"
+
+#include <assert.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+namespace Tracing {
+  struct Event {
+    enum Type {
+      SPAN,
+      COUNTER,
+    };
+
+    const char *name;
+    uint64_t timestamp;
+
+    /**
+     * The duration [us] of a span, or the value of a counter.
+     */
+    int64_t value;
+
+    Type type;
+  };
+
+  /**
+   * The event ring of one thread.  Only the owning thread writes to
+   * it; #head is incremented after an event has been written
+   * completely, so a reader can tell which slots may have been
+   * overwritten while it was copying them.
+   */
+  struct ThreadBuffer {
+    ThreadBuffer *next;
+
+    const char *volatile name;
+
+    unsigned id;
+
+    /**
+     * The total number of events ever written to this buffer.
+     */
+    volatile unsigned head;
+
+    Event events[BUFFER_SIZE];
+
+    void Add(const Event &event) {
+      const unsigned position = head;
+      events[position % BUFFER_SIZE] = event;
+      __sync_synchronize();
+      head = position + 1;
+    }
+  };
+
+  bool enabled;
+
+  static ThreadLocal thread_buffer;
+
+  /**
+   * Protects #buffers and #next_thread_id.  It is only locked when a
+   * thread records its first event and during export.  Buffers are
+   * never freed, because their thread may still be writing to them.
+   */
+  static FastMutex buffers_mutex;
+  static ThreadBuffer *buffers;
+  static unsigned next_thread_id = 1;
+
+  static ThreadBuffer &GetThreadBuffer();
+}
+
+void
+Tracing::Enable()
+{
+  enabled = true;
+}
+
+void
+Tracing::Disable()
+{
+  enabled = false;
+}
+
+uint64_t
+Tracing::Now()
+{
+  return MonotonicClockUS();
+}
+
+Tracing::ThreadBuffer &
+Tracing::GetThreadBuffer()
+{
+  ThreadBuffer *buffer = (ThreadBuffer *)thread_buffer.Get();
+  if (gcc_likely(buffer != NULL))
+    return *buffer;
+
+  buffer = new ThreadBuffer();
+  buffer->name = NULL;
+  buffer->head = 0;
+
+  buffers_mutex.Lock();
+  buffer->id = next_thread_id++;
+  buffer->next = buffers;
+  buffers = buffer;
+  buffers_mutex.Unlock();
+
+  thread_buffer.Set(buffer);
+  return *buffer;
+}
+
+void
+Tracing::SetThreadName(const char *name)
+{
+  if (!IsEnabled())
+    return;
+
+  ThreadBuffer &buffer = GetThreadBuffer();
+  if (buffer.name == name)
+    return;
+
+  buffer.name = name;
+
+#ifdef __linux__
+  /* name the kernel thread as well, to tell the threads apart in
+     /proc (e.g. in the CPU usage reported by FeedFlightLoad) */
+  prctl(PR_SET_NAME, (unsigned long)name, 0, 0, 0);
+#endif
+}
+
+void
+Tracing::AddSpan(const char *name, uint64_t start, uint64_t duration)
+{
+  Event event;
+  event.name = name;
+  event.timestamp = start;
+  event.value = (int64_t)duration;
+  event.type = Event::SPAN;
+  GetThreadBuffer().Add(event);
+}
+
+void
+Tracing::AddCounter(const char *name, int64_t value)
+{
+  Event event;
+  event.name = name;
+  event.timestamp = Now();
+  event.value = value;
+  event.type = Event::COUNTER;
+  GetThreadBuffer().Add(event);
+}
+
+static void
+WriteJSONString(FILE *file, const char *s)
+{
+  fputc('"', file);
+  for (; *s != 0; ++s) {
+    if (*s == '"' || *s == '\\')
+      fputc('\\', file);
+    if ((unsigned char)*s >= 0x20)
+      fputc(*s, file);
+  }
+  fputc('"', file);
+}
+
+static void
+WriteEvent(FILE *file, unsigned tid, const Tracing::Event &event)
+{
+  fputs(",\n{\"name\":", file);
+  WriteJSONString(file, event.name);
+
+  switch (event.type) {
+  case Tracing::Event::SPAN:
+    fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+            "\"ts\":%llu,\"dur\":%llu}",
+            tid, (unsigned long long)event.timestamp,
+            (unsigned long long)event.value);
+    break;
+
+  case Tracing::Event::COUNTER:
+    fprintf(file, ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,"
+            "\"ts\":%llu,\"args\":{\"value\":%lld}}",
+            tid, (unsigned long long)event.timestamp,
+            (long long)event.value);
+    break;
+  }
+}
+
+static void
+ExportThreadBuffer(FILE *file, const Tracing::ThreadBuffer &buffer,
+                   Tracing::Event *copy)
+{
+  using namespace Tracing;
+
+  const char *name = buffer.name;
+  if (name != NULL) {
+    fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%u,\"args\":{\"name\":", buffer.id);
+    WriteJSONString(file, name);
+    fputs("}}", file);
+  }
+
+  const unsigned end = buffer.head;
+  __sync_synchronize();
+  const unsigned begin = end > BUFFER_SIZE ? end - BUFFER_SIZE : 0;
+
+  for (unsigned i = begin; i != end; ++i)
+    copy[i - begin] = buffer.events[i % BUFFER_SIZE];
+
+  __sync_synchronize();
+
+  /* the writer may have overwritten the oldest slots while we were
+     copying; the slot it is currently writing to belongs to event
+     number "head", which overlaps event number "head-BUFFER_SIZE" */
+  const unsigned head = buffer.head;
+  unsigned valid = head >= BUFFER_SIZE ? head - BUFFER_SIZE + 1 : 0;
+  if (valid < begin)
+    valid = begin;
+
+  for (unsigned i = valid; i < end; ++i)
+    WriteEvent(file, buffer.id, copy[i - begin]);
+}
+
+bool
+Tracing::ExportChromeTrace(FILE *file)
+{
+  assert(file != NULL);
+
+  Event *copy = new Event[BUFFER_SIZE];
+
+  fputs("{\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+        "\"args\":{\"name\":\"XCSoar\"}}", file);
+
+  buffers_mutex.Lock();
+  for (const ThreadBuffer *buffer = buffers; buffer != NULL;
+       buffer = buffer->next)
+    ExportThreadBuffer(file, *buffer, copy);
+  buffers_mutex.Unlock();
+
+  fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+  delete[] copy;
+
+  return !ferror(file);
+}
+
+bool
+Tracing::ExportChromeTrace(const TCHAR *path)
+{
+  FILE *file = _tfopen(path, _T("w"));
+  if (file == NULL)
+    return false;
+
+  bool success = ExportChromeTrace(file);
+  return fclose(file) == 0 && success;
+}
@@ -0,0 +1,149 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#ifndef XCSOAR_TRACING_HPP
+#define XCSOAR_TRACING_HPP
+
+#include "Compiler.h"
+
+#include <tchar.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * A lightweight runtime-switchable tracer.  Each thread records spans
+ * and counters into its own fixed-size ring buffer, without taking a
+ * lock; when the ring is full, the oldest events are overwritten.
+ * The collected events can be exported in the Chrome trace event
+ * format, to be inspected with chrome://tracing or Perfetto.
+ *
+ * All names passed to this library must be string literals (or have
+ * static storage duration otherwise), because only the pointer is
+ * recorded.
+ */
+namespace Tracing {
+  /**
+   * The number of events kept per thread.
+   */
+  static const unsigned BUFFER_SIZE = 4096;
+
+  /**
+   * Is tracing switched on?  This is a plain variable, because it is
+   * checked on every traced code path.  It is only written by
+   * Enable() and Disable(), see there.
+   */
+  extern bool enabled;
+
+  gcc_pure
+  static inline bool
+  IsEnabled()
+  {
+    return enabled;
+  }
+
+  /**
+   * Switch tracing on.  This must be called before the threads to be
+   * traced are started (XCSoar does it while parsing the command
+   * line), because there is no memory barrier between this and the
+   * readers of #enabled.
+   */
+  void Enable();
+
+  /**
+   * Switch tracing off.  Like Enable(), this must not be called
+   * while other threads may be recording.
+   */
+  void Disable();
+
+  /**
+   * Returns the current trace timestamp [us].  Not declared "pure",
+   * because two calls must not be merged.
+   */
+  uint64_t Now();
+
+  /**
+   * Set a name for the calling thread, to be shown in the exported
+   * trace.  On Linux, the kernel thread is renamed, too.  Does
+   * nothing if tracing is disabled.
+   */
+  void SetThreadName(const char *name);
+
+  /**
+   * Record a completed span in the calling thread's buffer.
+   */
+  void AddSpan(const char *name, uint64_t start, uint64_t duration);
+
+  /**
+   * Record the current value of a counter.
+   */
+  void AddCounter(const char *name, int64_t value);
+
+  /**
+   * Write all recorded events as a Chrome trace event JSON object.
+   * Recording may continue in other threads meanwhile; events which
+   * were overwritten during the export are omitted.
+   */
+  bool ExportChromeTrace(FILE *file);
+
+  bool ExportChromeTrace(const TCHAR *path);
+}
+
+/**
+ * Records a span from construction to destruction.  If tracing is
+ * disabled at construction, this costs one flag check.
+ */
+class ScopeTraceSpan {
+  const char *name;
+  uint64_t start;
+
+public:
+  explicit ScopeTraceSpan(const char *_name)
+    :name(Tracing::IsEnabled() ? _name : NULL),
+     start(name != NULL ? Tracing::Now() : 0) {}
+
+  ~ScopeTraceSpan() {
+    if (name != NULL)
+      Tracing::AddSpan(name, start, Tracing::Now() - start);
+  }
+};
+
+#define TRACE_SPAN_CONCAT2(a, b) a ## b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT2(a, b)
+
+/**
+ * Trace the remainder of the current scope under the given name.
+ */
+#define TRACE_SPAN(name) \
+  const ScopeTraceSpan TRACE_SPAN_CONCAT(trace_span_, __LINE__)(name)
+
+/**
+ * Record a counter value if tracing is enabled.
+ */
+#define TRACE_COUNTER(name, value) \
+  do { \
+    if (Tracing::IsEnabled()) \
+      Tracing::AddCounter(name, value); \
+  } while (0)
+
+#endif
@@ -39,9 +39,11 @@ Copyright_License {
 namespace LiveTrack24
 {
   bool use_test_server = false;
+  const TCHAR *custom_server = NULL;
 
   const TCHAR *GetServer();
   bool SendRequest(const TCHAR *url);
+  bool SendRequest(Net::Session &session, const TCHAR *url);
 }
 
 LiveTrack24::UserID
@@ -121,6 +123,22 @@ LiveTrack24::SendPosition(SessionID session, unsigned packet_id,
                           GeoPoint position, unsigned altitude,
                           unsigned ground_speed, Angle track,
                           int64_t timestamp_utc)
+{
+  // Open download session
+  Net::Session net_session;
+  if (net_session.Error())
+    return false;
+
+  return SendPosition(net_session, session, packet_id, position, altitude,
+                      ground_speed, track, timestamp_utc);
+}
+
+bool
+LiveTrack24::SendPosition(Net::Session &net_session, SessionID session,
+                          unsigned packet_id,
+                          GeoPoint position, unsigned altitude,
+                          unsigned ground_speed, Angle track,
+                          int64_t timestamp_utc)
 {
   // http://www.livetrack24.com/track.php?leolive=4&sid=42664778&pid=321&
   //   lat=22.3&lon=40.2&alt=23&sog=40&cog=160&tm=1241422845
@@ -135,7 +153,7 @@ LiveTrack24::SendPosition(SessionID session, unsigned packet_id,
              (unsigned)track.AsBearing().Degrees(),
              (long long int)timestamp_utc);
 
-  return SendRequest(url);
+  return SendRequest(net_session, url);
 }
 
 bool
@@ -156,9 +174,18 @@ LiveTrack24::SetTestServer(bool _use_test_server)
   use_test_server = _use_test_server;
 }
 
+void
+LiveTrack24::SetServer(const TCHAR *server)
+{
+  custom_server = server;
+}
+
 const TCHAR *
 LiveTrack24::GetServer()
 {
+  if (custom_server != NULL)
+    return custom_server;
+
   return use_test_server ? _T("test.livetrack24.com") : _T("www.livetrack24.com");
 }
 
@@ -170,6 +197,12 @@ LiveTrack24::SendRequest(const TCHAR *url)
   if (session.Error())
     return false;
 
+  return SendRequest(session, url);
+}
+
+bool
+LiveTrack24::SendRequest(Net::Session &session, const TCHAR *url)
+{
   // Request the file
   Net::Request request(session, url, 3000);
   if (!request.Created())
@@ -32,6 +32,8 @@ struct BrokenDateTime;
 struct GeoPoint;
 class JobRunner;
 
+namespace Net { class Session; }
+
 /**
  * API for the LiveTrack24.com server.
  *
@@ -113,6 +115,18 @@ namespace LiveTrack24
                     GeoPoint position, unsigned altitude, unsigned ground_speed,
                     Angle track, int64_t timestamp_utc);
 
+  /**
+   * Sends a "gps point" packet over an existing #Net::Session.  Use
+   * this to submit a series of points, because the session may
+   * reuse the connection to the server.
+   *
+   * @param ground_speed Speed over ground in km/h
+   */
+  bool SendPosition(Net::Session &session, SessionID session_id,
+                    unsigned packet_id,
+                    GeoPoint position, unsigned altitude, unsigned ground_speed,
+                    Angle track, int64_t timestamp_utc);
+
   /** Sends the "end of track" packet to the tracking server */
   bool EndTracking(SessionID session, unsigned packet_id);
 
@@ -121,6 +135,13 @@ namespace LiveTrack24
    * the test or the production server
    */
   void SetTestServer(bool use_test_server);
+
+  /**
+   * Send the HTTP requests to the specified host (and optional
+   * port) instead, e.g. to a local stand-in for measurements.  Pass
+   * NULL to restore the default.  The string is not copied.
+   */
+  void SetServer(const TCHAR *server);
 }
 
 #endif
@@ -25,6 +25,25 @@ Copyright_License {
 #include "NMEA/Info.hpp"
 #include "NMEA/Derived.hpp"
 #include "Units/System.hpp"
+#include "Net/Session.hpp"
+#include "OS/FileUtil.hpp"
+#include "LocalPath.hpp"
+#include "DateTime.hpp"
+
+#include <algorithm>
+
+TrackingGlue::TrackingGlue()
+  :retry_delay(0), spooled(false)
+{
+  state.ResetSession();
+
+  /* pick up the fixes which could not be delivered before the last
+     shutdown */
+  LocalPath(spool_path, _T("livetrack24.spool"));
+  spooled = queue.Load(spool_path);
+  if (spooled)
+    queue.Expire(BrokenDateTime::NowUTC().ToUnixTimeUTC() - MAX_SPOOL_AGE);
+}
 
 void
 TrackingGlue::StopAsync()
@@ -38,6 +57,8 @@ TrackingGlue::WaitStopped()
 {
   ScopeLock protect(mutex);
   StandbyThread::WaitStopped();
+
+  SaveSpool();
 }
 
 void
@@ -70,33 +91,95 @@ TrackingGlue::OnTimer(const NMEAInfo &basic, const DerivedInfo &calculated)
     /* later */
     return;
 
-  ScopeLock protect(mutex);
-  if (IsBusy())
-    /* still running, skip this submission */
-    return;
-
-  date_time = basic.date_time_utc;
+  BrokenDateTime date_time = basic.date_time_utc;
   if (!basic.date_available)
     /* use "today" if the GPS didn't provide a date */
     (BrokenDate &)date_time = (BrokenDate)BrokenDateTime::NowUTC();
 
-  location = basic.location;
+  TrackingQueue::Fix fix;
+  fix.time = date_time.ToUnixTimeUTC();
+  fix.location = basic.location;
   /* XXX use nav_altitude? */
-  altitude = basic.gps_altitude_available && positive(basic.gps_altitude)
+  fix.altitude = basic.gps_altitude_available && positive(basic.gps_altitude)
     ? (unsigned)basic.gps_altitude
     : 0u;
-  ground_speed = basic.ground_speed_available
+  fix.ground_speed = basic.ground_speed_available
     ? (unsigned)Units::ToUserUnit(basic.ground_speed, unKiloMeterPerHour)
     : 0u;
-  track = basic.track_available
+  fix.track = basic.track_available
     ? basic.track
     : Angle::Zero();
 
-  flying = calculated.flight.flying;
+  ScopeLock protect(mutex);
+  queue.Push(fix);
+
+  if (IsBusy())
+    /* still running; Tick() checks the queue again before it
+       returns */
+    return;
+
+  if (retry_delay > 0 && !retry_clock.check(retry_delay))
+    /* the last attempt has failed recently, back off */
+    return;
 
   Trigger();
 }
 
+bool
+TrackingGlue::StartSession(LiveTrack24Settings copy,
+                           unsigned tracking_interval)
+{
+  LiveTrack24::UserID user_id = 0;
+  if (!copy.username.empty() && !copy.password.empty())
+    user_id = LiveTrack24::GetUserID(copy.username, copy.password);
+
+  if (user_id == 0) {
+    copy.username.clear();
+    copy.password.clear();
+    state.session_id = LiveTrack24::GenerateSessionID();
+  } else {
+    state.session_id = LiveTrack24::GenerateSessionID(user_id);
+  }
+
+  if (!LiveTrack24::StartTracking(state.session_id, copy.username,
+                                  copy.password, tracking_interval,
+                                  LiveTrack24::VehicleType::GLIDER)) {
+    state.ResetSession();
+    return false;
+  }
+
+  state.packet_id = 2;
+  return true;
+}
+
+void
+TrackingGlue::SaveSpool()
+{
+  if (queue.IsEmpty()) {
+    if (spooled) {
+      File::Delete(spool_path);
+      spooled = false;
+    }
+  } else if (queue.IsDirty()) {
+    /* if this fails, an older spool file may still exist */
+    spooled = queue.Save(spool_path) || spooled;
+  }
+}
+
+void
+TrackingGlue::OnFailure()
+{
+  retry_delay = retry_delay == 0
+    ? MIN_RETRY_DELAY
+    : std::min(retry_delay * 2, (unsigned)MAX_RETRY_DELAY);
+  retry_clock.update();
+
+  /* the backlog may grow for a while; make sure it survives a
+     restart */
+  if (spool_clock.check_update(SPOOL_INTERVAL))
+    SaveSpool();
+}
+
 void
 TrackingGlue::Tick()
 {
@@ -109,33 +192,62 @@ TrackingGlue::Tick()
 
   mutex.Unlock();
 
-  if (!state.HasSession()) {
-    LiveTrack24::UserID user_id = 0;
-    if (!copy.username.empty() && !copy.password.empty())
-      user_id = LiveTrack24::GetUserID(copy.username, copy.password);
-
-    if (user_id == 0) {
-      copy.username.clear();
-      copy.password.clear();
-      state.session_id = LiveTrack24::GenerateSessionID();
-    } else {
-      state.session_id = LiveTrack24::GenerateSessionID(user_id);
+  if (!state.HasSession() && !StartSession(copy, tracking_interval)) {
+    mutex.Lock();
+    OnFailure();
+    return;
+  }
+
+  /* one session for all fixes, so the connection can be reused */
+  Net::Session session;
+
+  mutex.Lock();
+
+  if (session.Error()) {
+    OnFailure();
+    return;
+  }
+
+  while (!queue.IsEmpty() && !IsStopped()) {
+    /* copy a batch, so the mutex can be unlocked while sending */
+    TrackingQueue::Fix batch[BATCH_SIZE];
+    const unsigned n = std::min(queue.GetSize(), (unsigned)BATCH_SIZE);
+    for (unsigned i = 0; i < n; ++i)
+      batch[i] = queue[i];
+
+    const uint32_t serial = queue.GetHeadSerial();
+
+    mutex.Unlock();
+
+    unsigned sent = 0;
+    while (sent < n) {
+      const TrackingQueue::Fix &fix = batch[sent];
+      if (!LiveTrack24::SendPosition(session, state.session_id,
+                                     state.packet_id,
+                                     fix.location, fix.altitude,
+                                     fix.ground_speed, fix.track,
+                                     fix.time))
+        break;
+
+      ++state.packet_id;
+      ++sent;
     }
 
-    if (!LiveTrack24::StartTracking(state.session_id, copy.username,
-                                    copy.password, tracking_interval,
-                                    LiveTrack24::VehicleType::GLIDER)) {
-      state.ResetSession();
-      mutex.Lock();
+    mutex.Lock();
+
+    /* the queue may have overflowed meanwhile; the serial number
+       makes sure only the delivered fixes are removed */
+    queue.Remove(serial + sent);
+
+    if (sent < n) {
+      OnFailure();
       return;
     }
-
-    state.packet_id = 2;
   }
 
-  LiveTrack24::SendPosition(state.session_id, state.packet_id++,
-                            location, altitude, ground_speed, track,
-                            date_time.ToUnixTimeUTC());
+  retry_delay = 0;
 
-  mutex.Lock();
+  if (queue.IsEmpty())
+    /* the backlog is gone, delete the spool file */
+    SaveSpool();
 }
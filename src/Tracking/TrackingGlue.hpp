@@ -31,14 +31,45 @@ Copyright_License {
 #include "Tracking/TrackingSettings.hpp"
 #include "Thread/StandbyThread.hpp"
 #include "Tracking/LiveTrack24.hpp"
+#include "Tracking/TrackingQueue.hpp"
 #include "PeriodClock.hpp"
-#include "Engine/Navigation/GeoPoint.hpp"
-#include "DateTime.hpp"
+
+#include <windef.h> /* for MAX_PATH */
 
 struct NMEAInfo;
 struct DerivedInfo;
 
+/**
+ * Submits the aircraft position to the live tracking server in
+ * background.  Fixes are collected in a #TrackingQueue and sent in
+ * batches; if the server cannot be reached, they are kept (and
+ * spooled to disk) until the connection recovers.
+ */
 class TrackingGlue : protected StandbyThread {
+  /**
+   * The maximum number of fixes submitted in one Tick() before the
+   * queue is checked again.
+   */
+  static const unsigned BATCH_SIZE = 16;
+
+  /**
+   * The initial delay [ms] before retrying after a failure.  It is
+   * doubled after each failure, up to #MAX_RETRY_DELAY.
+   */
+  static const unsigned MIN_RETRY_DELAY = 5000;
+  static const unsigned MAX_RETRY_DELAY = 5 * 60 * 1000;
+
+  /**
+   * Write the spool file at most this often [ms] while a backlog
+   * exists.
+   */
+  static const unsigned SPOOL_INTERVAL = 60 * 1000;
+
+  /**
+   * Spooled fixes older than this [s] are discarded on startup.
+   */
+  static const unsigned MAX_SPOOL_AGE = 6 * 60 * 60;
+
   struct LiveTrack24State
   {
     LiveTrack24::SessionID session_id;
@@ -58,20 +89,65 @@ class TrackingGlue : protected StandbyThread {
   TrackingSettings settings;
   LiveTrack24State state;
 
-  BrokenDateTime date_time;
-  GeoPoint location;
-  unsigned altitude;
-  unsigned ground_speed;
-  Angle track;
-  bool flying;
+  /**
+   * The fixes which have not been delivered yet.  Protected by the
+   * mutex.
+   */
+  TrackingQueue queue;
+
+  /**
+   * Measures the time since the last failure.  Protected by the
+   * mutex.
+   */
+  PeriodClock retry_clock;
+
+  /**
+   * The current delay [ms] before the next attempt after a failure;
+   * 0 if the last attempt was successful.  Protected by the mutex.
+   */
+  unsigned retry_delay;
+
+  PeriodClock spool_clock;
+
+  /**
+   * Does the spool file exist?
+   */
+  bool spooled;
+
+  TCHAR spool_path[MAX_PATH];
 
 public:
+  TrackingGlue();
+
   void StopAsync();
   void WaitStopped();
 
   void SetSettings(const TrackingSettings &_settings);
   void OnTimer(const NMEAInfo &basic, const DerivedInfo &calculated);
 
+private:
+  /**
+   * Start a new tracking session.
+   *
+   * Caller must not lock the mutex.
+   */
+  bool StartSession(LiveTrack24Settings copy, unsigned tracking_interval);
+
+  /**
+   * Write the queue to the spool file, or delete the spool file if
+   * the queue is empty.
+   *
+   * Caller must lock the mutex.
+   */
+  void SaveSpool();
+
+  /**
+   * Called after a failed attempt; schedules the next one.
+   *
+   * Caller must lock the mutex.
+   */
+  void OnFailure();
+
 protected:
   virtual void Tick();
 };
@@ -0,0 +1,137 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TrackingQueue.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+#include <windef.h> /* for MAX_PATH */
+
+static const uint32_t tracking_queue_magic = 0x4c543234;
+
+struct TrackingQueueHeader {
+  uint32_t magic;
+
+  /** sizeof(Fix), to detect incompatible spool files */
+  uint32_t fix_size;
+
+  uint32_t size;
+};
+
+void
+TrackingQueue::Push(const Fix &fix)
+{
+  if (size == MAX_SIZE)
+    /* the queue is full: sacrifice the oldest fix */
+    Shift();
+
+  fixes[(head + size) % MAX_SIZE] = fix;
+  ++size;
+  dirty = true;
+}
+
+void
+TrackingQueue::Remove(uint32_t end_serial)
+{
+  /* signed difference to be safe against serial number wraparound */
+  while (size > 0 && (int32_t)(end_serial - head_serial) > 0) {
+    Shift();
+    dirty = true;
+  }
+}
+
+void
+TrackingQueue::Expire(int64_t min_time)
+{
+  while (size > 0 && fixes[head].time < min_time) {
+    Shift();
+    dirty = true;
+  }
+}
+
+bool
+TrackingQueue::Save(const TCHAR *path)
+{
+  TCHAR tmp_path[MAX_PATH];
+  _tcscpy(tmp_path, path);
+  _tcscat(tmp_path, _T(".tmp"));
+
+  FILE *file = _tfopen(tmp_path, _T("wb"));
+  if (file == NULL)
+    return false;
+
+  TrackingQueueHeader header;
+  header.magic = tracking_queue_magic;
+  header.fix_size = sizeof(Fix);
+  header.size = size;
+
+  /* the ring buffer may wrap around; write it in (up to) two chunks */
+  const unsigned first = std::min(size, MAX_SIZE - head);
+  const unsigned second = size - first;
+
+  bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(fixes + head, sizeof(fixes[0]), first, file) == first &&
+    fwrite(fixes, sizeof(fixes[0]), second, file) == second;
+  success = fclose(file) == 0 && success;
+
+#ifndef HAVE_POSIX
+  /* MoveFile() does not overwrite existing files */
+  if (success)
+    File::Delete(path);
+#endif
+
+  if (!success || !File::Rename(tmp_path, path)) {
+    File::Delete(tmp_path);
+    return false;
+  }
+
+  dirty = false;
+  return true;
+}
+
+bool
+TrackingQueue::Load(const TCHAR *path)
+{
+  head = size = 0;
+  dirty = false;
+
+  FILE *file = _tfopen(path, _T("rb"));
+  if (file == NULL)
+    return false;
+
+  TrackingQueueHeader header;
+  bool success = fread(&header, sizeof(header), 1, file) == 1 &&
+    header.magic == tracking_queue_magic &&
+    header.fix_size == sizeof(Fix) &&
+    header.size <= MAX_SIZE &&
+    fread(fixes, sizeof(fixes[0]), header.size, file) == header.size;
+  fclose(file);
+
+  if (success)
+    size = header.size;
+
+  return success;
+}
@@ -0,0 +1,159 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TRACKING_QUEUE_HPP
+#define XCSOAR_TRACKING_QUEUE_HPP
+
+#include "Engine/Navigation/GeoPoint.hpp"
+#include "Compiler.h"
+
+#include <tchar.h>
+#include <stdint.h>
+#include <assert.h>
+
+/**
+ * A bounded FIFO of live tracking fixes which have not yet been
+ * delivered to the server.  When the queue is full, the oldest fix
+ * is discarded.
+ *
+ * Every fix gets a serial number, which allows the sender to remove
+ * exactly the fixes it has delivered, even if the queue has been
+ * modified (and possibly overflowed) while the request was in
+ * progress.
+ *
+ * The queue can be spooled to a file, so pending fixes survive a
+ * restart.  This class is not thread-safe.
+ */
+class TrackingQueue {
+public:
+  struct Fix {
+    /** UNIX time stamp (UTC) */
+    int64_t time;
+
+    GeoPoint location;
+
+    /** Altitude above MSL [m] */
+    unsigned altitude;
+
+    /** Speed over ground [km/h] */
+    unsigned ground_speed;
+
+    Angle track;
+  };
+
+  static const unsigned MAX_SIZE = 1024;
+
+private:
+  Fix fixes[MAX_SIZE];
+
+  /** The index of the oldest fix in #fixes */
+  unsigned head;
+
+  /** The number of fixes in the queue */
+  unsigned size;
+
+  /** The serial number of the oldest fix */
+  uint32_t head_serial;
+
+  /**
+   * Was the queue modified since the last Save() or Load() call?
+   */
+  bool dirty;
+
+public:
+  TrackingQueue()
+    :head(0), size(0), head_serial(0), dirty(false) {}
+
+  bool IsEmpty() const {
+    return size == 0;
+  }
+
+  unsigned GetSize() const {
+    return size;
+  }
+
+  bool IsDirty() const {
+    return dirty;
+  }
+
+  /**
+   * Returns the serial number of the oldest fix.  Serial numbers of
+   * the following fixes are incremented by one.
+   */
+  uint32_t GetHeadSerial() const {
+    return head_serial;
+  }
+
+  /**
+   * Returns the fix at the specified position, 0 being the oldest.
+   */
+  const Fix &operator[](unsigned i) const {
+    assert(i < size);
+
+    return fixes[(head + i) % MAX_SIZE];
+  }
+
+  void Clear() {
+    head_serial += size;
+    head = size = 0;
+    dirty = true;
+  }
+
+  /**
+   * Append a fix.  If the queue is full, the oldest one is dropped.
+   */
+  void Push(const Fix &fix);
+
+  /**
+   * Remove all fixes with a serial number before the specified one.
+   */
+  void Remove(uint32_t end_serial);
+
+  /**
+   * Remove all fixes which are older than the specified time stamp.
+   */
+  void Expire(int64_t min_time);
+
+  /**
+   * Write all pending fixes to the specified file, replacing its
+   * previous contents.  Clears the "dirty" flag on success.
+   */
+  bool Save(const TCHAR *path);
+
+  /**
+   * Replace the contents of this queue with fixes loaded from the
+   * specified file.  On error, the queue is left empty.
+   */
+  bool Load(const TCHAR *path);
+
+private:
+  void Shift() {
+    assert(size > 0);
+
+    head = (head + 1) % MAX_SIZE;
+    --size;
+    ++head_serial;
+  }
+};
+
+#endif
@@ -0,0 +1,71 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#ifndef XCSOAR_TEST_BENCHMARK_HPP
+#define XCSOAR_TEST_BENCHMARK_HPP
+
+#include "OS/Clock.hpp"
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * Helpers for the benchmark programs run by "make bench".  Each
+ * result is printed to stdout as one JSON object per line; the
+ * script benchall.pl collects them into one document.  Result names
+ * must remain stable, because they are used to compare builds.
+ */
+
+/**
+ * Measures the time from construction to destruction, and prints it
+ * as a benchmark result.
+ */
+class ScopeBenchmark {
+  const char *name;
+  unsigned iterations;
+  uint64_t start;
+
+public:
+  ScopeBenchmark(const char *_name, unsigned _iterations=1)
+    :name(_name), iterations(_iterations), start(MonotonicClockUS()) {}
+
+  ~ScopeBenchmark() {
+    const uint64_t duration = MonotonicClockUS() - start;
+    printf("{\"name\": \"%s\", \"iterations\": %u, \"total_us\": %llu, "
+           "\"ns_per_iteration\": %.1f}\n",
+           name, iterations, (unsigned long long)duration,
+           iterations > 0 ? duration * 1000. / iterations : 0.);
+  }
+};
+
+/**
+ * Prints a counter (e.g. the number of solver iterations) as a
+ * benchmark result.
+ */
+static inline void
+PrintBenchmarkCounter(const char *name, unsigned long value)
+{
+  printf("{\"name\": \"%s\", \"count\": %lu}\n", name, value);
+}
+
+#endif
@@ -0,0 +1,369 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+/*
+ * Benchmarks for the non-graphical kernels: trace, contest solvers,
+ * airspace queries, NMEA parser and waypoint reader.  All input is
+ * read from test/data, except for the generated airspaces of the
+ * airspace list benchmark.
+ */
+
+#include "Benchmark.hpp"
+#include "Replay/IGCParser.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Engine/Navigation/Geometry/GeoVector.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceVisitor.hpp"
+#include "Engine/Airspace/AirspaceSorter.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Device/Parser.hpp"
+#include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/PathName.hpp"
+#include "Util/Macros.hpp"
+
+#ifdef INSTRUMENT_TASK
+#include "Contest/ContestSolvers/ContestDijkstra.hpp"
+#endif
+
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static bool
+LoadFlight(const char *path, std::vector<AircraftState> &states)
+{
+  FileLineReaderA reader(path);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+
+  const char *line;
+  while ((line = reader.read()) != NULL) {
+    IGCFix fix;
+    if (!IGCParseFix(line, fix))
+      continue;
+
+    AircraftState state;
+    state.location = fix.location;
+    state.ground_speed = fixed(30);
+    state.track = Angle::Zero();
+    state.altitude = state.altitude_agl = fix.gps_altitude;
+    state.time = fixed(fix.time.GetSecondOfDay());
+    states.push_back(state);
+  }
+
+  return !states.empty();
+}
+
+static void
+BenchmarkTrace(const std::vector<AircraftState> &states)
+{
+  {
+    ScopeBenchmark benchmark("trace.append_thin", states.size());
+
+    /* a small trace forces frequent thinning */
+    Trace trace(60, Trace::null_time, 128);
+    for (auto i = states.begin(), end = states.end(); i != end; ++i) {
+      trace.append(*i);
+      trace.optimise_if_old();
+    }
+  }
+}
+
+static void
+BenchmarkContest(const std::vector<AircraftState> &states)
+{
+  Trace full_trace(60);
+  Trace sprint_trace(0, 9000, 300);
+
+  for (auto i = states.begin(), end = states.end(); i != end; ++i) {
+    full_trace.append(*i);
+    sprint_trace.append(*i);
+  }
+
+  full_trace.optimise_if_old();
+  sprint_trace.optimise_if_old();
+
+  {
+    ContestManager olc(OLC_Classic, full_trace, sprint_trace);
+    ScopeBenchmark benchmark("olc.classic.solve");
+    olc.SolveExhaustive();
+  }
+
+  {
+    ContestManager olc(OLC_FAI, full_trace, sprint_trace);
+    ScopeBenchmark benchmark("olc.fai.solve");
+    olc.SolveExhaustive();
+  }
+
+#ifdef INSTRUMENT_TASK
+  PrintBenchmarkCounter("olc.solve_count", ContestDijkstra::count_olc_solve);
+#endif
+}
+
+class CountingAirspaceVisitor : public AirspaceVisitor {
+public:
+  unsigned count;
+
+  CountingAirspaceVisitor():count(0) {}
+
+protected:
+  virtual void Visit(const AirspaceCircle &as) {
+    ++count;
+  }
+
+  virtual void Visit(const AirspacePolygon &as) {
+    ++count;
+  }
+};
+
+static void
+BenchmarkAirspace(const char *path)
+{
+  Airspaces airspaces;
+
+  {
+    FileLineReader reader(path, ConvertLineReader::AUTO);
+    if (reader.error()) {
+      fprintf(stderr, "Failed to open %s\n", path);
+      return;
+    }
+
+    ScopeBenchmark benchmark("airspace.parse");
+    AirspaceParser parser(airspaces);
+    NullOperationEnvironment operation;
+    parser.Parse(reader, operation);
+    airspaces.optimise();
+  }
+
+  const GeoPoint center = airspaces.get_task_projection().get_center();
+  const unsigned n = 1000;
+
+  /* query points on a spiral around the center of all airspaces */
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < n; ++i)
+    points.push_back(GeoVector(fixed(i * 200),
+                               Angle::Degrees(fixed(i * 37))).EndPoint(center));
+
+  {
+    ScopeBenchmark benchmark("airspace.visit_within_range", n);
+    CountingAirspaceVisitor visitor;
+    for (auto i = points.begin(), end = points.end(); i != end; ++i)
+      airspaces.visit_within_range(*i, fixed(20000), visitor);
+  }
+
+  {
+    ScopeBenchmark benchmark("airspace.visit_inside", n);
+    CountingAirspaceVisitor visitor;
+    for (auto i = points.begin(), end = points.end(); i != end; ++i)
+      airspaces.visit_inside(*i, visitor);
+  }
+
+  unsigned found = 0;
+
+  {
+    ScopeBenchmark benchmark("airspace.find_nearest", n);
+    for (auto i = points.begin(), end = points.end(); i != end; ++i)
+      if (airspaces.find_nearest(*i) != NULL)
+        ++found;
+  }
+
+  PrintBenchmarkCounter("airspace.find_nearest.found", found);
+}
+
+/**
+ * The airspace list dialog with a large number of generated
+ * airspaces: building the sorted list, and the queries which run for
+ * each key stroke of the name filter and each change of the distance
+ * filter.
+ */
+static void
+BenchmarkAirspaceSorter()
+{
+  const unsigned n = 30000;
+
+  Airspaces airspaces;
+  srand(1);
+  for (unsigned i = 0; i < n; ++i) {
+    TCHAR name[8];
+    for (unsigned j = 0; j < 6; ++j)
+      name[j] = _T('A') + rand() % 26;
+    name[6] = 0;
+
+    const GeoPoint center(Angle::Degrees(fixed(rand() % 10000) / 1000),
+                          Angle::Degrees(fixed(45 + rand() % 10000 / 1000.)));
+    AbstractAirspace *airspace =
+      new AirspaceCircle(center, fixed(500 + rand() % 10000));
+    airspace->SetProperties(name, OTHER, AirspaceAltitude(),
+                            AirspaceAltitude());
+    airspaces.insert(airspace);
+  }
+
+  airspaces.optimise();
+
+  const GeoPoint location(Angle::Degrees(fixed(5)), Angle::Degrees(fixed(50)));
+
+  AirspaceSorter *sorter;
+
+  {
+    ScopeBenchmark benchmark("airspace_sorter.create");
+    sorter = new AirspaceSorter(airspaces, location, fixed_one);
+    sorter->UpdateMetrics();
+  }
+
+  static const TCHAR *const keystrokes[] = {
+    _T("K"), _T("KL"), _T("KLM"), _T("KLMN"), _T("KLMNO"),
+  };
+
+  AirspaceSelectInfoVector result;
+  unsigned found = 0;
+
+  {
+    ScopeBenchmark benchmark("airspace_sorter.find_name_prefix",
+                             ARRAY_SIZE(keystrokes));
+    for (unsigned i = 0; i < ARRAY_SIZE(keystrokes); ++i) {
+      sorter->FindNamePrefix(result, keystrokes[i]);
+      found += result.size();
+    }
+  }
+
+  {
+    static const unsigned distances[] = { 5000, 25000, 50000, 100000 };
+    ScopeBenchmark benchmark("airspace_sorter.find_within_range",
+                             ARRAY_SIZE(distances));
+    for (unsigned i = 0; i < ARRAY_SIZE(distances); ++i) {
+      sorter->FindWithinRange(result, fixed(distances[i]));
+      found += result.size();
+    }
+  }
+
+  delete sorter;
+
+  PrintBenchmarkCounter("airspace_sorter.found", found);
+}
+
+static void
+FormatNMEAAngle(char *buffer, Angle angle, char positive, char negative)
+{
+  fixed degrees = angle.Degrees();
+  char suffix = positive;
+  if (negative(degrees)) {
+    degrees = -degrees;
+    suffix = negative;
+  }
+
+  const unsigned whole = (unsigned)degrees;
+  sprintf(buffer, "%u%07.4f,%c", whole, (double)((degrees - fixed(whole)) * 60),
+          suffix);
+}
+
+/**
+ * Generate GPRMC and GPGGA sentences from the specified flight.
+ */
+static void
+GenerateNMEA(const std::vector<AircraftState> &states,
+             std::vector<std::string> &lines)
+{
+  for (auto i = states.begin(), end = states.end(); i != end; ++i) {
+    const unsigned t = (unsigned)i->time;
+    const unsigned hh = t / 3600, mm = t / 60 % 60, ss = t % 60;
+
+    char latitude[32], longitude[32], buffer[128];
+    FormatNMEAAngle(latitude, i->location.latitude, 'N', 'S');
+    FormatNMEAAngle(longitude, i->location.longitude, 'E', 'W');
+
+    sprintf(buffer, "$GPRMC,%02u%02u%02u,A,%s,%s,058.3,284.0,050611,,",
+            hh, mm, ss, latitude, longitude);
+    AppendNMEAChecksum(buffer);
+    lines.push_back(buffer);
+
+    sprintf(buffer, "$GPGGA,%02u%02u%02u,%s,%s,1,08,0.9,%.1f,M,46.9,M,,",
+            hh, mm, ss, latitude, longitude, (double)i->altitude);
+    AppendNMEAChecksum(buffer);
+    lines.push_back(buffer);
+  }
+}
+
+static void
+BenchmarkNMEA(const std::vector<AircraftState> &states)
+{
+  std::vector<std::string> lines;
+  GenerateNMEA(states, lines);
+
+  NMEAParser parser;
+  NMEAInfo info;
+  info.Reset();
+  info.clock = fixed_one;
+
+  ScopeBenchmark benchmark("nmea.parse", lines.size());
+  for (auto i = lines.begin(), end = lines.end(); i != end; ++i) {
+    info.clock += fixed_half;
+    parser.ParseLine(i->c_str(), info);
+  }
+}
+
+static void
+BenchmarkWaypoints(const char *path)
+{
+  const unsigned n = 20;
+
+  ScopeBenchmark benchmark("waypoint.load_cup", n);
+  for (unsigned i = 0; i < n; ++i) {
+    Waypoints waypoints;
+    WaypointReader reader(PathName(path), 0);
+    NullOperationEnvironment operation;
+    if (reader.Error() || !reader.Parse(waypoints, operation)) {
+      fprintf(stderr, "Failed to load %s\n", path);
+      return;
+    }
+
+    waypoints.Optimise();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<AircraftState> states;
+  if (!LoadFlight("test/data/0asljd01.igc", states))
+    return EXIT_FAILURE;
+
+  BenchmarkTrace(states);
+  BenchmarkContest(states);
+  BenchmarkAirspace("test/data/AirspaceAus-DAA.txt");
+  BenchmarkAirspaceSorter();
+  BenchmarkNMEA(states);
+  BenchmarkWaypoints("test/data/waypoints.cup");
+
+  return EXIT_SUCCESS;
+}
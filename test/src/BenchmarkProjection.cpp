@@ -23,9 +23,18 @@ Copyright_License {
 
 #include "Projection/Projection.hpp"
 #include "Screen/Layout.hpp"
+#include "Benchmark.hpp"
+
+#include <stdlib.h>
 
 unsigned Layout::scale_1024 = 1024;
 
+/**
+ * The results are stored here, to prevent the compiler from
+ * optimizing the loops away.
+ */
+static volatile long sink;
+
 class TestProjection : public Projection {
 public:
   TestProjection() {
@@ -43,13 +52,29 @@ int main(int argc, char **argv)
   GeoPoint gp = GeoPoint(Angle::Degrees(fixed(7.7061111111111114)),
                          Angle::Degrees(fixed(51.051944444444445)));
   long x = 0, y = 0;
-  for (unsigned i = 64 * 1024 * 1024; i-- > 0;) {
-    RasterPoint rp = projection.GeoToScreen(gp);
 
-    /* prevent gcc from optimizing this loop away */
-    x += rp.x;
-    y += rp.y;
+  const unsigned n = 1024 * 1024;
+
+  {
+    ScopeBenchmark benchmark("projection.geo_to_screen", n);
+    for (unsigned i = n; i-- > 0;) {
+      RasterPoint rp = projection.GeoToScreen(gp);
+
+      x += rp.x;
+      y += rp.y;
+    }
   }
 
-  return x + y;
+  {
+    ScopeBenchmark benchmark("projection.screen_to_geo", n);
+    for (unsigned i = n; i-- > 0;) {
+      GeoPoint p = projection.ScreenToGeo(i & 0x1ff, i >> 11);
+
+      x += (long)p.longitude.Native();
+    }
+  }
+
+  sink = x + y;
+
+  return EXIT_SUCCESS;
 }
@@ -0,0 +1,145 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+/*
+ * Benchmarks for the terrain kernels: line scans, the height matrix
+ * used by the terrain renderer, and reach/route planning.  The
+ * terrain is loaded from test/data/benalla9.xcm.
+ */
+
+#include "Benchmark.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Route/TerrainRoute.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Navigation/SpeedVector.hpp"
+#include "Navigation/Geometry/GeoVector.hpp"
+#include "Screen/Layout.hpp"
+#include "Operation/Operation.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+#ifdef INSTRUMENT_TASK
+/* counts the MacCready calculations, see MacCready.cpp */
+extern long count_mc;
+#endif
+
+static void
+BenchmarkScanLine(const RasterMap &map)
+{
+  const GeoPoint center = map.GetMapCenter();
+  const unsigned n = 1000;
+
+  enum { SIZE = 256 };
+  short buffer[SIZE];
+
+  ScopeBenchmark benchmark("terrain.scan_line", n);
+  for (unsigned i = 0; i < n; ++i) {
+    const Angle direction = Angle::Degrees(fixed(i * 7));
+    const GeoPoint start = GeoVector(fixed(30000), direction).EndPoint(center);
+    const GeoPoint end =
+      GeoVector(fixed(30000), direction.Reciprocal()).EndPoint(center);
+    map.ScanLine(start, end, buffer, SIZE, true);
+  }
+}
+
+static void
+BenchmarkHeightMatrix(const RasterMap &map)
+{
+  WindowProjection projection;
+  projection.SetScreenSize(640, 480);
+  projection.SetScaleFromRadius(fixed(50000));
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(320, 240);
+  projection.UpdateScreenBounds();
+
+  const unsigned n = 20;
+
+  HeightMatrix matrix;
+  ScopeBenchmark benchmark("terrain.height_matrix_fill", n);
+  for (unsigned i = 0; i < n; ++i)
+    matrix.Fill(map, projection, 1, true);
+}
+
+static void
+BenchmarkRoute(const RasterMap &map)
+{
+  GlidePolar polar(fixed_one);
+  SpeedVector wind(Angle::Zero(), fixed_zero);
+
+  TerrainRoute route;
+  route.UpdatePolar(polar, polar, wind);
+  route.SetTerrain(&map);
+
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::rpBoth;
+
+  const GeoPoint origin = map.GetMapCenter();
+  const AGeoPoint aorigin(origin,
+                          RoughAltitude(map.GetHeight(origin) + 1000));
+
+  {
+    ScopeBenchmark benchmark("route.reach");
+    route.SolveReach(aorigin, config, RoughAltitude::Max());
+  }
+
+  const unsigned n = 16;
+
+  ScopeBenchmark benchmark("route.solve", n);
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoPoint dest =
+      GeoVector(fixed(40000), Angle::Degrees(fixed(i * 360 / n))).EndPoint(origin);
+    const AGeoPoint adest(dest, RoughAltitude(map.GetHeight(dest) + 100));
+    route.Solve(aorigin, adest, config, RoughAltitude(10000));
+  }
+
+#ifdef INSTRUMENT_TASK
+  PrintBenchmarkCounter("route.mc_count", count_mc);
+#endif
+}
+
+int main(int argc, char **argv)
+{
+  NullOperationEnvironment operation;
+  RasterMap map(_T("test/data/benalla9.xcm/terrain.jp2"), NULL, NULL,
+                operation);
+  if (!map.isMapLoaded()) {
+    fprintf(stderr, "failed to load map\n");
+    return EXIT_FAILURE;
+  }
+
+  do {
+    map.SetViewCenter(map.GetMapCenter(), fixed(100000));
+  } while (map.IsDirty());
+
+  BenchmarkScanLine(map);
+  BenchmarkHeightMatrix(map);
+  BenchmarkRoute(map);
+
+  return EXIT_SUCCESS;
+}
@@ -92,4 +92,14 @@ protected:
 DebugReplay *
 CreateDebugReplay(Args &args);
 
+/**
+ * Create a #DebugReplay for the specified IGC file.  The returned
+ * object is independent of all others, and may be used in a
+ * separate thread.
+ *
+ * @return NULL on error (an error message has been printed)
+ */
+DebugReplay *
+CreateDebugReplayIGC(const char *input_file);
+
 #endif
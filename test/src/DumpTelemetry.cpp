@@ -0,0 +1,198 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Maps the telemetry segment of a running XCSoar instance (started
+ * with "-telemetry") and prints its contents periodically.  This is
+ * also a reference for external tools which read the segment; see
+ * src/Telemetry/TelemetryLayout.hpp.
+ */
+
+#include "Telemetry/TelemetryLayout.hpp"
+#include "Args.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace Telemetry;
+
+/**
+ * Copy a section, retrying while the writer is active.
+ */
+template<typename T>
+static bool
+Read(const Section<T> &section, T &dest)
+{
+  for (unsigned i = 0; i < 1000; ++i)
+    if (TryRead(section, dest))
+      return true;
+
+  return false;
+}
+
+static void
+PrintFlight(const Flight &flight)
+{
+  printf("time=%.0f", flight.time);
+
+  if (flight.flags & Flight::LOCATION)
+    printf(" location=%.5f,%.5f gs=%.1f track=%.0f",
+           flight.latitude, flight.longitude,
+           flight.ground_speed, flight.track);
+  else
+    printf(" location=none");
+
+  if (flight.flags & Flight::GPS_ALTITUDE)
+    printf(" alt=%.0f", flight.gps_altitude);
+
+  if (flight.flags & Flight::BARO_ALTITUDE)
+    printf(" baro=%.0f", flight.baro_altitude);
+
+  if (flight.flags & Flight::ALTITUDE_AGL)
+    printf(" agl=%.0f", flight.altitude_agl);
+
+  if (flight.flags & Flight::AIRSPEED)
+    printf(" tas=%.1f", flight.true_airspeed);
+
+  printf(" vario=%.1f avg=%.1f", flight.brutto_vario, flight.average_vario);
+
+  if (flight.flags & Flight::NETTO_VARIO)
+    printf(" netto=%.1f", flight.netto_vario);
+
+  if (flight.flags & Flight::WIND)
+    printf(" wind=%.0f/%.1f", flight.wind_bearing, flight.wind_speed);
+
+  printf(" mc=%.1f", flight.mac_cready);
+
+  if (flight.flags & Flight::TASK_VALID)
+    printf(" task=%.0fm/%+.0fm", flight.task_remaining_distance,
+           flight.task_altitude_difference);
+
+  printf(" sats=%u traffic=%u%s%s%s\n",
+         flight.satellites_used, flight.flarm_traffic,
+         flight.flags & Flight::CONNECTED ? "" : " disconnected",
+         flight.flags & Flight::FLYING ? " flying" : "",
+         flight.flags & Flight::CIRCLING ? " circling" : "");
+}
+
+static void
+PrintThread(const ThreadTiming &timing, const ThreadTiming &previous,
+            double interval)
+{
+  const uint64_t cycles = timing.cycles - previous.cycles;
+  const uint64_t duration = timing.total_duration - previous.total_duration;
+
+  printf("  %-20s %8llu cycles %7.1f/s busy=%5.1f%% avg=%6lluus"
+         " last=%6uus max=%6uus\n",
+         timing.name, (unsigned long long)timing.cycles,
+         interval > 0 ? cycles / interval : 0.,
+         interval > 0 ? duration / (interval * 1e4) : 0.,
+         cycles > 0 ? (unsigned long long)(duration / cycles) : 0ULL,
+         (unsigned)timing.last_duration, (unsigned)timing.max_duration);
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv, "[--name NAME] [--interval MS] [--once]");
+
+  const char *name = "/xcsoar-telemetry";
+  unsigned interval = 1000;
+  bool once = false;
+
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+    if (strcmp(arg, "--name") == 0)
+      name = args.ExpectNext();
+    else if (strcmp(arg, "--interval") == 0)
+      interval = atoi(args.ExpectNext());
+    else if (strcmp(arg, "--once") == 0)
+      once = true;
+    else {
+      fprintf(stderr, "Unknown option: %s\n", arg);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (interval == 0) {
+    fprintf(stderr, "Invalid interval\n");
+    return EXIT_FAILURE;
+  }
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    perror("Failed to open the telemetry segment");
+    return EXIT_FAILURE;
+  }
+
+  void *p = mmap(NULL, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    perror("Failed to map the telemetry segment");
+    return EXIT_FAILURE;
+  }
+
+  const Segment &segment = *(const Segment *)p;
+  if (segment.magic != MAGIC || segment.version != VERSION ||
+      segment.size != sizeof(segment)) {
+    fprintf(stderr, "Incompatible telemetry segment\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("pid %u\n", (unsigned)segment.pid);
+
+  ThreadTiming previous[NUM_THREADS];
+  for (unsigned i = 0; i < NUM_THREADS; ++i)
+    if (!Read(segment.threads[i], previous[i]))
+      memset(&previous[i], 0, sizeof(previous[i]));
+
+  while (true) {
+    if (!once)
+      usleep(interval * 1000);
+
+    Flight flight;
+    if (Read(segment.flight, flight))
+      PrintFlight(flight);
+
+    for (unsigned i = 0; i < NUM_THREADS; ++i) {
+      ThreadTiming timing;
+      if (!Read(segment.threads[i], timing))
+        continue;
+
+      PrintThread(timing, previous[i], once ? 0. : interval / 1000.);
+      previous[i] = timing;
+    }
+
+    fflush(stdout);
+
+    if (once)
+      break;
+  }
+
+  munmap(p, sizeof(Segment));
+  return EXIT_SUCCESS;
+}
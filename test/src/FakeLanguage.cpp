@@ -31,4 +31,10 @@ gettext(const TCHAR *text)
   return text;
 }
 
+const TCHAR *
+gettext_literal(const TCHAR *text)
+{
+  return text;
+}
+
 #endif
@@ -0,0 +1,214 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * A local stand-in for the LiveTrack24 server.  It answers every
+ * HTTP request with "OK", optionally after a delay, and can simulate
+ * periodic outages.  Use it with "RunLiveTrack24 --server=..." to
+ * measure throughput and backlog recovery time.
+ */
+
+#include "OS/Clock.hpp"
+#include "OS/Sleep.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+
+static const char response[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/plain\r\n"
+  "Content-Length: 2\r\n"
+  "\r\n"
+  "OK";
+
+static unsigned latency = 0;
+static unsigned up_time = 0, down_time = 0;
+static unsigned start_time;
+
+static unsigned n_requests = 0, n_rejected = 0;
+
+/**
+ * Is the simulated server currently unavailable?
+ */
+static bool
+IsDown()
+{
+  if (down_time == 0)
+    return false;
+
+  const unsigned t = (MonotonicClockMS() - start_time) / 1000;
+  return t % (up_time + down_time) >= up_time;
+}
+
+struct Client {
+  int fd;
+
+  size_t fill;
+  char buffer[4096];
+};
+
+static const unsigned MAX_CLIENTS = 16;
+static Client clients[MAX_CLIENTS];
+static unsigned n_clients = 0;
+
+/**
+ * Reads from a (keep-alive) connection and answers all complete
+ * requests.
+ *
+ * @return false if the connection shall be closed
+ */
+static bool
+HandleClient(Client &client)
+{
+  if (IsDown()) {
+    ++n_rejected;
+    return false;
+  }
+
+  ssize_t nbytes = recv(client.fd, client.buffer + client.fill,
+                        sizeof(client.buffer) - 1 - client.fill, 0);
+  if (nbytes <= 0)
+    return false;
+
+  client.fill += nbytes;
+  client.buffer[client.fill] = 0;
+
+  /* the client sends only GET requests without a body; each one
+     ends with an empty line */
+  char *end;
+  while ((end = strstr(client.buffer, "\r\n\r\n")) != NULL) {
+    end += 4;
+
+    if (latency > 0)
+      Sleep(latency);
+
+    if (send(client.fd, response, sizeof(response) - 1, 0) < 0)
+      return false;
+
+    ++n_requests;
+
+    client.fill -= end - client.buffer;
+    memmove(client.buffer, end, client.fill + 1);
+  }
+
+  /* reject requests which are too large */
+  return client.fill < sizeof(client.buffer) - 1;
+}
+
+int
+main(int argc, char **argv)
+{
+  if (argc > 5) {
+    fprintf(stderr, "Usage: %s [PORT [LATENCY_MS [UP_S DOWN_S]]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const unsigned port = argc > 1 ? atoi(argv[1]) : 8024;
+  if (argc > 2)
+    latency = atoi(argv[2]);
+  if (argc > 4) {
+    up_time = atoi(argv[3]);
+    down_time = atoi(argv[4]);
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    perror("Failed to create socket");
+    return EXIT_FAILURE;
+  }
+
+  const int one = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+
+  if (bind(listen_fd, (const struct sockaddr *)&address,
+           sizeof(address)) < 0 ||
+      listen(listen_fd, 4) < 0) {
+    perror("Failed to bind socket");
+    return EXIT_FAILURE;
+  }
+
+  printf("Listening on 127.0.0.1:%u\n", port);
+
+  start_time = MonotonicClockMS();
+
+  unsigned n_connections = 0;
+  while (true) {
+    struct pollfd pfds[1 + MAX_CLIENTS];
+    pfds[0].fd = listen_fd;
+    pfds[0].events = n_clients < MAX_CLIENTS ? POLLIN : 0;
+    for (unsigned i = 0; i < n_clients; ++i) {
+      pfds[1 + i].fd = clients[i].fd;
+      pfds[1 + i].events = POLLIN;
+    }
+
+    if (poll(pfds, 1 + n_clients, -1) < 0) {
+      perror("poll() failed");
+      return EXIT_FAILURE;
+    }
+
+    /* walk backwards, because closed clients are replaced with the
+       last one */
+    for (unsigned i = n_clients; i-- > 0;) {
+      if (pfds[1 + i].revents == 0 || HandleClient(clients[i]))
+        continue;
+
+      close(clients[i].fd);
+      clients[i] = clients[--n_clients];
+
+      printf("connections=%u requests=%u rejected=%u\n",
+             n_connections, n_requests, n_rejected);
+      fflush(stdout);
+    }
+
+    if (pfds[0].revents != 0) {
+      int fd = accept(listen_fd, NULL, NULL);
+      if (fd < 0) {
+        perror("Failed to accept connection");
+        continue;
+      }
+
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+      ++n_connections;
+      clients[n_clients].fd = fd;
+      clients[n_clients].fill = 0;
+      ++n_clients;
+    }
+  }
+}
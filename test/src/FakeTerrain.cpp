@@ -23,12 +23,21 @@ Copyright_License {
 
 #include "Terrain/RasterTerrain.hpp"
 
+#include <algorithm>
+
 short
 RasterMap::GetHeight(const GeoPoint &location) const
 {
   return RasterBuffer::TERRAIN_INVALID;
 }
 
+void
+RasterMap::GetHeights(const GeoPoint *locations, short *heights,
+                      unsigned n) const
+{
+  std::fill(heights, heights + n, (short)RasterBuffer::TERRAIN_INVALID);
+}
+
 GeoPoint
 RasterMap::Intersection(const GeoPoint& origin,
                         const short h_origin,
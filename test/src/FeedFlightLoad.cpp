@@ -0,0 +1,540 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * A synthetic load generator for the NMEA input pipeline.  It flies
+ * an own ship (alternating between cruise and circling) surrounded by
+ * a configurable number of FLARM targets, and sends the resulting
+ * NMEA sentences to a running XCSoar instance over TCP, a pseudo-TTY
+ * or stdout.
+ *
+ * With "--pid", it samples the CPU usage of each thread of that
+ * process from /proc.  Start XCSoar with "-trace" to get the thread
+ * names, and to record the fix-to-screen latency as the counter
+ * "MapWindow.fix_latency_ms" in xcsoar-trace.json.
+ */
+
+#include "NMEA/Checksum.hpp"
+#include "OS/Clock.hpp"
+#include "Args.hpp"
+
+#include <map>
+#include <string>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/** the reference point of the flat-earth simulation */
+static const double REFERENCE_LATITUDE = 51.0;
+static const double REFERENCE_LONGITUDE = 7.0;
+static const double METERS_PER_DEGREE = 111195.;
+
+/** FLARM does not report targets beyond this distance [m] */
+static const double FLARM_RANGE = 10000.;
+
+enum VarioProtocol {
+  VARIO_NONE,
+  VARIO_LX,
+  VARIO_VEGA,
+};
+
+struct VarioProtocolName {
+  const char *name;
+  VarioProtocol protocol;
+};
+
+static const VarioProtocolName vario_protocols[] = {
+  { "none", VARIO_NONE },
+  { "lx", VARIO_LX },
+  { "vega", VARIO_VEGA },
+};
+
+struct Aircraft {
+  /** position relative to the reference point [m] */
+  double north, east, altitude;
+
+  /** [rad], clockwise from north */
+  double track;
+
+  /** [m/s] */
+  double speed, climb;
+
+  /** [rad/s]; zero when flying straight */
+  double turn_rate;
+
+  char id[7];
+
+  void Integrate(double dt) {
+    track = fmod(track + turn_rate * dt + 2 * M_PI, 2 * M_PI);
+    north += cos(track) * speed * dt;
+    east += sin(track) * speed * dt;
+    altitude += climb * dt;
+  }
+};
+
+/**
+ * Returns a pseudo-random number between 0 and 1.
+ */
+static double
+Random()
+{
+  return rand() / (RAND_MAX + 1.);
+}
+
+/**
+ * The own ship cruises for 60 seconds, then circles for 30 seconds.
+ */
+static void
+UpdateOwnShip(Aircraft &ship, double time)
+{
+  const bool circling = fmod(time, 90.) >= 60.;
+  ship.turn_rate = circling ? 2 * M_PI / 20 : 0;
+  ship.climb = circling ? 2. : -1.;
+}
+
+static Aircraft
+CreateTarget(unsigned i, double radius)
+{
+  Aircraft target;
+  const double distance = radius * sqrt(Random());
+  const double bearing = Random() * 2 * M_PI;
+  target.north = cos(bearing) * distance;
+  target.east = sin(bearing) * distance;
+  target.altitude = 1000. + Random() * 1000.;
+  target.track = Random() * 2 * M_PI;
+  target.speed = 20. + Random() * 20.;
+  target.climb = Random() * 4. - 2.;
+  /* every third target circles, in either direction */
+  target.turn_rate = i % 3 == 0
+    ? (i % 2 == 0 ? 1 : -1) * 2 * M_PI / (18. + Random() * 8.)
+    : 0.;
+  sprintf(target.id, "%06X", 0xD00000 + i);
+  return target;
+}
+
+/**
+ * Formats an angle as NMEA degrees and minutes.
+ */
+static void
+FormatAngle(char *buffer, double value, unsigned degree_digits)
+{
+  value = fabs(value);
+  const unsigned degrees = (unsigned)value;
+  sprintf(buffer, "%0*u%06.3f", degree_digits, degrees,
+          (value - degrees) * 60);
+}
+
+class Output {
+  int fd;
+
+  unsigned long sentences, bytes;
+
+public:
+  Output(int _fd):fd(_fd), sentences(0), bytes(0) {}
+
+  /**
+   * Appends the checksum and sends the sentence.  Blocks if the
+   * receiver is not fast enough.
+   */
+  void Send(char *sentence) {
+    AppendNMEAChecksum(sentence);
+    strcat(sentence, "\r\n");
+
+    const char *p = sentence;
+    size_t length = strlen(sentence);
+    while (length > 0) {
+      ssize_t nbytes = write(fd, p, length);
+      if (nbytes < 0) {
+        if (errno == EINTR)
+          continue;
+
+        perror("Failed to send");
+        exit(EXIT_FAILURE);
+      }
+
+      p += nbytes;
+      length -= nbytes;
+      bytes += nbytes;
+    }
+
+    ++sentences;
+  }
+
+  unsigned long GetSentences() const {
+    return sentences;
+  }
+
+  unsigned long GetBytes() const {
+    return bytes;
+  }
+};
+
+static void
+SendOwnShip(Output &output, const Aircraft &ship, double time,
+            VarioProtocol vario)
+{
+  const double latitude = REFERENCE_LATITUDE + ship.north / METERS_PER_DEGREE;
+  const double longitude = REFERENCE_LONGITUDE + ship.east /
+    (METERS_PER_DEGREE * cos(REFERENCE_LATITUDE * M_PI / 180));
+  const double track_degrees = ship.track * 180 / M_PI;
+
+  char lat[16], lon[16];
+  FormatAngle(lat, latitude, 2);
+  FormatAngle(lon, longitude, 3);
+
+  const unsigned second_of_day = (unsigned)time % 86400;
+  char stamp[16];
+  sprintf(stamp, "%02u%02u%05.2f", second_of_day / 3600,
+          second_of_day / 60 % 60,
+          second_of_day % 60 + (time - floor(time)));
+
+  char sentence[256];
+  sprintf(sentence, "$GPRMC,%s,A,%s,%c,%s,%c,%.1f,%.1f,010711,,,A",
+          stamp, lat, latitude >= 0 ? 'N' : 'S',
+          lon, longitude >= 0 ? 'E' : 'W',
+          ship.speed * 3600 / 1852, track_degrees);
+  output.Send(sentence);
+
+  sprintf(sentence, "$GPGGA,%s,%s,%c,%s,%c,1,08,1.0,%.1f,M,0.0,M,,",
+          stamp, lat, latitude >= 0 ? 'N' : 'S',
+          lon, longitude >= 0 ? 'E' : 'W', ship.altitude);
+  output.Send(sentence);
+
+  sprintf(sentence, "$PGRMZ,%d,f,3", (int)(ship.altitude / 0.3048));
+  output.Send(sentence);
+
+  switch (vario) {
+  case VARIO_NONE:
+    break;
+
+  case VARIO_LX:
+    // $LXWP0,logger,IAS,baroaltitude,vario1..6,heading,windcourse,windspeed
+    sprintf(sentence, "$LXWP0,Y,%.1f,%.1f,%.2f,,,,,,%.0f,,",
+            ship.speed * 3.6, ship.altitude, ship.climb, track_degrees);
+    output.Send(sentence);
+    break;
+
+  case VARIO_VEGA:
+    // $PDVDV,vario,ias,densityratio,altitude,staticpressure
+    sprintf(sentence, "$PDVDV,%d,%d,1024,%d,",
+            (int)(ship.climb * 10), (int)(ship.speed * 10),
+            (int)ship.altitude);
+    output.Send(sentence);
+    break;
+  }
+}
+
+static void
+SendTraffic(Output &output, const Aircraft &ship,
+            const Aircraft *targets, unsigned n_targets)
+{
+  char sentence[256];
+
+  unsigned n_visible = 0;
+  for (unsigned i = 0; i < n_targets; ++i) {
+    const Aircraft &target = targets[i];
+    const double north = target.north - ship.north;
+    const double east = target.east - ship.east;
+    if (north * north + east * east > FLARM_RANGE * FLARM_RANGE)
+      continue;
+
+    // PFLAA,<AlarmLevel>,<RelativeNorth>,<RelativeEast>,<RelativeVertical>,
+    //   <IDType>,<ID>,<Track>,<TurnRate>,<GroundSpeed>,<ClimbRate>,<AcftType>
+    sprintf(sentence, "$PFLAA,0,%d,%d,%d,2,%s,%d,%d,%d,%.1f,1",
+            (int)north, (int)east, (int)(target.altitude - ship.altitude),
+            target.id, (int)(target.track * 180 / M_PI),
+            (int)(target.turn_rate * 180 / M_PI), (int)target.speed,
+            target.climb);
+    output.Send(sentence);
+    ++n_visible;
+  }
+
+  // PFLAU,<RX>,<TX>,<GPS>,<Power>,<AlarmLevel>,<RelativeBearing>,<AlarmType>,
+  //   <RelativeVertical>,<RelativeDistance>(,<ID>)
+  sprintf(sentence, "$PFLAU,%u,1,2,1,0,,0,,", n_visible);
+  output.Send(sentence);
+}
+
+static int
+ConnectTCP(unsigned port)
+{
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("Socket");
+    exit(EXIT_FAILURE);
+  }
+
+  if (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    perror("Connect");
+    exit(EXIT_FAILURE);
+  }
+
+  return fd;
+}
+
+/**
+ * Creates a pseudo-TTY and returns the master.  XCSoar shall be
+ * configured to open the slave as a serial port.
+ */
+static int
+OpenPTY()
+{
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+    perror("Failed to create a pseudo-TTY");
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(stderr, "Serial port: %s\n", ptsname(fd));
+  return fd;
+}
+
+/**
+ * Samples the CPU usage of each thread of a process from
+ * /proc/PID/task/TID/stat.
+ */
+class ThreadCPUMonitor {
+  unsigned pid;
+
+  struct Sample {
+    std::string name;
+    unsigned long ticks;
+  };
+
+  /** the previous sample, by thread id */
+  std::map<unsigned, Sample> previous;
+
+  static bool ReadSample(const char *path, Sample &sample) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+      return false;
+
+    char line[1024];
+    const bool success = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+    if (!success)
+      return false;
+
+    /* the name is in parentheses and may contain spaces */
+    char *open = strchr(line, '('), *close = strrchr(line, ')');
+    if (open == NULL || close == NULL || close < open)
+      return false;
+
+    sample.name.assign(open + 1, close);
+
+    /* skip "state" and the 10 fields up to utime and stime */
+    unsigned long utime, stime;
+    if (sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+               "%lu %lu", &utime, &stime) != 2)
+      return false;
+
+    sample.ticks = utime + stime;
+    return true;
+  }
+
+public:
+  explicit ThreadCPUMonitor(unsigned _pid):pid(_pid) {}
+
+  /**
+   * Prints the CPU usage of each thread since the last call.
+   */
+  void Report(double elapsed_s) {
+    char path[64];
+    sprintf(path, "/proc/%u/task", pid);
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+      fprintf(stderr, "Failed to open %s\n", path);
+      return;
+    }
+
+    const double ticks_per_second = sysconf(_SC_CLK_TCK);
+
+    std::map<unsigned, Sample> current;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+      if (ent->d_name[0] == '.')
+        continue;
+
+      const unsigned tid = atoi(ent->d_name);
+      sprintf(path, "/proc/%u/task/%u/stat", pid, tid);
+
+      Sample sample;
+      if (!ReadSample(path, sample))
+        continue;
+
+      current[tid] = sample;
+
+      std::map<unsigned, Sample>::const_iterator i = previous.find(tid);
+      if (i != previous.end() && elapsed_s > 0)
+        fprintf(stderr, "  cpu %6u %-16s %5.1f%%\n", tid, sample.name.c_str(),
+                (sample.ticks - i->second.ticks) * 100. /
+                (ticks_per_second * elapsed_s));
+    }
+
+    closedir(dir);
+    previous.swap(current);
+  }
+};
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv,
+            "[--tcp PORT | --pty] [--traffic N] [--radius METERS]\n"
+            "    [--rate HZ] [--vario none|lx|vega] [--duration SECONDS]\n"
+            "    [--pid PID]");
+
+  int fd = STDOUT_FILENO;
+  unsigned n_targets = 0, pid = 0;
+  double radius = 5000., rate = 1., duration = 0.;
+  VarioProtocol vario = VARIO_LX;
+
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+    if (strcmp(arg, "--tcp") == 0)
+      fd = ConnectTCP(atoi(args.ExpectNext()));
+    else if (strcmp(arg, "--pty") == 0)
+      fd = OpenPTY();
+    else if (strcmp(arg, "--traffic") == 0)
+      n_targets = atoi(args.ExpectNext());
+    else if (strcmp(arg, "--radius") == 0)
+      radius = atof(args.ExpectNext());
+    else if (strcmp(arg, "--rate") == 0)
+      rate = atof(args.ExpectNext());
+    else if (strcmp(arg, "--duration") == 0)
+      duration = atof(args.ExpectNext());
+    else if (strcmp(arg, "--pid") == 0)
+      pid = atoi(args.ExpectNext());
+    else if (strcmp(arg, "--vario") == 0) {
+      const char *name = args.ExpectNext();
+      unsigned i = 0;
+      while (i < sizeof(vario_protocols) / sizeof(vario_protocols[0]) &&
+             strcmp(vario_protocols[i].name, name) != 0)
+        ++i;
+
+      if (i == sizeof(vario_protocols) / sizeof(vario_protocols[0])) {
+        fprintf(stderr, "Unknown vario protocol: %s\n", name);
+        return EXIT_FAILURE;
+      }
+
+      vario = vario_protocols[i].protocol;
+    } else {
+      fprintf(stderr, "Unknown option: %s\n", arg);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (rate <= 0) {
+    fprintf(stderr, "Invalid rate\n");
+    return EXIT_FAILURE;
+  }
+
+  Aircraft ship;
+  ship.north = ship.east = 0;
+  ship.altitude = 1500;
+  ship.track = 0;
+  ship.speed = 30;
+  ship.climb = 0;
+  ship.turn_rate = 0;
+
+  Aircraft *targets = new Aircraft[n_targets];
+  for (unsigned i = 0; i < n_targets; ++i)
+    targets[i] = CreateTarget(i, radius);
+
+  ThreadCPUMonitor monitor(pid);
+
+  Output output(fd);
+
+  /* the simulated time starts at 10:00 UTC */
+  const double start_time = 36000;
+  const double dt = 1. / rate;
+
+  const uint64_t start_us = MonotonicClockUS();
+  uint64_t report_us = start_us;
+  unsigned long n_fixes = 0, report_sentences = 0, report_bytes = 0;
+  unsigned long late_fixes = 0;
+
+  while (duration <= 0 || n_fixes * dt < duration) {
+    const double time = start_time + n_fixes * dt;
+
+    UpdateOwnShip(ship, time);
+
+    SendOwnShip(output, ship, time, vario);
+    if (n_targets > 0)
+      SendTraffic(output, ship, targets, n_targets);
+
+    ship.Integrate(dt);
+    for (unsigned i = 0; i < n_targets; ++i)
+      targets[i].Integrate(dt);
+
+    ++n_fixes;
+
+    /* keep the schedule; if sending blocked for too long, the
+       receiver is saturated and the fix is counted as late */
+    const uint64_t deadline = start_us + (uint64_t)(n_fixes * dt * 1e6);
+    const uint64_t now = MonotonicClockUS();
+    if (now < deadline)
+      usleep(deadline - now);
+    else
+      ++late_fixes;
+
+    if (now >= report_us + 1000000) {
+      const double elapsed_s = (now - report_us) / 1e6;
+      fprintf(stderr, "%lu fixes, %.0f sentences/s, %.0f bytes/s, "
+              "%lu late\n",
+              n_fixes,
+              (output.GetSentences() - report_sentences) / elapsed_s,
+              (output.GetBytes() - report_bytes) / elapsed_s,
+              late_fixes);
+
+      if (pid > 0)
+        monitor.Report(elapsed_s);
+
+      report_us = now;
+      report_sentences = output.GetSentences();
+      report_bytes = output.GetBytes();
+    }
+  }
+
+  delete[] targets;
+
+  if (fd != STDOUT_FILENO)
+    close(fd);
+
+  return EXIT_SUCCESS;
+}
@@ -22,17 +22,77 @@
 
 #include "Language/MOLoader.hpp"
 #include "OS/PathName.hpp"
+#include "OS/Clock.hpp"
 
 #include <stdio.h>
+#include <string.h>
 
 #ifdef _UNICODE
 #include <windows.h>
 #include <syslimits.h>
 #endif
 
+/**
+ * The old lookup method, for comparison.
+ */
+static int
+LinearFind(const MOFile &mo, const char *original)
+{
+  for (unsigned i = 0, n = mo.get_count(); i < n; ++i)
+    if (strcmp(mo.get_original(i), original) == 0)
+      return i;
+
+  return -1;
+}
+
+/**
+ * Look up every string of the file, and compare the hash table
+ * lookup with a linear search.
+ */
+static int
+Benchmark(const MOFile &mo)
+{
+  const unsigned n = mo.get_count();
+  const unsigned rounds = 10;
+
+  unsigned errors = 0;
+  for (unsigned i = 0; i < n; ++i)
+    if (mo.find(mo.get_original(i)) != LinearFind(mo, mo.get_original(i)))
+      ++errors;
+
+  if (mo.find("this string is not in the file") != -1)
+    ++errors;
+
+  unsigned found = 0;
+  unsigned long start = MonotonicClockUS();
+  for (unsigned r = 0; r < rounds; ++r)
+    for (unsigned i = 0; i < n; ++i)
+      found += mo.find(mo.get_original(i)) >= 0;
+  const unsigned long hashed = MonotonicClockUS() - start;
+
+  start = MonotonicClockUS();
+  for (unsigned r = 0; r < rounds; ++r)
+    for (unsigned i = 0; i < n; ++i)
+      found += LinearFind(mo, mo.get_original(i)) >= 0;
+  const unsigned long linear = MonotonicClockUS() - start;
+
+  if (found != 2 * n * rounds)
+    ++errors;
+
+  printf("%u strings, %u lookups: %lu us hashed, %lu us linear\n",
+         n, n * rounds, hashed, linear);
+
+  if (errors > 0) {
+    fprintf(stderr, "%u lookup errors\n", errors);
+    return 4;
+  }
+
+  return 0;
+}
+
 int main(int argc, char **argv) {
-  if (argc != 3) {
-    fprintf(stderr, "Usage: %s FILE.mo STRING\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    fprintf(stderr, "Usage: %s FILE.mo [STRING]\n", argv[0]);
     return 1;
   }
 
@@ -45,14 +105,17 @@ int main(int argc, char **argv) {
   const char *path = argv[1];
 #endif
 
-  const char *original = argv[2];
-
   MOLoader mo(path);
   if (mo.error()) {
     fprintf(stderr, "Failed to load %s\n", (const char *)NarrowPathName(path));
     return 2;
   }
 
+  if (argc == 2)
+    return Benchmark(mo.get());
+
+  const char *original = argv[2];
+
   const char *translated = mo.get().lookup(original);
   if (translated == NULL) {
     fprintf(stderr, "No such string\n");
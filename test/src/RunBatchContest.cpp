@@ -0,0 +1,380 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+/*
+ * Score the contests of many flights at once: each IGC file is
+ * replayed through its own #DebugReplay and #ContestManager instances
+ * on a pool of worker threads.  Results are streamed to stdout (in
+ * input order) as CSV or JSON, and the throughput is reported on
+ * stderr.
+ *
+ * This is a contest scoring tool only: the fixes are fed into the
+ * contest traces, but there is no GlideComputer or TaskManager, so
+ * task, wind and thermal statistics are not calculated.
+ */
+
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
+#include "Args.hpp"
+#include "DebugReplay.hpp"
+#include "NMEA/Aircraft.hpp"
+#include "UtilsFile.hpp"
+
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#endif
+
+enum {
+  CONTEST_CLASSIC,
+  CONTEST_LEAGUE,
+  CONTEST_FAI,
+  CONTEST_SPRINT,
+  CONTEST_PLUS,
+  N_CONTESTS,
+};
+
+static const char *const contest_names[N_CONTESTS] = {
+  "classic", "league", "fai", "sprint", "plus",
+};
+
+struct FlightResult {
+  /** has this flight been analysed already? */
+  bool done;
+
+  /** was the IGC file readable? */
+  bool valid;
+
+  unsigned n_fixes;
+
+  ContestResult results[N_CONTESTS];
+};
+
+/**
+ * Replays one flight and solves all contests, using only objects
+ * local to this call, so it may run in any thread.
+ */
+static void
+AnalyseFlight(const char *path, FlightResult &result)
+{
+  result.valid = false;
+  result.n_fixes = 0;
+
+  DebugReplay *replay = CreateDebugReplayIGC(path);
+  if (replay == NULL)
+    return;
+
+  Trace full_trace(60);
+  Trace sprint_trace(0, 9000, 300);
+
+  ContestManager classic(OLC_Classic, full_trace, sprint_trace);
+  ContestManager league(OLC_League, full_trace, sprint_trace);
+  ContestManager fai(OLC_FAI, full_trace, sprint_trace);
+  ContestManager sprint(OLC_Sprint, full_trace, sprint_trace);
+  ContestManager plus(OLC_Plus, full_trace, sprint_trace);
+
+  while (replay->Next()) {
+    const AircraftState state =
+      ToAircraftState(replay->Basic(), replay->Calculated());
+    full_trace.append(state);
+    sprint_trace.append(state);
+
+    full_trace.optimise_if_old();
+    sprint_trace.optimise_if_old();
+
+    sprint.UpdateIdle();
+    ++result.n_fixes;
+  }
+
+  delete replay;
+
+  classic.SolveExhaustive();
+  league.SolveExhaustive();
+  fai.SolveExhaustive();
+  plus.SolveExhaustive();
+
+  result.results[CONTEST_CLASSIC] = classic.GetStats().GetResult();
+  result.results[CONTEST_LEAGUE] = league.GetStats().GetResult();
+  result.results[CONTEST_FAI] = fai.GetStats().GetResult();
+  result.results[CONTEST_SPRINT] = sprint.GetStats().GetResult();
+  result.results[CONTEST_PLUS] = plus.GetStats().GetResult();
+  result.valid = true;
+}
+
+class BatchAnalysis {
+  const std::vector<std::string> &paths;
+  std::vector<FlightResult> results;
+
+  const bool json;
+
+  /**
+   * Protects #next_job, #next_output and the "done" flags in
+   * #results.
+   */
+  Mutex mutex;
+
+  unsigned next_job, next_output;
+
+public:
+  BatchAnalysis(const std::vector<std::string> &_paths, bool _json)
+    :paths(_paths), results(_paths.size()), json(_json),
+     next_job(0), next_output(0) {
+    for (auto i = results.begin(), end = results.end(); i != end; ++i)
+      i->done = false;
+  }
+
+  void BeginOutput() const {
+    if (json)
+      puts("[");
+    else {
+      printf("file,fixes");
+      for (unsigned i = 0; i < N_CONTESTS; ++i)
+        printf(",%s_score,%s_distance,%s_speed,%s_time",
+               contest_names[i], contest_names[i],
+               contest_names[i], contest_names[i]);
+      putchar('\n');
+    }
+  }
+
+  void EndOutput() const {
+    if (json)
+      puts("]");
+  }
+
+  /**
+   * Worker loop: analyse flights until there are no more.
+   */
+  void Work() {
+    unsigned i;
+    while ((i = NextJob()) < paths.size()) {
+      FlightResult result;
+      AnalyseFlight(paths[i].c_str(), result);
+      Finish(i, result);
+    }
+  }
+
+private:
+  unsigned NextJob() {
+    ScopeLock protect(mutex);
+    return next_job++;
+  }
+
+  void Finish(unsigned i, const FlightResult &result) {
+    ScopeLock protect(mutex);
+
+    results[i] = result;
+    results[i].done = true;
+
+    /* stream all results which are complete, preserving the input
+       order */
+    while (next_output < results.size() && results[next_output].done) {
+      Print(next_output);
+      ++next_output;
+    }
+
+    fflush(stdout);
+  }
+
+  /**
+   * Print a string as a JSON string literal.
+   */
+  static void PrintJSONString(const char *p) {
+    putchar('"');
+    for (; *p != 0; ++p) {
+      const unsigned char ch = *p;
+      if (ch == '"' || ch == '\\')
+        printf("\\%c", ch);
+      else if (ch < 0x20)
+        printf("\\u%04x", ch);
+      else
+        putchar(ch);
+    }
+    putchar('"');
+  }
+
+  /**
+   * Print a CSV field, quoted if necessary.
+   */
+  static void PrintCSVString(const char *p) {
+    if (strpbrk(p, ",\"\r\n") == NULL) {
+      fputs(p, stdout);
+      return;
+    }
+
+    putchar('"');
+    for (; *p != 0; ++p) {
+      if (*p == '"')
+        putchar('"');
+      putchar(*p);
+    }
+    putchar('"');
+  }
+
+  void Print(unsigned i) const {
+    const FlightResult &result = results[i];
+    const char *path = paths[i].c_str();
+
+    if (json) {
+      fputs("  {\"file\": ", stdout);
+      PrintJSONString(path);
+      printf(", \"valid\": %s, \"fixes\": %u",
+             result.valid ? "true" : "false", result.n_fixes);
+      if (result.valid)
+        for (unsigned j = 0; j < N_CONTESTS; ++j) {
+          const ContestResult &r = result.results[j];
+          printf(", \"%s\": {\"score\": %.2f, \"distance\": %.1f, "
+                 "\"speed\": %.2f, \"time\": %.0f}",
+                 contest_names[j], (double)r.score, (double)r.distance,
+                 (double)r.speed, (double)r.time);
+        }
+      printf("}%s\n", i + 1 < results.size() ? "," : "");
+    } else {
+      PrintCSVString(path);
+      printf(",%u", result.n_fixes);
+      for (unsigned j = 0; j < N_CONTESTS; ++j) {
+        const ContestResult &r = result.results[j];
+        if (result.valid)
+          printf(",%.2f,%.1f,%.2f,%.0f",
+                 (double)r.score, (double)r.distance,
+                 (double)r.speed, (double)r.time);
+        else
+          printf(",,,,");
+      }
+      putchar('\n');
+    }
+  }
+};
+
+class BatchWorker : public Thread {
+  BatchAnalysis &analysis;
+
+public:
+  BatchWorker(BatchAnalysis &_analysis):analysis(_analysis) {}
+
+protected:
+  virtual void Run() {
+    analysis.Work();
+  }
+};
+
+class IGCCollector : public File::Visitor {
+  std::vector<std::string> &paths;
+
+public:
+  IGCCollector(std::vector<std::string> &_paths):paths(_paths) {}
+
+  virtual void Visit(const TCHAR *path, const TCHAR *filename) {
+    paths.push_back(path);
+  }
+};
+
+static unsigned
+GetDefaultThreadCount()
+{
+#ifdef HAVE_POSIX
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n > 0)
+    return n;
+#endif
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "[--json] [-j THREADS] FILE.igc|DIR ...\n\n"
+            "Calculates the OLC Classic, League, FAI, Sprint and Plus scores\n"
+            "of each flight.  No other flight statistics are calculated.");
+
+  bool json = false;
+  unsigned n_threads = GetDefaultThreadCount();
+  std::vector<std::string> paths;
+
+  while (!args.IsEmpty()) {
+    const char *arg = args.GetNext();
+    if (strcmp(arg, "--json") == 0)
+      json = true;
+    else if (strcmp(arg, "-j") == 0) {
+      n_threads = atoi(args.ExpectNext());
+      if (n_threads == 0)
+        n_threads = 1;
+    } else if (Directory::Exists(arg)) {
+      IGCCollector collector(paths);
+      Directory::VisitSpecificFiles(arg, "*.igc", collector, true);
+    } else
+      paths.push_back(arg);
+  }
+
+  if (paths.empty()) {
+    fprintf(stderr, "No flights\n");
+    return EXIT_FAILURE;
+  }
+
+  if (n_threads > paths.size())
+    n_threads = paths.size();
+
+  BatchAnalysis analysis(paths, json);
+  analysis.BeginOutput();
+
+  const unsigned start_time = MonotonicClockMS();
+
+  /* the main thread is worker number one */
+  std::vector<BatchWorker *> workers;
+  for (unsigned i = 1; i < n_threads; ++i) {
+    BatchWorker *worker = new BatchWorker(analysis);
+    if (!worker->Start()) {
+      delete worker;
+      break;
+    }
+
+    workers.push_back(worker);
+  }
+
+  analysis.Work();
+
+  for (auto i = workers.begin(), end = workers.end(); i != end; ++i) {
+    (*i)->Join();
+    delete *i;
+  }
+
+  const unsigned duration_ms = MonotonicClockMS() - start_time;
+
+  analysis.EndOutput();
+
+  fprintf(stderr, "%u flights on %u threads in %.2f s (%.2f flights/s)\n",
+          (unsigned)paths.size(), (unsigned)workers.size() + 1,
+          duration_ms / 1000.,
+          duration_ms > 0 ? paths.size() * 1000. / duration_ms : 0.);
+
+  return EXIT_SUCCESS;
+}
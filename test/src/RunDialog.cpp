@@ -33,6 +33,7 @@ Copyright_License {
 #include "OS/PathName.hpp"
 #include "OS/FileUtil.hpp"
 #include "Look/DialogLook.hpp"
+#include "OS/Clock.hpp"
 
 #include <tchar.h>
 #include <stdio.h>
@@ -77,7 +78,7 @@ WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
 #endif
 
   if (argc < 2) {
-    fprintf(stderr, "Usage: RunDialog XMLFILE [-portrait]\n");
+    fprintf(stderr, "Usage: RunDialog RESOURCE [-portrait]\n");
     return 1;
   }
 
@@ -102,6 +103,7 @@ WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
                          Fonts::map_bold, Fonts::map_bold);
   SetXMLDialogLook(dialog_look);
 
+  const uint64_t start_us = MonotonicClockUS();
   WndForm *form = LoadDialog(NULL, main_window, argv[1]);
   if (form == NULL) {
     fprintf(stderr, "Failed to load resource '%s'\n",
@@ -109,6 +111,9 @@ WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     return 1;
   }
 
+  printf("Loaded '%s' in %u us\n", (const char *)NarrowPathName(argv[1]),
+         (unsigned)(MonotonicClockUS() - start_us));
+
   form->ShowModal();
   delete form;
 
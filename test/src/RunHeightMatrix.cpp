@@ -23,6 +23,9 @@ Copyright_License {
 
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/HeightMatrix.hpp"
+#include "Terrain/RasterRenderer.hpp"
+#include "Screen/Ramp.hpp"
+#include "OS/Clock.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Screen/Layout.hpp"
 #include "OS/PathName.hpp"
@@ -34,6 +37,68 @@ Copyright_License {
 
 unsigned Layout::scale_1024 = 1024;
 
+static const ColorRamp color_ramp[NUM_COLOR_RAMP_LEVELS] = {
+  {0,           0x70, 0xc0, 0xa7},
+  {250,         0xca, 0xe7, 0xb9},
+  {500,         0xf4, 0xea, 0xaf},
+  {750,         0xdc, 0xb2, 0x82},
+  {1000,        0xca, 0x8e, 0x72},
+  {1250,        0xde, 0xc8, 0xbd},
+  {1500,        0xe3, 0xe4, 0xe9},
+  {1750,        0xdb, 0xd9, 0xef},
+  {2000,        0xce, 0xcd, 0xf5},
+  {2250,        0xc2, 0xc1, 0xfa},
+  {2500,        0xb7, 0xb9, 0xff},
+  {5000,        0xb7, 0xb9, 0xff},
+  {6000,        0xb7, 0xb9, 0xff}
+};
+
+/**
+ * Render the terrain at the given map size a few times, and print
+ * the average duration of each step.
+ */
+static void
+BenchmarkRenderer(const RasterMap &map, unsigned width, unsigned height)
+{
+  static const unsigned ITERATIONS = 10;
+  static const unsigned height_scale = 4;
+
+  WindowProjection projection;
+  projection.SetScreenSize(width, height);
+  projection.SetScaleFromRadius(fixed(50000));
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(width / 2, height / 2);
+  projection.UpdateScreenBounds();
+
+  RasterRenderer renderer;
+  renderer.ColorTable(color_ramp, true, height_scale, 2);
+
+  const Angle sun_azimuth = Angle::Degrees(fixed(-45));
+
+  uint64_t scan = 0, shaded = 0, unshaded = 0;
+
+  for (unsigned i = 0; i < ITERATIONS; ++i) {
+    uint64_t t0 = MonotonicClockUS();
+    renderer.ScanMap(map, projection);
+    uint64_t t1 = MonotonicClockUS();
+    renderer.GenerateImage(true, height_scale, 150, 36, sun_azimuth);
+    uint64_t t2 = MonotonicClockUS();
+    renderer.GenerateImage(false, height_scale, 150, 36, sun_azimuth);
+    uint64_t t3 = MonotonicClockUS();
+
+    scan += t1 - t0;
+    shaded += t2 - t1;
+    unshaded += t3 - t2;
+  }
+
+  printf("%ux%u (%ux%u cells): "
+         "scan %.2f ms, shaded %.2f ms, unshaded %.2f ms\n",
+         width, height, renderer.get_width(), renderer.get_height(),
+         scan / (ITERATIONS * 1000.),
+         shaded / (ITERATIONS * 1000.),
+         unshaded / (ITERATIONS * 1000.));
+}
+
 int main(int argc, char **argv)
 {
   if (argc != 2) {
@@ -73,5 +138,8 @@ int main(int argc, char **argv)
   HeightMatrix matrix;
   matrix.Fill(map, projection, 1, false);
 
+  BenchmarkRenderer(map, 1920, 1080);
+  BenchmarkRenderer(map, 3840, 2160);
+
   return EXIT_SUCCESS;
 }
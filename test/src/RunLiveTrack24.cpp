@@ -22,20 +22,75 @@ Copyright_License {
 */
 
 #include "Tracking/LiveTrack24.hpp"
+#include "Tracking/TrackingQueue.hpp"
 #include "Net/Init.hpp"
+#include "Net/Session.hpp"
 #include "DateTime.hpp"
 #include "Units/System.hpp"
+#include "PeriodClock.hpp"
+#include "OS/PathName.hpp"
+#include "OS/Sleep.h"
 #include "Args.hpp"
 #include "DebugReplay.hpp"
 
 #include <cstdio>
+#include <string.h>
 
 using namespace LiveTrack24;
 
+/** the number of fixes submitted per batch, as in #TrackingGlue */
+static const unsigned BATCH_SIZE = 16;
+
+/**
+ * The duration of one simulated timer tick [ms] while backing off
+ * after a failure.
+ */
+static const unsigned TICK = 250;
+
+static const unsigned MAX_RETRY_TICKS = 32;
+
+/**
+ * Submits the oldest fixes of the queue over the given session.
+ *
+ * @return the number of fixes which were delivered
+ */
+static unsigned
+SendBatch(Net::Session &net_session, SessionID session, unsigned &packet_id,
+          TrackingQueue &queue)
+{
+  const unsigned n = std::min(queue.GetSize(), BATCH_SIZE);
+  const uint32_t serial = queue.GetHeadSerial();
+
+  unsigned sent = 0;
+  while (sent < n) {
+    const TrackingQueue::Fix &fix = queue[sent];
+    if (!SendPosition(net_session, session, packet_id, fix.location,
+                      fix.altitude, fix.ground_speed, fix.track, fix.time))
+      break;
+
+    ++packet_id;
+    ++sent;
+  }
+
+  queue.Remove(serial + sent);
+  return sent;
+}
+
 static bool
 TestTracking(int argc, char *argv[])
 {
-  Args args(argc, argv, "[DRIVER] FILE [USERNAME [PASSWORD]]");
+  Args args(argc, argv,
+            "[--server=HOST[:PORT]] [DRIVER] FILE [USERNAME [PASSWORD]]");
+
+  const char *server_arg = args.PeekNext();
+  if (server_arg != NULL && strncmp(server_arg, "--server=", 9) == 0) {
+    args.GetNext();
+
+    /* LiveTrack24::SetServer() does not copy the string */
+    static PathName server(server_arg + 9);
+    SetServer(server);
+  }
+
   DebugReplay *replay = CreateDebugReplay(args);
   if (replay == NULL)
     return false;
@@ -64,35 +119,118 @@ TestTracking(int argc, char *argv[])
   bool result = StartTracking(session, username.c_str(), password.c_str(), 10,
                               VehicleType::GLIDER, _T("Hornet"));
   printf(result ? "done\n" : "failed\n");
-  if (!result)
+  if (!result) {
+    delete replay;
     return false;
+  }
 
   BrokenDate now = BrokenDateTime::NowUTC();
 
-  printf("Sending positions ");
+  Net::Session net_session;
+  if (net_session.Error()) {
+    delete replay;
+    return false;
+  }
+
+  static TrackingQueue queue;
+
   unsigned package_id = 2;
-  while (replay->Next()) {
-    if (package_id % 10 == 0) {
-      putchar('.');
-      fflush(stdout);
+  unsigned pushed = 0, delivered = 0, failures = 0, max_backlog = 0;
+  unsigned outages = 0, send_time = 0, recovery_time = 0;
+  unsigned retry_ticks = 0, wait_ticks = 0;
+  bool recovering = false;
+  PeriodClock recovery_clock;
+
+  /* each iteration is one timer tick of TrackingGlue: a new fix
+     arrives, and a batch is submitted unless we're backing off */
+  printf("Sending positions ");
+  bool more = true;
+  while (more || !queue.IsEmpty()) {
+    if (more && (more = replay->Next())) {
+      const MoreData &basic = replay->Basic();
+
+      const BrokenTime time = basic.date_time_utc;
+      BrokenDateTime datetime(now.year, now.month, now.day, time.hour,
+                              time.minute, time.second);
+
+      TrackingQueue::Fix fix;
+      fix.time = datetime.ToUnixTimeUTC();
+      fix.location = basic.location;
+      fix.altitude = (unsigned)basic.nav_altitude;
+      fix.ground_speed =
+        (unsigned)Units::ToUserUnit(basic.ground_speed, unKiloMeterPerHour);
+      fix.track = basic.track;
+      queue.Push(fix);
+      ++pushed;
     }
-    const MoreData &basic = replay->Basic();
 
-    const BrokenTime time = basic.date_time_utc;
-    BrokenDateTime datetime(now.year, now.month, now.day, time.hour,
-                            time.minute, time.second);
+    if (queue.GetSize() > max_backlog)
+      max_backlog = queue.GetSize();
 
-    result = SendPosition(
-        session, package_id, basic.location, (unsigned)basic.nav_altitude,
-        (unsigned)Units::ToUserUnit(basic.ground_speed, unKiloMeterPerHour),
-        basic.track, datetime.ToUnixTimeUTC());
+    if (wait_ticks > 0) {
+      /* backing off after a failure */
+      --wait_ticks;
+      Sleep(TICK);
+      continue;
+    }
 
-    if (!result)
-      break;
+    if (queue.IsEmpty())
+      continue;
+
+    PeriodClock clock;
+    clock.update();
+    const unsigned n = std::min(queue.GetSize(), BATCH_SIZE);
+    const unsigned sent = SendBatch(net_session, session, package_id, queue);
+    send_time += clock.elapsed();
+    delivered += sent;
+
+    if (sent < n) {
+      if (retry_ticks == 0) {
+        ++outages;
+        putchar('!');
+        fflush(stdout);
+      }
+
+      ++failures;
+      retry_ticks = retry_ticks == 0
+        ? 1
+        : std::min(retry_ticks * 2, MAX_RETRY_TICKS);
+      wait_ticks = retry_ticks;
+      recovering = false;
+      continue;
+    }
+
+    if (retry_ticks > 0) {
+      /* the first successful batch after an outage */
+      retry_ticks = 0;
+      recovering = true;
+      recovery_clock = clock;
+    }
 
-    package_id++;
+    if (recovering && queue.GetSize() <= 1) {
+      recovering = false;
+      recovery_time += recovery_clock.elapsed();
+    }
+
+    if (delivered % 10 < sent) {
+      putchar('.');
+      fflush(stdout);
+    }
   }
-  printf(result ? "done\n" : "failed\n");
+  printf(" done\n");
+
+  delete replay;
+
+  printf("Delivered %u of %u fixes, %u dropped\n",
+         delivered, pushed, pushed - delivered - queue.GetSize());
+  if (send_time > 0)
+    printf("Throughput: %u fixes/s (%u ms sending)\n",
+           delivered * 1000 / send_time, send_time);
+  printf("Failed requests: %u in %u outage(s), max backlog %u fixes\n",
+         failures, outages, max_backlog);
+  if (outages > 0)
+    printf("Backlog recovery: %u ms total, %u ms average\n",
+           recovery_time, recovery_time / outages);
 
   printf("Stopping tracking ... ");
   result = EndTracking(session, package_id);
@@ -100,7 +238,6 @@ TestTracking(int argc, char *argv[])
 
   return true;
 }
-
 int
 main(int argc, char *argv[])
 {
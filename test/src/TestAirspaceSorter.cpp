@@ -0,0 +1,211 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Airspace/AirspaceSorter.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdlib.h>
+
+static const TCHAR *const fixed_names[] = {
+  _T(""), _T("A"), _T("a"), _T("Alpha"), _T("alpha 1"), _T("ALPHA 2"),
+  _T("Alpine"), _T("alps"), _T("B"), _T("Beta"), _T("beta"), _T("BETA X"),
+  _T("Zulu"), _T("zz top"), _T("\xc3\x84rm"), _T("\xc3\xa4rm"),
+  _T("1st"), _T("{brace}"), _T("~tilde"),
+};
+
+static const unsigned N_RANDOM = 500;
+
+static const TCHAR name_chars[] = _T("AaBbLlPpZz 1-");
+
+static GeoPoint
+RandomLocation()
+{
+  return GeoPoint(Angle::Degrees(fixed(7 + (rand() % 2000) / 1000.)),
+                  Angle::Degrees(fixed(51 + (rand() % 2000) / 1000.)));
+}
+
+static void
+FillAirspaces(Airspaces &airspaces)
+{
+  srand(42);
+
+  const unsigned n_fixed = ARRAY_SIZE(fixed_names);
+  for (unsigned i = 0; i < n_fixed + N_RANDOM; ++i) {
+    tstring name;
+    if (i < n_fixed)
+      name = fixed_names[i];
+    else
+      for (unsigned length = rand() % 7; length > 0; --length)
+        name += name_chars[rand() % (ARRAY_SIZE(name_chars) - 1)];
+
+    const GeoPoint center = RandomLocation();
+
+    AbstractAirspace *airspace;
+    if (i % 3 == 0) {
+      std::vector<GeoPoint> points;
+      points.push_back(center);
+      points.push_back(GeoPoint(center.longitude + Angle::Degrees(fixed(0.05)),
+                                center.latitude));
+      points.push_back(GeoPoint(center.longitude,
+                                center.latitude + Angle::Degrees(fixed(0.03))));
+      airspace = new AirspacePolygon(points);
+    } else
+      airspace = new AirspaceCircle(center, fixed(500 + rand() % 5000));
+
+    airspace->SetProperties(name, OTHER, AirspaceAltitude(),
+                            AirspaceAltitude());
+    airspaces.insert(airspace);
+  }
+
+  airspaces.optimise();
+}
+
+struct AirspacePointerLess {
+  bool operator()(const AirspaceSelectInfo &a,
+                  const AirspaceSelectInfo &b) const {
+    return a.airspace < b.airspace;
+  }
+};
+
+struct AirspaceDistanceLess {
+  bool operator()(const AirspaceSelectInfo &a,
+                  const AirspaceSelectInfo &b) const {
+    return a.Distance < b.Distance;
+  }
+};
+
+/**
+ * Do both lists contain the same airspaces?
+ */
+static bool
+SameAirspaces(AirspaceSelectInfoVector a, AirspaceSelectInfoVector b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  std::sort(a.begin(), a.end(), AirspacePointerLess());
+  std::sort(b.begin(), b.end(), AirspacePointerLess());
+
+  for (unsigned i = 0; i < a.size(); ++i)
+    if (a[i].airspace != b[i].airspace)
+      return false;
+
+  return true;
+}
+
+static bool
+CheckRange(const AirspaceSorter &sorter, fixed distance)
+{
+  AirspaceSelectInfoVector found;
+  sorter.FindWithinRange(found, distance);
+
+  AirspaceSelectInfoVector expected = sorter.get_list();
+  sorter.filter_distance(expected, distance);
+
+  return SameAirspaces(found, expected) &&
+    std::is_sorted(found.begin(), found.end(), AirspaceDistanceLess());
+}
+
+/**
+ * Compare FindWithinRange() with a brute-force filter, at distances
+ * which are exactly on an airspace and just below.
+ */
+static void
+TestRange(const AirspaceSorter &sorter)
+{
+  std::vector<fixed> distances;
+  const AirspaceSelectInfoVector &list = sorter.get_list();
+  for (auto i = list.begin(), end = list.end(); i != end; ++i)
+    distances.push_back(i->Distance);
+
+  std::sort(distances.begin(), distances.end());
+
+  const unsigned n = distances.size();
+  const unsigned indices[] = { 0, 1, n / 10, n / 2, n - 1 };
+  for (unsigned i = 0; i < ARRAY_SIZE(indices); ++i) {
+    const unsigned k = indices[i];
+    const fixed edge = distances[k];
+    const fixed below = k > 0
+      ? (distances[k - 1] + edge) / 2
+      : edge / 2;
+
+    ok1(CheckRange(sorter, edge));
+    ok1(CheckRange(sorter, below));
+  }
+}
+
+static const TCHAR *const prefixes[] = {
+  _T(""), _T("a"), _T("A"), _T("aL"), _T("ALP"), _T("alPh"),
+  _T("Alpha"), _T("ALPHA "), _T("b"), _T("bEtA"), _T("z"), _T("ZZ T"),
+  _T("\xc3\x84"), _T("1"), _T("~"), _T("no such name"),
+};
+
+/**
+ * Compare FindNamePrefix() with a brute-force filter.
+ */
+static void
+TestNamePrefix(const AirspaceSorter &sorter)
+{
+  for (unsigned i = 0; i < ARRAY_SIZE(prefixes); ++i) {
+    AirspaceSelectInfoVector found;
+    sorter.FindNamePrefix(found, prefixes[i]);
+
+    AirspaceSelectInfoVector expected = sorter.get_list();
+    sorter.FilterNamePrefix(expected, prefixes[i]);
+
+    ok1(SameAirspaces(found, expected));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * 10 + ARRAY_SIZE(prefixes));
+
+  Airspaces airspaces;
+  FillAirspaces(airspaces);
+
+  /* distances in km */
+  AirspaceSorter sorter(airspaces, GeoPoint(Angle::Degrees(fixed(8)),
+                                            Angle::Degrees(fixed(52))),
+                        fixed(0.001));
+  sorter.UpdateMetrics();
+  TestRange(sorter);
+
+  /* near the edge of the area, after the aircraft has moved */
+  sorter.SetLocation(GeoPoint(Angle::Degrees(fixed(7.1)),
+                              Angle::Degrees(fixed(51.2))));
+  sorter.UpdateMetrics();
+  TestRange(sorter);
+
+  TestNamePrefix(sorter);
+
+  return exit_status();
+}
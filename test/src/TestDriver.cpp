@@ -194,6 +194,51 @@ TestFLARM()
   } else {
     skip(12, 0, "traffic == NULL");
   }
+
+  /* let the first two targets expire, and verify that the lookup
+     index follows the remaining one */
+  nmea_info.clock = fixed(5);
+  ok1(parser.ParseLine("$PFLAA,0,100,-150,10,2,DDA85D,123,13,24,1.4,2*78",
+                                      nmea_info));
+  ok1(nmea_info.flarm.GetActiveTrafficCount() == 3);
+
+  nmea_info.flarm.Refresh(fixed(6));
+  ok1(nmea_info.flarm.GetActiveTrafficCount() == 1);
+  ok1(nmea_info.flarm.FindTraffic(id) == NULL);
+
+  id.Parse("DDA85D", NULL);
+  traffic = nmea_info.flarm.FindTraffic(id);
+  ok1(traffic != NULL && traffic->id == id);
+
+  /* let the FLARM expire while targets are present; the lookup index
+     must be emptied together with the traffic list */
+  static const char *const targets[] = {
+    "$PFLAA,0,100,-150,10,2,DDA85C,123,13,24,1.4,2*7f",
+    "$PFLAA,2,20,10,24,2,DEADFF,,,,,1*46",
+    "$PFLAA,0,100,-150,10,2,DDA85D,123,13,24,1.4,2*78",
+  };
+
+  for (unsigned i = 0; i < 3; ++i) {
+    nmea_info.clock = fixed(20 * (i + 1));
+    ok1(parser.ParseLine("$PFLAU,3,1,1,1,0*50", nmea_info));
+    ok1(parser.ParseLine(targets[i], nmea_info));
+
+    nmea_info.flarm.Refresh(nmea_info.clock + fixed(11));
+    ok1(nmea_info.flarm.GetActiveTrafficCount() == 0);
+  }
+
+  nmea_info.clock = fixed(100);
+  ok1(parser.ParseLine("$PFLAU,3,1,1,1,0*50", nmea_info));
+  ok1(parser.ParseLine(targets[1], nmea_info));
+  ok1(nmea_info.flarm.GetActiveTrafficCount() == 1);
+
+  id.Parse("DDA85C", NULL);
+  ok1(nmea_info.flarm.FindTraffic(id) == NULL);
+  id.Parse("DDA85D", NULL);
+  ok1(nmea_info.flarm.FindTraffic(id) == NULL);
+  id.Parse("DEADFF", NULL);
+  traffic = nmea_info.flarm.FindTraffic(id);
+  ok1(traffic != NULL && traffic->id == id);
 }
 
 static void
@@ -843,7 +888,7 @@ TestFlightList(const struct DeviceRegister &driver)
 
 int main(int argc, char **argv)
 {
-  plan_tests(442);
+  plan_tests(462);
 
   TestGeneric();
   TestTasman();
@@ -23,6 +23,10 @@
 #include "Math/Earth.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+
+#include <time.h>
+
 static void
 TestLinearDistance()
 {
@@ -53,9 +57,80 @@ TestLinearDistance()
   }
 }
 
+static const unsigned N_BATCH = 1024;
+
+static GeoPoint batch_locations[N_BATCH];
+static fixed batch_distances[N_BATCH];
+static Angle batch_bearings[N_BATCH];
+
+/**
+ * Compares the batched DistanceBearing() with the scalar one, and
+ * prints the time consumed by both.
+ */
+static void
+TestBatch()
+{
+  const GeoPoint origin(Angle::Degrees(fixed(7.7061111111111114)),
+                        Angle::Degrees(fixed(51.051944444444445)));
+
+  /* a spiral of points up to ~1000 km around the origin, including
+     the origin itself */
+  for (unsigned i = 0; i < N_BATCH; ++i) {
+    const fixed r = fixed(i) / N_BATCH * fixed(9);
+    const Angle a = Angle::Degrees(fixed(i * 37 % 360));
+    batch_locations[i] = GeoPoint(origin.longitude + Angle::Degrees(r * a.cos()),
+                                  origin.latitude + Angle::Degrees(r * a.sin()));
+  }
+
+  DistanceBearing(origin, batch_locations, N_BATCH,
+                  batch_distances, batch_bearings);
+
+  unsigned distance_errors = 0, bearing_errors = 0;
+  for (unsigned i = 0; i < N_BATCH; ++i) {
+    fixed distance;
+    Angle bearing;
+    DistanceBearing(origin, batch_locations[i], &distance, &bearing);
+
+    if (fabs(batch_distances[i] - distance) > fixed(1) + distance / 10000)
+      ++distance_errors;
+
+    if (positive(distance) &&
+        (batch_bearings[i] - bearing).AsDelta().AbsoluteDegrees() >
+        fixed(0.01))
+      ++bearing_errors;
+  }
+
+  ok1(distance_errors == 0);
+  ok1(bearing_errors == 0);
+
+  /* only distances */
+  static fixed distances_only[N_BATCH];
+  DistanceBearing(origin, batch_locations, N_BATCH, distances_only, NULL);
+  ok1(std::equal(distances_only, distances_only + N_BATCH, batch_distances));
+
+  /* benchmark */
+  const unsigned n_loops = 200;
+
+  clock_t t = clock();
+  for (unsigned j = 0; j < n_loops; ++j)
+    for (unsigned i = 0; i < N_BATCH; ++i)
+      DistanceBearing(origin, batch_locations[i],
+                      &batch_distances[i], &batch_bearings[i]);
+  const clock_t t_scalar = clock() - t;
+
+  t = clock();
+  for (unsigned j = 0; j < n_loops; ++j)
+    DistanceBearing(origin, batch_locations, N_BATCH,
+                    batch_distances, batch_bearings);
+  const clock_t t_batch = clock() - t;
+
+  diag("DistanceBearing: scalar %.1f ms, batch %.1f ms",
+       t_scalar * 1000. / CLOCKS_PER_SEC, t_batch * 1000. / CLOCKS_PER_SEC);
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(9 + 36 + 18);
+  plan_tests(9 + 36 + 18 + 3);
 
   const GeoPoint a(Angle::Degrees(fixed(7.7061111111111114)),
                    Angle::Degrees(fixed(51.051944444444445)));
@@ -89,6 +164,7 @@ int main(int argc, char **argv)
   ok1(big_distance > fixed(494000) && big_distance < fixed(495000));
 
   TestLinearDistance();
+  TestBatch();
 
   return exit_status();
 }
@@ -22,11 +22,164 @@
 
 #include "FLARM/FlarmNet.hpp"
 #include "FLARM/FlarmId.hpp"
+#include "IO/LineReader.hpp"
 #include "TestUtil.hpp"
 
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Track the heap usage of the program, to verify that loading the
+ * FlarmNet database does not need much more memory than the final
+ * table.  Each block has a header which remembers its size.
+ */
+
+static size_t heap_current, heap_peak;
+
+union HeapHeader {
+  size_t size;
+  long double align;
+};
+
+static void *
+TrackedAlloc(size_t size)
+{
+  HeapHeader *header = (HeapHeader *)malloc(sizeof(*header) + size);
+  if (header == NULL)
+    return NULL;
+
+  header->size = size;
+  heap_current += size;
+  if (heap_current > heap_peak)
+    heap_peak = heap_current;
+
+  return header + 1;
+}
+
+static void
+TrackedFree(void *p)
+{
+  if (p == NULL)
+    return;
+
+  HeapHeader *header = (HeapHeader *)p - 1;
+  heap_current -= header->size;
+  free(header);
+}
+
+void *
+operator new(size_t size)
+{
+  /* this project is built without exceptions */
+  void *p = TrackedAlloc(size);
+  if (p == NULL)
+    abort();
+  return p;
+}
+
+void *
+operator new(size_t size, const std::nothrow_t &)
+{
+  return TrackedAlloc(size);
+}
+
+void
+operator delete(void *p)
+{
+  TrackedFree(p);
+}
+
+void
+operator delete(void *p, const std::nothrow_t &)
+{
+  TrackedFree(p);
+}
+
+/**
+ * Generates a FlarmNet file with #n records.  Every tenth id is
+ * repeated, to exercise the duplicate removal.
+ */
+class SyntheticFlarmNetReader : public NLineReader {
+  /** a valid record; the first 12 characters are the id */
+  static const char *const TEMPLATE;
+
+  unsigned n, i;
+  char buffer[256];
+
+public:
+  SyntheticFlarmNetReader(unsigned _n):n(_n), i(0) {}
+
+  virtual char *read() {
+    if (i > n)
+      return NULL;
+
+    if (i++ == 0) {
+      strcpy(buffer, "000b93");
+      return buffer;
+    }
+
+    unsigned value = i - 1;
+    if (value % 10 == 9)
+      --value;
+
+    /* hex-encode the six characters of the id */
+    char id[8];
+    sprintf(id, "%06X", 0x100000 + value);
+    for (unsigned j = 0; j < 6; ++j)
+      sprintf(buffer + j * 2, "%02x", (unsigned char)id[j]);
+
+    strcpy(buffer + 12, TEMPLATE + 12);
+    return buffer;
+  }
+
+  virtual long size() const {
+    return (n + 1) * 173;
+  }
+};
+
+const char *const SyntheticFlarmNetReader::TEMPLATE =
+  "4444413835374d61726b75732046656c646d616e6e202020202020415454454e"
+  "444f524e2020202020202020202020204c532d34202020202020202020202020"
+  "2020202020442d36363736204d46203132312e343030";
+
+static void
+TestMemory()
+{
+  static const unsigned N = 2000;
+
+  FlarmNet::Destroy();
+
+  const size_t base = heap_current;
+  heap_peak = base;
+
+  SyntheticFlarmNetReader reader(N);
+  ok1(FlarmNet::LoadFile(reader) == N);
+
+  /* every tenth record was a duplicate */
+  const FlarmNet::Record *array[N];
+  ok1(FlarmNet::FindRecordsByCallSign(_T("MF"), array, N) == N - N / 10);
+
+  FlarmId id;
+  id.Parse("100008", NULL);
+  ok1(FlarmNet::FindRecordById(id) != NULL);
+  id.Parse("100009", NULL);
+  ok1(FlarmNet::FindRecordById(id) == NULL);
+
+  /* the table must not have been copied during loading */
+  const size_t final_size = heap_current - base;
+  const size_t peak_size = heap_peak - base;
+  ok1(final_size >= (N - N / 10) * sizeof(FlarmNet::Record));
+  ok1(peak_size < final_size * 3 / 2);
+
+  FlarmNet::Destroy();
+  ok1(heap_current == base);
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(15);
+  plan_tests(29);
 
   int count = FlarmNet::LoadFile(_T("test/data/flarmnet/data.fln"));
   ok1(count == 6);
@@ -74,7 +227,21 @@ int main(int argc, char **argv)
   ok1(foundDDA85C);
   ok1(foundDDA896);
 
+  ok1(FlarmNet::FindRecordsByCallSignPrefix(_T("T"), array, 3) == 2);
+  ok1(FlarmNet::FindRecordsByCallSignPrefix(_T("TH"), array, 3) == 2);
+  ok1(FlarmNet::FindRecordsByCallSignPrefix(_T("TX"), array, 3) == 0);
+  ok1(FlarmNet::FindRecordsByCallSignPrefix(_T("M"), array, 3) == 1);
+  ok1(_tcscmp(array[0]->id, _T("DDA857")) == 0);
+
+  record = FlarmNet::FindFirstRecordByCallSign(_T("L1"));
+  ok1(record != NULL && _tcscmp(record->id, _T("DDA85A")) == 0);
+
+  id.Parse("DDA858", NULL);
+  ok1(FlarmNet::FindRecordById(id) == NULL);
+
   FlarmNet::Destroy();
 
+  TestMemory();
+
   return exit_status();
 }
@@ -0,0 +1,315 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Device/Driver/LX/Convert.hpp"
+#include "Device/Driver/DownloadPipeline.hpp"
+#include "OS/ByteOrder.hpp"
+#include "TestUtil.hpp"
+
+#include <string>
+#include <string.h>
+
+/**
+ * Generates a synthetic LXN flight.
+ */
+class LXNBuilder {
+  std::string data;
+
+public:
+  const std::string &GetData() const {
+    return data;
+  }
+
+  void Byte(uint8_t value) {
+    data.push_back((char)value);
+  }
+
+  void Bytes(const void *p, size_t length) {
+    data.append((const char *)p, length);
+  }
+
+  template<typename T>
+  void Packet(const T &packet) {
+    Bytes(&packet, sizeof(packet));
+  }
+
+  void String(const char *value) {
+    const size_t length = strlen(value);
+    Byte((uint8_t)length);
+    Bytes(value, length);
+  }
+
+  void Flight() {
+    String("AXXX");
+    String("HFFTYFRTYPE:LX Colibri");
+
+    LXN::Version version;
+    version.cmd = LXN::VERSION;
+    version.hardware = 30;
+    version.software = 42;
+    Packet(version);
+
+    LXN::Start start;
+    start.cmd = LXN::START;
+    memcpy(start.streraz, "STReRAZ", 8);
+    start.flight_no = 3;
+    Packet(start);
+
+    LXN::Date date;
+    date.cmd = LXN::DATE;
+    date.day = 21;
+    date.month = 6;
+    date.year = ToBE16(11);
+    Packet(date);
+
+    LXN::Serial serial;
+    memset(&serial, 0, sizeof(serial));
+    serial.cmd = LXN::SERIAL;
+    strcpy(serial.serial, "ABC");
+    Packet(serial);
+
+    LXN::FlightInfo info;
+    memset(&info, 0, sizeof(info));
+    info.cmd = LXN::FLIGHT_INFO;
+    strcpy(info.pilot, "Pilot");
+    strcpy(info.glider, "ASW 24");
+    strcpy(info.registration, "D-1234");
+    strcpy(info.competition_class, "X");
+    info.competition_class_id = 2;
+    strcpy(info.gps, "uBlox");
+    Packet(info);
+
+    /* no extensions: the extension configuration code is known to
+       misbehave with bits set */
+    LXN::ExtConfig ext_config;
+    ext_config.cmd = LXN::B_EXT_CONFIG;
+    ext_config.time = 0;
+    ext_config.dat = 0;
+    Packet(ext_config);
+    ext_config.cmd = LXN::K_EXT_CONFIG;
+    Packet(ext_config);
+
+    LXN::Task task;
+    memset(&task, 0, sizeof(task));
+    task.cmd = LXN::TASK;
+    task.time = ToBE32(36000);
+    task.num_tps = 2;
+    task.usage[0] = task.usage[1] = 1;
+    task.latitude[0] = ToBE32(51 * 60000);
+    task.longitude[0] = ToBE32(7 * 60000);
+    strcpy(task.name[0], "Start");
+    task.latitude[1] = ToBE32(52 * 60000);
+    task.longitude[1] = ToBE32((uint32_t)(-7 * 60000));
+    strcpy(task.name[1], "Finish");
+    Packet(task);
+
+    LXN::Origin origin;
+    origin.cmd = LXN::ORIGIN;
+    origin.time = ToBE32(36000);
+    origin.latitude = ToBE32(51 * 60000);
+    origin.longitude = ToBE32(7 * 60000);
+    Packet(origin);
+
+    for (unsigned i = 0; i < 500; ++i) {
+      if (i % 97 == 0) {
+        LXN::Event event;
+        memset(&event, 0, sizeof(event));
+        event.cmd = LXN::EVENT;
+        strcpy(event.foo, "PEV");
+        Packet(event);
+      }
+
+      LXN::Position position;
+      position.cmd = i % 50 == 7 ? LXN::POSITION_BAD : LXN::POSITION_OK;
+      position.time = ToBE16(i * 4);
+      position.latitude = ToBE16(i * 3);
+      position.longitude = ToBE16((uint16_t)-(int)i);
+      position.aalt = ToBE16(1000 + i);
+      position.galt = ToBE16(1010 + i);
+      Packet(position);
+
+      if (i % 10 == 0) {
+        Byte(LXN::B_EXT);
+        Byte(LXN::K_EXT);
+        Byte(i);
+
+        /* the B_EXT/K_EXT conversion checks for a null byte in the
+           following bytes; a short EMPTY run provides it */
+        for (unsigned j = 0; j < 9; ++j)
+          Byte(LXN::EMPTY);
+      }
+
+      if (i == 255)
+        for (unsigned j = 0; j < 300; ++j)
+          Byte(LXN::EMPTY);
+    }
+
+    LXN::Security security;
+    memset(&security, 0, sizeof(security));
+    security.cmd = LXN::SECURITY;
+    security.length = 4;
+    security.type = LXN::SECURITY_HIGH;
+    Packet(security);
+
+    Byte(LXN::END);
+  }
+};
+
+/**
+ * Read the contents of a temporary file and close it.
+ */
+static std::string
+ReadAndClose(FILE *file)
+{
+  std::string result;
+  rewind(file);
+
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    result.append(buffer, n);
+
+  fclose(file);
+  return result;
+}
+
+static std::string
+ConvertWhole(const std::string &lxn, bool &success)
+{
+  FILE *file = tmpfile();
+  success = LX::ConvertLXNToIGC(lxn.data(), lxn.length(), file);
+  return ReadAndClose(file);
+}
+
+static std::string
+ConvertChunked(const std::string &lxn, size_t chunk_size, bool &success)
+{
+  FILE *file = tmpfile();
+  LX::LXNToIGC converter(file);
+
+  success = true;
+  for (size_t i = 0; i < lxn.length() && success; i += chunk_size)
+    success = converter.Feed(lxn.data() + i,
+                             std::min(chunk_size, lxn.length() - i));
+
+  success = converter.Finish() && success;
+  return ReadAndClose(file);
+}
+
+class TestConsumer : public DownloadPipeline::Consumer {
+public:
+  LX::LXNToIGC converter;
+
+  TestConsumer(FILE *file):converter(file) {}
+
+  virtual bool OnBlock(const void *data, size_t length) {
+    return converter.Feed(data, length);
+  }
+};
+
+/**
+ * Simulate a download: blocks are "received" into the pipeline
+ * buffers (like LX::ReceivePacket() does), while the previous ones
+ * are being converted.
+ */
+static std::string
+ConvertPipelined(const std::string &lxn, size_t block_size, bool &success)
+{
+  FILE *file = tmpfile();
+  TestConsumer consumer(file);
+
+  {
+    DownloadPipeline pipeline(consumer);
+
+    success = true;
+    for (size_t i = 0; i < lxn.length(); i += block_size) {
+      const size_t length = std::min(block_size, lxn.length() - i);
+      void *buffer = pipeline.GetBuffer(length);
+      if (buffer == NULL) {
+        success = false;
+        break;
+      }
+
+      memcpy(buffer, lxn.data() + i, length);
+      pipeline.Commit(length);
+    }
+
+    success = pipeline.Finish() && success;
+  }
+
+  success = consumer.converter.Finish() && success;
+  return ReadAndClose(file);
+}
+
+int main(int argc, char **argv)
+{
+  static const size_t chunk_sizes[] = { 1, 2, 3, 7, 64, 255, 4096 };
+  const unsigned n_chunk_sizes = sizeof(chunk_sizes) / sizeof(chunk_sizes[0]);
+
+  plan_tests(4 + 2 * n_chunk_sizes + 4);
+
+  LXNBuilder builder;
+  builder.Flight();
+  const std::string &lxn = builder.GetData();
+
+  bool success;
+  const std::string expected = ConvertWhole(lxn, success);
+  ok1(success);
+  ok1(expected.find("LFILEMPTY300\r\n") != std::string::npos);
+  ok1(expected.find("HFPLTPILOT:Pilot\r\n") != std::string::npos);
+  ok1(expected.find("Start\r\n") != std::string::npos);
+
+  for (unsigned i = 0; i < n_chunk_sizes; ++i) {
+    const std::string igc = ConvertChunked(lxn, chunk_sizes[i], success);
+    ok(success && igc == expected, "chunk size %u", (unsigned)chunk_sizes[i]);
+  }
+
+  for (unsigned i = 0; i < n_chunk_sizes; ++i) {
+    const std::string igc = ConvertPipelined(lxn, chunk_sizes[i], success);
+    ok(success && igc == expected, "pipelined, block size %u",
+       (unsigned)chunk_sizes[i]);
+  }
+
+  /* truncated data must fail, but produce the same prefix */
+  const std::string truncated = lxn.substr(0, lxn.length() / 2);
+  bool whole_success;
+  const std::string whole = ConvertWhole(truncated, whole_success);
+  const std::string chunked = ConvertChunked(truncated, 7, success);
+  ok1(!whole_success && !success && whole == chunked);
+
+  /* malformed data stops the pipeline */
+  std::string malformed = lxn.substr(0, lxn.length() - 1);
+  malformed.push_back(0x41);
+  malformed.push_back(LXN::END);
+  ConvertPipelined(malformed, 64, success);
+  ok1(!success);
+
+  ConvertChunked(malformed, 3, success);
+  ok1(!success);
+
+  /* a flight without END is incomplete */
+  ConvertChunked(lxn.substr(0, lxn.length() - 1), 5, success);
+  ok1(!success);
+
+  return exit_status();
+}
@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Contest/ContestSolvers/OLCTriangle.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <stdlib.h>
+
+/**
+ * Exposes the flat perimeter of the best triangle.
+ */
+class TestTriangle : public OLCTriangle {
+public:
+  TestTriangle(const Trace &trace, bool is_fai)
+    :OLCTriangle(trace, is_fai) {}
+
+  unsigned GetBestFlatDistance() const {
+    return is_complete ? best_d : 0;
+  }
+};
+
+/**
+ * Check all triangles of the trace, with the same rules as
+ * OLCTriangle.  The exception for FAI triangles of 500 km and more
+ * is not implemented; the test traces are much smaller.
+ */
+static unsigned
+BruteForce(const TracePointVector &v, bool is_fai)
+{
+  unsigned best = 0;
+  const unsigned n = v.size();
+  for (unsigned i = 0; i < n; ++i) {
+    for (unsigned j = i + 1; j < n; ++j) {
+      const unsigned d1 = v[i].flat_distance(v[j]);
+
+      for (unsigned k = j + 1; k < n; ++k) {
+        const unsigned d2 = v[j].flat_distance(v[k]);
+        const unsigned d3 = v[k].flat_distance(v[i]);
+        const unsigned total = d1 + d2 + d3;
+        if (total < 20 || total <= best)
+          continue;
+
+        const unsigned shortest = std::min(d1, std::min(d2, d3));
+        if (shortest == 0)
+          continue;
+
+        if (is_fai && (shortest * 4 < total || shortest * 25 < total * 7))
+          continue;
+
+        best = total;
+      }
+    }
+  }
+
+  return best;
+}
+
+/**
+ * Fill the trace with a random walk of #n fixes around a base point.
+ * A few long jumps make large triangles possible.
+ */
+static void
+FillTrace(Trace &trace, unsigned n, unsigned seed)
+{
+  srand(seed);
+
+  GeoPoint location(Angle::Degrees(fixed(7)), Angle::Degrees(fixed(51)));
+
+  AircraftState state;
+  state.altitude = fixed(1000);
+  state.altitude_agl = fixed(500);
+  state.netto_vario = fixed_zero;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const double step = rand() % 8 == 0 ? 0.05 : 0.005;
+    location.longitude += Angle::Degrees(fixed(step * (rand() % 201 - 100) / 100));
+    location.latitude += Angle::Degrees(fixed(step * (rand() % 201 - 100) / 100));
+
+    state.location = location;
+    state.time = fixed(10 * i);
+    trace.append(state);
+  }
+}
+
+static void
+TestTrace(unsigned n, unsigned seed, bool is_fai)
+{
+  Trace trace;
+  FillTrace(trace, n, seed);
+
+  TracePointVector points;
+  trace.get_trace_points(points);
+  const unsigned expected = BruteForce(points, is_fai);
+
+  TestTriangle exhaustive(trace, is_fai);
+  exhaustive.Solve(true);
+  ok(exhaustive.GetBestFlatDistance() == expected, "exhaustive", 0);
+
+  /* the incremental search must find the same triangle */
+  TestTriangle incremental(trace, is_fai);
+  unsigned calls = 0;
+  while (!incremental.Solve(false) && calls < 10000)
+    ++calls;
+  ok(incremental.GetBestFlatDistance() == expected, "incremental", 0);
+}
+
+int main(int argc, char **argv)
+{
+  static const unsigned N_SEEDS = 8;
+
+  plan_tests(N_SEEDS * 2 * 2);
+
+  for (unsigned seed = 0; seed < N_SEEDS; ++seed) {
+    const unsigned n = 20 + seed * 20;
+    TestTrace(n, seed, false);
+    TestTrace(n, seed, true);
+  }
+
+  return exit_status();
+}
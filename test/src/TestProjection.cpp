@@ -23,6 +23,9 @@
 #include "Projection/Projection.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <stdlib.h>
+
 static void
 TestGeoScreenCouple(const Projection prj, const GeoPoint geo,
                     long x, long y)
@@ -45,12 +48,88 @@ test_simple()
                                     Angle::Degrees(fixed_zero)), 0, 0);
 }
 
+/**
+ * Moves the screen points of #cached to a projection which was panned
+ * by #pan pixels to the east, using the screen offset of the old
+ * GeoLocation (like TrailRenderer's projection cache), and compares
+ * them with a fresh projection.
+ */
+static void
+TestTranslation(const Projection &cached, int pan, bool reusable)
+{
+  const RasterPoint origin = cached.GetScreenOrigin();
+
+  Projection current = cached;
+  current.SetGeoLocation(cached.ScreenToGeo(origin.x + pan, origin.y));
+
+  const GeoPoint &reference = cached.GetGeoLocation();
+  const RasterPoint reference_pt = current.GeoToScreen(reference);
+  const int offset_x = reference_pt.x - origin.x;
+  const int offset_y = reference_pt.y - origin.y;
+
+  /* four times the screen size, like the cache bounds */
+  Angle south = reference.latitude, north = reference.latitude;
+  unsigned max_deviation = 0;
+  for (int y = -720; y <= 1200; y += 40) {
+    for (int x = -720; x <= 1200; x += 40) {
+      const GeoPoint g = cached.ScreenToGeo(x, y);
+      south = std::min(south, g.latitude);
+      north = std::max(north, g.latitude);
+
+      RasterPoint translated = cached.GeoToScreen(g);
+      translated.x += offset_x;
+      translated.y += offset_y;
+
+      const RasterPoint fresh = current.GeoToScreen(g);
+      max_deviation = std::max(max_deviation,
+                               (unsigned)std::max(abs(translated.x - fresh.x),
+                                                  abs(translated.y - fresh.y)));
+    }
+  }
+
+  const Angle shift =
+    Angle::Radians((current.GetGeoLocation().longitude -
+                    reference.longitude).AsDelta().AbsoluteRadians());
+  const fixed error = cached.GetTranslationError(shift, south, north);
+
+  ok1((error <= fixed_one) == reusable);
+
+  /* the estimate must hold, except for integer rounding */
+  ok1(max_deviation <= error + 2);
+
+  if (reusable)
+    ok1(max_deviation <= 3);
+  else
+    /* a translated cache would be visibly off here */
+    ok1(max_deviation > 3);
+}
+
+static void
+TestTranslation()
+{
+  /* 200 km across a 480 pixel screen, at 65 degrees north */
+  Projection prj;
+  prj.SetScale(fixed(480) / 200000);
+  prj.SetScreenOrigin(240, 240);
+  prj.SetGeoLocation(GeoPoint(Angle::Degrees(fixed(10)),
+                              Angle::Degrees(fixed(65))));
+
+  for (unsigned i = 0; i < 2; ++i) {
+    prj.SetScreenAngle(Angle::Degrees(fixed(i * 30)));
+
+    TestTranslation(prj, 2, true);
+    /* still inside of the cache bounds */
+    TestTranslation(prj, 600, false);
+  }
+}
+
 int
 main(int argc, char **argv)
 {
-  plan_tests(4);
+  plan_tests(4 + 2 * 6);
 
   test_simple();
+  TestTranslation();
 
   return exit_status();
 }
@@ -0,0 +1,247 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterTile.hpp"
+#include "Terrain/RasterLocation.hpp"
+#include "TestUtil.hpp"
+
+#include <stdlib.h>
+#include <math.h>
+
+static const unsigned WIDTH = 1024, HEIGHT = 1024, TILE_SIZE = 256;
+
+/**
+ * Synthetic terrain: rolling hills with a lake and a hole without
+ * data.
+ */
+static short
+SyntheticHeight(unsigned x, unsigned y, bool detail)
+{
+  if (x >= 600 && x < 700 && y >= 200 && y < 260)
+    return RasterBuffer::TERRAIN_WATER_THRESHOLD - 1;
+
+  if (x >= 100 && x < 140 && y >= 800 && y < 900)
+    return RasterBuffer::TERRAIN_INVALID;
+
+  int h = 800 + (int)(600 * sin(x / 97.) * cos(y / 131.));
+  if (detail)
+    h += (int)((x * 7 + y * 13) % 200);
+
+  return (short)std::max(h, 0);
+}
+
+/**
+ * Exposes the protected parts needed to set up a #RasterTileCache
+ * without a JPEG2000 file.
+ */
+class TestTileCache : public RasterTileCache {
+public:
+  bool Setup() {
+    SetSize(WIDTH, HEIGHT, TILE_SIZE, TILE_SIZE,
+            WIDTH / TILE_SIZE, HEIGHT / TILE_SIZE);
+    SetLatLonBounds(7, 8, 51, 52);
+
+    for (unsigned i = 0; i < 4; ++i)
+      segments.append(MarkerSegmentInfo(i));
+
+    for (unsigned row = 0; row < HEIGHT / TILE_SIZE; ++row)
+      for (unsigned column = 0; column < WIDTH / TILE_SIZE; ++column)
+        SetTile(row * (WIDTH / TILE_SIZE) + column,
+                column * TILE_SIZE, row * TILE_SIZE,
+                (column + 1) * TILE_SIZE, (row + 1) * TILE_SIZE);
+
+    short *overview = GetOverview();
+    const unsigned overview_width = WIDTH >> 4;
+    for (unsigned y = 0; y < (HEIGHT >> 4); ++y)
+      for (unsigned x = 0; x < overview_width; ++x)
+        overview[y * overview_width + x] =
+          SyntheticHeight(x << 4, y << 4, false);
+
+    SetInitialised(true);
+
+    /* round-trip through the cache file, which builds the pyramid */
+    FILE *file = tmpfile();
+    if (file == NULL)
+      return false;
+
+    bool success = SaveCache(file);
+    rewind(file);
+    success = success && LoadCache(file);
+    fclose(file);
+    return success;
+  }
+
+  void LoadTile(unsigned index) {
+    RasterTile &tile = tiles.GetLinear(index);
+    tile.set_request();
+    short *data = GetImageBuffer(index);
+    for (unsigned y = 0; y < tile.height; ++y)
+      for (unsigned x = 0; x < tile.width; ++x)
+        data[y * tile.width + x] =
+          SyntheticHeight(tile.xstart + x, tile.ystart + y, true);
+
+    pyramid.Merge(tile.buffer, tile.xstart, tile.ystart);
+  }
+
+  void DisableTile(unsigned index) {
+    tiles.GetLinear(index).Disable();
+  }
+
+  void DisablePyramid() {
+    pyramid.Reset();
+  }
+};
+
+static TestTileCache cache, reference;
+
+struct Query {
+  int x0, y0, x1, y1;
+  short h_origin, h_dest;
+  int slope_fact;
+  short h_ceiling, h_safety;
+  bool can_climb;
+};
+
+static Query
+RandomQuery()
+{
+  Query q;
+  q.x0 = rand() % WIDTH;
+  q.y0 = rand() % HEIGHT;
+  q.x1 = rand() % WIDTH;
+  q.y1 = rand() % HEIGHT;
+  q.h_origin = rand() % 3000;
+  q.h_dest = q.h_origin + rand() % 1000;
+  q.slope_fact = 50 + rand() % 400;
+  q.h_ceiling = 2000 + rand() % 3000;
+  q.h_safety = rand() % 3 == 0 ? -50 : rand() % 200;
+  q.can_climb = rand() % 2 == 0;
+  return q;
+}
+
+/**
+ * Run random intersection queries on both caches and count the
+ * differences.
+ */
+static unsigned
+CompareQueries(unsigned n)
+{
+  unsigned differences = 0;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const Query q = RandomQuery();
+
+    unsigned ax = 0, ay = 0, bx = 0, by = 0;
+    short ah = 0, bh = 0;
+    const bool a = cache.FirstIntersection(q.x0, q.y0, q.x1, q.y1,
+                                           q.h_origin, q.h_dest,
+                                           q.slope_fact, q.h_ceiling,
+                                           q.h_safety, ax, ay, ah,
+                                           q.can_climb);
+    const bool b = reference.FirstIntersection(q.x0, q.y0, q.x1, q.y1,
+                                               q.h_origin, q.h_dest,
+                                               q.slope_fact, q.h_ceiling,
+                                               q.h_safety, bx, by, bh,
+                                               q.can_climb);
+    if (a != b || (a && (ax != bx || ay != by || ah != bh)))
+      ++differences;
+
+    const RasterLocation c = cache.Intersection(q.x0, q.y0, q.x1, q.y1,
+                                                q.h_origin, q.slope_fact);
+    const RasterLocation d = reference.Intersection(q.x0, q.y0, q.x1, q.y1,
+                                                    q.h_origin,
+                                                    q.slope_fact);
+    if (c.x != d.x || c.y != d.y)
+      ++differences;
+  }
+
+  return differences;
+}
+
+/**
+ * Compare RasterTileCache::GetHeights() with GetHeight() at random
+ * pixels, some of them out of range.
+ */
+static unsigned
+CompareBatchHeights(unsigned n)
+{
+  RasterLocation pixels[200];
+  short heights[200];
+
+  unsigned differences = 0;
+  for (unsigned i = 0; i < n; ++i) {
+    for (unsigned j = 0; j < 200; ++j)
+      pixels[j] = RasterLocation(rand() % (WIDTH + 64),
+                                 rand() % (HEIGHT + 64));
+
+    cache.GetHeights(pixels, heights, 200);
+
+    for (unsigned j = 0; j < 200; ++j)
+      if (heights[j] != cache.GetHeight(pixels[j].x, pixels[j].y))
+        ++differences;
+  }
+
+  return differences;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(8);
+
+  ok1(cache.Setup());
+  ok1(reference.Setup());
+  reference.DisablePyramid();
+
+  srand(42);
+
+  /* overview only */
+  ok1(CompareQueries(2000) == 0);
+
+  /* with detailed tiles, some of them higher than the overview */
+  for (unsigned i = 0; i < 16; i += 3) {
+    cache.LoadTile(i);
+    reference.LoadTile(i);
+  }
+
+  ok1(CompareQueries(2000) == 0);
+
+  /* discarded tiles leave conservative bounds behind */
+  cache.DisableTile(3);
+  reference.DisableTile(3);
+  ok1(CompareQueries(2000) == 0);
+
+  /* batched height lookups, on both loaded and discarded tiles */
+  ok1(CompareBatchHeights(50) == 0);
+
+  const RasterTileCache::IntersectionStatistics &with =
+    cache.GetIntersectionStatistics();
+  const RasterTileCache::IntersectionStatistics &without =
+    reference.GetIntersectionStatistics();
+  ok1(without.skipped == 0);
+  ok1(with.lookups < without.lookups);
+
+  printf("# terrain lookups: %u with pyramid (%u skipped), %u without\n",
+         with.lookups, with.skipped, without.lookups);
+
+  return exit_status();
+}
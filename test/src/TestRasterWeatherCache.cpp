@@ -0,0 +1,174 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterWeatherCache.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Operation/Operation.hpp"
+#include "Thread/Trigger.hpp"
+#include "TestUtil.hpp"
+
+typedef RasterWeatherCache::Key Key;
+
+static RasterMap *
+NewMap()
+{
+  NullOperationEnvironment operation;
+  return new RasterMap(_T("/nonexistent/rasp.jp2"), NULL, NULL, operation);
+}
+
+static unsigned num_loads;
+static Trigger load_started(false);
+static Trigger *block_load;
+
+static RasterMap *
+LoadTestMap(unsigned parameter, unsigned time_index,
+            OperationEnvironment &operation)
+{
+  ++num_loads;
+  load_started.Signal();
+
+  if (block_load != NULL)
+    block_load->Wait();
+
+  return NewMap();
+}
+
+static void
+TestPutTake()
+{
+  RasterWeatherCache cache(LoadTestMap);
+  const Key key(1, 2, 100);
+
+  ok1(cache.Take(key) == NULL);
+
+  RasterMap *map = NewMap();
+  cache.Put(key, map);
+
+  /* a map from another version of the RASP file */
+  ok1(cache.Take(Key(1, 2, 101)) == NULL);
+  ok1(cache.Take(Key(1, 3, 100)) == NULL);
+
+  ok1(cache.Take(key) == map);
+  ok1(cache.Take(key) == NULL);
+
+  delete map;
+}
+
+static void
+TestTrim()
+{
+  RasterMap *map = NewMap();
+  const size_t size = map->GetMemoryUsage();
+  delete map;
+
+  RasterWeatherCache cache(LoadTestMap, size * 2);
+
+  RasterMap *map1 = NewMap(), *map2 = NewMap(), *map3 = NewMap();
+  cache.Put(Key(1, 1, 0), map1);
+  cache.Put(Key(1, 2, 0), map2);
+
+  /* use the first one, so the second one is the least recently used */
+  ok1(cache.Take(Key(1, 1, 0)) == map1);
+  cache.Put(Key(1, 1, 0), map1);
+
+  cache.Put(Key(1, 3, 0), map3);
+  ok1(cache.Take(Key(1, 2, 0)) == NULL);
+  ok1(cache.Take(Key(1, 1, 0)) == map1);
+  cache.Put(Key(1, 1, 0), map1);
+
+  cache.SetBudget(size);
+  ok1(cache.Take(Key(1, 3, 0)) == NULL);
+  ok1(cache.Take(Key(1, 1, 0)) == map1);
+
+  delete map1;
+}
+
+static void
+TestPrefetch()
+{
+  RasterWeatherCache cache(LoadTestMap);
+  const Key keys[2] = { Key(1, 3, 7), Key(1, 4, 7) };
+
+  num_loads = 0;
+  cache.Prefetch(keys, 2, GeoPoint::Invalid(), fixed_zero);
+  cache.WaitPrefetch();
+  ok1(num_loads == 2);
+
+  RasterMap *map = cache.Take(keys[0]);
+  ok1(map != NULL);
+
+  /* cached maps are not loaded again */
+  cache.Prefetch(keys, 2, GeoPoint::Invalid(), fixed_zero);
+  cache.WaitPrefetch();
+  ok1(num_loads == 3);
+
+  ok1(cache.Take(keys[1]) != NULL);
+  delete map;
+  map = cache.Take(keys[0]);
+  ok1(map != NULL);
+  delete map;
+
+  cache.Clear();
+}
+
+static void
+TestTakeQueued()
+{
+  RasterWeatherCache cache(LoadTestMap);
+  const Key keys[2] = { Key(1, 5, 0), Key(1, 6, 0) };
+
+  Trigger block;
+  block_load = &block;
+  num_loads = 0;
+  load_started.Reset();
+
+  cache.Prefetch(keys, 2, GeoPoint::Invalid(), fixed_zero);
+
+  /* the thread is now loading the first map; taking the second one
+     must not wait for it */
+  load_started.Wait();
+  ok1(cache.Take(keys[1]) == NULL);
+
+  block.Signal();
+  RasterMap *map = cache.Take(keys[0]);
+  ok1(map != NULL);
+  delete map;
+
+  cache.WaitPrefetch();
+  ok1(num_loads == 1);
+
+  block_load = NULL;
+  cache.Clear();
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(5 + 5 + 5 + 3);
+
+  TestPutTake();
+  TestTrim();
+  TestPrefetch();
+  TestTakeQueued();
+
+  return exit_status();
+}
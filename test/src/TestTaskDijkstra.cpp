@@ -0,0 +1,249 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/TaskEvents.hpp"
+#include "Engine/Task/OrderedTaskBehaviour.hpp"
+#include "Engine/Task/Tasks/OrderedTask.hpp"
+#include "Engine/Task/Tasks/PathSolvers/TaskDijkstra.hpp"
+#include "Engine/Task/TaskPoints/StartPoint.hpp"
+#include "Engine/Task/TaskPoints/ASTPoint.hpp"
+#include "Engine/Task/TaskPoints/AATPoint.hpp"
+#include "Engine/Task/TaskPoints/FinishPoint.hpp"
+#include "Engine/Task/ObservationZones/CylinderZone.hpp"
+#include "Engine/Task/ObservationZones/FAISectorZone.hpp"
+#include "Engine/Task/ObservationZones/LineSectorZone.hpp"
+#include "Engine/Task/ObservationZones/SectorZone.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+
+static TaskEvents task_events;
+static TaskBehaviour task_behaviour;
+static OrderedTaskBehaviour ordered_task_behaviour;
+static GlidePolar glide_polar(fixed_zero);
+
+/**
+ * Exposes the search of #TaskDijkstra, and compares it with an
+ * exhaustive enumeration of all paths which follows the same rules.
+ */
+class TestDijkstra : public TaskDijkstra {
+  SearchPoint result[MAX_STAGES];
+
+public:
+  TestDijkstra(OrderedTask &task, bool is_min)
+    :TaskDijkstra(task, is_min) {}
+
+  bool Solve(const SearchPoint *location) {
+    return refresh_task() && run(location);
+  }
+
+  /**
+   * Returns the flat distance of the saved path.
+   */
+  unsigned GetSolutionValue(const SearchPoint *location) const {
+    unsigned first_stage = 0, value = 0;
+    if (location != NULL && active_stage > 0) {
+      first_stage = active_stage;
+      value = result[first_stage].flat_distance(*location);
+    }
+
+    for (unsigned stage = first_stage + 1; stage < num_stages; ++stage)
+      value += result[stage - 1].flat_distance(result[stage]);
+
+    return value;
+  }
+
+  /**
+   * Returns the flat distance of the best path, found by trying all
+   * of them.
+   */
+  unsigned BruteForce(const SearchPoint *location, bool is_min) const {
+    unsigned best = is_min ? (unsigned)-1 : 0;
+
+    if (location != NULL && active_stage > 0) {
+      const SearchPointVector &first = GetStagePoints(active_stage);
+      for (auto i = first.begin(), end = first.end(); i != end; ++i)
+        Search(active_stage + 1, *i, i->flat_distance(*location),
+               is_min, best);
+    } else
+      Search(1, GetStagePoints(0)[0], 0, is_min, best);
+
+    return best;
+  }
+
+protected:
+  virtual void save() {
+    std::copy(solution, solution + num_stages, result);
+  }
+
+private:
+  void Search(unsigned stage, const SearchPoint &previous, unsigned value,
+              bool is_min, unsigned &best) const {
+    if (stage == num_stages) {
+      if (is_min ? value < best : value > best)
+        best = value;
+      return;
+    }
+
+    const SearchPointVector &points = GetStagePoints(stage);
+    for (auto i = points.begin(), end = points.end(); i != end; ++i)
+      Search(stage + 1, *i, value + previous.flat_distance(*i),
+             is_min, best);
+  }
+};
+
+static GeoPoint
+MakeGeoPoint(double longitude, double latitude)
+{
+  return GeoPoint(Angle::Degrees(fixed(longitude)),
+                  Angle::Degrees(fixed(latitude)));
+}
+
+static Waypoint
+MakeWaypoint(double longitude, double latitude)
+{
+  Waypoint wp(MakeGeoPoint(longitude, latitude));
+  wp.altitude = fixed(300);
+  return wp;
+}
+
+static void
+TestTask(OrderedTask &task)
+{
+  ok1(task.CheckTask());
+
+  static const GeoPoint aircraft_locations[] = {
+    MakeGeoPoint(7.1, 51.2),
+    MakeGeoPoint(7.6, 51.05),
+  };
+
+  for (unsigned k = 0; k < 2; ++k) {
+    const bool is_min = k == 0;
+    TestDijkstra dijkstra(task, is_min);
+
+    /* from the start point */
+    task.SetActiveTaskPoint(0);
+    ok1(dijkstra.Solve(NULL) &&
+        dijkstra.GetSolutionValue(NULL) == dijkstra.BruteForce(NULL, is_min));
+
+    /* from the aircraft, with the active task point after the start */
+    for (unsigned active = 1; active <= 2; ++active) {
+      task.SetActiveTaskPoint(active);
+
+      bool equal = true;
+      for (unsigned i = 0; i < ARRAY_SIZE(aircraft_locations); ++i) {
+        const SearchPoint location(aircraft_locations[i],
+                                   task.GetTaskProjection());
+        equal = equal && dijkstra.Solve(&location) &&
+          dijkstra.GetSolutionValue(&location) ==
+          dijkstra.BruteForce(&location, is_min);
+      }
+
+      ok1(equal);
+    }
+  }
+}
+
+static void
+TestCylinders()
+{
+  OrderedTask task(task_events, task_behaviour, glide_polar, true);
+
+  const Waypoint wp1 = MakeWaypoint(7, 51);
+  const Waypoint wp2 = MakeWaypoint(7.5, 51.4);
+  const Waypoint wp3 = MakeWaypoint(8, 51);
+  const Waypoint wp4 = MakeWaypoint(7.1, 50.9);
+
+  task.Append(StartPoint(new CylinderZone(wp1.location, fixed(1000)), wp1,
+                         task_behaviour, ordered_task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp2.location, fixed(30000)), wp2,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp3.location, fixed(40000)), wp3,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(FinishPoint(new CylinderZone(wp4.location, fixed(1000)), wp4,
+                          task_behaviour, ordered_task_behaviour));
+
+  TestTask(task);
+}
+
+static void
+TestSectors()
+{
+  OrderedTask task(task_events, task_behaviour, glide_polar, true);
+
+  const Waypoint wp1 = MakeWaypoint(7, 51);
+  const Waypoint wp2 = MakeWaypoint(7.3, 51.5);
+  const Waypoint wp3 = MakeWaypoint(8.1, 51.2);
+  const Waypoint wp4 = MakeWaypoint(7, 51);
+
+  task.Append(StartPoint(new LineSectorZone(wp1.location, fixed(5000)), wp1,
+                         task_behaviour, ordered_task_behaviour));
+  task.Append(ASTPoint(new FAISectorZone(wp2.location), wp2,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(AATPoint(new SectorZone(wp3.location, fixed(25000),
+                                      Angle::Degrees(fixed(200)),
+                                      Angle::Degrees(fixed(300))), wp3,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(FinishPoint(new CylinderZone(wp4.location, fixed(3000)), wp4,
+                          task_behaviour, ordered_task_behaviour));
+
+  TestTask(task);
+}
+
+static void
+TestOverlapping()
+{
+  OrderedTask task(task_events, task_behaviour, glide_polar, true);
+
+  const Waypoint wp1 = MakeWaypoint(7, 51);
+  const Waypoint wp2 = MakeWaypoint(7.2, 51.1);
+  const Waypoint wp3 = MakeWaypoint(7.4, 51);
+  const Waypoint wp4 = MakeWaypoint(7.3, 50.8);
+  const Waypoint wp5 = MakeWaypoint(7.05, 50.95);
+
+  task.Append(StartPoint(new CylinderZone(wp1.location, fixed(2000)), wp1,
+                         task_behaviour, ordered_task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp2.location, fixed(15000)), wp2,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp3.location, fixed(20000)), wp3,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(AATPoint(new CylinderZone(wp4.location, fixed(10000)), wp4,
+                       task_behaviour, ordered_task_behaviour));
+  task.Append(FinishPoint(new CylinderZone(wp5.location, fixed(2000)), wp5,
+                          task_behaviour, ordered_task_behaviour));
+
+  TestTask(task);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(3 * 7);
+
+  TestCylinders();
+  TestSectors();
+  TestOverlapping();
+
+  return exit_status();
+}
@@ -0,0 +1,182 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Task/TaskIndex.hpp"
+#include "OS/FileUtil.hpp"
+#include "Thread/Flag.hpp"
+#include "TestUtil.hpp"
+
+#include <stdio.h>
+
+static const TCHAR *const index_path = _T("output/TestTaskIndex.idx");
+static const TCHAR *const path_a = _T("output/TestTaskIndex-a.tsk");
+static const TCHAR *const path_b = _T("output/TestTaskIndex-b.tsk");
+static const TCHAR *const path_c = _T("output/TestTaskIndex-c.tsk");
+
+static void
+WriteFile(const TCHAR *path, const char *contents)
+{
+  FILE *file = _tfopen(path, _T("wb"));
+  if (file == NULL)
+    return;
+
+  fputs(contents, file);
+  fclose(file);
+}
+
+/**
+ * Pretends that each file contains as many tasks as it has bytes,
+ * except for files starting with 'x', which are invalid.
+ */
+class FakeReader : public TaskIndex::Reader {
+public:
+  unsigned num_read;
+
+  FakeReader():num_read(0) {}
+
+  virtual bool Read(const TCHAR *path, TaskIndex::FileEntry &entry) {
+    ++num_read;
+
+    FILE *file = _tfopen(path, _T("rb"));
+    if (file == NULL)
+      return false;
+
+    int ch = fgetc(file);
+    fclose(file);
+    if (ch == EOF || ch == 'x')
+      return false;
+
+    for (unsigned i = 0; i < entry.size; ++i) {
+      TaskIndex::Task task;
+      task.suffix = i == 0 ? tstring() : tstring(_T("second"));
+      task.summary.valid = true;
+      task.summary.has_targets = i > 0;
+      task.summary.factory_type = 2;
+      task.summary.num_points = 3 + i;
+      task.summary.distance_nominal = fixed(100000 + i);
+      task.summary.distance_min = fixed(90000);
+      task.summary.distance_max = fixed(110000);
+      entry.tasks.push_back(task);
+    }
+
+    return true;
+  }
+};
+
+gcc_pure
+static const TaskIndex::FileEntry *
+Find(const TaskIndex &index, const TCHAR *path)
+{
+  for (TaskIndex::const_iterator i = index.begin(), e = index.end();
+       i != e; ++i)
+    if (i->path == path)
+      return &*i;
+
+  return NULL;
+}
+
+static std::vector<tstring>
+MakePaths(const TCHAR *a, const TCHAR *b=NULL, const TCHAR *c=NULL)
+{
+  std::vector<tstring> paths;
+  paths.push_back(a);
+  if (b != NULL)
+    paths.push_back(b);
+  if (c != NULL)
+    paths.push_back(c);
+  return paths;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(22);
+
+  WriteFile(path_a, "a");
+  WriteFile(path_b, "bb");
+  WriteFile(path_c, "x");
+
+  TaskIndex index;
+  FakeReader reader;
+
+  /* initial scan; a missing file is skipped */
+  ok1(index.Update(MakePaths(path_b, path_a, _T("output/missing.tsk")),
+                   reader) == 2);
+  ok1(index.size() == 2);
+  ok1(index.begin()->path == path_a);
+
+  const TaskIndex::FileEntry *b = Find(index, path_b);
+  ok1(b != NULL && b->tasks.size() == 2);
+  ok1(b != NULL && b->tasks[1].suffix == _T("second") &&
+      b->tasks[1].summary.has_targets &&
+      b->tasks[1].summary.num_points == 4 &&
+      b->tasks[1].summary.distance_nominal == fixed(100001));
+
+  /* round trip */
+  ok1(index.Save(index_path));
+
+  TaskIndex loaded;
+  ok1(loaded.Load(index_path));
+  ok1(loaded.size() == 2);
+  b = Find(loaded, path_b);
+  ok1(b != NULL && b->tasks.size() == 2 &&
+      b->tasks[0].suffix.empty() && b->tasks[0].summary.valid &&
+      !b->tasks[0].summary.has_targets &&
+      b->tasks[0].summary.factory_type == 2 &&
+      b->tasks[0].summary.distance_min == fixed(90000) &&
+      b->tasks[0].summary.distance_max == fixed(110000));
+
+  /* nothing has changed: nothing is read */
+  reader.num_read = 0;
+  ok1(loaded.Update(MakePaths(path_a, path_b), reader) == 0);
+  ok1(reader.num_read == 0);
+  ok1(loaded.size() == 2);
+
+  /* a modified file is read again, a removed one disappears, and an
+     invalid one is remembered without tasks */
+  WriteFile(path_a, "aaa");
+  ok1(loaded.Update(MakePaths(path_a, path_c), reader) == 2);
+  ok1(loaded.size() == 2);
+  ok1(Find(loaded, path_b) == NULL);
+  ok1(Find(loaded, path_a) != NULL && Find(loaded, path_a)->tasks.size() == 3);
+  ok1(Find(loaded, path_c) != NULL && Find(loaded, path_c)->tasks.empty());
+
+  reader.num_read = 0;
+  ok1(loaded.Update(MakePaths(path_a, path_c), reader) == 0);
+
+  /* cancellation leaves the index alone */
+  Flag cancel(true);
+  ok1(loaded.Update(MakePaths(path_b), reader, &cancel) == -1);
+  ok1(loaded.size() == 2 && Find(loaded, path_b) == NULL);
+
+  /* garbage is rejected */
+  WriteFile(index_path, "garbage");
+  ok1(!loaded.Load(index_path));
+  ok1(loaded.size() == 0);
+
+  File::Delete(index_path);
+  File::Delete(path_a);
+  File::Delete(path_b);
+  File::Delete(path_c);
+
+  return exit_status();
+}
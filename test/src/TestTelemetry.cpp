@@ -0,0 +1,169 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Telemetry/Telemetry.hpp"
+#include "Thread/Thread.hpp"
+#include "TestUtil.hpp"
+
+#include <string.h>
+
+#ifdef HAVE_POSIX
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Writes snapshots whose fields all carry the same number, so a torn
+ * read can be detected.
+ */
+class FlightWriter : public Thread {
+  Telemetry::Section<Telemetry::Flight> &section;
+
+public:
+  static const unsigned N = 200000;
+
+  FlightWriter(Telemetry::Section<Telemetry::Flight> &_section)
+    :section(_section) {}
+
+protected:
+  virtual void Run() {
+    for (unsigned i = 1; i <= N; ++i) {
+      Telemetry::Flight &flight = Telemetry::BeginWrite(section);
+      flight.timestamp = i;
+      flight.flags = i;
+      flight.latitude = i;
+      flight.longitude = i;
+      flight.flarm_traffic = i;
+      Telemetry::EndWrite(section);
+    }
+  }
+};
+
+static bool
+IsConsistent(const Telemetry::Flight &flight)
+{
+  return flight.flags == flight.timestamp &&
+    flight.latitude == (double)flight.timestamp &&
+    flight.longitude == (double)flight.timestamp &&
+    flight.flarm_traffic == flight.timestamp;
+}
+
+int main(int argc, char **argv)
+{
+#ifdef HAVE_POSIX
+  plan_tests(18);
+#else
+  plan_tests(15);
+#endif
+
+  ok1(!Telemetry::IsEnabled());
+
+  /* disabled: must not crash */
+  {
+    ScopeTelemetryCycle cycle(Telemetry::MERGE_THREAD);
+  }
+
+  static Telemetry::Segment segment;
+  Telemetry::Attach(segment);
+  ok1(Telemetry::IsEnabled());
+  ok1(segment.magic == Telemetry::MAGIC);
+  ok1(segment.version == Telemetry::VERSION);
+  ok1(segment.size == sizeof(segment));
+  ok1(strcmp(segment.threads[Telemetry::DRAW_THREAD].data.name,
+             "DrawThread") == 0);
+
+  Telemetry::AddCycle(Telemetry::MERGE_THREAD, 1000, 30);
+  Telemetry::AddCycle(Telemetry::MERGE_THREAD, 2000, 10);
+
+  Telemetry::ThreadTiming timing;
+  ok1(Telemetry::TryRead(segment.threads[Telemetry::MERGE_THREAD], timing));
+  ok1(timing.cycles == 2 && timing.last_start == 2000 &&
+      timing.last_duration == 10 && timing.max_duration == 30 &&
+      timing.total_duration == 40);
+
+  {
+    ScopeTelemetryCycle cycle(Telemetry::CALCULATION_THREAD);
+  }
+  ok1(Telemetry::TryRead(segment.threads[Telemetry::CALCULATION_THREAD],
+                         timing));
+  ok1(timing.cycles == 1 && timing.last_start > 0);
+
+  /* a reader must not accept a section while it is being written */
+  Telemetry::BeginWrite(segment.flight);
+  Telemetry::Flight flight;
+  ok1(!Telemetry::TryRead(segment.flight, flight));
+  Telemetry::EndWrite(segment.flight);
+  ok1(Telemetry::TryRead(segment.flight, flight));
+
+  /* concurrent writer: every successful read is consistent */
+  FlightWriter writer(segment.flight);
+  writer.Start();
+
+  unsigned reads = 0, torn = 0;
+  do {
+    if (Telemetry::TryRead(segment.flight, flight)) {
+      ++reads;
+      if (!IsConsistent(flight))
+        ++torn;
+    }
+  } while (flight.timestamp < FlightWriter::N);
+
+  writer.Join();
+  ok1(reads > 0);
+  ok1(torn == 0);
+
+  Telemetry::Close();
+  ok1(!Telemetry::IsEnabled());
+
+#ifdef HAVE_POSIX
+  static const char name[] = "/xcsoar-test-telemetry";
+  ok1(Telemetry::Open(name));
+
+  Telemetry::AddCycle(Telemetry::DRAW_THREAD, 5, 6);
+
+  /* map it the way an external tool would */
+  bool mapped = false;
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd >= 0) {
+    void *p = mmap(NULL, sizeof(Telemetry::Segment), PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p != MAP_FAILED) {
+      const Telemetry::Segment &shared = *(const Telemetry::Segment *)p;
+      mapped = shared.magic == Telemetry::MAGIC &&
+        Telemetry::TryRead(shared.threads[Telemetry::DRAW_THREAD],
+                           timing) &&
+        timing.cycles == 1 && timing.last_duration == 6;
+      munmap(p, sizeof(Telemetry::Segment));
+    }
+  }
+
+  ok1(mapped);
+
+  Telemetry::Close();
+  ok1(shm_open(name, O_RDONLY, 0) < 0);
+#endif
+
+  return exit_status();
+}
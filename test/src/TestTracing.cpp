@@ -0,0 +1,100 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Tracing/Tracing.hpp"
+#include "TestUtil.hpp"
+
+#include <string>
+
+static std::string
+Export()
+{
+  FILE *file = tmpfile();
+  if (file == NULL)
+    return std::string();
+
+  Tracing::ExportChromeTrace(file);
+
+  std::string result;
+  rewind(file);
+  char buffer[4096];
+  size_t nbytes;
+  while ((nbytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    result.append(buffer, nbytes);
+
+  fclose(file);
+  return result;
+}
+
+static unsigned
+Count(const std::string &haystack, const char *needle)
+{
+  unsigned n = 0;
+  for (std::string::size_type i = haystack.find(needle);
+       i != std::string::npos; i = haystack.find(needle, i + 1))
+    ++n;
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(9);
+
+  ok1(!Tracing::IsEnabled());
+
+  {
+    TRACE_SPAN("disabled");
+  }
+  TRACE_COUNTER("disabled.counter", 1);
+  Tracing::SetThreadName("main");
+
+  std::string json = Export();
+  ok1(json.compare(0, 15, "{\"traceEvents\":") == 0);
+  ok1(Count(json, "disabled") == 0);
+  ok1(Count(json, "\"main\"") == 0);
+
+  Tracing::Enable();
+  ok1(Tracing::IsEnabled());
+
+  Tracing::SetThreadName("main");
+  {
+    TRACE_SPAN("outer");
+    TRACE_SPAN("inner");
+  }
+  TRACE_COUNTER("counter", 42);
+
+  json = Export();
+  ok1(Count(json, "\"name\":\"main\"") == 1);
+  ok1(Count(json, "\"ph\":\"X\"") == 2);
+  ok1(Count(json, "\"args\":{\"value\":42}") == 1);
+
+  /* overflow the ring; only the newest events survive, minus the
+     slot which a concurrent writer might be overwriting */
+  for (unsigned i = 0; i < Tracing::BUFFER_SIZE + 100; ++i)
+    Tracing::AddSpan("overflow", i, 1);
+
+  json = Export();
+  ok1(Count(json, "\"overflow\"") == Tracing::BUFFER_SIZE - 1);
+
+  return exit_status();
+}
@@ -0,0 +1,92 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2011 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Tracking/TrackingQueue.hpp"
+#include "OS/FileUtil.hpp"
+#include "TestUtil.hpp"
+
+static TrackingQueue::Fix
+MakeFix(int64_t time)
+{
+  TrackingQueue::Fix fix;
+  fix.time = time;
+  fix.location = GeoPoint(Angle::Degrees(fixed(7)),
+                          Angle::Degrees(fixed(51)));
+  fix.altitude = 1000;
+  fix.ground_speed = 100;
+  fix.track = Angle::Zero();
+  return fix;
+}
+
+static TrackingQueue queue, queue2;
+
+int main(int argc, char **argv)
+{
+  plan_tests(22);
+
+  ok1(queue.IsEmpty());
+
+  for (unsigned i = 0; i < 10; ++i)
+    queue.Push(MakeFix(i));
+
+  ok1(queue.GetSize() == 10);
+  ok1(queue.IsDirty());
+  ok1(queue.GetHeadSerial() == 0);
+  ok1(queue[0].time == 0);
+  ok1(queue[9].time == 9);
+
+  /* remove the first three fixes */
+  queue.Remove(3);
+  ok1(queue.GetSize() == 7);
+  ok1(queue.GetHeadSerial() == 3);
+  ok1(queue[0].time == 3);
+
+  /* overflow: the oldest fixes are dropped, and removing by serial
+     number does not touch fixes which were pushed later */
+  for (unsigned i = 10; i < TrackingQueue::MAX_SIZE + 5; ++i)
+    queue.Push(MakeFix(i));
+
+  ok1(queue.GetSize() == TrackingQueue::MAX_SIZE);
+  ok1(queue[0].time == 5);
+  queue.Remove(8);
+  ok1(queue[0].time == 8);
+  ok1(queue.GetSize() == TrackingQueue::MAX_SIZE - 3);
+
+  queue.Expire(100);
+  ok1(queue[0].time == 100);
+
+  /* spool to disk and back */
+  const TCHAR *path = _T("output/test/TestTrackingQueue.spool");
+  ok1(queue.Save(path));
+  ok1(!queue.IsDirty());
+  ok1(queue2.Load(path));
+  ok1(queue2.GetSize() == queue.GetSize());
+  ok1(queue2[0].time == 100);
+  ok1(queue2[queue2.GetSize() - 1].time ==
+      (int64_t)TrackingQueue::MAX_SIZE + 4);
+
+  File::Delete(path);
+  ok1(!queue2.Load(path));
+  ok1(queue2.IsEmpty());
+
+  return exit_status();
+}
@@ -0,0 +1,30 @@
+#!/usr/bin/perl
+#
+# Runs the specified benchmark programs and collects their results
+# (one JSON object per line) into one JSON document on stdout.
+#
+
+use warnings;
+use strict;
+
+my @results;
+my $failed = 0;
+
+foreach my $program (@ARGV) {
+    open(my $fh, '-|', $program) or die "Failed to run $program: $!\n";
+    while (my $line = <$fh>) {
+        chomp $line;
+        push @results, "    $line" if $line =~ /^\{.*\}$/;
+    }
+
+    unless (close($fh)) {
+        print STDERR "$program failed\n";
+        $failed = 1;
+    }
+}
+
+print "{\n  \"benchmarks\": [\n";
+print join(",\n", @results), "\n";
+print "  ]\n}\n";
+
+exit($failed);
@@ -28,8 +28,6 @@ Copyright_License {
 #include <stdio.h>
 #include <stdlib.h>
 
-static const long MAX_LXN_SIZE = 1024 * 1024;
-
 int
 main(int argc, char **argv)
 {
@@ -45,25 +43,25 @@ main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
-  long size;
-  if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) <= 0 ||
-      fseek(file, 0, SEEK_SET) != 0 || size > MAX_LXN_SIZE)  {
-    fprintf(stderr, "Failed to seek file %s\n", lxn_path);
-    fclose(file);
-    return EXIT_FAILURE;
+  /* convert block by block, just like the LX driver does while
+     downloading */
+  LX::LXNToIGC converter(stdout);
+
+  char buffer[4096];
+  size_t n;
+  while (!converter.IsDone() &&
+         (n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    if (!converter.Feed(buffer, n))
+      break;
   }
 
-  void *data = malloc(size);
-  size_t n = fread(data, 1, size, file);
+  const bool read_error = ferror(file);
   fclose(file);
-  if (n != (size_t)size) {
-    free(data);
+
+  if (read_error) {
     fprintf(stderr, "Failed to read from file %s\n", lxn_path);
     return EXIT_FAILURE;
   }
 
-  bool success = LX::ConvertLXNToIGC(data, n, stdout);
-  free(data);
-
-  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  return converter.Finish() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -118,6 +118,11 @@ int main(int argc, char** argv) {
   plan_tests(1);
   test_reach(map, fixed_zero, fixed(0.1));
 
+  const RasterTileCache::IntersectionStatistics &statistics =
+    map.GetIntersectionStatistics();
+  printf("# terrain lookups %u, skipped by max pyramid %u\n",
+         statistics.lookups, statistics.skipped);
+
   return exit_status();
 }
 
@@ -125,6 +125,11 @@ int main(int argc, char** argv) {
   test_troute(map, fixed_zero, fixed_zero, RoughAltitude(10000));
   test_troute(map, fixed(5.0), fixed_one, RoughAltitude(10000));
 
+  const RasterTileCache::IntersectionStatistics &statistics =
+    map.GetIntersectionStatistics();
+  printf("# terrain lookups %u, skipped by max pyramid %u\n",
+         statistics.lookups, statistics.skipped);
+
   return exit_status();
 }
 
@@ -26,7 +26,7 @@ while (<>) {
     if (/^\s*(\d+)\s+BITMAP\s+DISCARDABLE\s+"(.*?)"\s*$/) {
         push @numeric, $1;
         generate_blob("resource_$1", "Data/$2");
-    } elsif (/^\s*([.\w]+)\s+(?:TEXT|XMLDIALOG|MO|RASTERDATA)\s+DISCARDABLE\s+"(.*?)"\s*$/) {
+    } elsif (/^\s*([.\w]+)\s+(?:TEXT|MO|RASTERDATA)\s+DISCARDABLE\s+"(.*?)"\s*$/) {
         push @named, $1;
         my $path = $2;
         my $variable = "resource_$1";
@@ -0,0 +1,150 @@
+#!/usr/bin/perl -w
+#
+# Converts the XML dialogs listed in Data/Dialogs/index.txt to
+# constant DialogNode tables (see src/Dialogs/DialogNode.hpp), which
+# are compiled into XCSoar.  This saves inflating and parsing the XML
+# each time a dialog is opened.
+#
+
+use strict;
+use File::Basename;
+
+die "Usage: $0 index.txt\n" unless @ARGV == 1;
+
+my $index_path = $ARGV[0];
+my $directory = dirname($index_path);
+
+sub decode_entities($) {
+    my $value = shift;
+    $value =~ s/&#x([0-9a-fA-F]+);/chr(hex($1))/ge;
+    $value =~ s/&#(\d+);/chr($1)/ge;
+    $value =~ s/&lt;/</g;
+    $value =~ s/&gt;/>/g;
+    $value =~ s/&quot;/"/g;
+    $value =~ s/&apos;/'/g;
+    $value =~ s/&amp;/&/g;
+    return $value;
+}
+
+# Returns a C string literal, UTF-8 encoded.
+sub quote($) {
+    my $value = shift;
+    utf8::encode($value);
+    $value =~ s/\\/\\\\/g;
+    $value =~ s/"/\\"/g;
+    $value =~ s/\n/\\n/g;
+    $value =~ s/\r/\\r/g;
+    $value =~ s/\t/\\t/g;
+    $value =~ s/\?\?/?\\?/g;
+    return "_T(\"$value\")";
+}
+
+# Parses the XML file into a tree of hashes; returns the root element.
+sub parse_xml($) {
+    my $path = shift;
+
+    open FILE, "<$path" or die "Failed to open $path: $!\n";
+    local $/;
+    my $xml = <FILE>;
+    close FILE;
+
+    utf8::decode($xml);
+    $xml =~ s/<\?.*?\?>//gs;
+    $xml =~ s/<!--.*?-->//gs;
+
+    my $root;
+    my @stack;
+    while ($xml =~ /\G(?:\s+|<\/([\w:]+)\s*>|<([\w:]+)((?:\s+[\w:]+\s*=\s*(?:"[^"]*"|'[^']*'))*)\s*(\/?)>)/gc) {
+        if (defined $1) {
+            my $node = pop @stack;
+            die "$path: mismatched </$1>\n"
+                unless defined $node and $node->{name} eq $1;
+        } elsif (defined $2) {
+            my $node = { name => $2, attributes => [], children => [] };
+
+            my $attributes = $3;
+            while ($attributes =~ /([\w:]+)\s*=\s*(?:"([^"]*)"|'([^']*)')/g) {
+                push @{$node->{attributes}},
+                    [ $1, decode_entities(defined $2 ? $2 : $3) ];
+            }
+
+            if (@stack) {
+                push @{$stack[-1]->{children}}, $node;
+            } else {
+                die "$path: more than one root element\n" if defined $root;
+                $root = $node;
+            }
+
+            push @stack, $node unless $4;
+        }
+    }
+
+    die "$path: syntax error at offset " . pos($xml) . "\n"
+        if defined pos($xml) and pos($xml) < length($xml);
+    die "$path: unterminated element\n" if @stack;
+    die "$path: no root element\n" unless defined $root;
+
+    return $root;
+}
+
+my @dialogs;
+
+open INDEX, "<$index_path" or die "Failed to open $index_path: $!\n";
+while (<INDEX>) {
+    next if /^\s*(?:#.*)?$/;
+    die "$index_path: malformed line: $_" unless /^\s*(\w+)\s+(\S+)\s*$/;
+    push @dialogs, [ $1, parse_xml("$directory/$2") ];
+}
+close INDEX;
+
+# Flatten the trees; the children of each node are stored
+# contiguously, so they can be iterated with a pointer.
+
+my @nodes;
+my @attributes;
+
+my %roots;
+foreach my $dialog (@dialogs) {
+    my ($name, $root) = @$dialog;
+
+    $roots{$name} = scalar @nodes;
+    push @nodes, $root;
+
+    my @queue = ($root);
+    while (my $node = shift @queue) {
+        $node->{first_attribute} = scalar @attributes;
+        push @attributes, @{$node->{attributes}};
+
+        $node->{first_child} = scalar @nodes;
+        push @nodes, @{$node->{children}};
+        push @queue, @{$node->{children}};
+    }
+}
+
+print "/* generated by xml2cpp.pl - do not edit */\n\n";
+
+print "static const DialogNode::Attribute dialog_attributes[] = {\n";
+foreach my $attribute (@attributes) {
+    print "  { ", quote($attribute->[0]), ", ", quote($attribute->[1]), " },\n";
+}
+print "};\n\n";
+
+print "static const DialogNode dialog_nodes[] = {\n";
+foreach my $node (@nodes) {
+    my $num_attributes = scalar @{$node->{attributes}};
+    my $num_children = scalar @{$node->{children}};
+    printf "  { %s, %s, %u, %s, %u },\n",
+        quote($node->{name}),
+        $num_attributes > 0 ? "dialog_attributes + $node->{first_attribute}" : "NULL",
+        $num_attributes,
+        $num_children > 0 ? "dialog_nodes + $node->{first_child}" : "NULL",
+        $num_children;
+}
+print "};\n\n";
+
+print "/* sorted by name, for binary search */\n";
+print "static const DialogTableEntry dialog_table[] = {\n";
+foreach my $name (sort keys %roots) {
+    print "  { ", quote($name), ", dialog_nodes + $roots{$name} },\n";
+}
+print "};\n";